@@ -331,7 +331,8 @@ pub fn build(b: *Builder) void {
     "src/node/miner.c",
     "src/node/node.c",
     "src/node/pool.c",
-    "src/node/rpc.c"
+    "src/node/rpc.c",
+    "src/node/txreq.c"
   };
 
   const wallet_sources = [_][]const u8{
@@ -531,8 +532,11 @@ pub fn build(b: *Builder) void {
       "mempool",
       "miner",
       "rpc",
+      "txreq",
       // wallet
-      "wallet"
+      "wallet",
+      // lcdb
+      "lcdb"
     };
 
     for (node_tests) |name| {
@@ -546,6 +550,7 @@ pub fn build(b: *Builder) void {
                          defines.items,
                          libs.items);
 
+      t.addIncludeDir("./deps/lcdb/include");
       t.linkLibrary(node);
       t.linkLibrary(wallet);
       t.linkLibrary(client);
@@ -571,6 +576,7 @@ pub fn build(b: *Builder) void {
     "bip340",
     "chacha20",
     "drbg",
+    "ecc",
     "ecdsa",
     "hash160",
     "hash256",
@@ -70,6 +70,7 @@ typedef struct ldb_batch_s ldb_batch_t;
 typedef struct ldb_bloom_s ldb_bloom_t;
 typedef struct ldb_comparator_s ldb_comparator_t;
 typedef struct ldb_dbopt_s ldb_dbopt_t;
+typedef struct ldb_family_s ldb_family_t;
 typedef struct ldb_handler_s ldb_handler_t;
 typedef struct ldb_iter_s ldb_iter_t;
 typedef struct ldb_logger_s ldb_logger_t;
@@ -118,16 +119,26 @@ struct ldb_dbopt_s {
   ldb_lru_t *block_cache;
   size_t block_size;
   int block_restart_interval;
+  int block_hash_index;
+  size_t index_partition_size;
   size_t max_file_size;
+  size_t rate_limit;
   enum ldb_compression compression;
   int reuse_logs;
   ldb_bloom_t *filter_policy;
   int use_mmap;
 };
 
+struct ldb_family_s {
+  const char *name;
+  const ldb_dbopt_t *options;
+  ldb_t *handle;
+};
+
 struct ldb_handler_s {
   void *state;
   uint64_t number;
+  int family;
 
   void (*put)(ldb_handler_t *handler,
               const ldb_slice_t *key,
@@ -160,6 +171,7 @@ struct ldb_readopt_s {
 
 struct ldb_writeopt_s {
   int sync;
+  int disable_wal;
 };
 
 struct ldb_s {
@@ -228,6 +240,17 @@ ldb_batch_put(ldb_batch_t *batch,
 LDB_EXTERN void
 ldb_batch_del(ldb_batch_t *batch, const ldb_slice_t *key);
 
+LDB_EXTERN void
+ldb_batch_put_family(ldb_batch_t *batch,
+                     const ldb_t *family,
+                     const ldb_slice_t *key,
+                     const ldb_slice_t *value);
+
+LDB_EXTERN void
+ldb_batch_del_family(ldb_batch_t *batch,
+                     const ldb_t *family,
+                     const ldb_slice_t *key);
+
 LDB_EXTERN int
 ldb_batch_iterate(const ldb_batch_t *batch, ldb_handler_t *handler);
 
@@ -252,6 +275,13 @@ ldb_lru_destroy(ldb_lru_t *lru);
 LDB_EXTERN int
 ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr);
 
+LDB_EXTERN int
+ldb_open_families(const char *dbname,
+                  const ldb_dbopt_t *options,
+                  ldb_family_t *families,
+                  int length,
+                  ldb_t **dbptr);
+
 LDB_EXTERN void
 ldb_close(ldb_t *db);
 
@@ -291,6 +321,9 @@ ldb_approximate_sizes(ldb_t *db, const ldb_range_t *range,
 LDB_EXTERN void
 ldb_compact(ldb_t *db, const ldb_slice_t *begin, const ldb_slice_t *end);
 
+LDB_EXTERN int
+ldb_flush(ldb_t *db);
+
 LDB_EXTERN int
 ldb_backup(ldb_t *db, const char *name);
 
@@ -572,6 +605,7 @@ static leveldb_writeoptions_t *
 convert_writeopt(const ldb_writeopt_t *x) {
   leveldb_writeoptions_t *z = leveldb_writeoptions_create();
 
+  /* Note that x->disable_wal is ignored. */
   leveldb_writeoptions_set_sync(z, x->sync);
 
   return z;
@@ -624,6 +658,23 @@ ldb_batch_del(ldb_batch_t *batch, const ldb_slice_t *key) {
   leveldb_writebatch_delete(batch->rep, key->data, key->size);
 }
 
+void
+ldb_batch_put_family(ldb_batch_t *batch,
+                     const ldb_t *family,
+                     const ldb_slice_t *key,
+                     const ldb_slice_t *value) {
+  (void)family;
+  ldb_batch_put(batch, key, value);
+}
+
+void
+ldb_batch_del_family(ldb_batch_t *batch,
+                     const ldb_t *family,
+                     const ldb_slice_t *key) {
+  (void)family;
+  ldb_batch_del(batch, key);
+}
+
 static void
 batch_put(void *state, const char *k, size_t klen,
                        const char *v, size_t vlen) {
@@ -636,6 +687,7 @@ batch_put(void *state, const char *k, size_t klen,
   val.data = (void *)v;
   val.size = vlen;
 
+  handler->family = 0;
   handler->put(handler, &key, &val);
 }
 
@@ -647,6 +699,7 @@ batch_del(void *state, const char *k, size_t klen) {
   key.data = (void *)k;
   key.size = klen;
 
+  handler->family = 0;
   handler->del(handler, &key);
 }
 
@@ -782,6 +835,26 @@ ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr) {
   return rc;
 }
 
+/* leveldb has no column families. Every family is backed by the
+   database itself, so callers must keep the families' keys apart
+   and close only the database handle. */
+int
+ldb_open_families(const char *dbname,
+                  const ldb_dbopt_t *options,
+                  ldb_family_t *families,
+                  int length,
+                  ldb_t **dbptr) {
+  int rc = ldb_open(dbname, options, dbptr);
+  int i;
+
+  if (rc == LDB_OK) {
+    for (i = 0; i < length; i++)
+      families[i].handle = *dbptr;
+  }
+
+  return rc;
+}
+
 void
 ldb_close(ldb_t *db) {
   if (db->level != NULL)
@@ -961,6 +1034,14 @@ ldb_compact(ldb_t *db, const ldb_slice_t *begin, const ldb_slice_t *end) {
                                    end->data, end->size);
 }
 
+int
+ldb_flush(ldb_t *db) {
+  /* Writes always go through the leveldb log (disable_wal
+     is not supported), so there is nothing to persist. */
+  (void)db;
+  return LDB_OK;
+}
+
 int
 ldb_backup(ldb_t *db, const char *name) {
   ldb_readopt_t iopt = *ldb_iteropt_default;
@@ -1404,7 +1485,10 @@ static const ldb_dbopt_t db_options = {
   /* .block_cache = */ NULL,
   /* .block_size = */ 4 * 1024,
   /* .block_restart_interval = */ 16,
+  /* .block_hash_index = */ 0,
+  /* .index_partition_size = */ 0,
   /* .max_file_size = */ 2 * 1024 * 1024,
+  /* .rate_limit = */ 0,
   /* .compression = */ LDB_SNAPPY_COMPRESSION,
   /* .reuse_logs = */ 0,
   /* .filter_policy = */ NULL,
@@ -1418,7 +1502,8 @@ static const ldb_readopt_t read_options = {
 };
 
 static const ldb_writeopt_t write_options = {
-  /* .sync = */ 0
+  /* .sync = */ 0,
+  /* .disable_wal = */ 0
 };
 
 static const ldb_readopt_t iter_options = {
@@ -65,6 +65,7 @@ typedef struct ldb_batch_s ldb_batch_t;
 typedef struct ldb_bloom_s ldb_bloom_t;
 typedef struct ldb_comparator_s ldb_comparator_t;
 typedef struct ldb_dbopt_s ldb_dbopt_t;
+typedef struct ldb_family_s ldb_family_t;
 typedef struct ldb_handler_s ldb_handler_t;
 typedef struct ldb_iter_s ldb_iter_t;
 typedef struct ldb_logger_s ldb_logger_t;
@@ -109,16 +110,26 @@ struct ldb_dbopt_s {
   ldb_lru_t *block_cache;
   size_t block_size;
   int block_restart_interval;
+  int block_hash_index;
+  size_t index_partition_size;
   size_t max_file_size;
+  size_t rate_limit;
   enum ldb_compression compression;
   int reuse_logs;
   const ldb_bloom_t *filter_policy;
   int use_mmap;
 };
 
+struct ldb_family_s {
+  const char *name;
+  const ldb_dbopt_t *options;
+  ldb_t *handle;
+};
+
 struct ldb_handler_s {
   void *state;
   ldb_uint64_t number;
+  int family;
 
   void (*put)(ldb_handler_t *handler,
               const ldb_slice_t *key,
@@ -141,6 +152,7 @@ struct ldb_readopt_s {
 
 struct ldb_writeopt_s {
   int sync;
+  int disable_wal;
 };
 
 /*
@@ -196,6 +208,17 @@ ldb_batch_put(ldb_batch_t *batch,
 void
 ldb_batch_del(ldb_batch_t *batch, const ldb_slice_t *key);
 
+void
+ldb_batch_put_family(ldb_batch_t *batch,
+                     const ldb_t *family,
+                     const ldb_slice_t *key,
+                     const ldb_slice_t *value);
+
+void
+ldb_batch_del_family(ldb_batch_t *batch,
+                     const ldb_t *family,
+                     const ldb_slice_t *key);
+
 int
 ldb_batch_iterate(const ldb_batch_t *batch, ldb_handler_t *handler);
 
@@ -260,6 +283,13 @@ ldb_lru_destroy(ldb_lru_t *lru);
 int
 ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr);
 
+int
+ldb_open_families(const char *dbname,
+                  const ldb_dbopt_t *options,
+                  ldb_family_t *families,
+                  int length,
+                  ldb_t **dbptr);
+
 void
 ldb_close(ldb_t *db);
 
@@ -299,6 +329,9 @@ ldb_approximate_sizes(ldb_t *db, const ldb_range_t *range,
 void
 ldb_compact(ldb_t *db, const ldb_slice_t *begin, const ldb_slice_t *end);
 
+int
+ldb_flush(ldb_t *db);
+
 int
 ldb_backup(ldb_t *db, const char *name);
 
@@ -36,7 +36,8 @@ ldb_build_table(const char *dbname,
                 const ldb_dbopt_t *options,
                 ldb_tables_t *table_cache,
                 ldb_iter_t *iter,
-                ldb_filemeta_t *meta) {
+                ldb_filemeta_t *meta,
+                ldb_ratelim_t *ratelim) {
   char fname[LDB_PATH_MAX];
   int rc = LDB_OK;
 
@@ -58,6 +59,9 @@ ldb_build_table(const char *dbname,
     if (rc != LDB_OK)
       return rc;
 
+    if (ratelim != NULL)
+      ldb_wfile_limit(file, ratelim);
+
     builder = ldb_tablegen_create(options, file);
 
     key = ldb_iter_key(iter);
@@ -20,6 +20,7 @@
 struct ldb_dbopt_s;
 struct ldb_filemeta_s;
 struct ldb_iter_s;
+struct ldb_ratelim_s;
 struct ldb_tables_s;
 
 /*
@@ -30,12 +31,14 @@ struct ldb_tables_s;
    will be named according to meta->number. On success, the rest of
    *meta will be filled with metadata about the generated table.
    If no data is present in *iter, meta->file_size will be set to
-   zero, and no Table file will be produced. */
+   zero, and no Table file will be produced. Writes are throttled
+   through ratelim if it is non-null. */
 int
 ldb_build_table(const char *dbname,
                 const struct ldb_dbopt_s *options,
                 struct ldb_tables_s *table_cache,
                 struct ldb_iter_s *iter,
-                struct ldb_filemeta_s *meta);
+                struct ldb_filemeta_s *meta,
+                struct ldb_ratelim_s *ratelim);
 
 #endif /* LDB_BUILDER_H */
@@ -117,6 +117,7 @@ typedef struct ldb_waiter_s {
   int status;
   ldb_batch_t *batch;
   int sync;
+  int disable_wal;
   int done;
   ldb_cond_t cv;
   struct ldb_waiter_s *next;
@@ -127,6 +128,7 @@ ldb_waiter_init(ldb_waiter_t *w) {
   w->status = LDB_OK;
   w->batch = NULL;
   w->sync = 0;
+  w->disable_wal = 0;
   w->done = 0;
   w->next = NULL;
 
@@ -341,6 +343,9 @@ ldb_sanitize_options(const char *dbname,
   clip_to_range(result.max_file_size, 1 << 20, 1 << 30);
   clip_to_range(result.block_size, 1 << 10, 4 << 20);
 
+  if (result.index_partition_size > 0)
+    clip_to_range(result.index_partition_size, 1 << 10, 4 << 20);
+
   if (result.info_log == NULL) {
     char info[LDB_PATH_MAX];
     char old[LDB_PATH_MAX];
@@ -408,6 +413,7 @@ struct ldb_s {
   ldb_wfile_t *logfile;
   uint64_t logfile_number;
   ldb_writer_t *log;
+  int unlogged; /* Memtables hold writes missing from the log. */
   uint32_t seed; /* For sampling. */
 
   /* Queue of writers. */
@@ -420,9 +426,20 @@ struct ldb_s {
      part of ongoing compactions. */
   rb_set64_t pending_outputs;
 
+  /* Number of checkpoints linking our files. Obsolete
+     files are not deleted until they are finished. */
+  int checkpoints;
+
   /* Thread pool. */
   ldb_pool_t *pool;
 
+  /* Throttles table writes (NULL if options.rate_limit is zero).
+     Families use their parent's, so the limit covers all of them. */
+  ldb_ratelim_t *ratelim;
+
+  /* How far this database wants the limit relaxed (see below). */
+  ldb_atomic(int) relax;
+
   /* Has a background compaction been scheduled or is running? */
   int background_compaction_scheduled;
 
@@ -434,6 +451,16 @@ struct ldb_s {
   int bg_error;
 
   ldb_stats_t stats[LDB_NUM_LEVELS];
+
+  /* Column families. A family has its own memtables, tables and
+     manifest, but no log: its writes go through the parent's log
+     and share the parent's sequence space. A family's mutex may be
+     acquired while holding its parent's, never the other way. */
+  ldb_t *parent;
+  uint32_t family_id;
+  ldb_t **families;
+  int num_families;
+  ldb_memtable_t **tables; /* Scratch space for batch insertion. */
 };
 
 static ldb_t *
@@ -489,6 +516,7 @@ ldb_create(const char *dbname, const ldb_dbopt_t *options) {
 
   db->logfile = NULL;
   db->logfile_number = 0;
+  db->unlogged = 0;
   db->log = NULL;
   db->seed = 0;
 
@@ -500,8 +528,16 @@ ldb_create(const char *dbname, const ldb_dbopt_t *options) {
   rb_set64_init(&db->pending_outputs);
 
   db->pool = ldb_pool_create(1);
+  db->ratelim = NULL;
+
+  if (db->options.rate_limit > 0)
+    db->ratelim = ldb_ratelim_create(db->options.rate_limit);
+
+  ldb_atomic_init(&db->relax, 0);
+
   db->background_compaction_scheduled = 0;
   db->manual_compaction = NULL;
+  db->checkpoints = 0;
 
   db->versions = ldb_versions_create(db->dbname,
                                      &db->options,
@@ -513,11 +549,19 @@ ldb_create(const char *dbname, const ldb_dbopt_t *options) {
   for (i = 0; i < LDB_NUM_LEVELS; i++)
     ldb_stats_init(&db->stats[i]);
 
+  db->parent = NULL;
+  db->family_id = 0;
+  db->families = NULL;
+  db->num_families = 0;
+  db->tables = NULL;
+
   return db;
 }
 
 static void
 ldb_destroy_internal(ldb_t *db) {
+  int i;
+
   /* Wait for background work to finish. */
   ldb_mutex_lock(&db->mutex);
 
@@ -530,6 +574,21 @@ ldb_destroy_internal(ldb_t *db) {
 
   ldb_pool_destroy(db->pool);
 
+  /* Our background thread may lock the families. */
+  for (i = 0; i < db->num_families; i++) {
+    if (db->families[i] != NULL)
+      ldb_destroy_internal(db->families[i]);
+  }
+
+  if (db->families != NULL)
+    ldb_free(db->families);
+
+  if (db->tables != NULL)
+    ldb_free(db->tables);
+
+  if (db->ratelim != NULL && db->parent == NULL)
+    ldb_ratelim_destroy(db->ratelim);
+
   if (db->db_lock != NULL)
     ldb_unlock_file(db->db_lock);
 
@@ -573,6 +632,29 @@ ldb_user_comparator(const ldb_t *db) {
   return db->internal_comparator.user_comparator;
 }
 
+/* Return the oldest log which may still hold
+   updates for the database or one of its families. */
+static uint64_t
+ldb_min_log_number(ldb_t *db) {
+  uint64_t number = db->versions->log_number;
+  int i;
+
+  ldb_mutex_assert_held(&db->mutex);
+
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
+
+    ldb_mutex_lock(&cf->mutex);
+
+    if (cf->versions->log_number < number)
+      number = cf->versions->log_number;
+
+    ldb_mutex_unlock(&cf->mutex);
+  }
+
+  return number;
+}
+
 static int
 ldb_new_db(ldb_t *db) {
   char manifest[LDB_PATH_MAX];
@@ -646,6 +728,7 @@ ldb_remove_obsolete_files(ldb_t *db) {
   char **filenames = NULL;
   ldb_vector_t to_delete;
   ldb_filetype_t type;
+  uint64_t min_log;
   rb_set64_t live;
   uint64_t number;
   int i, len;
@@ -658,6 +741,11 @@ ldb_remove_obsolete_files(ldb_t *db) {
     return;
   }
 
+  if (db->checkpoints > 0) {
+    /* Collected once the checkpoint is finished. */
+    return;
+  }
+
   rb_set64_init(&live);
   ldb_vector_init(&to_delete);
 
@@ -666,6 +754,8 @@ ldb_remove_obsolete_files(ldb_t *db) {
 
   ldb_versions_add_files(db->versions, &live);
 
+  min_log = ldb_min_log_number(db);
+
   len = ldb_get_children(db->dbname, &filenames); /* Ignoring errors. */
 
   for (i = 0; i < len; i++) {
@@ -676,7 +766,7 @@ ldb_remove_obsolete_files(ldb_t *db) {
 
       switch (type) {
         case LDB_FILE_LOG:
-          keep = ((number >= db->versions->log_number) ||
+          keep = ((number >= min_log) ||
                   (number == db->versions->prev_log_number));
           break;
         case LDB_FILE_DESC:
@@ -769,7 +859,8 @@ ldb_write_level0_table(ldb_t *db, ldb_memtable_t *mem,
                          &db->options,
                          db->table_cache,
                          iter,
-                         &meta);
+                         &meta,
+                         db->ratelim);
 
     ldb_mutex_lock(&db->mutex);
   }
@@ -838,9 +929,27 @@ ldb_recover_log_file(ldb_t *db, uint64_t log_number,
   int compactions = 0;
   ldb_memtable_t *mem = NULL;
   ldb_reader_t reader;
+  int ours = 1;
+  int i;
 
   ldb_mutex_assert_held(&db->mutex);
 
+  /* With families, logs are replayed from the oldest log any family
+     needs. Each family only takes records from its own logs. */
+  if (db->num_families > 0) {
+    ours = (log_number >= db->versions->log_number ||
+            log_number == db->versions->prev_log_number);
+
+    for (i = 0; i < db->num_families; i++) {
+      ldb_t *cf = db->families[i];
+
+      if (log_number >= cf->versions->log_number)
+        db->tables[i + 1] = cf->mem;
+      else
+        db->tables[i + 1] = NULL;
+    }
+  }
+
   /* Open the log file. */
   if (!ldb_log_filename(fname, sizeof(fname), db->dbname, log_number))
     return LDB_INVALID;
@@ -881,12 +990,19 @@ ldb_recover_log_file(ldb_t *db, uint64_t log_number,
 
     ldb_batch_set_contents(&batch, &record);
 
-    if (mem == NULL) {
+    if (mem == NULL && ours) {
       mem = ldb_memtable_create(&db->internal_comparator);
       ldb_memtable_ref(mem);
     }
 
-    rc = ldb_batch_insert_into(&batch, mem);
+    if (db->num_families > 0) {
+      db->tables[0] = mem;
+
+      rc = ldb_batch_insert_families(&batch, db->tables,
+                                     db->num_families + 1);
+    } else {
+      rc = ldb_batch_insert_into(&batch, mem);
+    }
 
     ldb_maybe_ignore_error(db, &rc);
 
@@ -898,7 +1014,8 @@ ldb_recover_log_file(ldb_t *db, uint64_t log_number,
     if (last_seq > *max_sequence)
       *max_sequence = last_seq;
 
-    if (ldb_memtable_usage(mem) > db->options.write_buffer_size) {
+    if (mem != NULL &&
+        ldb_memtable_usage(mem) > db->options.write_buffer_size) {
       compactions++;
       *save_manifest = 1;
 
@@ -921,7 +1038,8 @@ ldb_recover_log_file(ldb_t *db, uint64_t log_number,
   ldb_rfile_destroy(file);
 
   /* See if we should keep reusing the last log file. */
-  if (rc == LDB_OK && db->options.reuse_logs && last_log && compactions == 0) {
+  if (rc == LDB_OK && db->options.reuse_logs && last_log &&
+      compactions == 0 && db->num_families == 0) {
     uint64_t lfile_size;
 
     assert(db->logfile == NULL);
@@ -964,11 +1082,223 @@ compare_ascending(uint64_t x, uint64_t y) {
   return LDB_CMP(x, y);
 }
 
+static ldb_t *
+ldb_create(const char *dbname, const ldb_dbopt_t *options);
+
+static int
+ldb_recover(ldb_t *db, ldb_edit_t *edit, int *save_manifest,
+                       const ldb_family_t *families,
+                       int length);
+
+static void
+ldb_maybe_schedule_compaction(ldb_t *db);
+
+static int
+ldb_family_name_valid(const char *name) {
+  size_t len = strlen(name);
+  size_t i;
+
+  if (len == 0 || len > 64 || name[0] == '.')
+    return 0;
+
+  for (i = 0; i < len; i++) {
+    int ch = name[i];
+
+    if (ch >= '0' && ch <= '9')
+      continue;
+
+    if (ch >= 'A' && ch <= 'Z')
+      continue;
+
+    if (ch >= 'a' && ch <= 'z')
+      continue;
+
+    if (ch == '_' || ch == '-' || ch == '.')
+      continue;
+
+    return 0;
+  }
+
+  return 1;
+}
+
+/* Family ids are positional and are written to the log, so the list
+   of families may only grow. The FAMILIES file records the list the
+   database was last opened with. */
+static int
+ldb_check_families(ldb_t *db, const ldb_family_t *families, int length) {
+  char path[LDB_PATH_MAX];
+  ldb_buffer_t expect, data;
+  int rc = LDB_OK;
+  int i;
+
+  if (!ldb_families_filename(path, sizeof(path), db->dbname))
+    return LDB_INVALID;
+
+  ldb_buffer_init(&expect);
+  ldb_buffer_init(&data);
+
+  for (i = 0; i < length; i++) {
+    ldb_buffer_string(&expect, families[i].name);
+    ldb_buffer_push(&expect, '\n');
+  }
+
+  if (ldb_file_exists(path))
+    rc = ldb_read_file(path, &data);
+
+  if (rc == LDB_OK) {
+    if (data.size > expect.size)
+      rc = LDB_INVALID; /* "missing column families" */
+    else if (data.size > 0 && memcmp(data.data, expect.data, data.size) != 0)
+      rc = LDB_INVALID; /* "column families reordered" */
+  }
+
+  if (rc == LDB_OK && data.size < expect.size)
+    rc = ldb_write_file(path, &expect, 1);
+
+  ldb_buffer_clear(&expect);
+  ldb_buffer_clear(&data);
+
+  return rc;
+}
+
+static int
+ldb_open_family(ldb_t *db, const ldb_family_t *family,
+                           uint32_t id,
+                           ldb_t **cfptr) {
+  char path[LDB_PATH_MAX - 35];
+  ldb_dbopt_t options;
+  int save_manifest = 0;
+  ldb_edit_t edit;
+  ldb_t *cf;
+  int rc;
+
+  if (!ldb_family_name_valid(family->name))
+    return LDB_INVALID;
+
+  if (!ldb_join(path, sizeof(path), db->dbname, family->name))
+    return LDB_INVALID;
+
+  options = family->options != NULL ? *family->options : *ldb_dbopt_default;
+
+  if (options.filter_policy != NULL) {
+    if (strlen(options.filter_policy->name) > 64)
+      return LDB_INVALID;
+  }
+
+  /* Families come and go with their parent. */
+  options.create_if_missing = 1;
+  options.error_if_exists = 0;
+  options.reuse_logs = 0;
+
+  /* ...and share its write limit. */
+  options.rate_limit = 0;
+
+  *cfptr = cf = ldb_create(path, &options);
+
+  cf->parent = db;
+  cf->family_id = id;
+  cf->ratelim = db->ratelim;
+
+  ldb_edit_init(&edit);
+  ldb_mutex_lock(&cf->mutex);
+
+  /* A family has no logs of its own to recover. */
+  rc = ldb_recover(cf, &edit, &save_manifest, NULL, 0);
+
+  if (rc == LDB_OK) {
+    cf->mem = ldb_memtable_create(&cf->internal_comparator);
+
+    ldb_memtable_ref(cf->mem);
+  }
+
+  if (rc == LDB_OK && save_manifest)
+    rc = ldb_versions_apply(cf->versions, &edit, &cf->mutex);
+
+  ldb_mutex_unlock(&cf->mutex);
+  ldb_edit_clear(&edit);
+
+  return rc;
+}
+
+static int
+ldb_open_families_inner(ldb_t *db, const ldb_family_t *families,
+                                   int length) {
+  int rc = ldb_check_families(db, families, length);
+  int i;
+
+  if (rc != LDB_OK || length == 0)
+    return rc;
+
+  db->families = ldb_malloc(length * sizeof(ldb_t *));
+  db->tables = ldb_malloc((length + 1) * sizeof(ldb_memtable_t *));
+
+  for (i = 0; i < length; i++)
+    db->families[i] = NULL;
+
+  db->num_families = length;
+
+  for (i = 0; i < length && rc == LDB_OK; i++)
+    rc = ldb_open_family(db, &families[i], i + 1, &db->families[i]);
+
+  return rc;
+}
+
+/* Flush whatever the families recovered from the log and point
+   them at the parent's new log. */
+static int
+ldb_finish_families(ldb_t *db) {
+  int rc = LDB_OK;
+  int i;
+
+  ldb_mutex_assert_held(&db->mutex);
+
+  for (i = 0; i < db->num_families && rc == LDB_OK; i++) {
+    ldb_t *cf = db->families[i];
+    ldb_edit_t edit;
+
+    ldb_edit_init(&edit);
+    ldb_mutex_lock(&cf->mutex);
+
+    rc = ldb_write_level0_table(cf, cf->mem, &edit, NULL);
+
+    if (rc == LDB_OK) {
+      ldb_memtable_unref(cf->mem);
+
+      cf->mem = ldb_memtable_create(&cf->internal_comparator);
+
+      ldb_memtable_ref(cf->mem);
+
+      cf->logfile_number = db->logfile_number;
+      cf->versions->last_sequence = db->versions->last_sequence;
+
+      ldb_versions_mark_file_number(cf->versions, cf->logfile_number);
+
+      ldb_edit_set_prev_log_number(&edit, 0);
+      ldb_edit_set_log_number(&edit, cf->logfile_number);
+
+      rc = ldb_versions_apply(cf->versions, &edit, &cf->mutex);
+    }
+
+    if (rc == LDB_OK) {
+      ldb_remove_obsolete_files(cf);
+      ldb_maybe_schedule_compaction(cf);
+    }
+
+    ldb_mutex_unlock(&cf->mutex);
+    ldb_edit_clear(&edit);
+  }
+
+  return rc;
+}
+
 /* Recover the descriptor from persistent storage. May do a significant
    amount of work to recover recently logged updates. Any changes to
    be made to the descriptor are added to *edit. */
 static int
-ldb_recover(ldb_t *db, ldb_edit_t *edit, int *save_manifest) {
+ldb_recover(ldb_t *db, ldb_edit_t *edit, int *save_manifest,
+                       const ldb_family_t *families,
+                       int length) {
   uint64_t min_log, prev_log, number;
   ldb_seqnum_t max_sequence = 0;
   char path[LDB_PATH_MAX];
@@ -1022,6 +1352,13 @@ ldb_recover(ldb_t *db, ldb_edit_t *edit, int *save_manifest) {
   if (rc != LDB_OK)
     return rc;
 
+  if (db->parent == NULL) {
+    rc = ldb_open_families_inner(db, families, length);
+
+    if (rc != LDB_OK)
+      return rc;
+  }
+
   /* Recover from all newer log files than the ones named in the
    * descriptor (new log files may have been added by the previous
    * incarnation without registering them in the descriptor).
@@ -1030,7 +1367,7 @@ ldb_recover(ldb_t *db, ldb_edit_t *edit, int *save_manifest) {
    * attention to it in case we are recovering a database
    * produced by an older version of leveldb.
    */
-  min_log = db->versions->log_number;
+  min_log = ldb_min_log_number(db);
   prev_log = db->versions->prev_log_number;
 
   len = ldb_get_children(db->dbname, &filenames);
@@ -1081,6 +1418,18 @@ ldb_recover(ldb_t *db, ldb_edit_t *edit, int *save_manifest) {
   if (db->versions->last_sequence < max_sequence)
     db->versions->last_sequence = max_sequence;
 
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
+
+    if (db->versions->last_sequence < cf->versions->last_sequence)
+      db->versions->last_sequence = cf->versions->last_sequence;
+  }
+
+  /* Families are flushed after recovery, so the logs we
+     replayed are always obsoleted by a new manifest. */
+  if (db->num_families > 0 && logs.length > 0)
+    *save_manifest = 1;
+
   rc = LDB_OK;
 fail:
   rb_set64_clear(&expected);
@@ -1099,6 +1448,52 @@ ldb_record_background_error(ldb_t *db, int status) {
   }
 }
 
+/* Relax the table write limit as level-0 fills up. Throttled
+   compactions should smooth out I/O, not be the reason that
+   writers get slowed down or stopped. A parent and its families
+   share one limiter, so it is relaxed as far as any of them
+   wants: one family's quota must not stall another's writers. */
+#define LDB_RELAX_MAX 31 /* Unlimited. */
+
+static void
+ldb_tune_ratelim(ldb_t *db) {
+  ldb_t *root = db->parent != NULL ? db->parent : db;
+  int64_t rate = root->options.rate_limit;
+  int files, relax, i;
+
+  ldb_mutex_assert_held(&db->mutex);
+
+  if (db->ratelim == NULL)
+    return;
+
+  files = ldb_versions_files(db->versions, 0);
+
+  if (files >= LDB_L0_SLOWDOWN_WRITES_TRIGGER - 2)
+    relax = LDB_RELAX_MAX;
+  else if (files > LDB_L0_COMPACTION_TRIGGER)
+    relax = files - LDB_L0_COMPACTION_TRIGGER;
+  else
+    relax = 0;
+
+  ldb_atomic_store(&db->relax, relax, ldb_order_relaxed);
+
+  relax = ldb_atomic_load(&root->relax, ldb_order_relaxed);
+
+  for (i = 0; i < root->num_families; i++) {
+    ldb_t *cf = root->families[i];
+
+    if (cf != NULL)
+      relax = LDB_MAX(relax, ldb_atomic_load(&cf->relax, ldb_order_relaxed));
+  }
+
+  if (relax == LDB_RELAX_MAX)
+    rate = 0;
+  else
+    rate <<= relax;
+
+  ldb_ratelim_set_rate(db->ratelim, rate);
+}
+
 /* Compact the in-memory write buffer to disk. Switches to a new
    log-file/memtable and writes a new descriptor iff successful.
    Errors are recorded in bg_error. */
@@ -1132,6 +1527,10 @@ ldb_compact_memtable(ldb_t *db) {
     ldb_edit_set_log_number(&edit, db->logfile_number); /* Earlier logs no
                                                            longer needed. */
 
+    /* A family's log number refers to its parent's log. */
+    if (db->parent != NULL)
+      ldb_versions_mark_file_number(db->versions, db->logfile_number);
+
     rc = ldb_versions_apply(db->versions, &edit, &db->mutex);
   }
 
@@ -1141,6 +1540,7 @@ ldb_compact_memtable(ldb_t *db) {
     db->imm = NULL;
     ldb_atomic_store(&db->has_imm, 0, ldb_order_release);
     ldb_remove_obsolete_files(db);
+    ldb_tune_ratelim(db);
   } else {
     ldb_record_background_error(db, rc);
   }
@@ -1175,8 +1575,12 @@ ldb_open_compaction_output_file(ldb_t *db, ldb_cstate_t *state) {
 
   rc = ldb_truncfile_create(fname, &state->outfile);
 
-  if (rc == LDB_OK)
+  if (rc == LDB_OK) {
+    if (db->ratelim != NULL)
+      ldb_wfile_limit(state->outfile, db->ratelim);
+
     state->builder = ldb_tablegen_create(&db->options, state->outfile);
+  }
 
   return rc;
 }
@@ -1516,6 +1920,8 @@ ldb_background_compaction(ldb_t *db) {
     return;
   }
 
+  ldb_tune_ratelim(db);
+
   if (is_manual) {
     ldb_manual_t *m = db->manual_compaction;
 
@@ -1747,6 +2153,11 @@ ldb_build_batch_group(ldb_t *db, ldb_waiter_t **last_writer) {
       break;
     }
 
+    if (w->disable_wal != first->disable_wal) {
+      /* Do not mix logged and unlogged writes. */
+      break;
+    }
+
     if (w->batch != NULL) {
       size += ldb_batch_size(w->batch);
 
@@ -1774,78 +2185,243 @@ ldb_build_batch_group(ldb_t *db, ldb_waiter_t **last_writer) {
   return result;
 }
 
-/* REQUIRES: db->mutex is held. */
-/* REQUIRES: this thread is currently at the front of the writer queue. */
+/* Column family helpers. These run on the parent with its mutex
+   held, from the thread at the front of the writer queue. Only
+   that thread inserts into or replaces a family's memtable. */
 static int
-ldb_make_room_for_write(ldb_t *db, int force) {
-  size_t write_buffer_size = db->options.write_buffer_size;
-  char fname[LDB_PATH_MAX];
-  int allow_delay = !force;
-  int rc = LDB_OK;
+ldb_family_full(ldb_t *db) {
+  int i;
 
-  ldb_mutex_assert_held(&db->mutex);
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
 
-  assert(db->writers.length > 0);
+    if (ldb_memtable_usage(cf->mem) > cf->options.write_buffer_size)
+      return 1;
+  }
 
-  for (;;) {
-#define L0_FILES ldb_versions_files(db->versions, 0)
-    if (db->bg_error != LDB_OK) {
-      /* Yield previous error. */
-      rc = db->bg_error;
-      break;
-    } else if (allow_delay && L0_FILES >= LDB_L0_SLOWDOWN_WRITES_TRIGGER) {
-      /* We are getting close to hitting a hard limit on the number of
-         L0 files. Rather than delaying a single write by several
-         seconds when we hit the hard limit, start delaying each
-         individual write by 1ms to reduce latency variance. Also,
-         this delay hands over some CPU to the compaction thread in
-         case it is sharing the same core as the writer. */
-      ldb_mutex_unlock(&db->mutex);
-      ldb_sleep_usec(1000);
-      allow_delay = 0; /* Do not delay a single write more than once. */
-      ldb_mutex_lock(&db->mutex);
-    } else if (!force && ldb_memtable_usage(db->mem) <= write_buffer_size) {
-      /* There is room in current memtable. */
-      break;
-    } else if (db->imm != NULL) {
-      /* We have filled up the current memtable, but the previous
-         one is still being compacted, so we wait. */
-      ldb_log(db->options.info_log, "Current memtable full; waiting...");
-      ldb_cond_wait(&db->background_work_finished_signal, &db->mutex);
-    } else if (L0_FILES >= LDB_L0_STOP_WRITES_TRIGGER) {
-      /* There are too many level-0 files. */
-      ldb_log(db->options.info_log, "Too many L0 files; waiting...");
-      ldb_cond_wait(&db->background_work_finished_signal, &db->mutex);
-    } else {
-      ldb_wfile_t *lfile = NULL;
-      uint64_t new_log_number;
+  return 0;
+}
 
-      /* Attempt to switch to a new memtable and trigger compaction of old. */
-      assert(db->versions->prev_log_number == 0);
+static int
+ldb_family_l0_files(ldb_t *db) {
+  int files = ldb_versions_files(db->versions, 0);
+  int i;
 
-      new_log_number = ldb_versions_new_file_number(db->versions);
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
+    int n;
 
-      if (!ldb_log_filename(fname, sizeof(fname), db->dbname, new_log_number))
-        abort(); /* LCOV_EXCL_LINE */
+    ldb_mutex_lock(&cf->mutex);
 
-      rc = ldb_truncfile_create(fname, &lfile);
+    n = ldb_versions_files(cf->versions, 0);
 
-      if (rc != LDB_OK) {
-        /* Avoid chewing through file number space in a tight loop. */
-        ldb_versions_reuse_file_number(db->versions, new_log_number);
-        break;
-      }
+    ldb_mutex_unlock(&cf->mutex);
 
-      if (db->log != NULL)
-        ldb_writer_destroy(db->log);
+    if (n > files)
+      files = n;
+  }
 
-      if (db->logfile != NULL) {
-        rc = ldb_wfile_close(db->logfile);
+  return files;
+}
 
-        if (rc != LDB_OK) {
-          /* We may have lost some data written to the previous log file.
-           * Switch to the new log file anyway, but record as a background
-           * error so we do not attempt any more writes.
+static int
+ldb_family_stalled(ldb_t *cf) {
+  ldb_mutex_assert_held(&cf->mutex);
+
+  if (cf->bg_error != LDB_OK)
+    return 0;
+
+  return cf->imm != NULL
+      || ldb_versions_files(cf->versions, 0) >= LDB_L0_STOP_WRITES_TRIGGER;
+}
+
+/* Return the first family which is not ready to have its memtable
+   switched, either because of a background error or because it is
+   still compacting. */
+static ldb_t *
+ldb_family_busy(ldb_t *db) {
+  int i;
+
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
+    int busy;
+
+    ldb_mutex_lock(&cf->mutex);
+
+    busy = (cf->bg_error != LDB_OK || ldb_family_stalled(cf));
+
+    ldb_mutex_unlock(&cf->mutex);
+
+    if (busy)
+      return cf;
+  }
+
+  return NULL;
+}
+
+/* Wait for a busy family without blocking readers of the parent. */
+static int
+ldb_family_wait(ldb_t *db, ldb_t *cf) {
+  int rc;
+
+  ldb_mutex_unlock(&db->mutex);
+  ldb_mutex_lock(&cf->mutex);
+
+  if (ldb_family_stalled(cf))
+    ldb_log(cf->options.info_log, "Family memtable full; waiting...");
+
+  while (ldb_family_stalled(cf))
+    ldb_cond_wait(&cf->background_work_finished_signal, &cf->mutex);
+
+  rc = cf->bg_error;
+
+  ldb_mutex_unlock(&cf->mutex);
+  ldb_mutex_lock(&db->mutex);
+
+  return rc;
+}
+
+/* Called after the parent has switched to a new log. Every family's
+   memtable is switched along with the parent's so that no family
+   holds an old log hostage. Empty memtables produce no tables. */
+static void
+ldb_family_switch(ldb_t *db) {
+  int i;
+
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
+
+    ldb_mutex_lock(&cf->mutex);
+
+    assert(cf->imm == NULL);
+
+    cf->imm = cf->mem;
+    cf->logfile_number = db->logfile_number;
+
+    ldb_atomic_store(&cf->has_imm, 1, ldb_order_release);
+
+    cf->mem = ldb_memtable_create(&cf->internal_comparator);
+
+    ldb_memtable_ref(cf->mem);
+
+    ldb_maybe_schedule_compaction(cf);
+
+    ldb_mutex_unlock(&cf->mutex);
+  }
+}
+
+static void
+ldb_family_sequence(ldb_t *db, ldb_seqnum_t last_sequence) {
+  int i;
+
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
+
+    ldb_mutex_lock(&cf->mutex);
+
+    assert(last_sequence >= cf->versions->last_sequence);
+
+    cf->versions->last_sequence = last_sequence;
+
+    ldb_mutex_unlock(&cf->mutex);
+  }
+}
+
+/* REQUIRES: db->mutex is held. */
+/* REQUIRES: this thread is currently at the front of the writer queue. */
+static int
+ldb_make_room_for_write(ldb_t *db, int force) {
+  size_t write_buffer_size = db->options.write_buffer_size;
+  char fname[LDB_PATH_MAX];
+  int allow_delay = !force;
+  int rc = LDB_OK;
+
+  ldb_mutex_assert_held(&db->mutex);
+
+  assert(db->writers.length > 0);
+
+  for (;;) {
+#define L0_FILES ldb_versions_files(db->versions, 0)
+    ldb_t *busy = NULL;
+
+    if (db->bg_error != LDB_OK) {
+      /* Yield previous error. */
+      rc = db->bg_error;
+      break;
+    } else if (allow_delay && ldb_family_l0_files(db)
+                              >= LDB_L0_SLOWDOWN_WRITES_TRIGGER) {
+      /* We are getting close to hitting a hard limit on the number of
+         L0 files. Rather than delaying a single write by several
+         seconds when we hit the hard limit, start delaying each
+         individual write by 1ms to reduce latency variance. Also,
+         this delay hands over some CPU to the compaction thread in
+         case it is sharing the same core as the writer. */
+      ldb_mutex_unlock(&db->mutex);
+      ldb_sleep_usec(1000);
+      allow_delay = 0; /* Do not delay a single write more than once. */
+      ldb_mutex_lock(&db->mutex);
+    } else if (!force && ldb_memtable_usage(db->mem) <= write_buffer_size
+                      && !ldb_family_full(db)) {
+      /* There is room in current memtable. */
+      break;
+    } else if (db->imm != NULL) {
+      /* We have filled up the current memtable, but the previous
+         one is still being compacted, so we wait. */
+      ldb_log(db->options.info_log, "Current memtable full; waiting...");
+      ldb_cond_wait(&db->background_work_finished_signal, &db->mutex);
+    } else if ((busy = ldb_family_busy(db)) != NULL) {
+      /* A family is still compacting its previous memtable. */
+      rc = ldb_family_wait(db, busy);
+
+      if (rc != LDB_OK)
+        break;
+    } else if (L0_FILES >= LDB_L0_STOP_WRITES_TRIGGER) {
+      /* There are too many level-0 files. */
+      ldb_log(db->options.info_log, "Too many L0 files; waiting...");
+      ldb_cond_wait(&db->background_work_finished_signal, &db->mutex);
+    } else {
+      ldb_wfile_t *lfile = NULL;
+      uint64_t new_log_number;
+
+      /* Attempt to switch to a new memtable and trigger compaction of old. */
+      assert(db->versions->prev_log_number == 0);
+
+      /* Unlogged writes become durable once the old memtable is flushed.
+         Make sure every logged write made before them is durable too. */
+      if (db->unlogged && db->logfile != NULL) {
+        rc = ldb_wfile_sync(db->logfile);
+
+        if (rc != LDB_OK) {
+          ldb_record_background_error(db, rc);
+          break;
+        }
+
+        db->unlogged = 0;
+      }
+
+      new_log_number = ldb_versions_new_file_number(db->versions);
+
+      if (!ldb_log_filename(fname, sizeof(fname), db->dbname, new_log_number))
+        abort(); /* LCOV_EXCL_LINE */
+
+      rc = ldb_truncfile_create(fname, &lfile);
+
+      if (rc != LDB_OK) {
+        /* Avoid chewing through file number space in a tight loop. */
+        ldb_versions_reuse_file_number(db->versions, new_log_number);
+        break;
+      }
+
+      if (db->log != NULL)
+        ldb_writer_destroy(db->log);
+
+      if (db->logfile != NULL) {
+        rc = ldb_wfile_close(db->logfile);
+
+        if (rc != LDB_OK) {
+          /* We may have lost some data written to the previous log file.
+           * Switch to the new log file anyway, but record as a background
+           * error so we do not attempt any more writes.
            *
            * We could perhaps attempt to save the memtable corresponding
            * to log file and suppress the error if that works, but that
@@ -1868,6 +2444,8 @@ ldb_make_room_for_write(ldb_t *db, int force) {
 
       ldb_memtable_ref(db->mem);
 
+      ldb_family_switch(db);
+
       force = 0; /* Do not force another compaction if have room. */
       ldb_maybe_schedule_compaction(db);
     }
@@ -1981,23 +2559,309 @@ ldb_backup_inner(const char *dbname, const char *bakname, rb_set64_t *live) {
   return rc;
 }
 
+/*
+ * Checkpoint
+ */
+
+/* A checkpoint records the files making up a database (or one of its
+   families) at a point in time. Tables are immutable and get linked.
+   The manifest and current log are appended to, so only the part of
+   them written at that point is copied. */
+typedef struct ldb_ckpt_s {
+  rb_set64_t live;
+  uint64_t manifest_number;
+  uint64_t manifest_size;
+  uint64_t min_log;
+  uint64_t prev_log;
+  uint64_t log_number;
+  uint64_t log_size;
+} ldb_ckpt_t;
+
+static void
+ldb_ckpt_init(ldb_ckpt_t *ckpt) {
+  rb_set64_init(&ckpt->live);
+
+  ckpt->manifest_number = 0;
+  ckpt->manifest_size = 0;
+  ckpt->min_log = 0;
+  ckpt->prev_log = 0;
+  ckpt->log_number = 0;
+  ckpt->log_size = 0;
+}
+
+static void
+ldb_ckpt_clear(ldb_ckpt_t *ckpt) {
+  rb_set64_clear(&ckpt->live);
+}
+
+static int
+ldb_checkpoint_begin(ldb_t *db, ldb_ckpt_t *ckpt) {
+  char path[LDB_PATH_MAX];
+
+  ldb_mutex_assert_held(&db->mutex);
+
+  /* Nothing may be halfway through writing the manifest. */
+  while (db->background_compaction_scheduled)
+    ldb_cond_wait(&db->background_work_finished_signal, &db->mutex);
+
+  if (db->bg_error != LDB_OK)
+    return db->bg_error;
+
+  ldb_versions_add_files(db->versions, &ckpt->live);
+
+  ckpt->manifest_number = db->versions->manifest_file_number;
+  ckpt->min_log = db->versions->log_number;
+  ckpt->prev_log = db->versions->prev_log_number;
+
+  if (!ldb_desc_filename(path, sizeof(path), db->dbname,
+                                             ckpt->manifest_number)) {
+    return LDB_INVALID;
+  }
+
+  return ldb_file_size(path, &ckpt->manifest_size);
+}
+
+static void
+ldb_checkpoint_end(ldb_t *db) {
+  ldb_mutex_assert_held(&db->mutex);
+
+  if (--db->checkpoints == 0)
+    ldb_remove_obsolete_files(db);
+}
+
+static int
+ldb_copy_prefix(const char *from, const char *to, uint64_t size) {
+  unsigned char *buf = ldb_malloc(1 << 16);
+  ldb_rfile_t *rfile = NULL;
+  ldb_wfile_t *wfile = NULL;
+  ldb_slice_t chunk;
+  size_t want;
+  int rc;
+
+  rc = ldb_seqfile_create(from, &rfile);
+
+  if (rc == LDB_OK)
+    rc = ldb_truncfile_create(to, &wfile);
+
+  while (rc == LDB_OK && size > 0) {
+    want = size < (1 << 16) ? (size_t)size : (1 << 16);
+
+    rc = ldb_rfile_read(rfile, &chunk, buf, want);
+
+    if (rc != LDB_OK || chunk.size == 0)
+      break;
+
+    rc = ldb_wfile_append(wfile, &chunk);
+
+    size -= chunk.size;
+  }
+
+  if (rc == LDB_OK)
+    rc = ldb_wfile_sync(wfile);
+
+  if (rc == LDB_OK)
+    rc = ldb_wfile_close(wfile);
+
+  if (wfile != NULL)
+    ldb_wfile_destroy(wfile);
+
+  if (rfile != NULL)
+    ldb_rfile_destroy(rfile);
+
+  ldb_free(buf);
+
+  return rc;
+}
+
+static int
+ldb_checkpoint_dir(const char *dbname,
+                   const char *bakname,
+                   const ldb_ckpt_t *ckpt) {
+  char **filenames = NULL;
+  char src[LDB_PATH_MAX];
+  char dst[LDB_PATH_MAX];
+  ldb_filetype_t type;
+  uint64_t number;
+  int rc = LDB_OK;
+  int i, len;
+
+  len = ldb_get_children(dbname, &filenames);
+
+  if (len < 0)
+    return ldb_system_error();
+
+  for (i = 0; i < len && rc == LDB_OK; i++) {
+    const char *filename = filenames[i];
+
+    if (!ldb_parse_filename(&type, &number, filename))
+      continue;
+
+    if (!ldb_join(src, sizeof(src), dbname, filename)) {
+      rc = LDB_INVALID;
+      break;
+    }
+
+    if (!ldb_join(dst, sizeof(dst), bakname, filename)) {
+      rc = LDB_INVALID;
+      break;
+    }
+
+    switch (type) {
+      case LDB_FILE_LOG:
+        if (ckpt->log_number == 0)
+          break;
+
+        if (number == ckpt->log_number)
+          rc = ldb_copy_prefix(src, dst, ckpt->log_size);
+        else if (number >= ckpt->min_log || number == ckpt->prev_log)
+          rc = ldb_copy_file(src, dst);
+
+        break;
+      case LDB_FILE_DESC:
+        if (number == ckpt->manifest_number)
+          rc = ldb_copy_prefix(src, dst, ckpt->manifest_size);
+        break;
+      case LDB_FILE_TABLE:
+        if (rb_set64_has(&ckpt->live, number))
+          rc = ldb_link_file(src, dst);
+        break;
+      default:
+        break;
+    }
+  }
+
+  ldb_free_children(filenames, len);
+
+  if (rc == LDB_OK)
+    rc = ldb_set_current_file(bakname, ckpt->manifest_number);
+
+  if (rc == LDB_OK)
+    rc = ldb_sync_dir(bakname);
+
+  return rc;
+}
+
+static void
+ldb_checkpoint_remove(const char *bakname) {
+  char **filenames = NULL;
+  char path[LDB_PATH_MAX];
+  ldb_filetype_t type;
+  uint64_t number;
+  int i, len;
+
+  len = ldb_get_children(bakname, &filenames);
+
+  for (i = 0; i < len; i++) {
+    const char *filename = filenames[i];
+
+    if (!ldb_parse_filename(&type, &number, filename))
+      continue;
+
+    if (type == LDB_FILE_LOCK)
+      continue; /* Lock file will be deleted at end. */
+
+    if (!ldb_join(path, sizeof(path), bakname, filename))
+      continue;
+
+    ldb_remove_file(path);
+  }
+
+  if (len >= 0)
+    ldb_free_children(filenames, len);
+}
+
+static int
+ldb_checkpoint_write(ldb_t *db, const char *bakname, ldb_ckpt_t *ckpts) {
+  char lockname[LDB_PATH_MAX];
+  char path[LDB_PATH_MAX];
+  ldb_filelock_t *lock;
+  int rc, i;
+
+  if (!ldb_lock_filename(lockname, sizeof(lockname), bakname))
+    return LDB_INVALID;
+
+  rc = ldb_create_dir(bakname);
+
+  if (rc != LDB_OK)
+    return rc;
+
+  rc = ldb_lock_file(lockname, &lock);
+
+  if (rc != LDB_OK) {
+    ldb_remove_dir(bakname);
+    return rc;
+  }
+
+  for (i = 0; i < db->num_families && rc == LDB_OK; i++) {
+    ldb_t *cf = db->families[i];
+    const char *name = cf->dbname + strlen(db->dbname) + 1;
+
+    if (!ldb_join(path, sizeof(path), bakname, name))
+      rc = LDB_INVALID;
+    else
+      rc = ldb_create_dir(path);
+
+    if (rc == LDB_OK)
+      rc = ldb_checkpoint_dir(cf->dbname, path, &ckpts[i + 1]);
+  }
+
+  /* The parent goes last: its CURRENT file marks a usable copy. */
+  if (rc == LDB_OK)
+    rc = ldb_checkpoint_dir(db->dbname, bakname, &ckpts[0]);
+
+  if (rc != LDB_OK) {
+    for (i = 0; i < db->num_families; i++) {
+      ldb_t *cf = db->families[i];
+      const char *name = cf->dbname + strlen(db->dbname) + 1;
+
+      if (ldb_join(path, sizeof(path), bakname, name)) {
+        ldb_checkpoint_remove(path);
+        ldb_remove_dir(path);
+      }
+    }
+
+    ldb_checkpoint_remove(bakname);
+  }
+
+  ldb_unlock_file(lock);
+  ldb_remove_file(lockname);
+
+  if (rc != LDB_OK)
+    ldb_remove_dir(bakname);
+
+  return rc;
+}
+
 /*
  * API
  */
 
 int
 ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr) {
+  return ldb_open_families(dbname, options, NULL, 0, dbptr);
+}
+
+int
+ldb_open_families(const char *dbname,
+                  const ldb_dbopt_t *options,
+                  ldb_family_t *families,
+                  int length,
+                  ldb_t **dbptr) {
   char path[LDB_PATH_MAX];
   int save_manifest = 0;
   ldb_edit_t edit;
   int rc = LDB_OK;
   ldb_t *db;
+  int i;
 
   ldb_crc32c_init();
 
   *dbptr = NULL;
 
-  if (options == NULL)
+  if (options == NULL || length < 0)
+    return LDB_INVALID;
+
+  if (length > 0 && families == NULL)
     return LDB_INVALID;
 
   if (options->filter_policy != NULL) {
@@ -2014,7 +2878,7 @@ ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr) {
   ldb_mutex_lock(&db->mutex);
 
   /* Recover handles create_if_missing, error_if_exists. */
-  rc = ldb_recover(db, &edit, &save_manifest);
+  rc = ldb_recover(db, &edit, &save_manifest, families, length);
 
   if (rc == LDB_OK && db->mem == NULL) {
     /* Create new log and a corresponding memtable. */
@@ -2046,6 +2910,9 @@ ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr) {
     rc = ldb_versions_apply(db->versions, &edit, &db->mutex);
   }
 
+  if (rc == LDB_OK)
+    rc = ldb_finish_families(db);
+
   if (rc == LDB_OK) {
     ldb_remove_obsolete_files(db);
     ldb_maybe_schedule_compaction(db);
@@ -2055,6 +2922,10 @@ ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr) {
 
   if (rc == LDB_OK) {
     assert(db->mem != NULL);
+
+    for (i = 0; i < length; i++)
+      families[i].handle = db->families[i];
+
     *dbptr = db;
   } else {
     ldb_destroy_internal(db);
@@ -2067,7 +2938,14 @@ ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr) {
 
 void
 ldb_close(ldb_t *db) {
-  ldb_destroy_internal(db);
+  /* Families are closed by their parent. */
+  if (db->parent == NULL)
+    ldb_destroy_internal(db);
+}
+
+uint32_t
+ldb_family_id(const ldb_t *db) {
+  return db->family_id;
 }
 
 int
@@ -2187,6 +3065,58 @@ ldb_del(ldb_t *db, const ldb_slice_t *key, const ldb_writeopt_t *options) {
   return rc;
 }
 
+typedef struct ldb_retag_s {
+  ldb_t *family;
+  ldb_batch_t batch;
+} ldb_retag_t;
+
+static void
+retag_put(ldb_handler_t *handler,
+          const ldb_slice_t *key,
+          const ldb_slice_t *value) {
+  ldb_retag_t *rt = handler->state;
+
+  ldb_batch_put_family(&rt->batch, rt->family, key, value);
+}
+
+static void
+retag_del(ldb_handler_t *handler, const ldb_slice_t *key) {
+  ldb_retag_t *rt = handler->state;
+
+  ldb_batch_del_family(&rt->batch, rt->family, key);
+}
+
+/* Writes to a family handle are addressed to
+   the family and committed by its parent. */
+static int
+ldb_family_write(ldb_t *cf, ldb_batch_t *updates,
+                            const ldb_writeopt_t *options) {
+  ldb_handler_t handler;
+  ldb_retag_t rt;
+  int rc;
+
+  if (updates == NULL)
+    return ldb_write(cf->parent, NULL, options);
+
+  rt.family = cf;
+
+  ldb_batch_init(&rt.batch);
+
+  handler.state = &rt;
+  handler.number = 0;
+  handler.put = retag_put;
+  handler.del = retag_del;
+
+  rc = ldb_batch_iterate(updates, &handler);
+
+  if (rc == LDB_OK)
+    rc = ldb_write(cf->parent, &rt.batch, options);
+
+  ldb_batch_clear(&rt.batch);
+
+  return rc;
+}
+
 int
 ldb_write(ldb_t *db, ldb_batch_t *updates, const ldb_writeopt_t *options) {
   ldb_waiter_t *last_writer;
@@ -2194,13 +3124,17 @@ ldb_write(ldb_t *db, ldb_batch_t *updates, const ldb_writeopt_t *options) {
   ldb_waiter_t w;
   int rc;
 
+  if (db->parent != NULL)
+    return ldb_family_write(db, updates, options);
+
   if (options == NULL)
     options = ldb_writeopt_default;
 
   ldb_waiter_init(&w);
 
   w.batch = updates;
-  w.sync = options->sync;
+  w.sync = options->sync && !options->disable_wal;
+  w.disable_wal = options->disable_wal;
   w.done = 0;
 
   ldb_mutex_lock(&db->mutex);
@@ -2228,6 +3162,15 @@ ldb_write(ldb_t *db, ldb_batch_t *updates, const ldb_writeopt_t *options) {
 
     last_sequence += ldb_batch_count(write_batch);
 
+    if (db->num_families > 0) {
+      int i;
+
+      db->tables[0] = db->mem;
+
+      for (i = 0; i < db->num_families; i++)
+        db->tables[i + 1] = db->families[i]->mem;
+    }
+
     /* Add to log and apply to memtable. We can release the lock
        during this phase since &w is currently responsible for logging
        and protects against concurrent loggers and concurrent writes
@@ -2240,17 +3183,25 @@ ldb_write(ldb_t *db, ldb_batch_t *updates, const ldb_writeopt_t *options) {
 
       contents = ldb_batch_contents(write_batch);
 
-      rc = ldb_writer_add_record(db->log, &contents);
+      if (!w.disable_wal)
+        rc = ldb_writer_add_record(db->log, &contents);
 
-      if (rc == LDB_OK && options->sync) {
+      if (rc == LDB_OK && w.sync) {
         rc = ldb_wfile_sync(db->logfile);
 
         if (rc != LDB_OK)
           sync_error = 1;
       }
 
-      if (rc == LDB_OK)
-        rc = ldb_batch_insert_into(write_batch, db->mem);
+      if (rc == LDB_OK) {
+        if (db->num_families > 0) {
+          rc = ldb_batch_insert_families(write_batch,
+                                         db->tables,
+                                         db->num_families + 1);
+        } else {
+          rc = ldb_batch_insert_into(write_batch, db->mem);
+        }
+      }
 
       ldb_mutex_lock(&db->mutex);
 
@@ -2268,6 +3219,11 @@ ldb_write(ldb_t *db, ldb_batch_t *updates, const ldb_writeopt_t *options) {
     assert(last_sequence >= db->versions->last_sequence);
 
     db->versions->last_sequence = last_sequence;
+
+    if (w.disable_wal)
+      db->unlogged = 1;
+
+    ldb_family_sequence(db, last_sequence);
   }
 
   for (;;) {
@@ -2510,33 +3466,94 @@ ldb_compact(ldb_t *db, const ldb_slice_t *begin, const ldb_slice_t *end) {
     ldb_test_compact_range(db, level, begin, end);
 }
 
+int
+ldb_flush(ldb_t *db) {
+  return ldb_test_compact_memtable(db);
+}
+
 int
 ldb_backup(ldb_t *db, const char *name) {
-  rb_set64_t live;
-  int rc;
+  /* Writers are only held up while the checkpoint is taken.
+     Copying happens afterwards, with file deletions paused. */
+  int length = db->num_families + 1;
+  char path[LDB_PATH_MAX];
+  ldb_ckpt_t *ckpts;
+  int rc = LDB_OK;
+  int i;
 
   if (strlen(name) + 1 > LDB_PATH_MAX - 35)
     return LDB_INVALID;
 
+  if (db->parent != NULL)
+    return LDB_INVALID;
+
+  ckpts = ldb_malloc(length * sizeof(ldb_ckpt_t));
+
+  for (i = 0; i < length; i++)
+    ldb_ckpt_init(&ckpts[i]);
+
+  /* Pin the logs before any family is checkpointed. */
   ldb_mutex_lock(&db->mutex);
+  db->checkpoints++;
+  ldb_mutex_unlock(&db->mutex);
 
-  while (db->background_compaction_scheduled)
-    ldb_cond_wait(&db->background_work_finished_signal, &db->mutex);
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
+
+    ldb_mutex_lock(&cf->mutex);
 
-  rc = db->bg_error;
+    cf->checkpoints++;
+
+    if (rc == LDB_OK)
+      rc = ldb_checkpoint_begin(cf, &ckpts[i + 1]);
+
+    ldb_mutex_unlock(&cf->mutex);
+  }
+
+  ldb_mutex_lock(&db->mutex);
+
+  if (rc == LDB_OK)
+    rc = ldb_checkpoint_begin(db, &ckpts[0]);
 
   if (rc == LDB_OK) {
-    rb_set64_init(&live);
+    ldb_ckpt_t *ckpt = &ckpts[0];
 
-    ldb_versions_add_files(db->versions, &live);
+    /* Families replay the parent's log from their own log number. */
+    for (i = 1; i < length; i++) {
+      if (ckpts[i].min_log < ckpt->min_log)
+        ckpt->min_log = ckpts[i].min_log;
+    }
 
-    rc = ldb_backup_inner(db->dbname, name, &live);
+    ckpt->log_number = db->logfile_number;
 
-    rb_set64_clear(&live);
+    if (!ldb_log_filename(path, sizeof(path), db->dbname, ckpt->log_number))
+      rc = LDB_INVALID;
+    else
+      rc = ldb_file_size(path, &ckpt->log_size);
+  }
+
+  ldb_mutex_unlock(&db->mutex);
+
+  if (rc == LDB_OK)
+    rc = ldb_checkpoint_write(db, name, ckpts);
+
+  for (i = 0; i < db->num_families; i++) {
+    ldb_t *cf = db->families[i];
+
+    ldb_mutex_lock(&cf->mutex);
+    ldb_checkpoint_end(cf);
+    ldb_mutex_unlock(&cf->mutex);
   }
 
+  ldb_mutex_lock(&db->mutex);
+  ldb_checkpoint_end(db);
   ldb_mutex_unlock(&db->mutex);
 
+  for (i = 0; i < length; i++)
+    ldb_ckpt_clear(&ckpts[i]);
+
+  ldb_free(ckpts);
+
   return rc;
 }
 
@@ -32,6 +32,12 @@ struct ldb_snapshot_s;
 
 typedef struct ldb_s ldb_t;
 
+typedef struct ldb_family_s {
+  const char *name;
+  const ldb_dbopt_t *options; /* NULL for defaults. */
+  ldb_t *handle; /* Set on open. */
+} ldb_family_t;
+
 /*
  * Helpers
  */
@@ -51,6 +57,24 @@ ldb_sanitize_options(const char *dbname,
 LDB_EXTERN int
 ldb_open(const char *dbname, const ldb_dbopt_t *options, ldb_t **dbptr);
 
+/* Open a database along with a set of column families. Families
+   live in subdirectories of the database, each with its own options,
+   memtables and tables, while sharing the database's log: a batch
+   may update several families atomically through
+   ldb_batch_put_family() and ldb_batch_del_family().
+
+   Families are identified by position, so later opens must pass the
+   same names in the same order (new families may be appended). The
+   handles are valid until the database is closed and may be used
+   with every read and write function; snapshots must be taken from
+   the handle they are read with. */
+LDB_EXTERN int
+ldb_open_families(const char *dbname,
+                  const ldb_dbopt_t *options,
+                  ldb_family_t *families,
+                  int length,
+                  ldb_t **dbptr);
+
 LDB_EXTERN void
 ldb_close(ldb_t *db);
 
@@ -94,6 +118,12 @@ ldb_approximate_sizes(ldb_t *db, const ldb_range_t *range,
 LDB_EXTERN void
 ldb_compact(ldb_t *db, const ldb_slice_t *begin, const ldb_slice_t *end);
 
+/* Flush the memtable to a table file and wait for it to be written.
+   Unlogged writes (see disable_wal) made before the call are durable
+   once this returns. */
+LDB_EXTERN int
+ldb_flush(ldb_t *db);
+
 LDB_EXTERN int
 ldb_backup(ldb_t *db, const char *name);
 
@@ -148,6 +178,10 @@ ldb_test_max_next_level_overlapping_bytes(ldb_t *db);
  * Internal
  */
 
+/* Return the column family id of a handle (zero for the database). */
+uint32_t
+ldb_family_id(const ldb_t *db);
+
 /* Record a sample of bytes read at the specified internal key.
    Samples are taken approximately once every LDB_READ_BYTES_PERIOD
    bytes. */
@@ -89,6 +89,11 @@ ldb_lock_filename(char *buf, size_t size, const char *dbname) {
   return ldb_join(buf, size, dbname, "LOCK");
 }
 
+int
+ldb_families_filename(char *buf, size_t size, const char *dbname) {
+  return ldb_join(buf, size, dbname, "FAMILIES");
+}
+
 int
 ldb_temp_filename(char *buf, size_t size, const char *dbname, uint64_t num) {
   assert(num > 0);
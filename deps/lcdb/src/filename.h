@@ -69,6 +69,12 @@ ldb_current_filename(char *buf, size_t size, const char *dbname);
 int
 ldb_lock_filename(char *buf, size_t size, const char *dbname);
 
+/* Return the name of the file listing the column families of
+   the db named by "dbname". The result will be prefixed with
+   "dbname". */
+int
+ldb_families_filename(char *buf, size_t size, const char *dbname);
+
 /* Return the name of a temporary file owned by the db named "dbname".
    The result will be prefixed with "dbname". */
 int
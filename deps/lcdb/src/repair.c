@@ -336,7 +336,8 @@ convert_log_to_table(ldb_repair_t *rep, uint64_t log) {
                        &rep->options,
                        rep->table_cache,
                        iter,
-                       &meta);
+                       &meta,
+                       NULL);
 
   ldb_iter_destroy(iter);
 
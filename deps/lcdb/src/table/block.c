@@ -17,6 +17,7 @@
 #include "../util/buffer.h"
 #include "../util/coding.h"
 #include "../util/comparator.h"
+#include "../util/hash.h"
 #include "../util/internal.h"
 #include "../util/slice.h"
 #include "../util/status.h"
@@ -42,10 +43,31 @@ ldb_block_destroy(ldb_block_t *block) {
   ldb_free(block);
 }
 
-static uint32_t
-ldb_block_restarts(const ldb_block_t *block) {
-  assert(block->size >= 4);
-  return ldb_fixed32_decode(block->data + block->size - 4);
+static int
+ldb_block_read_index(ldb_block_t *block) {
+  size_t size = block->size - 4;
+
+  if (block->num_restarts > LDB_HASH_MAX_RESTARTS || size < 2)
+    return 0;
+
+  size -= 2;
+
+  block->num_buckets = (uint32_t)block->data[size + 0] << 0
+                     | (uint32_t)block->data[size + 1] << 8;
+
+  if (block->num_buckets == 0 || size < block->num_buckets)
+    return 0;
+
+  size -= block->num_buckets;
+
+  block->buckets = block->data + size;
+
+  if (block->num_restarts > size / 4)
+    return 0;
+
+  block->restart_offset = size - block->num_restarts * 4;
+
+  return 1;
 }
 
 void
@@ -53,18 +75,30 @@ ldb_block_init(ldb_block_t *block, const ldb_contents_t *contents) {
   block->data = contents->data.data;
   block->size = contents->data.size;
   block->restart_offset = 0;
+  block->num_restarts = 0;
+  block->buckets = NULL;
+  block->num_buckets = 0;
   block->owned = contents->heap_allocated;
 
   if (block->size < 4) {
     block->size = 0; /* Error marker. */
   } else {
-    size_t max_restarts_allowed = (block->size - 4) / 4;
+    uint32_t num_restarts = ldb_fixed32_decode(block->data + block->size - 4);
+
+    block->num_restarts = num_restarts & ~LDB_HASH_INDEX_FLAG;
 
-    if (ldb_block_restarts(block) > max_restarts_allowed) {
-      /* The size is too small for ldb_block_restarts(). */
-      block->size = 0;
+    if (num_restarts & LDB_HASH_INDEX_FLAG) {
+      if (!ldb_block_read_index(block))
+        block->size = 0;
     } else {
-      block->restart_offset = block->size - (1 + ldb_block_restarts(block)) * 4;
+      size_t max_restarts_allowed = (block->size - 4) / 4;
+
+      if (block->num_restarts > max_restarts_allowed) {
+        /* The size is too small for num_restarts. */
+        block->size = 0;
+      } else {
+        block->restart_offset = block->size - (1 + block->num_restarts) * 4;
+      }
     }
   }
 }
@@ -133,6 +167,8 @@ typedef struct ldb_blockiter_s {
   const uint8_t *data;    /* Underlying block contents. */
   uint32_t restarts;      /* Offset of restart array (list of fixed32). */
   uint32_t num_restarts;  /* Number of uint32_t entries in restart array. */
+  const uint8_t *buckets; /* Hash index (NULL if not present). */
+  uint32_t num_buckets;   /* Number of entries in hash index. */
 
   /* current is offset in data of current entry. >= restarts if !valid. */
   uint32_t current;
@@ -189,15 +225,15 @@ seek_to_restart_point(ldb_blockiter_t *iter, uint32_t index) {
 static void
 ldb_blockiter_init(ldb_blockiter_t *iter,
                    const ldb_comparator_t *comparator,
-                   const uint8_t *data,
-                   uint32_t restarts,
-                   uint32_t num_restarts) {
-  assert(num_restarts > 0);
+                   const ldb_block_t *block) {
+  assert(block->num_restarts > 0);
 
   iter->comparator = comparator;
-  iter->data = data;
-  iter->restarts = restarts;
-  iter->num_restarts = num_restarts;
+  iter->data = block->data;
+  iter->restarts = block->restart_offset;
+  iter->num_restarts = block->num_restarts;
+  iter->buckets = block->buckets;
+  iter->num_buckets = block->num_buckets;
   iter->current = iter->restarts;
   iter->restart_index = iter->num_restarts;
 
@@ -429,23 +465,68 @@ ldb_iter_t *
 ldb_blockiter_create(const ldb_block_t *block,
                      const ldb_comparator_t *comparator) {
   ldb_blockiter_t *iter;
-  uint32_t num_restarts;
 
   if (block->size < 4)
     return ldb_emptyiter_create(LDB_CORRUPTION); /* "bad block contents" */
 
-  num_restarts = ldb_block_restarts(block);
-
-  if (num_restarts == 0)
+  if (block->num_restarts == 0)
     return ldb_emptyiter_create(LDB_OK);
 
   iter = ldb_malloc(sizeof(ldb_blockiter_t));
 
-  ldb_blockiter_init(iter,
-                     comparator,
-                     block->data,
-                     block->restart_offset,
-                     num_restarts);
+  ldb_blockiter_init(iter, comparator, block);
 
   return ldb_iter_create(iter, &ldb_blockiter_table, comparator);
 }
+
+void
+ldb_blockiter_seek_get(ldb_iter_t *it, const ldb_slice_t *target) {
+  ldb_blockiter_t *iter = (ldb_blockiter_t *)it->ptr;
+  uint32_t hash, index;
+
+  if (it->table != &ldb_blockiter_table || iter->buckets == NULL) {
+    ldb_iter_seek(it, target);
+    return;
+  }
+
+  /* Blocks are only indexed when their keys are internal keys. */
+  if (iter->comparator->user_comparator == NULL || target->size < 8) {
+    ldb_blockiter_corruption(iter);
+    return;
+  }
+
+  hash = ldb_hash(target->data, target->size - 8, LDB_HASH_SEED);
+  index = iter->buckets[hash % iter->num_buckets];
+
+  if (index == LDB_HASH_BUCKET_COLLISION) {
+    ldb_blockiter_seek(iter, target);
+    return;
+  }
+
+  if (index == LDB_HASH_BUCKET_EMPTY) {
+    /* The user key is not in this block. */
+    iter->current = iter->restarts;
+    iter->restart_index = iter->num_restarts;
+    return;
+  }
+
+  if (index >= iter->num_restarts) {
+    ldb_blockiter_corruption(iter);
+    return;
+  }
+
+  /* If the user key is present, all of its entries live in this
+     restart interval and everything before it sorts below target,
+     so a linear scan from here lands where a full seek would. If
+     it is absent, we land on some other user key, which callers
+     treat as a miss. */
+  seek_to_restart_point(iter, index);
+
+  for (;;) {
+    if (!parse_next_key(iter))
+      return;
+
+    if (do_compare(iter, &iter->key, target) >= 0)
+      return;
+  }
+}
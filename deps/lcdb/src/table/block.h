@@ -16,6 +16,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "../util/types.h"
+
 /*
  * Types
  */
@@ -28,6 +30,9 @@ typedef struct ldb_block_s {
   const uint8_t *data;
   size_t size;
   uint32_t restart_offset;  /* Offset in data of restart array. */
+  uint32_t num_restarts;    /* Number of entries in restart array. */
+  const uint8_t *buckets;   /* Hash index (NULL if not present). */
+  uint32_t num_buckets;     /* Number of entries in hash index. */
   int owned;                /* Block owns data[]. */
 } ldb_block_t;
 
@@ -55,4 +60,12 @@ struct ldb_iter_s *
 ldb_blockiter_create(const ldb_block_t *block,
                      const struct ldb_comparator_s *comparator);
 
+/* Position a block iterator for a point lookup of target. Unlike seek(),
+   the iterator is only guaranteed to land on the first entry >= target
+   if that entry shares target's user key; otherwise it may land on any
+   entry with a different user key or become invalid. Falls back to a
+   regular seek if the block has no hash index. */
+void
+ldb_blockiter_seek_get(struct ldb_iter_s *iter, const ldb_slice_t *target);
+
 #endif /* LDB_BLOCK_H */
@@ -13,16 +13,19 @@
 #include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "../util/array.h"
 #include "../util/buffer.h"
 #include "../util/comparator.h"
+#include "../util/hash.h"
 #include "../util/internal.h"
 #include "../util/options.h"
 #include "../util/slice.h"
 #include "../util/vector.h"
 
 #include "block_builder.h"
+#include "format.h"
 
 /* BlockBuilder generates blocks where keys are prefix-compressed:
  *
@@ -47,6 +50,16 @@
  *     restarts: uint32[num_restarts]
  *     num_restarts: uint32
  * restarts[i] contains the offset within the block of the ith restart point.
+ *
+ * If options->block_hash_index is set (and the keys are internal keys),
+ * the trailer instead has the form:
+ *     restarts: uint32[num_restarts]
+ *     buckets: uint8[num_buckets]
+ *     num_buckets: uint16
+ *     num_restarts: uint32 (with the high bit set)
+ * buckets[hash(user_key) % num_buckets] contains the index of the restart
+ * interval holding user_key, allowing point lookups to skip the binary
+ * search. Blocks without the flag are read exactly as before.
  */
 
 /*
@@ -60,10 +73,13 @@ ldb_blockgen_init(ldb_blockgen_t *bb, const ldb_dbopt_t *options) {
   bb->options = options;
   bb->counter = 0;
   bb->finished = 0;
+  bb->hash_index = options->block_hash_index
+                && options->comparator->user_comparator != NULL;
 
   ldb_buffer_init(&bb->buffer);
   ldb_array_init(&bb->restarts);
   ldb_buffer_init(&bb->last_key);
+  ldb_array_init(&bb->hashes);
 
   ldb_array_push(&bb->restarts, 0); /* First restart point is at offset 0. */
 }
@@ -73,6 +89,7 @@ ldb_blockgen_clear(ldb_blockgen_t *bb) {
   ldb_buffer_clear(&bb->buffer);
   ldb_array_clear(&bb->restarts);
   ldb_buffer_clear(&bb->last_key);
+  ldb_array_clear(&bb->hashes);
 }
 
 void
@@ -86,6 +103,7 @@ ldb_blockgen_reset(ldb_blockgen_t *bb) {
   bb->finished = 0;
 
   ldb_buffer_reset(&bb->last_key);
+  ldb_array_reset(&bb->hashes);
 }
 
 void
@@ -133,6 +151,59 @@ ldb_blockgen_add(ldb_blockgen_t *bb,
   ldb_buffer_append(&bb->last_key, key_offset, non_shared);
   assert(ldb_slice_equal(&bb->last_key, key));
   bb->counter++;
+
+  /* Remember which restart interval holds the user key. */
+  if (bb->hash_index) {
+    uint32_t hash;
+
+    assert(key->size >= 8);
+
+    hash = ldb_hash(key->data, key->size - 8, LDB_HASH_SEED);
+
+    ldb_array_push(&bb->hashes, ((uint64_t)hash << 8)
+                              | (bb->restarts.length - 1));
+  }
+}
+
+static size_t
+ldb_blockgen_buckets(const ldb_blockgen_t *bb) {
+  /* Aim for a 75% load factor. */
+  size_t buckets = (bb->hashes.length * 4) / 3 + 1;
+
+  if (buckets > LDB_HASH_MAX_BUCKETS)
+    buckets = LDB_HASH_MAX_BUCKETS;
+
+  return buckets;
+}
+
+static int
+ldb_blockgen_indexable(const ldb_blockgen_t *bb) {
+  return bb->hash_index
+      && bb->hashes.length > 0
+      && bb->restarts.length <= LDB_HASH_MAX_RESTARTS;
+}
+
+static void
+ldb_blockgen_write_index(ldb_blockgen_t *bb) {
+  size_t num_buckets = ldb_blockgen_buckets(bb);
+  uint8_t *buckets = ldb_buffer_pad(&bb->buffer, num_buckets);
+  size_t i;
+
+  memset(buckets, LDB_HASH_BUCKET_EMPTY, num_buckets);
+
+  for (i = 0; i < bb->hashes.length; i++) {
+    uint64_t item = bb->hashes.items[i];
+    uint32_t index = item & 0xff;
+    uint8_t *bucket = &buckets[(item >> 8) % num_buckets];
+
+    if (*bucket == LDB_HASH_BUCKET_EMPTY)
+      *bucket = index;
+    else if (*bucket != index)
+      *bucket = LDB_HASH_BUCKET_COLLISION;
+  }
+
+  ldb_buffer_push(&bb->buffer, num_buckets & 0xff);
+  ldb_buffer_push(&bb->buffer, num_buckets >> 8);
 }
 
 ldb_slice_t
@@ -143,7 +214,12 @@ ldb_blockgen_finish(ldb_blockgen_t *bb) {
   for (i = 0; i < bb->restarts.length; i++)
     ldb_buffer_fixed32(&bb->buffer, bb->restarts.items[i]);
 
-  ldb_buffer_fixed32(&bb->buffer, bb->restarts.length);
+  if (ldb_blockgen_indexable(bb)) {
+    ldb_blockgen_write_index(bb);
+    ldb_buffer_fixed32(&bb->buffer, bb->restarts.length | LDB_HASH_INDEX_FLAG);
+  } else {
+    ldb_buffer_fixed32(&bb->buffer, bb->restarts.length);
+  }
 
   bb->finished = 1;
 
@@ -152,7 +228,12 @@ ldb_blockgen_finish(ldb_blockgen_t *bb) {
 
 size_t
 ldb_blockgen_size_estimate(const ldb_blockgen_t *bb) {
-  return (bb->buffer.size +                        /* Raw data buffer */
-          bb->restarts.length * sizeof(uint32_t) + /* Restart array */
-          sizeof(uint32_t));                       /* Restart array length */
+  size_t size = (bb->buffer.size +                        /* Raw data buffer */
+                 bb->restarts.length * sizeof(uint32_t) + /* Restart array */
+                 sizeof(uint32_t));                       /* Restart count */
+
+  if (ldb_blockgen_indexable(bb))
+    size += ldb_blockgen_buckets(bb) + 2; /* Hash index */
+
+  return size;
 }
@@ -31,6 +31,8 @@ typedef struct ldb_blockgen_s {
   int counter;                  /* Number of entries emitted since restart. */
   int finished;                 /* Has finish() been called? */
   ldb_buffer_t last_key;
+  ldb_array_t hashes;           /* Key hash and restart index (uint64_t). */
+  int hash_index;               /* Build a hash index for point lookups? */
 } ldb_blockgen_t;
 
 /*
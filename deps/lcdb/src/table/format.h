@@ -38,6 +38,23 @@
    and taking the leading 64 bits. */
 #define LDB_TABLE_MAGIC UINT64_C(0xdb4775248b80fb57) /* kTableMagicNumber */
 
+/* A data block with a hash index sets the high bit of its restart
+   count. Bucket values index the restart array, with two reserved
+   values marking empty and colliding buckets. */
+#define LDB_HASH_INDEX_FLAG UINT32_C(0x80000000)
+#define LDB_HASH_BUCKET_EMPTY 255
+#define LDB_HASH_BUCKET_COLLISION 254
+#define LDB_HASH_MAX_RESTARTS 253
+#define LDB_HASH_MAX_BUCKETS 0xffff
+#define LDB_HASH_SEED 397
+
+/* A table with a partitioned index names itself in the metaindex.
+   Its footer points at a top-level index whose values are the handle
+   of an index partition followed by the handle of that partition's
+   filter (when "partitioned.filter.<name>" is also present). */
+#define LDB_PARTITION_PREFIX "partitioned."
+#define LDB_PARTITION_INDEX LDB_PARTITION_PREFIX "index"
+
 /*
  * Types
  */
@@ -13,6 +13,7 @@
 #include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "../util/bloom.h"
 #include "../util/cache.h"
@@ -44,9 +45,32 @@ struct ldb_table_s {
   const uint8_t *filter_data;
   ldb_handle_t metaindex_handle; /* Handle to metaindex_block:
                                     saved from footer. */
-  ldb_block_t *index_block;
+  ldb_block_t *index_block; /* Top-level index if partitioned. */
+  int partitioned;
+  int partition_filters;
 };
 
+/* A filter partition held by the block cache. */
+typedef struct ldb_pfilter_s {
+  ldb_filter_t filter;
+  ldb_contents_t contents;
+} ldb_pfilter_t;
+
+static int
+ldb_meta_has(ldb_iter_t *iter, const char *name) {
+  ldb_slice_t key;
+
+  ldb_slice_set_str(&key, name);
+  ldb_iter_seek(iter, &key);
+
+  if (ldb_iter_valid(iter)) {
+    ldb_slice_t iter_key = ldb_iter_key(iter);
+    return ldb_slice_equal(&iter_key, &key);
+  }
+
+  return 0;
+}
+
 static void
 ldb_table_read_filter(ldb_table_t *table,
                       const ldb_slice_t *filter_handle_value) {
@@ -77,24 +101,24 @@ ldb_table_read_filter(ldb_table_t *table,
   table->filter = ldb_filter_create(table->options.filter_policy, &block.data);
 }
 
-static void
+static int
 ldb_table_read_meta(ldb_table_t *table, const ldb_footer_t *footer) {
   ldb_readopt_t opt = *ldb_readopt_default;
+  char name[sizeof(LDB_PARTITION_PREFIX) + 72];
+  const ldb_bloom_t *policy = table->options.filter_policy;
+  size_t off = sizeof(LDB_PARTITION_PREFIX) - 1;
   ldb_contents_t contents;
   ldb_block_t *meta;
   ldb_iter_t *iter;
-  ldb_slice_t key;
-  char name[72];
   int rc;
 
-  if (table->options.filter_policy == NULL)
-    return; /* Do not need any metadata. */
-
   if (table->options.paranoid_checks)
     opt.verify_checksums = 1;
 
-  if (!ldb_bloom_name(name, sizeof(name), table->options.filter_policy))
-    return;
+  memcpy(name, LDB_PARTITION_PREFIX, off);
+
+  if (policy != NULL && !ldb_bloom_name(name + off, 72, policy))
+    policy = NULL;
 
   rc = ldb_read_block(&contents,
                       table->file,
@@ -102,20 +126,21 @@ ldb_table_read_meta(ldb_table_t *table, const ldb_footer_t *footer) {
                       &footer->metaindex_handle);
 
   if (rc != LDB_OK) {
-    /* Do not propagate errors since meta info is not needed for operation. */
-    return;
+    /* Meta info is not needed for operation, but it tells us how to
+       interpret the index. Treating a partitioned table as an ordinary
+       one would return garbage, so the error must be propagated. */
+    return rc;
   }
 
   meta = ldb_block_create(&contents);
   iter = ldb_blockiter_create(meta, ldb_bytewise_comparator);
 
-  ldb_slice_set_str(&key, name);
-  ldb_iter_seek(iter, &key);
+  table->partitioned = ldb_meta_has(iter, LDB_PARTITION_INDEX);
 
-  if (ldb_iter_valid(iter)) {
-    ldb_slice_t iter_key = ldb_iter_key(iter);
-
-    if (ldb_slice_equal(&iter_key, &key)) {
+  if (policy != NULL) {
+    if (table->partitioned) {
+      table->partition_filters = ldb_meta_has(iter, name);
+    } else if (ldb_meta_has(iter, name + off)) {
       ldb_slice_t iter_value = ldb_iter_value(iter);
       ldb_table_read_filter(table, &iter_value);
     }
@@ -123,6 +148,8 @@ ldb_table_read_meta(ldb_table_t *table, const ldb_footer_t *footer) {
 
   ldb_iter_destroy(iter);
   ldb_block_destroy(meta);
+
+  return LDB_OK;
 }
 
 int
@@ -177,13 +204,18 @@ ldb_table_open(const ldb_dbopt_t *options,
     tbl->filter_data = NULL;
     tbl->metaindex_handle = footer.metaindex_handle;
     tbl->index_block = index_block;
+    tbl->partitioned = 0;
+    tbl->partition_filters = 0;
 
     if (options->block_cache != NULL)
       tbl->cache_id = ldb_lru_id(options->block_cache);
 
-    ldb_table_read_meta(tbl, &footer);
+    rc = ldb_table_read_meta(tbl, &footer);
 
-    *table = tbl;
+    if (rc == LDB_OK)
+      *table = tbl;
+    else
+      ldb_table_destroy(tbl);
   }
 
   return rc;
@@ -224,49 +256,68 @@ release_block(void *arg, void *h) {
   ldb_lru_release(cache, handle);
 }
 
-/* Convert an index iterator value (i.e., an encoded BlockHandle)
-   into an iterator over the contents of the corresponding block. */
+static void
+delete_cached_filter(const ldb_slice_t *key, void *value) {
+  ldb_pfilter_t *pf = (ldb_pfilter_t *)value;
+
+  (void)key;
+
+  if (pf->contents.heap_allocated)
+    ldb_free((void *)pf->contents.data.data);
+
+  ldb_free(pf);
+}
+
+static ldb_slice_t
+ldb_table_cache_key(uint8_t *buf, const ldb_table_t *table,
+                                  const ldb_handle_t *handle) {
+  ldb_slice_t key;
+
+  ldb_fixed64_write(buf + 0, table->cache_id);
+  ldb_fixed64_write(buf + 8, handle->offset);
+
+  ldb_slice_set(&key, buf, 16);
+
+  return key;
+}
+
+/* Return an iterator over the contents of the block at handle. Index
+   partitions are cached with high priority so that data blocks are
+   evicted first. */
 static ldb_iter_t *
-ldb_table_blockreader(void *arg,
-                      const ldb_readopt_t *options,
-                      const ldb_slice_t *index_value) {
-  ldb_table_t *table = (ldb_table_t *)arg;
+ldb_table_readblock(const ldb_table_t *table,
+                    const ldb_readopt_t *options,
+                    const ldb_handle_t *handle,
+                    int high_pri) {
   ldb_lru_t *block_cache = table->options.block_cache;
   ldb_entry_t *cache_handle = NULL;
   ldb_block_t *block = NULL;
-  ldb_handle_t handle;
+  ldb_contents_t contents;
   ldb_iter_t *iter;
   int rc = LDB_OK;
 
-  /* We intentionally allow extra stuff in index_value so that we
-     can add more features in the future. */
-
-  if (!ldb_handle_import(&handle, index_value))
-    rc = LDB_CORRUPTION;
-
-  if (rc == LDB_OK) {
-    ldb_contents_t contents;
-
-    if (block_cache != NULL) {
-      uint8_t cache_key_buffer[16];
-      ldb_slice_t key;
-
-      ldb_fixed64_write(cache_key_buffer + 0, table->cache_id);
-      ldb_fixed64_write(cache_key_buffer + 8, handle.offset);
-
-      ldb_slice_set(&key, cache_key_buffer, sizeof(cache_key_buffer));
+  if (block_cache != NULL) {
+    uint8_t cache_key_buffer[16];
+    ldb_slice_t key = ldb_table_cache_key(cache_key_buffer, table, handle);
 
-      cache_handle = ldb_lru_lookup(block_cache, &key);
+    cache_handle = ldb_lru_lookup(block_cache, &key);
 
-      if (cache_handle != NULL) {
-        block = (ldb_block_t *)ldb_lru_value(cache_handle);
-      } else {
-        rc = ldb_read_block(&contents, table->file, options, &handle);
+    if (cache_handle != NULL) {
+      block = (ldb_block_t *)ldb_lru_value(cache_handle);
+    } else {
+      rc = ldb_read_block(&contents, table->file, options, handle);
 
-        if (rc == LDB_OK) {
-          block = ldb_block_create(&contents);
+      if (rc == LDB_OK) {
+        block = ldb_block_create(&contents);
 
-          if (contents.cachable && options->fill_cache) {
+        if (contents.cachable && options->fill_cache) {
+          if (high_pri) {
+            cache_handle = ldb_lru_insert_high(block_cache,
+                                               &key,
+                                               block,
+                                               block->size,
+                                               &delete_cached_block);
+          } else {
             cache_handle = ldb_lru_insert(block_cache,
                                           &key,
                                           block,
@@ -275,12 +326,12 @@ ldb_table_blockreader(void *arg,
           }
         }
       }
-    } else {
-      rc = ldb_read_block(&contents, table->file, options, &handle);
-
-      if (rc == LDB_OK)
-        block = ldb_block_create(&contents);
     }
+  } else {
+    rc = ldb_read_block(&contents, table->file, options, handle);
+
+    if (rc == LDB_OK)
+      block = ldb_block_create(&contents);
   }
 
   if (block != NULL) {
@@ -299,17 +350,186 @@ ldb_table_blockreader(void *arg,
   return iter;
 }
 
+/* Convert an index iterator value (i.e., an encoded BlockHandle)
+   into an iterator over the contents of the corresponding block. */
+static ldb_iter_t *
+ldb_table_blockreader(void *arg,
+                      const ldb_readopt_t *options,
+                      const ldb_slice_t *index_value) {
+  ldb_table_t *table = (ldb_table_t *)arg;
+  ldb_handle_t handle;
+
+  /* We intentionally allow extra stuff in index_value so that we
+     can add more features in the future. */
+
+  if (!ldb_handle_import(&handle, index_value))
+    return ldb_emptyiter_create(LDB_CORRUPTION);
+
+  return ldb_table_readblock(table, options, &handle, 0);
+}
+
+/* Convert a top-level index value into an iterator over the
+   data blocks indexed by the corresponding partition. */
+static ldb_iter_t *
+ldb_table_partreader(void *arg,
+                     const ldb_readopt_t *options,
+                     const ldb_slice_t *top_value) {
+  ldb_table_t *table = (ldb_table_t *)arg;
+  ldb_handle_t handle;
+  ldb_iter_t *iter;
+
+  if (!ldb_handle_import(&handle, top_value))
+    return ldb_emptyiter_create(LDB_CORRUPTION);
+
+  iter = ldb_table_readblock(table, options, &handle, 1);
+
+  return ldb_twoiter_create(iter, &ldb_table_blockreader, table, options);
+}
+
+/* Check a key against a filter partition, caching the
+   partition with high priority. */
+static int
+ldb_table_filter_matches(const ldb_table_t *table,
+                         const ldb_readopt_t *options,
+                         const ldb_handle_t *handle,
+                         const ldb_slice_t *k) {
+  ldb_lru_t *block_cache = table->options.block_cache;
+  ldb_entry_t *cache_handle = NULL;
+  uint8_t cache_key_buffer[16];
+  ldb_contents_t contents;
+  ldb_pfilter_t *pf;
+  ldb_slice_t key;
+  int result;
+
+  if (block_cache != NULL) {
+    key = ldb_table_cache_key(cache_key_buffer, table, handle);
+
+    cache_handle = ldb_lru_lookup(block_cache, &key);
+
+    if (cache_handle != NULL) {
+      pf = (ldb_pfilter_t *)ldb_lru_value(cache_handle);
+      result = ldb_filter_matches(&pf->filter, 0, k);
+      ldb_lru_release(block_cache, cache_handle);
+      return result;
+    }
+  }
+
+  if (ldb_read_block(&contents, table->file, options, handle) != LDB_OK)
+    return 1; /* Errors are treated as potential matches. */
+
+  pf = ldb_malloc(sizeof(ldb_pfilter_t));
+  pf->contents = contents;
+
+  ldb_filter_init(&pf->filter, table->options.filter_policy,
+                               &pf->contents.data);
+
+  result = ldb_filter_matches(&pf->filter, 0, k);
+
+  if (block_cache != NULL && contents.cachable && options->fill_cache) {
+    cache_handle = ldb_lru_insert_high(block_cache,
+                                       &key,
+                                       pf,
+                                       contents.data.size,
+                                       &delete_cached_filter);
+
+    ldb_lru_release(block_cache, cache_handle);
+  } else {
+    delete_cached_filter(NULL, pf);
+  }
+
+  return result;
+}
+
 ldb_iter_t *
 ldb_tableiter_create(const ldb_table_t *table, const ldb_readopt_t *options) {
   ldb_iter_t *iter = ldb_blockiter_create(table->index_block,
                                           table->options.comparator);
 
+  if (table->partitioned) {
+    return ldb_twoiter_create(iter,
+                              &ldb_table_partreader,
+                              (void *)table,
+                              options);
+  }
+
   return ldb_twoiter_create(iter,
                             &ldb_table_blockreader,
                             (void *)table,
                             options);
 }
 
+static int
+ldb_table_partitioned_get(ldb_table_t *table,
+                          const ldb_readopt_t *options,
+                          const ldb_slice_t *k,
+                          void *arg,
+                          void (*handle_result)(void *,
+                                                const ldb_slice_t *,
+                                                const ldb_slice_t *)) {
+  ldb_iter_t *top_iter;
+  int rc = LDB_OK;
+
+  top_iter = ldb_blockiter_create(table->index_block,
+                                  table->options.comparator);
+
+  ldb_iter_seek(top_iter, k);
+
+  if (ldb_iter_valid(top_iter)) {
+    ldb_slice_t top_value = ldb_iter_value(top_iter);
+    const uint8_t *xp = top_value.data;
+    size_t xn = top_value.size;
+    ldb_handle_t index_handle;
+    ldb_handle_t filter_handle;
+
+    if (!ldb_handle_read(&index_handle, &xp, &xn)) {
+      rc = LDB_CORRUPTION;
+    } else if (table->partition_filters &&
+               ldb_handle_read(&filter_handle, &xp, &xn) &&
+               !ldb_table_filter_matches(table, options, &filter_handle, k)) {
+      /* Not found. */
+    } else {
+      ldb_iter_t *index_iter = ldb_table_readblock(table,
+                                                   options,
+                                                   &index_handle,
+                                                   1);
+
+      ldb_iter_seek(index_iter, k);
+
+      if (ldb_iter_valid(index_iter)) {
+        ldb_slice_t iter_value = ldb_iter_value(index_iter);
+        ldb_iter_t *block_iter = ldb_table_blockreader(table,
+                                                       options,
+                                                       &iter_value);
+
+        ldb_blockiter_seek_get(block_iter, k);
+
+        if (ldb_iter_valid(block_iter)) {
+          ldb_slice_t block_iter_key = ldb_iter_key(block_iter);
+          ldb_slice_t block_iter_value = ldb_iter_value(block_iter);
+
+          (*handle_result)(arg, &block_iter_key, &block_iter_value);
+        }
+
+        rc = ldb_iter_status(block_iter);
+
+        ldb_iter_destroy(block_iter);
+      }
+
+      if (rc == LDB_OK)
+        rc = ldb_iter_status(index_iter);
+
+      ldb_iter_destroy(index_iter);
+    }
+  }
+
+  if (rc == LDB_OK)
+    rc = ldb_iter_status(top_iter);
+
+  ldb_iter_destroy(top_iter);
+
+  return rc;
+}
+
 int
 ldb_table_internal_get(ldb_table_t *table,
                        const ldb_readopt_t *options,
@@ -321,6 +541,9 @@ ldb_table_internal_get(ldb_table_t *table,
   ldb_iter_t *index_iter;
   int rc = LDB_OK;
 
+  if (table->partitioned)
+    return ldb_table_partitioned_get(table, options, k, arg, handle_result);
+
   index_iter = ldb_blockiter_create(table->index_block,
                                     table->options.comparator);
 
@@ -340,7 +563,7 @@ ldb_table_internal_get(ldb_table_t *table,
                                                      options,
                                                      &iter_value);
 
-      ldb_iter_seek(block_iter, k);
+      ldb_blockiter_seek_get(block_iter, k);
 
       if (ldb_iter_valid(block_iter)) {
         ldb_slice_t block_iter_key = ldb_iter_key(block_iter);
@@ -380,6 +603,25 @@ ldb_table_approximate_offset(const ldb_table_t *table,
 
     if (ldb_handle_import(&handle, &input)) {
       result = handle.offset;
+
+      if (table->partitioned) {
+        /* The partition follows the data blocks it indexes. */
+        ldb_iter_t *iter = ldb_table_readblock(table,
+                                               ldb_readopt_default,
+                                               &handle,
+                                               1);
+
+        ldb_iter_seek(iter, key);
+
+        if (ldb_iter_valid(iter)) {
+          input = ldb_iter_value(iter);
+
+          if (ldb_handle_import(&handle, &input))
+            result = handle.offset;
+        }
+
+        ldb_iter_destroy(iter);
+      }
     } else {
       /* Strange: we can't decode the block handle in the index block.
          We'll just return the offset of the metaindex block, which is
@@ -68,7 +68,9 @@ ldb_tableiter_create(const ldb_table_t *table,
 
 /* Calls (*handle_result)(arg, ...) with the entry found after a call
  * to seek(key). May not make such a call if filter policy says
- * that key is not present.
+ * that key is not present. If a data block has a hash index, an
+ * entry with a different user key than key's may be reported (or
+ * none at all) where seek(key) would have found another.
  */
 int
 ldb_table_internal_get(ldb_table_t *table,
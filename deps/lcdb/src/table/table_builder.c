@@ -13,6 +13,7 @@
 #include <assert.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../util/bloom.h"
 #include "../util/buffer.h"
@@ -42,7 +43,9 @@ struct ldb_tablegen_s {
   uint64_t offset;
   int status;
   ldb_blockgen_t data_block;
-  ldb_blockgen_t index_block;
+  ldb_blockgen_t index_block; /* Current partition, if partitioned. */
+  ldb_blockgen_t top_block;   /* Top-level index, if partitioned. */
+  int partitioned;
   ldb_buffer_t last_key;
   int64_t num_entries;
   int closed; /* Either finish() or abandon() has been called. */
@@ -67,12 +70,16 @@ ldb_tablegen_init(ldb_tablegen_t *tb,
                   ldb_wfile_t *file) {
   tb->options = *options;
   tb->index_block_options = *options;
+  tb->index_block_options.block_hash_index = 0;
   tb->file = file;
   tb->offset = 0;
   tb->status = LDB_OK;
 
   ldb_blockgen_init(&tb->data_block, &tb->options);
   ldb_blockgen_init(&tb->index_block, &tb->index_block_options);
+  ldb_blockgen_init(&tb->top_block, &tb->index_block_options);
+
+  tb->partitioned = (options->index_partition_size > 0);
 
   ldb_buffer_init(&tb->last_key);
 
@@ -99,6 +106,7 @@ ldb_tablegen_clear(ldb_tablegen_t *tb) {
 
   ldb_blockgen_clear(&tb->data_block);
   ldb_blockgen_clear(&tb->index_block);
+  ldb_blockgen_clear(&tb->top_block);
 
   ldb_buffer_clear(&tb->last_key);
   ldb_buffer_clear(&tb->compressed_output);
@@ -212,6 +220,65 @@ ldb_tablegen_write_block(ldb_tablegen_t *tb,
   ldb_blockgen_reset(block);
 }
 
+static void
+ldb_tablegen_write_partition(ldb_tablegen_t *tb) {
+  /* Each partition is an ordinary index block preceded by a filter
+     covering every key of the data blocks it indexes. The top-level
+     index maps the partition's last key to both handles. */
+  uint8_t tmp[2 * LDB_HANDLE_SIZE];
+  ldb_handle_t filter_handle;
+  ldb_handle_t index_handle;
+  ldb_buffer_t handles;
+
+  assert(!ldb_blockgen_empty(&tb->index_block));
+
+  if (tb->status == LDB_OK && tb->filter_block != NULL) {
+    ldb_slice_t contents = ldb_filtergen_finish(tb->filter_block);
+
+    ldb_tablegen_write_raw_block(tb, &contents,
+                                     LDB_NO_COMPRESSION,
+                                     &filter_handle);
+
+    ldb_filtergen_clear(tb->filter_block);
+    ldb_filtergen_init(tb->filter_block, tb->options.filter_policy);
+    ldb_filtergen_start_block(tb->filter_block, 0);
+  }
+
+  if (tb->status != LDB_OK)
+    return;
+
+  ldb_tablegen_write_block(tb, &tb->index_block, &index_handle);
+
+  if (tb->status != LDB_OK)
+    return;
+
+  ldb_buffer_rwset(&handles, tmp, sizeof(tmp));
+  ldb_handle_export(&handles, &index_handle);
+
+  if (tb->filter_block != NULL)
+    ldb_handle_export(&handles, &filter_handle);
+
+  ldb_blockgen_add(&tb->top_block, &tb->last_key, &handles);
+}
+
+static void
+ldb_tablegen_add_index(ldb_tablegen_t *tb) {
+  uint8_t tmp[LDB_HANDLE_SIZE];
+  ldb_buffer_t handle_encoding;
+
+  ldb_buffer_rwset(&handle_encoding, tmp, sizeof(tmp));
+  ldb_handle_export(&handle_encoding, &tb->pending_handle);
+  ldb_blockgen_add(&tb->index_block, &tb->last_key, &handle_encoding);
+  tb->pending_index_entry = 0;
+
+  if (tb->partitioned) {
+    size_t size = ldb_blockgen_size_estimate(&tb->index_block);
+
+    if (size >= tb->options.index_partition_size)
+      ldb_tablegen_write_partition(tb);
+  }
+}
+
 void
 ldb_tablegen_add(ldb_tablegen_t *tb,
                  const ldb_slice_t *key,
@@ -227,16 +294,13 @@ ldb_tablegen_add(ldb_tablegen_t *tb,
     assert(ldb_compare(tb->options.comparator, key, &tb->last_key) > 0);
 
   if (tb->pending_index_entry) {
-    uint8_t tmp[LDB_HANDLE_SIZE];
-    ldb_buffer_t handle_encoding;
-
     assert(ldb_blockgen_empty(&tb->data_block));
 
     ldb_shortest_separator(tb->options.comparator, &tb->last_key, key);
-    ldb_buffer_rwset(&handle_encoding, tmp, sizeof(tmp));
-    ldb_handle_export(&handle_encoding, &tb->pending_handle);
-    ldb_blockgen_add(&tb->index_block, &tb->last_key, &handle_encoding);
-    tb->pending_index_entry = 0;
+    ldb_tablegen_add_index(tb);
+
+    if (tb->status != LDB_OK)
+      return;
   }
 
   if (tb->filter_block != NULL)
@@ -273,7 +337,7 @@ ldb_tablegen_flush(ldb_tablegen_t *tb) {
     tb->status = ldb_wfile_flush(tb->file);
   }
 
-  if (tb->filter_block != NULL)
+  if (tb->filter_block != NULL && !tb->partitioned)
     ldb_filtergen_start_block(tb->filter_block, tb->offset);
 }
 
@@ -289,8 +353,19 @@ ldb_tablegen_finish(ldb_tablegen_t *tb) {
 
   tb->closed = 1;
 
+  /* Finish the index (and its last partition). */
+  if (tb->status == LDB_OK && tb->pending_index_entry) {
+    ldb_short_successor(tb->options.comparator, &tb->last_key);
+    ldb_tablegen_add_index(tb);
+  }
+
+  if (tb->status == LDB_OK && tb->partitioned) {
+    if (!ldb_blockgen_empty(&tb->index_block))
+      ldb_tablegen_write_partition(tb);
+  }
+
   /* Write filter block. */
-  if (tb->status == LDB_OK && tb->filter_block != NULL) {
+  if (tb->status == LDB_OK && tb->filter_block != NULL && !tb->partitioned) {
     ldb_slice_t contents = ldb_filtergen_finish(tb->filter_block);
 
     ldb_tablegen_write_raw_block(tb, &contents,
@@ -300,47 +375,60 @@ ldb_tablegen_finish(ldb_tablegen_t *tb) {
 
   /* Write metaindex block. */
   if (tb->status == LDB_OK) {
+    ldb_dbopt_t metaindex_options = tb->options;
     ldb_blockgen_t metaindex_block;
 
-    ldb_blockgen_init(&metaindex_block, &tb->options);
+    metaindex_options.comparator = ldb_bytewise_comparator;
+    metaindex_options.block_hash_index = 0;
+
+    ldb_blockgen_init(&metaindex_block, &metaindex_options);
 
     if (tb->filter_block != NULL) {
       /* Add mapping from "filter.Name" to location of filter data. */
       uint8_t tmp[LDB_HANDLE_SIZE];
       ldb_buffer_t handle_encoding;
+      char name[sizeof(LDB_PARTITION_PREFIX) + 72];
       ldb_slice_t key;
-      char name[72];
+      size_t off = 0;
+
+      if (tb->partitioned) {
+        off = sizeof(LDB_PARTITION_PREFIX) - 1;
+        memcpy(name, LDB_PARTITION_PREFIX, off);
+      }
 
-      if (!ldb_bloom_name(name, sizeof(name), tb->options.filter_policy)) {
+      if (!ldb_bloom_name(name + off, 72, tb->options.filter_policy)) {
         ldb_blockgen_clear(&metaindex_block);
         return LDB_INVALID;
       }
 
       ldb_slice_set_str(&key, name);
       ldb_buffer_rwset(&handle_encoding, tmp, sizeof(tmp));
-      ldb_handle_export(&handle_encoding, &filter_handle);
+
+      if (!tb->partitioned)
+        ldb_handle_export(&handle_encoding, &filter_handle);
+
       ldb_blockgen_add(&metaindex_block, &key, &handle_encoding);
     }
 
+    if (tb->partitioned) {
+      ldb_slice_t key, empty;
+
+      ldb_slice_set_str(&key, LDB_PARTITION_INDEX);
+      ldb_slice_set(&empty, NULL, 0);
+      ldb_blockgen_add(&metaindex_block, &key, &empty);
+    }
+
     ldb_tablegen_write_block(tb, &metaindex_block, &metaindex_handle);
 
     ldb_blockgen_clear(&metaindex_block);
   }
 
-  /* Write index block. */
+  /* Write index block (or top-level index). */
   if (tb->status == LDB_OK) {
-    if (tb->pending_index_entry) {
-      uint8_t tmp[LDB_HANDLE_SIZE];
-      ldb_buffer_t handle_encoding;
-
-      ldb_short_successor(tb->options.comparator, &tb->last_key);
-      ldb_buffer_rwset(&handle_encoding, tmp, sizeof(tmp));
-      ldb_handle_export(&handle_encoding, &tb->pending_handle);
-      ldb_blockgen_add(&tb->index_block, &tb->last_key, &handle_encoding);
-      tb->pending_index_entry = 0;
-    }
-
-    ldb_tablegen_write_block(tb, &tb->index_block, &index_handle);
+    if (tb->partitioned)
+      ldb_tablegen_write_block(tb, &tb->top_block, &index_handle);
+    else
+      ldb_tablegen_write_block(tb, &tb->index_block, &index_handle);
   }
 
   /* Write footer. */
@@ -39,6 +39,12 @@
  *
  * - LRU: contains the items not currently referenced by clients, in LRU order
  *
+ * Items inserted with high priority (index and filter partitions) that are
+ * not referenced by clients sit in a third, high-priority LRU list instead.
+ * Eviction drains the low-priority list first. The high-priority list may
+ * hold at most half of the shard's capacity; beyond that its oldest items
+ * are demoted to the newest end of the low-priority list.
+ *
  * Elements are moved between these lists by the ref() and unref() methods,
  * when they detect an element in the cache acquiring or losing its only
  * external reference.
@@ -68,6 +74,8 @@ typedef struct lru_handle_s {
   size_t charge;
   size_t key_length;
   int in_cache;        /* Whether entry is in the cache. */
+  int high_pri;        /* Whether entry was inserted with high priority. */
+  int in_high;         /* Whether entry is on the high-priority list. */
   uint32_t refs;       /* References, including cache reference, if present. */
   uint32_t hash;       /* Hash of key(); used for fast sharding & comparisons */
   uint8_t key_data[1]; /* Beginning of key. */
@@ -229,16 +237,22 @@ lru_table_remove(lru_table_t *tbl, const ldb_slice_t *key, uint32_t hash) {
 typedef struct lru_shard_s {
   /* Initialized before use. */
   size_t capacity;
+  size_t high_capacity;
 
   /* mutex protects the following state. */
   ldb_mutex_t mutex;
   size_t usage;
+  size_t high_usage;
 
   /* Dummy head of LRU list. */
   /* list.prev is newest entry, list.next is oldest entry. */
   /* Entries have refs==1 and in_cache==1. */
   lru_handle_t list;
 
+  /* Dummy head of high-priority LRU list. */
+  /* Entries have refs==1, in_cache==1 and in_high==1. */
+  lru_handle_t high;
+
   /* Dummy head of in-use list. */
   /* Entries are in use by clients, and have refs >= 2 and in_cache==1. */
   lru_handle_t in_use;
@@ -270,10 +284,53 @@ lru_shard_remove(lru_handle_t *e) {
   e->prev->next = e->next;
 }
 
+static void
+lru_shard_detach(lru_shard_t *lru, lru_handle_t *e) {
+  lru_shard_remove(e);
+
+  if (e->in_high) {
+    lru->high_usage -= e->charge;
+    e->in_high = 0;
+  }
+}
+
+static void
+lru_shard_park(lru_shard_t *lru, lru_handle_t *e) {
+  if (!e->high_pri) {
+    lru_shard_append(&lru->list, e);
+    return;
+  }
+
+  lru_shard_append(&lru->high, e);
+
+  e->in_high = 1;
+
+  lru->high_usage += e->charge;
+
+  /* Demote the oldest high-priority entries once the pool is full. */
+  while (lru->high_usage > lru->high_capacity && lru->high.next != e) {
+    lru_handle_t *old = lru->high.next;
+
+    lru_shard_detach(lru, old);
+    lru_shard_append(&lru->list, old);
+  }
+}
+
+static lru_handle_t *
+lru_shard_oldest(lru_shard_t *lru) {
+  if (lru->list.next != &lru->list)
+    return lru->list.next;
+
+  if (lru->high.next != &lru->high)
+    return lru->high.next;
+
+  return NULL;
+}
+
 static void
 lru_shard_ref(lru_shard_t *lru, lru_handle_t *e) {
-  if (e->refs == 1 && e->in_cache) { /* If on lru->list, move to lru->in_use. */
-    lru_shard_remove(e);
+  if (e->refs == 1 && e->in_cache) { /* If on an LRU list, move to in_use. */
+    lru_shard_detach(lru, e);
     lru_shard_append(&lru->in_use, e);
   }
   e->refs++;
@@ -294,9 +351,9 @@ lru_shard_unref(lru_shard_t *lru, lru_handle_t *e) {
 
     ldb_free(e);
   } else if (e->in_cache && e->refs == 1) {
-    /* No longer in use; move to lru->list. */
+    /* No longer in use; move to an LRU list. */
     lru_shard_remove(e);
-    lru_shard_append(&lru->list, e);
+    lru_shard_park(lru, e);
   }
 }
 
@@ -307,12 +364,17 @@ lru_shard_init(lru_shard_t *lru) {
   ldb_mutex_init(&lru->mutex);
 
   lru->capacity = 0;
+  lru->high_capacity = 0;
   lru->usage = 0;
+  lru->high_usage = 0;
 
   /* Make empty circular linked lists. */
   lru->list.next = &lru->list;
   lru->list.prev = &lru->list;
 
+  lru->high.next = &lru->high;
+  lru->high.prev = &lru->high;
+
   lru->in_use.next = &lru->in_use;
   lru->in_use.prev = &lru->in_use;
 
@@ -320,13 +382,10 @@ lru_shard_init(lru_shard_t *lru) {
 }
 
 static void
-lru_shard_clear(lru_shard_t *lru) {
+lru_shard_clear_list(lru_shard_t *lru, lru_handle_t *list) {
   lru_handle_t *e, *next;
 
-  assert(lru->in_use.next == &lru->in_use); /* Error if caller has
-                                               an unreleased handle */
-
-  for (e = lru->list.next; e != &lru->list; e = next) {
+  for (e = list->next; e != list; e = next) {
     next = e->next;
 
     assert(e->in_cache);
@@ -337,6 +396,15 @@ lru_shard_clear(lru_shard_t *lru) {
 
     lru_shard_unref(lru, e);
   }
+}
+
+static void
+lru_shard_clear(lru_shard_t *lru) {
+  assert(lru->in_use.next == &lru->in_use); /* Error if caller has
+                                               an unreleased handle */
+
+  lru_shard_clear_list(lru, &lru->list);
+  lru_shard_clear_list(lru, &lru->high);
 
   lru_table_clear(&lru->table);
 
@@ -373,7 +441,7 @@ lru_shard_finish(lru_shard_t *lru, lru_handle_t *e) {
   if (e != NULL) {
     assert(e->in_cache);
 
-    lru_shard_remove(e);
+    lru_shard_detach(lru, e);
 
     e->in_cache = 0;
 
@@ -394,10 +462,11 @@ lru_shard_erase(lru_shard_t *lru, const ldb_slice_t *key, uint32_t hash) {
 
 static void
 lru_shard_prune(lru_shard_t *lru) {
+  lru_handle_t *e;
+
   ldb_mutex_lock(&lru->mutex);
 
-  while (lru->list.next != &lru->list) {
-    lru_handle_t *e = lru->list.next;
+  while ((e = lru_shard_oldest(lru)) != NULL) {
     ldb_slice_t key = lru_handle_key(e);
 
     assert(e->refs == 1);
@@ -415,8 +484,9 @@ lru_shard_insert(lru_shard_t *lru,
                  uint32_t hash,
                  void *value,
                  size_t charge,
-                 void (*deleter)(const ldb_slice_t *key, void *value)) {
-  lru_handle_t *e;
+                 void (*deleter)(const ldb_slice_t *key, void *value),
+                 int high_pri) {
+  lru_handle_t *e, *old;
 
   ldb_mutex_lock(&lru->mutex);
 
@@ -428,6 +498,8 @@ lru_shard_insert(lru_shard_t *lru,
   e->key_length = key->size;
   e->hash = hash;
   e->in_cache = 0;
+  e->high_pri = high_pri;
+  e->in_high = 0;
   e->refs = 1; /* For the returned handle. */
 
   memcpy(e->key_data, key->data, key->size);
@@ -443,8 +515,7 @@ lru_shard_insert(lru_shard_t *lru,
     e->next = NULL;
   }
 
-  while (lru->usage > lru->capacity && lru->list.next != &lru->list) {
-    lru_handle_t *old = lru->list.next;
+  while (lru->usage > lru->capacity && (old = lru_shard_oldest(lru))) {
     ldb_slice_t old_key = lru_handle_key(old);
 
     assert(old->refs == 1);
@@ -492,6 +563,7 @@ ldb_lru_create(size_t capacity) {
     lru_shard_init(&lru->shard[i]);
 
     lru->shard[i].capacity = per_shard;
+    lru->shard[i].high_capacity = per_shard / 2;
   }
 
   return lru;
@@ -517,7 +589,18 @@ ldb_lru_insert(ldb_lru_t *lru,
                void (*deleter)(const ldb_slice_t *key, void *value)) {
   uint32_t hash = ldb_lru_hash(key);
   lru_shard_t *shard = &lru->shard[ldb_lru_shard(hash)];
-  return lru_shard_insert(shard, key, hash, value, charge, deleter);
+  return lru_shard_insert(shard, key, hash, value, charge, deleter, 0);
+}
+
+lru_handle_t *
+ldb_lru_insert_high(ldb_lru_t *lru,
+                    const ldb_slice_t *key,
+                    void *value,
+                    size_t charge,
+                    void (*deleter)(const ldb_slice_t *key, void *value)) {
+  uint32_t hash = ldb_lru_hash(key);
+  lru_shard_t *shard = &lru->shard[ldb_lru_shard(hash)];
+  return lru_shard_insert(shard, key, hash, value, charge, deleter, 1);
 }
 
 lru_handle_t *
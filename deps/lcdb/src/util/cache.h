@@ -58,6 +58,17 @@ ldb_lru_insert(ldb_lru_t *lru,
                size_t charge,
                void (*deleter)(const ldb_slice_t *key, void *value));
 
+/* Like insert(), but the entry is evicted only after all unreferenced
+ * normal-priority entries, for as long as high-priority entries fit
+ * in half of the cache. Intended for index and filter partitions.
+ */
+ldb_entry_t *
+ldb_lru_insert_high(ldb_lru_t *lru,
+                    const ldb_slice_t *key,
+                    void *value,
+                    size_t charge,
+                    void (*deleter)(const ldb_slice_t *key, void *value));
+
 /* If the cache has no mapping for "key", returns NULL.
  *
  * Else return a handle that corresponds to the mapping. The caller
@@ -18,6 +18,8 @@
 #  include "env_unix_impl.h"
 #endif
 
+#include "port.h"
+
 /*
  * Globals
  */
@@ -76,6 +78,9 @@ ldb_wfile_append(ldb_wfile_t *file, const ldb_slice_t *data) {
   }
 #endif
 
+  if (file->ratelim != NULL)
+    ldb_ratelim_request(file->ratelim, data->size);
+
   return ldb_wfile_append0(file, data);
 }
 
@@ -198,3 +203,98 @@ ldb_test_filename(char *result, size_t size, const char *name) {
 
   return ldb_join(result, size, result, name);
 }
+
+void
+ldb_wfile_limit(ldb_wfile_t *file, ldb_ratelim_t *lim) {
+  file->ratelim = lim;
+}
+
+/*
+ * RateLimiter
+ */
+
+struct ldb_ratelim_s {
+  ldb_mutex_t mutex;
+  int64_t rate;      /* Bytes per second (0 = unlimited). */
+  int64_t available; /* Tokens in the bucket (negative when in debt). */
+  int64_t last;      /* Time of last refill (usec). */
+};
+
+ldb_ratelim_t *
+ldb_ratelim_create(int64_t rate) {
+  ldb_ratelim_t *lim = ldb_malloc(sizeof(ldb_ratelim_t));
+
+  ldb_mutex_init(&lim->mutex);
+
+  lim->rate = rate;
+  lim->available = 0;
+  lim->last = ldb_now_usec();
+
+  return lim;
+}
+
+void
+ldb_ratelim_destroy(ldb_ratelim_t *lim) {
+  ldb_mutex_destroy(&lim->mutex);
+  ldb_free(lim);
+}
+
+void
+ldb_ratelim_set_rate(ldb_ratelim_t *lim, int64_t rate) {
+  ldb_mutex_lock(&lim->mutex);
+
+  if (rate != lim->rate) {
+    lim->rate = rate;
+    lim->available = 0;
+    lim->last = ldb_now_usec();
+  }
+
+  ldb_mutex_unlock(&lim->mutex);
+}
+
+int64_t
+ldb_ratelim_rate(ldb_ratelim_t *lim) {
+  int64_t rate;
+
+  ldb_mutex_lock(&lim->mutex);
+
+  rate = lim->rate;
+
+  ldb_mutex_unlock(&lim->mutex);
+
+  return rate;
+}
+
+void
+ldb_ratelim_request(ldb_ratelim_t *lim, size_t size) {
+  int64_t wait = 0;
+
+  ldb_mutex_lock(&lim->mutex);
+
+  if (lim->rate > 0) {
+    int64_t now = ldb_now_usec();
+    int64_t burst = lim->rate / 10; /* Allow 100ms worth of bursting. */
+
+    if (now > lim->last) {
+      int64_t elapsed = LDB_MIN(now - lim->last, 1000000);
+
+      lim->available += (elapsed * lim->rate) / 1000000;
+      lim->last = now;
+    }
+
+    if (lim->available > burst)
+      lim->available = burst;
+
+    lim->available -= (int64_t)size;
+
+    /* Pay off any debt before returning. Later
+       requests will queue up behind this one. */
+    if (lim->available < 0)
+      wait = (-lim->available * 1000000) / lim->rate;
+  }
+
+  ldb_mutex_unlock(&lim->mutex);
+
+  if (wait > 0)
+    ldb_sleep_usec(wait);
+}
@@ -38,6 +38,7 @@ typedef struct ldb_filelock_s ldb_filelock_t;
 typedef struct ldb_logger_s ldb_logger_t;
 typedef struct ldb_rfile_s ldb_rfile_t;
 typedef struct ldb_wfile_s ldb_wfile_t;
+typedef struct ldb_ratelim_s ldb_ratelim_t;
 
 /*
  * Globals
@@ -193,6 +194,32 @@ ldb_wfile_close(ldb_wfile_t *file);
 void
 ldb_wfile_destroy(ldb_wfile_t *file);
 
+/* Throttle all further appends to file through lim. */
+void
+ldb_wfile_limit(ldb_wfile_t *file, ldb_ratelim_t *lim);
+
+/*
+ * RateLimiter
+ */
+
+/* Token bucket shared by the files being written in the background.
+   A rate of zero means unlimited. */
+ldb_ratelim_t *
+ldb_ratelim_create(int64_t rate);
+
+void
+ldb_ratelim_destroy(ldb_ratelim_t *lim);
+
+void
+ldb_ratelim_set_rate(ldb_ratelim_t *lim, int64_t rate);
+
+int64_t
+ldb_ratelim_rate(ldb_ratelim_t *lim);
+
+/* Block until `size` bytes worth of tokens are available. */
+void
+ldb_ratelim_request(ldb_ratelim_t *lim, size_t size);
+
 /*
  * Logging
  */
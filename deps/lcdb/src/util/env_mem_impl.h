@@ -704,12 +704,14 @@ ldb_randfile_create(const char *filename, ldb_rfile_t **file, int use_mmap) {
 struct ldb_wfile_s {
   ldb_fstate_t *state;
   int manifest;
+  ldb_ratelim_t *ratelim;
 };
 
 static void
 ldb_wfile_init(ldb_wfile_t *file, const char *filename, ldb_fstate_t *state) {
   file->state = ldb_fstate_ref(state);
   file->manifest = ldb_is_manifest(filename);
+  file->ratelim = NULL;
 }
 
 static LDB_INLINE int
@@ -1261,6 +1261,7 @@ struct ldb_wfile_s {
   int fd, manifest;
   unsigned char buf[LDB_WRITE_BUFFER];
   size_t pos;
+  ldb_ratelim_t *ratelim;
 };
 
 static void
@@ -1268,6 +1269,7 @@ ldb_wfile_init(ldb_wfile_t *file, const char *filename, int fd) {
   file->dirname = NULL;
   file->fd = fd;
   file->manifest = ldb_is_manifest(filename);
+  file->ratelim = NULL;
   file->pos = 0;
 
   if (file->manifest) {
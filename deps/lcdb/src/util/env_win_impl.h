@@ -1455,12 +1455,14 @@ struct ldb_wfile_s {
   int manifest;
   unsigned char buf[LDB_WRITE_BUFFER];
   size_t pos;
+  ldb_ratelim_t *ratelim;
 };
 
 static void
 ldb_wfile_init(ldb_wfile_t *file, const char *filename, HANDLE handle) {
   file->handle = handle;
   file->manifest = ldb_is_manifest(filename);
+  file->ratelim = NULL;
   file->pos = 0;
 }
 
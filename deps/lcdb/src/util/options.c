@@ -29,7 +29,10 @@ static const ldb_dbopt_t db_options = {
   /* .block_cache = */ NULL,
   /* .block_size = */ 4 * 1024,
   /* .block_restart_interval = */ 16,
+  /* .block_hash_index = */ 0,
+  /* .index_partition_size = */ 0,
   /* .max_file_size = */ 2 * 1024 * 1024,
+  /* .rate_limit = */ 0,
   /* .compression = */ LDB_SNAPPY_COMPRESSION,
   /* .reuse_logs = */ 0,
   /* .filter_policy = */ NULL,
@@ -51,7 +54,8 @@ static const ldb_readopt_t read_options = {
  */
 
 static const ldb_writeopt_t write_options = {
-  /* .sync = */ 0
+  /* .sync = */ 0,
+  /* .disable_wal = */ 0
 };
 
 /*
@@ -118,6 +118,23 @@ typedef struct ldb_dbopt_s {
    */
   int block_restart_interval; /* 16 */
 
+  /* If true, data blocks carry a small hash index mapping each user key
+   * to its restart interval. Point lookups consult it instead of binary
+   * searching the restart array. Costs roughly one byte per key. Blocks
+   * written without it remain readable. This parameter can be changed
+   * dynamically.
+   */
+  int block_hash_index; /* 0 */
+
+  /* If non-zero, the index of each table is split into partitions of
+   * roughly this many bytes, each with its own filter. Only the small
+   * top-level index stays in memory with the open table; partitions
+   * are read through the block cache at high priority. A zero value
+   * writes a single index block and a single filter block per table.
+   * This parameter can be changed dynamically.
+   */
+  size_t index_partition_size; /* 0 */
+
   /* The database will write up to this amount of bytes to a file before
    * switching to a new one.
    * Most clients should leave this parameter alone. However if your
@@ -129,6 +146,13 @@ typedef struct ldb_dbopt_s {
    */
   size_t max_file_size; /* 2 * 1024 * 1024 */
 
+  /* If non-zero, flushes and compactions write table files at no more
+   * than this many bytes per second, leaving disk bandwidth for reads
+   * and log writes. The limit is relaxed automatically as the number
+   * of level-0 files approaches the point where writes are slowed.
+   */
+  size_t rate_limit; /* 0 */
+
   /* Compress blocks using the specified compression algorithm. This
    * parameter can be changed dynamically.
    *
@@ -209,6 +233,15 @@ typedef struct ldb_writeopt_s {
    * system call followed by "fsync()".
    */
   int sync; /* 0 */
+
+  /* If true, the write is applied to the memtable without being
+   * added to the log. It becomes durable only once the memtable is
+   * flushed (see ldb_flush()) and is lost on close or crash before
+   * then. Useful when the caller can reconstruct the data itself.
+   * Logged writes made before an unlogged one are synced before the
+   * unlogged one can reach a table file.
+   */
+  int disable_wal; /* 0 */
 } ldb_writeopt_t;
 
 /*
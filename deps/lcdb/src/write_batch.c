@@ -21,6 +21,7 @@
 #include "util/slice.h"
 #include "util/status.h"
 
+#include "db_impl.h"
 #include "dbformat.h"
 #include "memtable.h"
 #include "write_batch.h"
@@ -31,7 +32,9 @@
  *    data: record[count]
  * record :=
  *    LDB_TYPE_VALUE varstring varstring |
- *    LDB_TYPE_DELETION varstring
+ *    LDB_TYPE_DELETION varstring |
+ *    LDB_TYPE_FAMILY_VALUE varint32 varstring varstring |
+ *    LDB_TYPE_FAMILY_DELETION varint32 varstring
  * varstring :=
  *    len: varint32
  *    data: uint8[len]
@@ -44,6 +47,21 @@
 /* Header has an 8-byte sequence number followed by a 4-byte count. */
 #define LDB_HEADER 12
 
+/* Records addressed to a column family carry the family
+   id before the key. These tags never reach a memtable. */
+#define LDB_TYPE_FAMILY_DELETION 4
+#define LDB_TYPE_FAMILY_VALUE 5
+
+/*
+ * Types
+ */
+
+typedef struct ldb_inserter_s {
+  ldb_memtable_t **tables;
+  int length;
+  int invalid;
+} ldb_inserter_t;
+
 /*
  * WriteBatch
  */
@@ -88,6 +106,7 @@ int
 ldb_batch_iterate(const ldb_batch_t *batch, ldb_handler_t *handler) {
   ldb_slice_t input = batch->rep;
   ldb_slice_t key, value;
+  uint32_t family;
   int found = 0;
 
   if (input.size < LDB_HEADER)
@@ -102,7 +121,16 @@ ldb_batch_iterate(const ldb_batch_t *batch, ldb_handler_t *handler) {
 
     found++;
 
+    family = 0;
+
     switch (tag) {
+      case LDB_TYPE_FAMILY_VALUE: {
+        if (!ldb_varint32_slurp(&family, &input) || family == 0)
+          return LDB_CORRUPTION; /* "bad WriteBatch Put" */
+
+        /* fallthrough */
+      }
+
       case LDB_TYPE_VALUE: {
         if (!ldb_slice_slurp(&key, &input))
           return LDB_CORRUPTION; /* "bad WriteBatch Put" */
@@ -110,15 +138,24 @@ ldb_batch_iterate(const ldb_batch_t *batch, ldb_handler_t *handler) {
         if (!ldb_slice_slurp(&value, &input))
           return LDB_CORRUPTION; /* "bad WriteBatch Put" */
 
+        handler->family = family;
         handler->put(handler, &key, &value);
 
         break;
       }
 
+      case LDB_TYPE_FAMILY_DELETION: {
+        if (!ldb_varint32_slurp(&family, &input) || family == 0)
+          return LDB_CORRUPTION; /* "bad WriteBatch Delete" */
+
+        /* fallthrough */
+      }
+
       case LDB_TYPE_DELETION: {
         if (!ldb_slice_slurp(&key, &input))
           return LDB_CORRUPTION; /* "bad WriteBatch Delete" */
 
+        handler->family = family;
         handler->del(handler, &key);
 
         break;
@@ -173,6 +210,42 @@ ldb_batch_del(ldb_batch_t *batch, const ldb_slice_t *key) {
   ldb_slice_export(&batch->rep, key);
 }
 
+void
+ldb_batch_put_family(ldb_batch_t *batch,
+                     const ldb_t *family,
+                     const ldb_slice_t *key,
+                     const ldb_slice_t *value) {
+  uint32_t id = ldb_family_id(family);
+
+  if (id == 0) {
+    ldb_batch_put(batch, key, value);
+    return;
+  }
+
+  ldb_batch_set_count(batch, ldb_batch_count(batch) + 1);
+  ldb_buffer_push(&batch->rep, LDB_TYPE_FAMILY_VALUE);
+  ldb_buffer_varint32(&batch->rep, id);
+  ldb_slice_export(&batch->rep, key);
+  ldb_slice_export(&batch->rep, value);
+}
+
+void
+ldb_batch_del_family(ldb_batch_t *batch,
+                     const ldb_t *family,
+                     const ldb_slice_t *key) {
+  uint32_t id = ldb_family_id(family);
+
+  if (id == 0) {
+    ldb_batch_del(batch, key);
+    return;
+  }
+
+  ldb_batch_set_count(batch, ldb_batch_count(batch) + 1);
+  ldb_buffer_push(&batch->rep, LDB_TYPE_FAMILY_DELETION);
+  ldb_buffer_varint32(&batch->rep, id);
+  ldb_slice_export(&batch->rep, key);
+}
+
 void
 ldb_batch_append(ldb_batch_t *dst, const ldb_batch_t *src) {
   assert(src->rep.size >= LDB_HEADER);
@@ -187,10 +260,14 @@ static void
 memtable_put(ldb_handler_t *handler,
              const ldb_slice_t *key,
              const ldb_slice_t *value) {
-  ldb_memtable_t *table = handler->state;
+  ldb_inserter_t *ins = handler->state;
   ldb_seqnum_t seq = handler->number;
 
-  ldb_memtable_add(table, seq, LDB_TYPE_VALUE, key, value);
+  if ((unsigned int)handler->family >= (unsigned int)ins->length)
+    ins->invalid = 1;
+  else if (ins->tables[handler->family] != NULL)
+    ldb_memtable_add(ins->tables[handler->family], seq,
+                     LDB_TYPE_VALUE, key, value);
 
   handler->number++;
 }
@@ -198,24 +275,46 @@ memtable_put(ldb_handler_t *handler,
 static void
 memtable_del(ldb_handler_t *handler, const ldb_slice_t *key) {
   static const ldb_slice_t value = {NULL, 0, 0};
-  ldb_memtable_t *table = handler->state;
+  ldb_inserter_t *ins = handler->state;
   ldb_seqnum_t seq = handler->number;
 
-  ldb_memtable_add(table, seq, LDB_TYPE_DELETION, key, &value);
+  if ((unsigned int)handler->family >= (unsigned int)ins->length)
+    ins->invalid = 1;
+  else if (ins->tables[handler->family] != NULL)
+    ldb_memtable_add(ins->tables[handler->family], seq,
+                     LDB_TYPE_DELETION, key, &value);
 
   handler->number++;
 }
 
 int
 ldb_batch_insert_into(const ldb_batch_t *batch, ldb_memtable_t *table) {
+  return ldb_batch_insert_families(batch, &table, 1);
+}
+
+int
+ldb_batch_insert_families(const ldb_batch_t *batch,
+                          ldb_memtable_t **tables,
+                          int length) {
   ldb_handler_t handler;
+  ldb_inserter_t ins;
+  int rc;
+
+  ins.tables = tables;
+  ins.length = length;
+  ins.invalid = 0;
 
-  handler.state = table;
+  handler.state = &ins;
   handler.number = ldb_batch_sequence(batch);
   handler.put = memtable_put;
   handler.del = memtable_del;
 
-  return ldb_batch_iterate(batch, &handler);
+  rc = ldb_batch_iterate(batch, &handler);
+
+  if (rc == LDB_OK && ins.invalid)
+    rc = LDB_CORRUPTION; /* "unknown column family" */
+
+  return rc;
 }
 
 void
@@ -41,12 +41,14 @@
  */
 
 struct ldb_memtable_s;
+struct ldb_s;
 
 typedef uint64_t ldb__seqnum_t;
 
 typedef struct ldb_handler_s {
   void *state;
   uint64_t number;
+  int family; /* Set before each callback; 0 is the default family. */
 
   void (*put)(struct ldb_handler_s *handler,
               const ldb_slice_t *key,
@@ -119,6 +121,19 @@ ldb_batch_put(ldb_batch_t *batch,
 LDB_EXTERN void
 ldb_batch_del(ldb_batch_t *batch, const ldb_slice_t *key);
 
+/* Store the mapping "key->value" in the given column family. */
+LDB_EXTERN void
+ldb_batch_put_family(ldb_batch_t *batch,
+                     const struct ldb_s *family,
+                     const ldb_slice_t *key,
+                     const ldb_slice_t *value);
+
+/* Erase "key" from the given column family. */
+LDB_EXTERN void
+ldb_batch_del_family(ldb_batch_t *batch,
+                     const struct ldb_s *family,
+                     const ldb_slice_t *key);
+
 /* Copies the operations in "src" to this batch.
  *
  * This runs in O(source size) time. However, the constant factor is better
@@ -131,6 +146,14 @@ ldb_batch_append(ldb_batch_t *dst, const ldb_batch_t *src);
 int
 ldb_batch_insert_into(const ldb_batch_t *batch, struct ldb_memtable_s *table);
 
+/* Insert each record into the memtable of its family. Records
+   for a family whose table is NULL still consume a sequence
+   number but are otherwise skipped. */
+int
+ldb_batch_insert_families(const ldb_batch_t *batch,
+                          struct ldb_memtable_s **tables,
+                          int length);
+
 void
 ldb_batch_set_contents(ldb_batch_t *batch, const ldb_slice_t *contents);
 
@@ -103,6 +103,15 @@ btc_addrman_clear_banned(btc_addrman_t *man);
 BTC_EXTERN const btc_addrent_t *
 btc_addrman_get(btc_addrman_t *man);
 
+BTC_EXTERN const btc_addrent_t *
+btc_addrman_get_fresh(btc_addrman_t *man);
+
+BTC_EXTERN const btc_addrent_t *
+btc_addrman_get_collision(btc_addrman_t *man);
+
+BTC_EXTERN void
+btc_addrman_resolve_collisions(btc_addrman_t *man);
+
 BTC_EXTERN int
 btc_addrman_add(btc_addrman_t *man,
                 const btc_netaddr_t *addr,
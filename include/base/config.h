@@ -27,8 +27,11 @@ struct btc_conf_s {
   int network_active;
   int disable_wallet;
   int cache_size;
+  int rate_limit;
+  int chain_wal;
   int checkpoints;
   int prune;
+  int full_rbf;
   int workers;
   int listen;
   int port;
@@ -40,6 +43,7 @@ struct btc_conf_s {
   int max_connections;
   int max_inbound;
   int max_outbound;
+  int max_block_relay;
   int ban_time;
   int discover;
   int upnp;
@@ -54,6 +58,7 @@ struct btc_conf_s {
   char rpc_connect[64];
   char rpc_user[64];
   char rpc_pass[64];
+  char rpc_wallet[64];
   int version;
   int help;
   const char *method;
@@ -177,6 +177,9 @@ btc_fs_exists(const char *name);
 BTC_EXTERN int
 btc_fs_rename(const char *from, const char *to);
 
+BTC_EXTERN int
+btc_fs_link(const char *from, const char *to);
+
 BTC_EXTERN int
 btc_fs_unlink(const char *name);
 
@@ -98,6 +98,7 @@ typedef struct http_req {
 typedef struct http_res {
   btc_socket_t *socket;
   http_head_t headers;
+  int held;
 } http_res_t;
 
 struct http_server;
@@ -167,6 +168,12 @@ http_res_error(http_res_t *res, unsigned int status);
 BTC_EXTERN void
 http_res_unauthorized(http_res_t *res, const char *realm);
 
+BTC_EXTERN void
+http_res_hold(http_res_t *res);
+
+BTC_EXTERN void
+http_res_release(http_res_t *res);
+
 /*
  * Server
  */
@@ -68,6 +68,9 @@ btc_address_is_p2wpkh(const btc_address_t *addr);
 BTC_EXTERN int
 btc_address_is_p2wsh(const btc_address_t *addr);
 
+BTC_EXTERN int
+btc_address_is_p2tr(const btc_address_t *addr);
+
 BTC_EXTERN int
 btc_address_is_program(const btc_address_t *addr);
 
@@ -89,6 +92,9 @@ btc_address_set_p2wpkh(btc_address_t *addr, const uint8_t *hash);
 BTC_EXTERN void
 btc_address_set_p2wsh(btc_address_t *addr, const uint8_t *hash);
 
+BTC_EXTERN void
+btc_address_set_p2tr(btc_address_t *addr, const uint8_t *key);
+
 BTC_EXTERN int
 btc_address_set_program(btc_address_t *addr, const btc_program_t *program);
 
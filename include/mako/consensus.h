@@ -163,6 +163,56 @@ extern "C" {
 
 #define BTC_MAX_MULTISIG_PUBKEYS 20
 
+/**
+ * Taproot leaf version mask (consensus).
+ */
+
+#define BTC_TAPROOT_LEAF_MASK 0xfe
+
+/**
+ * Tapscript leaf version (consensus).
+ */
+
+#define BTC_TAPROOT_LEAF_TAPSCRIPT 0xc0
+
+/**
+ * First byte of a taproot annex (consensus).
+ */
+
+#define BTC_TAPROOT_ANNEX_TAG 0x50
+
+/**
+ * Base size of a taproot control block (consensus).
+ */
+
+#define BTC_TAPROOT_CONTROL_BASE_SIZE 33
+
+/**
+ * Size of a taproot merkle path node (consensus).
+ */
+
+#define BTC_TAPROOT_CONTROL_NODE_SIZE 32
+
+/**
+ * Max depth of a taproot merkle path (consensus).
+ */
+
+#define BTC_TAPROOT_CONTROL_MAX_NODES 128
+
+/**
+ * Tapscript validation weight consumed
+ * by each signature check (consensus).
+ */
+
+#define BTC_VALIDATION_WEIGHT_PER_SIGOP 50
+
+/**
+ * Tapscript validation weight offset
+ * added to the witness size (consensus).
+ */
+
+#define BTC_VALIDATION_WEIGHT_OFFSET 50
+
 /**
  * The date bip16 (p2sh) was activated (consensus).
  */
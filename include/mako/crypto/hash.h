@@ -29,6 +29,12 @@ btc_hash160_final(btc_hash160_t *ctx, uint8_t *out);
 BTC_EXTERN void
 btc_hash160(uint8_t *out, const void *data, size_t size);
 
+BTC_EXTERN void
+btc_hash160_batch(uint8_t *out,
+                  const uint8_t *data,
+                  size_t size,
+                  size_t count);
+
 /*
  * Hash256
  */
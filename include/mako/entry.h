@@ -21,7 +21,17 @@ extern "C" {
  * Constants
  */
 
-#define BTC_ENTRY_SIZE 132
+#define BTC_ENTRY_SIZE 136
+
+/* Entry status. A failed entry did not validate; a
+   failed child descends from one that did not. */
+#define BTC_ENTRY_FAILED (1 << 0)
+#define BTC_ENTRY_FAILED_CHILD (1 << 1)
+#define BTC_ENTRY_INVALID (BTC_ENTRY_FAILED | BTC_ENTRY_FAILED_CHILD)
+
+/* An orphan's block data is on disk but has not been
+   validated; its parent was unknown when it arrived. */
+#define BTC_ENTRY_ORPHAN (1 << 2)
 
 /*
  * Chain Entry
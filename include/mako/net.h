@@ -47,6 +47,12 @@ extern "C" {
 
 #define BTC_NET_SENDHEADERS_VERSION 7012
 
+/**
+ * Minimum version for bip133.
+ */
+
+#define BTC_NET_FEEFILTER_VERSION 70013
+
 /**
  * Minimum version for bip152.
  */
@@ -157,6 +163,30 @@ enum btc_net_services {
 
 #define BTC_NET_MAX_TX_REQUEST 10000
 
+/**
+ * Maximum number of in-flight tx requests per peer.
+ */
+
+#define BTC_NET_MAX_TX_INFLIGHT 100
+
+/**
+ * Delay before acting on a tx announced by an inbound peer (ms).
+ */
+
+#define BTC_NET_TX_INBOUND_DELAY 2000
+
+/**
+ * Time to wait for a requested tx before asking another peer (ms).
+ */
+
+#define BTC_NET_TX_TIMEOUT 60000
+
+/**
+ * Time a peer may still deliver a tx after it was requested (ms).
+ */
+
+#define BTC_NET_TX_LATE_TIMEOUT (10 * 60000)
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,7 +37,7 @@ typedef struct btc_checkpoint_s {
   uint8_t hash[32];
 } btc_checkpoint_t;
 
-typedef struct btc_deployment_s {
+struct btc_deployment_s {
   const char *name;
   int bit;
   int64_t start_time;
@@ -46,7 +46,7 @@ typedef struct btc_deployment_s {
   int32_t window;
   int required;
   int force;
-} btc_deployment_t;
+};
 
 struct btc_network_s {
   /**
@@ -217,6 +217,11 @@ struct btc_network_s {
      * Block which activated bip141.
      */
     btc_checkpoint_t segwit;
+
+    /**
+     * Block which activated bip341 & bip342.
+     */
+    btc_checkpoint_t taproot;
   } softforks;
 
   /**
@@ -112,6 +112,13 @@ extern "C" {
 
 #define BTC_MAX_P2WSH_SIZE 3600
 
+/**
+ * Max tapscript push size. Used for
+ * witness malleation checks (policy).
+ */
+
+#define BTC_MAX_TAPSCRIPT_PUSH 80
+
 /**
  * Default ancestor limit.
  */
@@ -137,12 +144,26 @@ extern "C" {
 
 #define BTC_MEMPOOL_EXPIRY_TIME (72 * 60 * 60)
 
+/**
+ * Half-life of the rolling minimum fee
+ * rate after mempool evictions.
+ */
+
+#define BTC_MEMPOOL_FEE_HALFLIFE (12 * 60 * 60)
+
 /**
  * Maximum number of orphan transactions.
  */
 
 #define BTC_MEMPOOL_MAX_ORPHANS 100
 
+/**
+ * Maximum number of transactions a
+ * replacement may evict (bip125).
+ */
+
+#define BTC_MEMPOOL_MAX_REPLACEMENTS 100
+
 /**
  * Minimum block size to create. Block will be
  * filled with free transactions until block
@@ -185,6 +206,9 @@ btc_round_fee(int64_t rate, size_t size);
 BTC_EXTERN int64_t
 btc_get_rate(int64_t fee, size_t size);
 
+BTC_EXTERN int64_t
+btc_round_filter(int64_t rate, int64_t min_relay);
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +44,10 @@ enum btc_script_flags {
   BTC_SCRIPT_VERIFY_NULLFAIL = (1U << 14),
   BTC_SCRIPT_VERIFY_WITNESS_PUBKEYTYPE = (1U << 15),
   BTC_SCRIPT_VERIFY_CONST_SCRIPTCODE = (1U << 16),
+  BTC_SCRIPT_VERIFY_TAPROOT = (1U << 17),
+  BTC_SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_TAPROOT_VERSION = (1U << 18),
+  BTC_SCRIPT_VERIFY_DISCOURAGE_OP_SUCCESS = (1U << 19),
+  BTC_SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_PUBKEYTYPE = (1U << 20),
   BTC_SCRIPT_MANDATORY_VERIFY_FLAGS = BTC_SCRIPT_VERIFY_P2SH,
   BTC_SCRIPT_STANDARD_VERIFY_FLAGS = 0
     | BTC_SCRIPT_MANDATORY_VERIFY_FLAGS
@@ -60,7 +64,11 @@ enum btc_script_flags {
     | BTC_SCRIPT_VERIFY_LOW_S
     | BTC_SCRIPT_VERIFY_WITNESS
     | BTC_SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_WITNESS_PROGRAM
-    | BTC_SCRIPT_VERIFY_WITNESS_PUBKEYTYPE,
+    | BTC_SCRIPT_VERIFY_WITNESS_PUBKEYTYPE
+    | BTC_SCRIPT_VERIFY_TAPROOT
+    | BTC_SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_TAPROOT_VERSION
+    | BTC_SCRIPT_VERIFY_DISCOURAGE_OP_SUCCESS
+    | BTC_SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_PUBKEYTYPE,
   BTC_SCRIPT_ONLY_STANDARD_VERIFY_FLAGS = BTC_SCRIPT_STANDARD_VERIFY_FLAGS
                                        & ~BTC_SCRIPT_MANDATORY_VERIFY_FLAGS
 };
@@ -126,6 +134,18 @@ enum btc_script_error {
   BTC_SCRIPT_ERR_OP_CODESEPARATOR,
   BTC_SCRIPT_ERR_SIG_FINDANDDELETE,
 
+  /* Taproot */
+  BTC_SCRIPT_ERR_SCHNORR_SIG_SIZE,
+  BTC_SCRIPT_ERR_SCHNORR_SIG_HASHTYPE,
+  BTC_SCRIPT_ERR_SCHNORR_SIG,
+  BTC_SCRIPT_ERR_TAPROOT_WRONG_CONTROL_SIZE,
+  BTC_SCRIPT_ERR_TAPSCRIPT_VALIDATION_WEIGHT,
+  BTC_SCRIPT_ERR_TAPSCRIPT_CHECKMULTISIG,
+  BTC_SCRIPT_ERR_TAPSCRIPT_MINIMALIF,
+  BTC_SCRIPT_ERR_DISCOURAGE_UPGRADABLE_TAPROOT_VERSION,
+  BTC_SCRIPT_ERR_DISCOURAGE_OP_SUCCESS,
+  BTC_SCRIPT_ERR_DISCOURAGE_UPGRADABLE_PUBKEYTYPE,
+
   BTC_SCRIPT_ERR_ERROR_COUNT
 };
 
@@ -264,6 +284,9 @@ enum btc_opcode {
   BTC_OP_NOP9 = 0xb8,
   BTC_OP_NOP10 = 0xb9,
 
+  /* tapscript */
+  BTC_OP_CHECKSIGADD = 0xba,
+
   BTC_OP_INVALIDOPCODE = 0xff
 };
 
@@ -509,6 +532,15 @@ btc_script_get_p2wsh(const uint8_t **hash, const btc_script_t *script);
 BTC_EXTERN void
 btc_script_set_p2wsh(btc_script_t *script, const uint8_t *hash);
 
+BTC_EXTERN int
+btc_script_is_p2tr(const btc_script_t *script);
+
+BTC_EXTERN int
+btc_script_get_p2tr(const uint8_t **key, const btc_script_t *script);
+
+BTC_EXTERN void
+btc_script_set_p2tr(btc_script_t *script, const uint8_t *key);
+
 BTC_EXTERN int
 btc_script_is_unknown(const btc_script_t *script);
 
@@ -579,6 +611,49 @@ btc_scriptsig_inspect(const btc_script_t *script);
 BTC_EXTERN void
 btc_script_inspect(const btc_script_t *script, const btc_network_t *network);
 
+/*
+ * Taproot
+ */
+
+BTC_EXTERN void
+btc_taproot_leaf_hash(uint8_t *hash, int version, const btc_script_t *script);
+
+BTC_EXTERN void
+btc_taproot_branch_hash(uint8_t *hash,
+                        const uint8_t *left,
+                        const uint8_t *right);
+
+BTC_EXTERN void
+btc_taproot_tweak_hash(uint8_t *hash, const uint8_t *key, const uint8_t *root);
+
+BTC_EXTERN void
+btc_taproot_root(uint8_t *root,
+                 const uint8_t *leaf,
+                 const uint8_t *path,
+                 size_t length);
+
+/*
+ * Signature Batch
+ */
+
+BTC_EXTERN void
+btc_sigbatch_init(btc_sigbatch_t *batch);
+
+BTC_EXTERN void
+btc_sigbatch_clear(btc_sigbatch_t *batch);
+
+BTC_EXTERN void
+btc_sigbatch_reset(btc_sigbatch_t *batch);
+
+BTC_EXTERN void
+btc_sigbatch_push(btc_sigbatch_t *batch,
+                  const uint8_t *msg,
+                  const uint8_t *sig,
+                  const uint8_t *key);
+
+BTC_EXTERN int
+btc_sigbatch_verify(btc_sigbatch_t *batch);
+
 /*
  * Reader
  */
@@ -203,9 +203,32 @@ btc_tx_sighash(uint8_t *hash,
                int version,
                btc_tx_cache_t *cache);
 
+BTC_EXTERN int
+btc_tx_sighash_taproot(uint8_t *hash,
+                       const btc_tx_t *tx,
+                       size_t index,
+                       const btc_script_t *prev,
+                       int64_t value,
+                       int type,
+                       const btc_buffer_t *annex,
+                       const uint8_t *leaf,
+                       uint32_t codesep,
+                       const btc_tx_cache_t *cache);
+
+BTC_EXTERN int
+btc_tx_precompute(btc_tx_cache_t *cache,
+                  const btc_tx_t *tx,
+                  const btc_view_t *view);
+
 BTC_EXTERN int
 btc_tx_verify(const btc_tx_t *tx, const btc_view_t *view, unsigned int flags);
 
+BTC_EXTERN int
+btc_tx_verify_batch(const btc_tx_t *tx,
+                    const btc_view_t *view,
+                    unsigned int flags,
+                    btc_sigbatch_t *batch);
+
 BTC_EXTERN int
 btc_tx_verify_input(const btc_tx_t *tx,
                     size_t index,
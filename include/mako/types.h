@@ -170,6 +170,8 @@ typedef struct btc_entry_s {
   int32_t block_pos;
   int32_t undo_file;
   int32_t undo_pos;
+  uint32_t status;
+  int64_t max_time;
   struct btc_entry_s *prev;
   struct btc_entry_s *next;
 } btc_entry_t;
@@ -199,6 +201,13 @@ typedef struct btc_multikey_s {
   size_t length;
 } btc_multikey_t;
 
+typedef struct btc_sigbatch_s {
+  struct btc_sigentry_s *items;
+  size_t alloc;
+  size_t length;
+  struct wei_scratch_s *scratch;
+} btc_sigbatch_t;
+
 typedef struct btc_tx_cache_s {
   uint8_t prevouts[32];
   uint8_t sequences[32];
@@ -206,6 +215,13 @@ typedef struct btc_tx_cache_s {
   int has_prevouts;
   int has_sequences;
   int has_outputs;
+  uint8_t sha_prevouts[32];
+  uint8_t sha_amounts[32];
+  uint8_t sha_scriptpubkeys[32];
+  uint8_t sha_sequences[32];
+  uint8_t sha_outputs[32];
+  int has_taproot;
+  btc_sigbatch_t *batch;
 } btc_tx_cache_t;
 
 typedef struct btc_verify_error_s {
@@ -216,6 +232,7 @@ typedef struct btc_verify_error_s {
   int malleated;
 } btc_verify_error_t;
 
+typedef struct btc_deployment_s btc_deployment_t;
 typedef struct btc_network_s btc_network_t;
 typedef struct btc_sha256_s btc__hash256_t;
 
@@ -258,6 +275,9 @@ typedef struct btc_mpentry_s {
   uint8_t locks;
   int64_t desc_fee;
   int64_t desc_size;
+  int64_t anc_fee;
+  int64_t anc_size;
+  int anc_count;
 } btc_mpentry_t;
 
 /* https://github.com/satoshilabs/slips/blob/master/slip-0132.md */
@@ -266,7 +286,8 @@ enum btc_bip32_type {
   BTC_BIP32_NESTED_P2WPKH = 1, /* ypub/yprv, m/49' */
   BTC_BIP32_P2WPKH = 2, /* zpub/zprv, m/84' */
   BTC_BIP32_NESTED_P2WSH = 3, /* Ypub/Yprv */
-  BTC_BIP32_P2WSH = 4 /* Zpub/Zprv */
+  BTC_BIP32_P2WSH = 4, /* Zpub/Zprv */
+  BTC_BIP32_P2TR = 5 /* xpub/xprv, m/86' */
 };
 
 typedef struct btc_hdnode_s {
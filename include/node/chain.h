@@ -86,6 +86,9 @@ btc_chain_set_threads(btc_chain_t *chain, int threads);
 BTC_EXTERN void
 btc_chain_set_cache(btc_chain_t *chain, size_t cache_size);
 
+BTC_EXTERN void
+btc_chain_set_rate_limit(btc_chain_t *chain, size_t rate_limit);
+
 BTC_EXTERN void
 btc_chain_on_block(btc_chain_t *chain, btc_chain_block_cb *handler);
 
@@ -149,6 +152,18 @@ btc_chain_add(btc_chain_t *chain,
               unsigned int flags,
               unsigned int id);
 
+BTC_EXTERN int
+btc_chain_invalidate(btc_chain_t *chain, const uint8_t *hash);
+
+BTC_EXTERN int
+btc_chain_reconsider(btc_chain_t *chain, const uint8_t *hash);
+
+BTC_EXTERN int
+btc_chain_precious(btc_chain_t *chain, const uint8_t *hash);
+
+BTC_EXTERN int
+btc_chain_backup(btc_chain_t *chain, const char *prefix);
+
 BTC_EXTERN const btc_entry_t *
 btc_chain_tip(btc_chain_t *chain);
 
@@ -182,6 +197,9 @@ btc_chain_by_hash(btc_chain_t *chain, const uint8_t *hash);
 BTC_EXTERN const btc_entry_t *
 btc_chain_by_height(btc_chain_t *chain, int32_t height);
 
+BTC_EXTERN const btc_entry_t *
+btc_chain_by_time(btc_chain_t *chain, int64_t time);
+
 BTC_EXTERN int
 btc_chain_is_main(btc_chain_t *chain, const btc_entry_t *entry);
 
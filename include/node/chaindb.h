@@ -29,12 +29,18 @@ btc_chaindb_destroy(btc_chaindb_t *db);
 BTC_EXTERN void
 btc_chaindb_set_cache(btc_chaindb_t *db, size_t cache_size);
 
+BTC_EXTERN void
+btc_chaindb_set_rate_limit(btc_chaindb_t *db, size_t rate_limit);
+
 BTC_EXTERN int
 btc_chaindb_open(btc_chaindb_t *db, const char *prefix, unsigned int flags);
 
 BTC_EXTERN void
 btc_chaindb_close(btc_chaindb_t *db);
 
+BTC_EXTERN int
+btc_chaindb_backup(btc_chaindb_t *db, const char *prefix);
+
 BTC_EXTERN btc_coin_t *
 btc_chaindb_coin(btc_chaindb_t *db, const uint8_t *hash, size_t index);
 
@@ -54,6 +60,12 @@ btc_chaindb_save(btc_chaindb_t *db,
                  const btc_block_t *block,
                  const btc_view_t *view);
 
+BTC_EXTERN void
+btc_chaindb_begin(btc_chaindb_t *db);
+
+BTC_EXTERN int
+btc_chaindb_commit(btc_chaindb_t *db);
+
 BTC_EXTERN int
 btc_chaindb_reconnect(btc_chaindb_t *db,
                       btc_entry_t *entry,
@@ -63,7 +75,39 @@ btc_chaindb_reconnect(btc_chaindb_t *db,
 BTC_EXTERN btc_view_t *
 btc_chaindb_disconnect(btc_chaindb_t *db,
                        btc_entry_t *entry,
-                       const btc_block_t *block);
+                       const btc_block_t *block,
+                       btc_undo_t *undo);
+
+BTC_EXTERN int
+btc_chaindb_save_orphan(btc_chaindb_t *db,
+                        const btc_entry_t *entry,
+                        const btc_block_t *block);
+
+BTC_EXTERN btc_block_t *
+btc_chaindb_get_orphan(btc_chaindb_t *db, const btc_entry_t *entry);
+
+BTC_EXTERN int
+btc_chaindb_remove_orphan(btc_chaindb_t *db, const btc_entry_t *entry);
+
+BTC_EXTERN void
+btc_chaindb_orphans(btc_chaindb_t *db, btc_vector_t *entries);
+
+BTC_EXTERN int
+btc_chaindb_update(btc_chaindb_t *db, const btc_entry_t *entry);
+
+BTC_EXTERN int
+btc_chaindb_get_state(btc_chaindb_t *db,
+                      const btc_deployment_t *deploy,
+                      const btc_entry_t *entry);
+
+BTC_EXTERN int
+btc_chaindb_put_state(btc_chaindb_t *db,
+                      const btc_deployment_t *deploy,
+                      const btc_entry_t *entry,
+                      int state);
+
+BTC_EXTERN void
+btc_chaindb_entries(btc_chaindb_t *db, btc_vector_t *entries);
 
 BTC_EXTERN const btc_entry_t *
 btc_chaindb_head(btc_chaindb_t *db);
@@ -80,6 +124,9 @@ btc_chaindb_by_hash(btc_chaindb_t *db, const uint8_t *hash);
 BTC_EXTERN const btc_entry_t *
 btc_chaindb_by_height(btc_chaindb_t *db, int32_t height);
 
+BTC_EXTERN const btc_entry_t *
+btc_chaindb_by_time(btc_chaindb_t *db, int64_t time);
+
 BTC_EXTERN int
 btc_chaindb_is_main(btc_chaindb_t *db, const btc_entry_t *entry);
 
@@ -95,6 +142,9 @@ btc_chaindb_get_raw_block(btc_chaindb_t *db,
                           size_t *length,
                           const btc_entry_t *entry);
 
+BTC_EXTERN btc_undo_t *
+btc_chaindb_get_undo_coins(btc_chaindb_t *db, const btc_entry_t *entry);
+
 BTC_EXTERN btc_view_t *
 btc_chaindb_get_undo(btc_chaindb_t *db,
                      const btc_entry_t *entry,
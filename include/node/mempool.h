@@ -46,6 +46,9 @@ btc_mempool_set_logger(btc_mempool_t *mp, btc_logger_t *logger);
 BTC_EXTERN void
 btc_mempool_set_timedata(btc_mempool_t *mp, const btc_timedata_t *td);
 
+BTC_EXTERN void
+btc_mempool_set_max_size(btc_mempool_t *mp, size_t size);
+
 BTC_EXTERN void
 btc_mempool_on_tx(btc_mempool_t *mp, btc_mempool_tx_cb *handler);
 
@@ -86,6 +89,9 @@ btc_mempool_handle_reorg(btc_mempool_t *mp);
 BTC_EXTERN const btc_verify_error_t *
 btc_mempool_error(btc_mempool_t *mp);
 
+BTC_EXTERN int64_t
+btc_mempool_min_fee(btc_mempool_t *mp);
+
 BTC_EXTERN size_t
 btc_mempool_size(btc_mempool_t *mp);
 
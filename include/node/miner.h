@@ -29,8 +29,10 @@ typedef struct btc_blockentry_s {
   int64_t rate;
   size_t weight;
   int sigops;
-  int64_t desc_rate;
-  int dep_count;
+  int64_t anc_fee;
+  int64_t anc_size;
+  int anc_count;
+  int included;
 } btc_blockentry_t;
 
 typedef struct btc_blockproof_s {
@@ -38,6 +38,20 @@ btc_node_start(btc_node_t *node);
 BTC_EXTERN void
 btc_node_stop(btc_node_t *node);
 
+BTC_EXTERN struct btc_wallet_s *
+btc_node_load_wallet(btc_node_t *node, const char *name, int create);
+
+BTC_EXTERN struct btc_wallet_s *
+btc_node_create_wallet(btc_node_t *node,
+                       const char *name,
+                       const struct btc_walopt_s *options);
+
+BTC_EXTERN int
+btc_node_unload_wallet(btc_node_t *node, const char *name);
+
+BTC_EXTERN struct btc_wallet_s *
+btc_node_get_wallet(btc_node_t *node, const char *name);
+
 #ifdef __cplusplus
 }
 #endif
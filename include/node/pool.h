@@ -52,6 +52,9 @@ btc_pool_set_maxinbound(btc_pool_t *pool, size_t max_inbound);
 BTC_EXTERN void
 btc_pool_set_maxoutbound(btc_pool_t *pool, size_t max_outbound);
 
+BTC_EXTERN void
+btc_pool_set_maxblockrelay(btc_pool_t *pool, size_t max_block_relay);
+
 BTC_EXTERN void
 btc_pool_set_bantime(btc_pool_t *pool, int64_t ban_time);
 
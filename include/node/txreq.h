@@ -0,0 +1,92 @@
+/*!
+ * txreq.h - tx request tracker for mako
+ * Copyright (c) 2021, Christopher Jeffrey (MIT License).
+ * https://github.com/chjj/mako
+ */
+
+#ifndef BTC_TXREQ_H
+#define BTC_TXREQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../mako/common.h"
+#include "../mako/impl.h"
+#include "../mako/types.h"
+
+/*
+ * Types
+ */
+
+typedef struct btc_txpeer_s {
+  int outbound;
+  int64_t ping;
+  size_t inflight;
+  btc_hashset_t announced;
+  btc_hashtab_t requested;
+} btc_txpeer_t;
+
+typedef struct btc_txreqs_s btc_txreqs_t;
+
+/*
+ * TX Peer
+ */
+
+BTC_EXTERN void
+btc_txpeer_init(btc_txpeer_t *peer);
+
+BTC_EXTERN void
+btc_txpeer_clear(btc_txpeer_t *peer);
+
+/*
+ * TX Requests
+ */
+
+BTC_EXTERN btc_txreqs_t *
+btc_txreqs_create(void);
+
+BTC_EXTERN void
+btc_txreqs_destroy(btc_txreqs_t *reqs);
+
+BTC_EXTERN size_t
+btc_txreqs_size(const btc_txreqs_t *reqs);
+
+BTC_EXTERN int
+btc_txreqs_has(const btc_txreqs_t *reqs, const uint8_t *hash);
+
+BTC_EXTERN void
+btc_txreqs_announce(btc_txreqs_t *reqs,
+                    btc_txpeer_t *peer,
+                    const uint8_t *hash,
+                    int64_t now);
+
+BTC_EXTERN size_t
+btc_txreqs_poll(btc_vector_t *out,
+                btc_txreqs_t *reqs,
+                btc_txpeer_t *peer,
+                int64_t now);
+
+BTC_EXTERN int
+btc_txreqs_received(btc_txreqs_t *reqs,
+                    btc_txpeer_t *peer,
+                    const uint8_t *hash);
+
+BTC_EXTERN int
+btc_txreqs_notfound(btc_txreqs_t *reqs,
+                    btc_txpeer_t *peer,
+                    const uint8_t *hash);
+
+BTC_EXTERN void
+btc_txreqs_forget(btc_txreqs_t *reqs, const uint8_t *hash);
+
+BTC_EXTERN void
+btc_txreqs_remove(btc_txreqs_t *reqs, btc_txpeer_t *peer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BTC_TXREQ_H */
@@ -25,6 +25,7 @@ enum btc_node_flags {
    */
   BTC_CHAIN_CHECKPOINTS = 1 << 0,
   BTC_CHAIN_PRUNE = 1 << 1,
+  BTC_CHAIN_NOWAL = 1 << 17,
   BTC_CHAIN_DEFAULT_FLAGS = BTC_CHAIN_CHECKPOINTS,
 
   /*
@@ -32,6 +33,7 @@ enum btc_node_flags {
    */
   BTC_MEMPOOL_PARANOID = 1 << 2,
   BTC_MEMPOOL_PERSISTENT = 1 << 3,
+  BTC_MEMPOOL_FULLRBF = 1 << 16,
   BTC_MEMPOOL_DEFAULT_FLAGS = 0,
 
   /*
@@ -90,6 +92,8 @@ typedef struct btc_mempool_s btc_mempool_t;
 typedef struct btc_miner_s btc_miner_t;
 
 struct btc_wallet_s;
+struct btc_walletset_s;
+struct btc_walopt_s;
 
 typedef struct btc_rpc_s btc_rpc_t;
 
@@ -103,7 +107,9 @@ typedef struct btc_node_s {
   btc_miner_t *miner;
   btc_pool_t *pool;
   struct btc_wallet_s *wallet;
+  struct btc_walletset_s *wallets;
   btc_rpc_t *rpc;
+  char *prefix;
 } btc_node_t;
 
 #ifdef __cplusplus
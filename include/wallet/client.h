@@ -35,6 +35,9 @@ btc_wclient_by_hash(const btc_wclient_t *client, const uint8_t *hash);
 const btc_entry_t *
 btc_wclient_by_height(const btc_wclient_t *client, int32_t height);
 
+const btc_entry_t *
+btc_wclient_by_time(const btc_wclient_t *client, int64_t time);
+
 btc_block_t *
 btc_wclient_get_block(const btc_wclient_t *client, const btc_entry_t *entry);
 
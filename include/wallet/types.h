@@ -40,6 +40,7 @@ typedef struct btc_wclient_s {
   const btc_entry_t *(*tip)(void *);
   const btc_entry_t *(*by_hash)(void *, const uint8_t *);
   const btc_entry_t *(*by_height)(void *, int32_t);
+  const btc_entry_t *(*by_time)(void *, int64_t);
   btc_block_t *(*get_block)(void *, const btc_entry_t *);
   void (*send)(void *, const btc_tx_t *);
   void (*log)(void *, int, const char *, va_list);
@@ -68,14 +69,18 @@ typedef struct btc_walopt_s {
   enum btc_bip32_type type;
   const btc_mnemonic_t *mnemonic;
   const btc_hdnode_t *chain;
+  int64_t birth;
 } btc_walopt_t;
 
 typedef struct btc_wallet_s btc_wallet_t;
+typedef struct btc_walletset_s btc_walletset_t;
 typedef struct btc_acctiter_s btc_acctiter_t;
 typedef struct btc_addriter_s btc_addriter_t;
 typedef struct btc_coiniter_s btc_coiniter_t;
 typedef struct btc_txiter_s btc_txiter_t;
 
+typedef void btc_wallet_unlock_cb(int result, void *arg);
+
 #ifdef __cplusplus
 }
 #endif
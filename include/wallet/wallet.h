@@ -66,6 +66,13 @@ btc_wallet_lock(btc_wallet_t *wallet);
 int
 btc_wallet_unlock(btc_wallet_t *wallet, const char *pass, int64_t msec);
 
+int
+btc_wallet_unlock_async(btc_wallet_t *wallet,
+                        const char *pass,
+                        int64_t msec,
+                        btc_wallet_unlock_cb *callback,
+                        void *arg);
+
 int
 btc_wallet_encrypt(btc_wallet_t *wallet, const char *pass);
 
@@ -150,7 +157,8 @@ btc_wallet_create_account(btc_wallet_t *wallet,
 int
 btc_wallet_create_watcher(btc_wallet_t *wallet,
                           const char *name,
-                          const btc_hdnode_t *node);
+                          const btc_hdnode_t *node,
+                          int64_t birth);
 
 btc_outset_t *
 btc_wallet_frozen(btc_wallet_t *wallet);
@@ -238,6 +246,47 @@ btc_wallet_coins(btc_wallet_t *wallet);
 btc_txiter_t *
 btc_wallet_txs(btc_wallet_t *wallet);
 
+/*
+ * Wallet Set
+ */
+
+btc_walletset_t *
+btc_walletset_create(void);
+
+void
+btc_walletset_destroy(btc_walletset_t *set);
+
+int
+btc_walletset_add(btc_walletset_t *set,
+                  const char *name,
+                  btc_wallet_t *wallet);
+
+btc_wallet_t *
+btc_walletset_remove(btc_walletset_t *set, const char *name);
+
+btc_wallet_t *
+btc_walletset_get(btc_walletset_t *set, const char *name);
+
+size_t
+btc_walletset_size(btc_walletset_t *set);
+
+const char *
+btc_walletset_name(btc_walletset_t *set, size_t index);
+
+btc_wallet_t *
+btc_walletset_wallet(btc_walletset_t *set, size_t index);
+
+void
+btc_walletset_add_tx(btc_walletset_t *set, const btc_tx_t *tx);
+
+void
+btc_walletset_add_block(btc_walletset_t *set,
+                        const btc_entry_t *entry,
+                        const btc_block_t *block);
+
+void
+btc_walletset_remove_block(btc_walletset_t *set, const btc_entry_t *entry);
+
 #ifdef __cplusplus
 }
 #endif
@@ -108,6 +108,13 @@ btc_address_is_p2wsh(const btc_address_t *addr) {
       && addr->length == 32;
 }
 
+int
+btc_address_is_p2tr(const btc_address_t *addr) {
+  return addr->type == BTC_ADDRESS_WITNESS
+      && addr->version == 1
+      && addr->length == 32;
+}
+
 int
 btc_address_is_program(const btc_address_t *addr) {
   return addr->type == BTC_ADDRESS_WITNESS;
@@ -175,6 +182,16 @@ btc_address_set_p2wsh(btc_address_t *addr, const uint8_t *hash) {
   memcpy(addr->hash, hash, 32);
 }
 
+void
+btc_address_set_p2tr(btc_address_t *addr, const uint8_t *key) {
+  addr->type = BTC_ADDRESS_WITNESS;
+  addr->version = 1;
+  addr->length = 32;
+
+  memset(addr->hash, 0, 40);
+  memcpy(addr->hash, key, 32);
+}
+
 int
 btc_address_set_program(btc_address_t *addr, const btc_program_t *program) {
   if (program->version == 0) {
@@ -47,6 +47,9 @@
 #define USED_COUNT 64
 #define USED_SIZE 256
 #define USED_SPREAD 8
+#define MAX_COLLISIONS 10
+#define REPLACE_HOURS 4
+#define TEST_WINDOW (40 * 60)
 
 /*
  * Address Key
@@ -308,6 +311,7 @@ struct btc_addrman_s {
   size_t total_used;
   btc_netmap_t local;
   btc_netmap_t banned;
+  btc_vector_t collisions;
   int needs_flush;
 };
 
@@ -339,6 +343,7 @@ btc_addrman_create(const btc_network_t *network) {
   man->total_used = 0;
   btc_netmap_init(&man->local);
   btc_netmap_init(&man->banned);
+  btc_vector_init(&man->collisions);
   man->needs_flush = 0;
 
   for (i = 0; i < FRESH_COUNT; i++)
@@ -370,12 +375,16 @@ btc_addrman_destroy(btc_addrman_t *man) {
   btc_map_each(&man->banned, it)
     btc_netaddr_destroy(man->banned.vals[it]);
 
+  for (i = 0; i < man->collisions.length; i++)
+    btc_netaddr_destroy(man->collisions.items[i]);
+
   btc_netmap_clear(&man->map);
   btc_vector_clear(&man->rnd);
   btc_free(man->fresh);
   btc_free(man->used);
   btc_netmap_clear(&man->local);
   btc_netmap_clear(&man->banned);
+  btc_vector_clear(&man->collisions);
   btc_free(man);
 }
 
@@ -554,6 +563,11 @@ btc_addrman_reset(btc_addrman_t *man) {
   for (i = 0; i < USED_COUNT; i++)
     btc_list_reset(&man->used[i]);
 
+  for (i = 0; i < man->collisions.length; i++)
+    btc_netaddr_destroy(man->collisions.items[i]);
+
+  btc_vector_reset(&man->collisions);
+
   man->total_fresh = 0;
   man->total_used = 0;
 
@@ -611,25 +625,13 @@ btc_addrman_clear_banned(btc_addrman_t *man) {
   btc_netmap_reset(&man->banned);
 }
 
-const btc_addrent_t *
-btc_addrman_get(btc_addrman_t *man) {
+static btc_addrent_t *
+btc_addrman_select(btc_addrman_t *man, int used) {
   btc_addrent_t *entry = NULL;
   double factor, num;
-  int used = -1;
   size_t index;
   int64_t now;
 
-  if (man->total_fresh > 0)
-    used = 0;
-
-  if (man->total_used > 0) {
-    if (man->total_fresh == 0 || btc_uniform(2) == 0)
-      used = 1;
-  }
-
-  if (used == -1)
-    return NULL;
-
   now = btc_timedata_now(man->timedata);
   factor = 1.0;
 
@@ -677,6 +679,32 @@ btc_addrman_get(btc_addrman_t *man) {
   return entry;
 }
 
+const btc_addrent_t *
+btc_addrman_get(btc_addrman_t *man) {
+  int used = -1;
+
+  if (man->total_fresh > 0)
+    used = 0;
+
+  if (man->total_used > 0) {
+    if (man->total_fresh == 0 || btc_uniform(2) == 0)
+      used = 1;
+  }
+
+  if (used == -1)
+    return NULL;
+
+  return btc_addrman_select(man, used);
+}
+
+const btc_addrent_t *
+btc_addrman_get_fresh(btc_addrman_t *man) {
+  if (man->total_fresh == 0)
+    return NULL;
+
+  return btc_addrman_select(man, 0);
+}
+
 static btc_netmap_t *
 fresh_bucket(btc_addrman_t *man, const btc_addrent_t *entry) {
   uint32_t hash32, hash, index;
@@ -963,33 +991,40 @@ btc_addrman_mark_success(btc_addrman_t *man, const btc_netaddr_t *addr) {
     entry->addr.time = now;
 }
 
-void
-btc_addrman_mark_ack(btc_addrman_t *man,
-                     const btc_netaddr_t *addr,
-                     uint64_t services) {
-  btc_addrent_t *entry = btc_netmap_get(&man->map, addr);
+static void
+btc_addrman_add_collision(btc_addrman_t *man, const btc_addrent_t *entry) {
+  size_t i;
+
+  if (man->collisions.length >= MAX_COLLISIONS)
+    return;
+
+  for (i = 0; i < man->collisions.length; i++) {
+    if (btc_netaddr_equal(man->collisions.items[i], &entry->addr))
+      return;
+  }
+
+  btc_vector_push(&man->collisions, btc_netaddr_clone(&entry->addr));
+}
+
+static void
+btc_addrman_promote(btc_addrman_t *man, btc_addrent_t *entry, int evict) {
   btc_addrent_t *evicted;
   btc_netmap_t *old = NULL;
   btc_netmap_t *fresh;
   btc_bucket_t *bucket;
-  int64_t now;
   size_t i;
 
-  if (entry == NULL)
-    return;
-
-  now = btc_timedata_now(man->timedata);
-
-  entry->addr.services |= services;
+  CHECK(!entry->used);
+  CHECK(entry->ref_count > 0);
 
-  entry->last_success = now;
-  entry->last_attempt = now;
-  entry->attempts = 0;
+  bucket = used_bucket(man, entry);
 
-  if (entry->used)
+  /* Test before evicting: leave the entry in
+     fresh until the used entry has been probed. */
+  if (bucket->length >= USED_SIZE && !evict) {
+    btc_addrman_add_collision(man, entry);
     return;
-
-  CHECK(entry->ref_count > 0);
+  }
 
   /* Remove from fresh. */
   for (i = 0; i < FRESH_COUNT; i++) {
@@ -1005,10 +1040,9 @@ btc_addrman_mark_ack(btc_addrman_t *man,
   CHECK(entry->ref_count == 0);
 
   man->total_fresh -= 1;
+  man->needs_flush = 1;
 
   /* Find room in used bucket. */
-  bucket = used_bucket(man, entry);
-
   if (bucket->length < USED_SIZE) {
     entry->used = 1;
     btc_list_push(bucket, entry, btc_addrent_t);
@@ -1036,6 +1070,113 @@ btc_addrman_mark_ack(btc_addrman_t *man,
   man->total_fresh += 1;
 }
 
+void
+btc_addrman_mark_ack(btc_addrman_t *man,
+                     const btc_netaddr_t *addr,
+                     uint64_t services) {
+  btc_addrent_t *entry = btc_netmap_get(&man->map, addr);
+  int64_t now;
+
+  if (entry == NULL)
+    return;
+
+  now = btc_timedata_now(man->timedata);
+
+  entry->addr.services |= services;
+
+  entry->last_success = now;
+  entry->last_attempt = now;
+  entry->attempts = 0;
+
+  if (entry->used)
+    return;
+
+  btc_addrman_promote(man, entry, 0);
+}
+
+static btc_addrent_t *
+btc_addrman_collision(btc_addrman_t *man, size_t index, btc_addrent_t **old) {
+  btc_netaddr_t *addr = man->collisions.items[index];
+  btc_addrent_t *entry = btc_netmap_get(&man->map, addr);
+  btc_bucket_t *bucket;
+
+  *old = NULL;
+
+  if (entry == NULL || entry->used)
+    return entry;
+
+  bucket = used_bucket(man, entry);
+
+  if (bucket->length >= USED_SIZE)
+    *old = evict_used(bucket);
+
+  return entry;
+}
+
+void
+btc_addrman_resolve_collisions(btc_addrman_t *man) {
+  int64_t now = btc_timedata_now(man->timedata);
+  int64_t window = REPLACE_HOURS * 60 * 60;
+  btc_addrent_t *entry, *old;
+  size_t i = 0;
+  int evict;
+
+  while (i < man->collisions.length) {
+    entry = btc_addrman_collision(man, i, &old);
+    evict = -1;
+
+    if (entry == NULL || entry->used) {
+      /* Entry was removed or promoted elsewhere. */
+      evict = 0;
+    } else if (old == NULL) {
+      /* Room opened up in the used bucket. */
+      btc_addrman_promote(man, entry, 1);
+      evict = 0;
+    } else if (now - old->last_success < window) {
+      /* Old entry is known good. Keep it. */
+      evict = 0;
+    } else if (now - old->last_attempt < window) {
+      /* Old entry was probed. Give the probe a minute. */
+      if (now - old->last_attempt > 60)
+        evict = 1;
+    } else if (now - entry->last_success > TEST_WINDOW) {
+      /* Old entry was never probed. Stop waiting. */
+      evict = 1;
+    }
+
+    if (evict == -1) {
+      i += 1;
+      continue;
+    }
+
+    if (evict == 1) {
+      btc_log_debug(man, "Evicting %N from used table for %N.",
+                    &old->addr, &entry->addr);
+      btc_addrman_promote(man, entry, 1);
+    }
+
+    btc_netaddr_destroy(man->collisions.items[i]);
+
+    man->collisions.items[i] = btc_vector_pop(&man->collisions);
+  }
+}
+
+const btc_addrent_t *
+btc_addrman_get_collision(btc_addrman_t *man) {
+  uint32_t n = man->collisions.length;
+  btc_addrent_t *entry, *old;
+
+  if (n == 0)
+    return NULL;
+
+  entry = btc_addrman_collision(man, btc_uniform(n), &old);
+
+  if (entry == NULL || entry->used)
+    return NULL;
+
+  return old;
+}
+
 int
 btc_addrman_has_local(btc_addrman_t *man, const btc_netaddr_t *addr) {
   return btc_netmap_has(&man->local, addr);
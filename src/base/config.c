@@ -460,8 +460,11 @@ conf_init(btc_conf_t *conf) {
   conf->network_active = 1;
   conf->disable_wallet = 0;
   conf->cache_size = 128;
+  conf->rate_limit = 0;
+  conf->chain_wal = 1;
   conf->checkpoints = 1;
   conf->prune = 0;
+  conf->full_rbf = 0;
   conf->workers = 0;
   conf->listen = 1;
   conf->port = 0;
@@ -473,6 +476,7 @@ conf_init(btc_conf_t *conf) {
   conf->max_connections = 0;
   conf->max_inbound = 128;
   conf->max_outbound = 8;
+  conf->max_block_relay = 2;
   conf->ban_time = 24 * 60 * 60;
   conf->discover = 1;
   conf->upnp = 0;
@@ -487,6 +491,7 @@ conf_init(btc_conf_t *conf) {
   btc_str_assign(conf->rpc_connect, "127.0.0.1");
   btc_str_assign(conf->rpc_user, "bitcoinrpc");
   btc_str_assign(conf->rpc_pass, "");
+  btc_str_assign(conf->rpc_wallet, "");
   conf->version = 0;
   conf->help = 0;
   conf->method = NULL;
@@ -586,12 +591,21 @@ conf_read_file(btc_conf_t *conf, const char *file) {
     if (btc_match_range(&conf->cache_size, opt, "dbcache=", 8, 2048))
       continue;
 
+    if (btc_match_range(&conf->rate_limit, opt, "dbratelimit=", 0, 4096))
+      continue;
+
+    if (btc_match_bool(&conf->chain_wal, opt, "dbchainwal="))
+      continue;
+
     if (btc_match_bool(&conf->checkpoints, opt, "checkpoints="))
       continue;
 
     if (btc_match_bool(&conf->prune, opt, "prune="))
       continue;
 
+    if (btc_match_bool(&conf->full_rbf, opt, "mempoolfullrbf="))
+      continue;
+
     if (btc_match_range(&conf->workers, opt, "par=", -6, 15))
       continue;
 
@@ -633,6 +647,9 @@ conf_read_file(btc_conf_t *conf, const char *file) {
     if (btc_match_uint(&conf->max_outbound, opt, "maxoutbound="))
       continue;
 
+    if (btc_match_uint(&conf->max_block_relay, opt, "maxblockrelay="))
+      continue;
+
     if (btc_match_uint(&conf->ban_time, opt, "bantime="))
       continue;
 
@@ -730,12 +747,21 @@ conf_parse_args(btc_conf_t *conf, int argc, char **argv, int allow_params) {
     if (btc_match_range(&conf->cache_size, arg, "-dbcache=", 8, 2048))
       continue;
 
+    if (btc_match_range(&conf->rate_limit, arg, "-dbratelimit=", 0, 4096))
+      continue;
+
+    if (btc_match_argbool(&conf->chain_wal, arg, "-dbchainwal="))
+      continue;
+
     if (btc_match_argbool(&conf->checkpoints, arg, "-checkpoints="))
       continue;
 
     if (btc_match_argbool(&conf->prune, arg, "-prune="))
       continue;
 
+    if (btc_match_argbool(&conf->full_rbf, arg, "-mempoolfullrbf="))
+      continue;
+
     if (btc_match_range(&conf->workers, arg, "-par=", -6, 15))
       continue;
 
@@ -777,6 +803,9 @@ conf_parse_args(btc_conf_t *conf, int argc, char **argv, int allow_params) {
     if (btc_match_uint(&conf->max_outbound, arg, "-maxoutbound="))
       continue;
 
+    if (btc_match_uint(&conf->max_block_relay, arg, "-maxblockrelay="))
+      continue;
+
     if (btc_match_uint(&conf->ban_time, arg, "-bantime="))
       continue;
 
@@ -826,6 +855,9 @@ conf_parse_args(btc_conf_t *conf, int argc, char **argv, int allow_params) {
     if (btc_match_str(conf->rpc_pass, arg, "-rpcpassword="))
       continue;
 
+    if (btc_match_str(conf->rpc_wallet, arg, "-rpcwallet="))
+      continue;
+
     if (strcmp(arg, "-testnet") == 0) {
       conf->network = btc_testnet;
       continue;
@@ -9,6 +9,7 @@
  *
  * Resources:
  *   https://github.com/bitcoin/bips/blob/master/bip-0173.mediawiki
+ *   https://github.com/bitcoin/bips/blob/master/bip-0350.mediawiki
  *   https://github.com/sipa/bech32/blob/master/ref/c/segwit_addr.c
  *   https://github.com/bitcoin/bitcoin/blob/master/src/bech32.cpp
  */
@@ -19,6 +20,13 @@
 #include <mako/encoding.h>
 #include "internal.h"
 
+/*
+ * Constants
+ */
+
+#define BECH32_CONST UINT32_C(1)
+#define BECH32M_CONST UINT32_C(0x2bc830a3)
+
 /*
  * Bech32
  */
@@ -60,7 +68,8 @@ static int
 bech32_serialize(char *str,
                  const char *hrp,
                  const uint8_t *data,
-                 size_t data_len) {
+                 size_t data_len,
+                 uint32_t constant) {
   uint32_t chk = 1;
   size_t i, hlen;
   size_t j = 0;
@@ -113,7 +122,7 @@ bech32_serialize(char *str,
   for (i = 0; i < 6; i++)
     chk = bech32_polymod(chk);
 
-  chk ^= 1;
+  chk ^= constant;
 
   for (i = 0; i < 6; i++)
     str[j++] = bech32_charset[(chk >> ((5 - i) * 5)) & 0x1f];
@@ -127,6 +136,7 @@ static int
 bech32_deserialize(char *hrp,
                    uint8_t *data,
                    size_t *data_len,
+                   uint32_t *constant,
                    const char *str) {
   uint32_t chk = 1;
   size_t hlen = 0;
@@ -195,10 +205,11 @@ bech32_deserialize(char *hrp,
       data[j++] = ch;
   }
 
-  if (chk != 1)
+  if (chk != BECH32_CONST && chk != BECH32M_CONST)
     return 0;
 
   *data_len = j;
+  *constant = chk;
 
   return 1;
 }
@@ -250,6 +261,7 @@ btc_bech32_encode(char *addr,
                   const uint8_t *hash,
                   size_t hash_len) {
   uint8_t data[65];
+  uint32_t constant;
   size_t data_len;
 
   if (version > 16)
@@ -265,7 +277,10 @@ btc_bech32_encode(char *addr,
 
   data_len += 1;
 
-  return bech32_serialize(addr, hrp, data, data_len);
+  /* Witness v0 uses bech32, v1+ uses bech32m (bip350). */
+  constant = version == 0 ? BECH32_CONST : BECH32M_CONST;
+
+  return bech32_serialize(addr, hrp, data, data_len, constant);
 }
 
 int
@@ -275,9 +290,10 @@ btc_bech32_decode(char *hrp,
                   size_t *hash_len,
                   const char *addr) {
   uint8_t data[83];
+  uint32_t constant;
   size_t data_len;
 
-  if (!bech32_deserialize(hrp, data, &data_len, addr))
+  if (!bech32_deserialize(hrp, data, &data_len, &constant, addr))
     return 0;
 
   if (data_len == 0 || data_len > 65)
@@ -286,6 +302,9 @@ btc_bech32_decode(char *hrp,
   if (data[0] > 16)
     return 0;
 
+  if (constant != (data[0] == 0 ? BECH32_CONST : BECH32M_CONST))
+    return 0;
+
   if (!bech32_convert_bits(hash, hash_len, 8, data + 1, data_len - 1, 5, 0))
     return 0;
 
@@ -85,6 +85,17 @@ parse_path(uint32_t *zp, int zn, const char *xp, int hard) {
   }
 }
 
+static uint32_t
+get_prefix(const uint32_t *table, enum btc_bip32_type type) {
+  /* There is no SLIP-132 prefix for taproot. BIP86
+     keys are serialized as plain xpub/xprv and the
+     type must be supplied by whoever imports them. */
+  if (type == BTC_BIP32_P2TR)
+    type = BTC_BIP32_STANDARD;
+
+  return table[type];
+}
+
 static int
 find_prefix(const uint32_t *table, uint32_t prefix) {
   int length = lengthof(((btc_network_t *)0)->key.xpubkey);
@@ -394,7 +405,7 @@ void
 btc_hdpriv_export(uint8_t *data,
                   const btc_hdnode_t *node,
                   const btc_network_t *network) {
-  uint32_t prefix = network->key.xprvkey[node->type];
+  uint32_t prefix = get_prefix(network->key.xprvkey, node->type);
 
   btc_write32be(data + 0, prefix);
 
@@ -685,7 +696,7 @@ void
 btc_hdpub_export(uint8_t *data,
                  const btc_hdnode_t *node,
                  const btc_network_t *network) {
-  uint32_t prefix = network->key.xpubkey[node->type];
+  uint32_t prefix = get_prefix(network->key.xpubkey, node->type);
 
   btc_write32be(data + 0, prefix);
 
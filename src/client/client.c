@@ -24,6 +24,7 @@ struct btc_client_s {
   uint32_t id;
   char user[256];
   char pass[256];
+  char path[80];
 };
 
 static void
@@ -32,6 +33,7 @@ btc_client_init(btc_client_t *client) {
   client->id = 0;
   client->user[0] = '\0';
   client->pass[0] = '\0';
+  strcpy(client->path, "/");
 }
 
 static void
@@ -82,6 +84,23 @@ btc_client_auth(btc_client_t *client, const char *user, const char *pass) {
   }
 }
 
+int
+btc_client_wallet(btc_client_t *client, const char *name) {
+  size_t len = strlen(name);
+
+  if (len == 0) {
+    strcpy(client->path, "/");
+    return 1;
+  }
+
+  if (len > 63)
+    return 0;
+
+  sprintf(client->path, "/wallet/%s", name);
+
+  return 1;
+}
+
 json_value *
 btc_client_call(btc_client_t *client, const char *method, json_value *params) {
   json_value *id, *error, *code, *message, *result;
@@ -105,7 +124,7 @@ btc_client_call(btc_client_t *client, const char *method, json_value *params) {
   http_options_init(&options);
 
   options.method = HTTP_METHOD_POST;
-  options.path = "/";
+  options.path = client->path;
   options.headers = NULL;
   options.agent = "mako";
   options.accept = "application/json";
@@ -42,6 +42,7 @@ static const char *rpc_args[] = {
   "-rpcpassword=",
   "-rpcport=",
   "-rpcuser=",
+  "-rpcwallet=",
   "-testnet",
   "-version"
 };
@@ -62,10 +63,12 @@ static const struct {
   { "createaccount", { json_string, json_integer } },
   { "createrawtransaction", { json_array, json_array,
                               json_integer, json_boolean } },
+  { "createwallet", { json_string, json_string, json_integer } },
   { "decoderawtransaction", { json_string, json_boolean } },
   { "decodescript", { json_string } },
   { "deleteaccount", { json_string } },
   { "disconnectnode", { json_string, json_integer } },
+  { "dumpchainstate", { json_string } },
   { "dumpprivkey", { json_string } },
   { "dumpwallet", { json_none } },
   { "encryptwallet", { json_string } },
@@ -115,16 +118,21 @@ static const struct {
   { "getwalletinfo", { json_none } },
   { "getwork", { json_string } },
   { "help", { json_string } },
+  { "invalidateblock", { json_string } },
   { "listaccounts", { json_boolean, json_integer, json_string } },
   { "listbanned", { json_none } },
   { "listlockunspent", { json_none } },
   { "listsinceblock", { json_string, json_null, json_integer } },
   { "listtransactions", { json_string, json_integer, json_integer } },
   { "listunspent", { json_string, json_integer, json_object } },
+  { "listwallets", { json_none } },
+  { "loadwallet", { json_string } },
   { "lockunspent", { json_boolean, json_array } },
   { "ping", { json_none } },
+  { "preciousblock", { json_string } },
   { "prioritisetransaction", { json_string, json_amount } },
   { "pruneblockchain", { json_integer } },
+  { "reconsiderblock", { json_string } },
   { "renameaccount", { json_string, json_string } },
   { "rescanblockchain", { json_integer } },
   { "resendwallettransactions", { json_none } },
@@ -147,6 +155,7 @@ static const struct {
   { "stop", { json_none } },
   { "submitblock", { json_string } },
   { "testmempoolaccept", { json_array, json_amount } },
+  { "unloadwallet", { json_string } },
   { "uptime", { json_none } },
   { "validateaddress", { json_string } },
   { "verifychain", { json_integer, json_integer } },
@@ -154,7 +163,7 @@ static const struct {
   { "walletlock", { json_none } },
   { "walletpassphrase", { json_string, json_integer } },
   { "walletpassphrasechange", { json_string, json_string } },
-  { "watchaccount", { json_string, json_string } }
+  { "watchaccount", { json_string, json_string, json_integer } }
 };
 
 static const json_type *
@@ -303,6 +312,11 @@ btc_main(const btc_conf_t *conf) {
 
   btc_client_auth(client, conf->rpc_user, conf->rpc_pass);
 
+  if (!btc_client_wallet(client, conf->rpc_wallet)) {
+    fprintf(stderr, "Invalid wallet name: %s.\n", conf->rpc_wallet);
+    goto fail;
+  }
+
   if (!btc_client_open(client, conf->rpc_connect, conf->rpc_port, 0)) {
     fprintf(stderr, "Could not connect to %s (port=%d).\n",
                     conf->rpc_connect, conf->rpc_port);
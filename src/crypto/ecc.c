@@ -230,6 +230,416 @@ checked_malloc(size_t size) {
   return ptr;
 }
 
+/*
+ * Safegcd
+ */
+
+#ifdef BTC_HAVE_INT128
+
+/* Bernstein-Yang inversion ("safegcd") on signed 62-bit limbs.
+ *
+ * See: https://gcd.cr.yp.to/safegcd-20190413.pdf
+ *      https://github.com/bitcoin-core/secp256k1/blob/master/doc/safegcd_implementation.md
+ *
+ * Numbers are v[0] + v[1] * 2^62 + ... + v[4] * 2^248 where every
+ * limb but the top one is in [0,2^62). The constant-time variant runs
+ * a fixed 590 divsteps in batches of 59. The variable-time variant
+ * batches 62 at a time, stops once g reaches zero, and drops limbs as
+ * f and g shrink.
+ */
+
+#define SAFEGCD_M62 (UINT64_MAX >> 2)
+
+typedef btc_int128_t safegcd_wide_t;
+
+typedef struct safegcd_s {
+  int64_t v[5];
+} safegcd_t;
+
+typedef struct safegcd_mod_s {
+  safegcd_t modulus;
+  uint64_t modulus_inv62; /* modulus^-1 mod 2^62 */
+} safegcd_mod_t;
+
+typedef struct safegcd_trans_s {
+  int64_t u, v, q, r;
+} safegcd_trans_t;
+
+static const safegcd_mod_t safegcd_field = {
+  {{-INT64_C(0x1000003d1), 0, 0, 0, 256}},
+  UINT64_C(0x27c7f6e22ddacacf)
+};
+
+static const safegcd_mod_t safegcd_scalar = {
+  {{INT64_C(0x3fd25e8cd0364141), INT64_C(0x2abb739abd2280ee),
+    -INT64_C(0x15), 0, 256}},
+  UINT64_C(0x34f20099aa774ec1)
+};
+
+static void
+safegcd_import(safegcd_t *z, const unsigned char *xp) {
+  /* Big-endian, 0 <= x < 2^256. */
+  uint64_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    a3 = (a3 << 8) | xp[i +  0];
+    a2 = (a2 << 8) | xp[i +  8];
+    a1 = (a1 << 8) | xp[i + 16];
+    a0 = (a0 << 8) | xp[i + 24];
+  }
+
+  z->v[0] = (int64_t)(a0 & SAFEGCD_M62);
+  z->v[1] = (int64_t)((a0 >> 62 | a1 <<  2) & SAFEGCD_M62);
+  z->v[2] = (int64_t)((a1 >> 60 | a2 <<  4) & SAFEGCD_M62);
+  z->v[3] = (int64_t)((a2 >> 58 | a3 <<  6) & SAFEGCD_M62);
+  z->v[4] = (int64_t)(a3 >> 56);
+}
+
+static void
+safegcd_export(unsigned char *zp, const safegcd_t *x) {
+  /* Requires 0 <= x < 2^256 with normalized limbs. */
+  uint64_t v0 = x->v[0], v1 = x->v[1], v2 = x->v[2];
+  uint64_t v3 = x->v[3], v4 = x->v[4];
+  uint64_t a0 = v0 >> 0 | v1 << 62;
+  uint64_t a1 = v1 >> 2 | v2 << 60;
+  uint64_t a2 = v2 >> 4 | v3 << 58;
+  uint64_t a3 = v3 >> 6 | v4 << 56;
+  int i;
+
+  for (i = 7; i >= 0; i--) {
+    zp[i +  0] = a3 & 0xff;
+    zp[i +  8] = a2 & 0xff;
+    zp[i + 16] = a1 & 0xff;
+    zp[i + 24] = a0 & 0xff;
+
+    a3 >>= 8;
+    a2 >>= 8;
+    a1 >>= 8;
+    a0 >>= 8;
+  }
+}
+
+static int64_t
+safegcd_divsteps_59(int64_t zeta,
+                    uint64_t f0,
+                    uint64_t g0,
+                    safegcd_trans_t *t) {
+  /* Perform 59 divsteps in constant time, tracking
+     zeta = -(delta + 1/2). The resulting matrix is
+     scaled by 2^62 (it starts at 2^3). */
+  uint64_t u = 8, v = 0, q = 0, r = 8;
+  uint64_t f = f0, g = g0;
+  uint64_t mask1, mask2, x, y, z;
+  int i;
+
+  for (i = 3; i < 62; i++) {
+    /* Masks for (zeta < 0) and (g & 1). */
+    mask1 = fe_word_barrier((uint64_t)(zeta >> 63));
+    mask2 = -fe_word_barrier(g & 1);
+
+    /* x, y, z = conditionally negated f, u, v. */
+    x = (f ^ mask1) - mask1;
+    y = (u ^ mask1) - mask1;
+    z = (v ^ mask1) - mask1;
+
+    /* Conditionally add x, y, z to g, q, r. */
+    g += x & mask2;
+    q += y & mask2;
+    r += z & mask2;
+
+    /* mask1 = (zeta < 0) & (g & 1). */
+    mask1 &= mask2;
+
+    /* zeta = mask1 ? -zeta - 2 : zeta - 1. */
+    zeta = (int64_t)(((uint64_t)zeta ^ mask1) - 1);
+
+    /* Conditionally add g, q, r to f, u, v. */
+    f += g & mask1;
+    u += q & mask1;
+    v += r & mask1;
+
+    g >>= 1;
+    u <<= 1;
+    v <<= 1;
+  }
+
+  t->u = (int64_t)u;
+  t->v = (int64_t)v;
+  t->q = (int64_t)q;
+  t->r = (int64_t)r;
+
+  return zeta;
+}
+
+static int
+safegcd_ctz_var(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(x);
+#else
+  int z = 0;
+
+  while ((x & 1) == 0) {
+    x >>= 1;
+    z += 1;
+  }
+
+  return z;
+#endif
+}
+
+static int64_t
+safegcd_divsteps_62_var(int64_t eta,
+                        uint64_t f0,
+                        uint64_t g0,
+                        safegcd_trans_t *t) {
+  /* Perform 62 divsteps in variable time, tracking eta = -delta. */
+  uint64_t u = 1, v = 0, q = 0, r = 1;
+  uint64_t f = f0, g = g0, m, w, tmp;
+  int i = 62, limit, zeros;
+
+  for (;;) {
+    /* Skip over all trailing zeros at once (a sentinel bit stops us at i). */
+    zeros = safegcd_ctz_var(g | (UINT64_MAX << i));
+
+    g >>= zeros;
+    u <<= zeros;
+    v <<= zeros;
+    eta -= zeros;
+    i -= zeros;
+
+    if (i == 0)
+      break;
+
+    if (eta < 0) {
+      /* Negate eta and replace (f, g) with (g, -f). */
+      eta = -eta;
+
+      tmp = f; f = g; g = -tmp;
+      tmp = u; u = q; q = -tmp;
+      tmp = v; v = r; r = -tmp;
+
+      limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+
+      /* Cancel up to 6 bits of g at once. */
+      m = (UINT64_MAX >> (64 - limit)) & 63;
+      w = (f * g * (f * f - 2)) & m;
+    } else {
+      limit = ((int)eta + 1) > i ? i : ((int)eta + 1);
+
+      /* Cancel up to 4 bits of g at once. */
+      m = (UINT64_MAX >> (64 - limit)) & 15;
+      w = f + (((f + 1) & 4) << 1);
+      w = (-w * g) & m;
+    }
+
+    g += f * w;
+    q += u * w;
+    r += v * w;
+  }
+
+  t->u = (int64_t)u;
+  t->v = (int64_t)v;
+  t->q = (int64_t)q;
+  t->r = (int64_t)r;
+
+  return eta;
+}
+
+static void
+safegcd_update_de(safegcd_t *d,
+                  safegcd_t *e,
+                  const safegcd_trans_t *t,
+                  const safegcd_mod_t *mod) {
+  /* Compute (t * [d, e]) / 2^62 mod modulus, keeping
+     d and e in the range (-2 * modulus, modulus). */
+  const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+  const int64_t *m = mod->modulus.v;
+  int64_t d4 = d->v[4], e4 = e->v[4];
+  int64_t md, me, sd, se;
+  safegcd_wide_t cd, ce;
+  int i;
+
+  /* md, me start as [u, q] if d < 0 plus [v, r] if e < 0. */
+  sd = d4 >> 63;
+  se = e4 >> 63;
+  md = (u & sd) + (v & se);
+  me = (q & sd) + (r & se);
+
+  cd = (safegcd_wide_t)u * d->v[0] + (safegcd_wide_t)v * e->v[0];
+  ce = (safegcd_wide_t)q * d->v[0] + (safegcd_wide_t)r * e->v[0];
+
+  /* Choose md, me such that the low 62 bits of
+     t * [d, e] + modulus * [md, me] are zero. */
+  md -= (int64_t)((mod->modulus_inv62 * (uint64_t)cd + md) & SAFEGCD_M62);
+  me -= (int64_t)((mod->modulus_inv62 * (uint64_t)ce + me) & SAFEGCD_M62);
+
+  cd += (safegcd_wide_t)m[0] * md;
+  ce += (safegcd_wide_t)m[0] * me;
+
+  cd >>= 62;
+  ce >>= 62;
+
+  for (i = 1; i < 5; i++) {
+    cd += (safegcd_wide_t)u * d->v[i] + (safegcd_wide_t)v * e->v[i];
+    ce += (safegcd_wide_t)q * d->v[i] + (safegcd_wide_t)r * e->v[i];
+
+    /* Limbs of the modulus are public. */
+    if (m[i] != 0) {
+      cd += (safegcd_wide_t)m[i] * md;
+      ce += (safegcd_wide_t)m[i] * me;
+    }
+
+    d->v[i - 1] = (int64_t)((uint64_t)cd & SAFEGCD_M62);
+    e->v[i - 1] = (int64_t)((uint64_t)ce & SAFEGCD_M62);
+
+    cd >>= 62;
+    ce >>= 62;
+  }
+
+  d->v[4] = (int64_t)cd;
+  e->v[4] = (int64_t)ce;
+}
+
+static void
+safegcd_update_fg(int len,
+                  safegcd_t *f,
+                  safegcd_t *g,
+                  const safegcd_trans_t *t) {
+  /* Compute (t * [f, g]) / 2^62 over the low len limbs. */
+  const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+  safegcd_wide_t cf, cg;
+  int i;
+
+  cf = (safegcd_wide_t)u * f->v[0] + (safegcd_wide_t)v * g->v[0];
+  cg = (safegcd_wide_t)q * f->v[0] + (safegcd_wide_t)r * g->v[0];
+
+  cf >>= 62;
+  cg >>= 62;
+
+  for (i = 1; i < len; i++) {
+    cf += (safegcd_wide_t)u * f->v[i] + (safegcd_wide_t)v * g->v[i];
+    cg += (safegcd_wide_t)q * f->v[i] + (safegcd_wide_t)r * g->v[i];
+
+    f->v[i - 1] = (int64_t)((uint64_t)cf & SAFEGCD_M62);
+    g->v[i - 1] = (int64_t)((uint64_t)cg & SAFEGCD_M62);
+
+    cf >>= 62;
+    cg >>= 62;
+  }
+
+  f->v[len - 1] = (int64_t)cf;
+  g->v[len - 1] = (int64_t)cg;
+}
+
+static void
+safegcd_normalize(safegcd_t *z, int64_t sign, const safegcd_mod_t *mod) {
+  /* Bring z from (-2 * modulus, modulus) to [0, modulus),
+     negating it if sign is negative (i.e. f = -1). */
+  const int64_t *m = mod->modulus.v;
+  int64_t add, neg;
+  int i;
+
+  add = z->v[4] >> 63;
+
+  for (i = 0; i < 5; i++)
+    z->v[i] += m[i] & add;
+
+  neg = sign >> 63;
+
+  for (i = 0; i < 5; i++)
+    z->v[i] = (z->v[i] ^ neg) - neg;
+
+  for (i = 0; i < 4; i++) {
+    z->v[i + 1] += z->v[i] >> 62;
+    z->v[i] &= (int64_t)SAFEGCD_M62;
+  }
+
+  add = z->v[4] >> 63;
+
+  for (i = 0; i < 5; i++)
+    z->v[i] += m[i] & add;
+
+  for (i = 0; i < 4; i++) {
+    z->v[i + 1] += z->v[i] >> 62;
+    z->v[i] &= (int64_t)SAFEGCD_M62;
+  }
+}
+
+static void
+safegcd_invert(safegcd_t *x, const safegcd_mod_t *mod) {
+  /* Constant-time modular inversion. Zero maps to zero. */
+  safegcd_t d = {{0, 0, 0, 0, 0}};
+  safegcd_t e = {{1, 0, 0, 0, 0}};
+  safegcd_t f = mod->modulus;
+  safegcd_t g = *x;
+  int64_t zeta = -1;
+  safegcd_trans_t t;
+  int i;
+
+  for (i = 0; i < 10; i++) {
+    zeta = safegcd_divsteps_59(zeta, f.v[0], g.v[0], &t);
+    safegcd_update_de(&d, &e, &t, mod);
+    safegcd_update_fg(5, &f, &g, &t);
+  }
+
+  /* f = +/-1 (or +/-modulus if x = 0). */
+  safegcd_normalize(&d, f.v[4], mod);
+
+  *x = d;
+}
+
+static void
+safegcd_invert_var(safegcd_t *x, const safegcd_mod_t *mod) {
+  /* Variable-time modular inversion. Zero maps to zero. */
+  safegcd_t d = {{0, 0, 0, 0, 0}};
+  safegcd_t e = {{1, 0, 0, 0, 0}};
+  safegcd_t f = mod->modulus;
+  safegcd_t g = *x;
+  int64_t eta = -1;
+  int64_t cond, fn, gn;
+  safegcd_trans_t t;
+  int j, len = 5;
+
+  for (;;) {
+    eta = safegcd_divsteps_62_var(eta, f.v[0], g.v[0], &t);
+    safegcd_update_de(&d, &e, &t, mod);
+    safegcd_update_fg(len, &f, &g, &t);
+
+    /* Done once g = 0. */
+    if (g.v[0] == 0) {
+      cond = 0;
+
+      for (j = 1; j < len; j++)
+        cond |= g.v[j];
+
+      if (cond == 0)
+        break;
+    }
+
+    /* Shrink len if the top limbs of f and g are both
+       0 or -1 (and len is not already 1). */
+    fn = f.v[len - 1];
+    gn = g.v[len - 1];
+
+    cond = ((int64_t)len - 2) >> 63;
+    cond |= fn ^ (fn >> 63);
+    cond |= gn ^ (gn >> 63);
+
+    if (cond == 0) {
+      f.v[len - 2] |= (int64_t)((uint64_t)fn << 62);
+      g.v[len - 2] |= (int64_t)((uint64_t)gn << 62);
+      len -= 1;
+    }
+  }
+
+  safegcd_normalize(&d, f.v[len - 1], mod);
+
+  *x = d;
+}
+
+#endif /* BTC_HAVE_INT128 */
+
 /*
  * Scalar
  */
@@ -377,40 +787,6 @@ sc_mulshift(sc_t z, const sc_t x, const sc_t y, mp_bits_t shift) {
   ASSERT(mpn_mulshift(z, x, y, SCALAR_LIMBS, shift, scratch) == 0);
 }
 
-static void
-sc_montmul(sc_t z, const sc_t x, const sc_t y) {
-  mp_limb_t scratch[MPN_MONTMUL_ITCH(SCALAR_LIMBS)]; /* 144 bytes */
-
-  mpn_sec_montmul(z, x, y, scalar_n, SCALAR_LIMBS, scalar_k, scratch);
-}
-
-static void
-sc_montsqr(sc_t z, const sc_t x) {
-  sc_montmul(z, x, x);
-}
-
-static void
-sc_montsqrn(sc_t z, const sc_t x, int n) {
-  int i;
-
-  ASSERT(n > 0);
-
-  sc_montsqr(z, x);
-
-  for (i = 1; i < n; i++)
-    sc_montsqr(z, z);
-}
-
-static void
-sc_mont(sc_t z, const sc_t x) {
-  sc_montmul(z, x, scalar_r2);
-}
-
-static void
-sc_normal(sc_t z, const sc_t x) {
-  sc_montmul(z, x, scalar_one);
-}
-
 static void
 sc_import_raw(sc_t z, const unsigned char *xp) {
   mpn_import(z, SCALAR_LIMBS, xp, 32, 1);
@@ -450,6 +826,79 @@ sc_set_fe(sc_t z, const fe_t x) {
   return sc_import_weak(z, raw);
 }
 
+#ifdef BTC_HAVE_INT128
+
+static int
+sc_invert_var(sc_t z, const sc_t x) {
+  unsigned char raw[32];
+  safegcd_t t;
+
+  sc_export(raw, x);
+
+  safegcd_import(&t, raw);
+  safegcd_invert_var(&t, &safegcd_scalar);
+  safegcd_export(raw, &t);
+
+  sc_import_raw(z, raw);
+
+  return sc_is_zero(z) ^ 1;
+}
+
+static int
+sc_invert(sc_t z, const sc_t x) {
+  unsigned char raw[32];
+  safegcd_t t;
+
+  sc_export(raw, x);
+
+  safegcd_import(&t, raw);
+  safegcd_invert(&t, &safegcd_scalar);
+  safegcd_export(raw, &t);
+
+  sc_import_raw(z, raw);
+
+  cleanse(raw, sizeof(raw));
+  cleanse(&t, sizeof(t));
+
+  return sc_is_zero(z) ^ 1;
+}
+
+#else /* !BTC_HAVE_INT128 */
+
+static void
+sc_montmul(sc_t z, const sc_t x, const sc_t y) {
+  mp_limb_t scratch[MPN_MONTMUL_ITCH(SCALAR_LIMBS)]; /* 144 bytes */
+
+  mpn_sec_montmul(z, x, y, scalar_n, SCALAR_LIMBS, scalar_k, scratch);
+}
+
+static void
+sc_montsqr(sc_t z, const sc_t x) {
+  sc_montmul(z, x, x);
+}
+
+static void
+sc_montsqrn(sc_t z, const sc_t x, int n) {
+  int i;
+
+  ASSERT(n > 0);
+
+  sc_montsqr(z, x);
+
+  for (i = 1; i < n; i++)
+    sc_montsqr(z, z);
+}
+
+static void
+sc_mont(sc_t z, const sc_t x) {
+  sc_montmul(z, x, scalar_r2);
+}
+
+static void
+sc_normal(sc_t z, const sc_t x) {
+  sc_montmul(z, x, scalar_one);
+}
+
 static int
 sc_invert_var(sc_t z, const sc_t x) {
   mp_limb_t scratch[MPN_INVERT_ITCH(SCALAR_LIMBS)]; /* 320 bytes */
@@ -558,6 +1007,8 @@ sc_invert(sc_t z, const sc_t x) {
   return sc_is_zero(z) ^ 1;
 }
 
+#endif /* !BTC_HAVE_INT128 */
+
 static int
 sc_minimize(sc_t z, const sc_t x) {
   int high = sc_is_high(x);
@@ -805,24 +1256,6 @@ fe_set(fe_t z, const fe_t x) {
     z[i] = x[i];
 }
 
-static int
-fe_set_limbs(fe_t z, const mp_limb_t *xp) {
-  unsigned char tmp[32];
-
-  mpn_export(tmp, 32, xp, FIELD_LIMBS, 1);
-
-  return fe_import(z, tmp);
-}
-
-static void
-fe_get_limbs(mp_limb_t *zp, const fe_t x) {
-  unsigned char tmp[32];
-
-  fe_export(tmp, x);
-
-  mpn_import(zp, FIELD_LIMBS, tmp, 32, 1);
-}
-
 static int
 fe_set_sc(fe_t z, const sc_t x) {
   unsigned char raw[32];
@@ -956,6 +1389,44 @@ fe_mul8(fe_t z, const fe_t x) {
   fiat_secp256k1_carry_scmul_8(z, x);
 }
 
+#ifdef BTC_HAVE_INT128
+
+static int
+fe_invert_var(fe_t z, const fe_t x) {
+  unsigned char raw[32];
+  safegcd_t t;
+
+  fe_export(raw, x);
+
+  safegcd_import(&t, raw);
+  safegcd_invert_var(&t, &safegcd_field);
+  safegcd_export(raw, &t);
+
+  ASSERT(fe_import(z, raw));
+
+  return fe_is_zero(z) ^ 1;
+}
+
+#else /* !BTC_HAVE_INT128 */
+
+static int
+fe_set_limbs(fe_t z, const mp_limb_t *xp) {
+  unsigned char tmp[32];
+
+  mpn_export(tmp, 32, xp, FIELD_LIMBS, 1);
+
+  return fe_import(z, tmp);
+}
+
+static void
+fe_get_limbs(mp_limb_t *zp, const fe_t x) {
+  unsigned char tmp[32];
+
+  fe_export(tmp, x);
+
+  mpn_import(zp, FIELD_LIMBS, tmp, 32, 1);
+}
+
 static int
 fe_invert_var(fe_t z, const fe_t x) {
   mp_limb_t scratch[MPN_INVERT_ITCH(FIELD_LIMBS)]; /* 320 bytes */
@@ -971,6 +1442,8 @@ fe_invert_var(fe_t z, const fe_t x) {
   return ret;
 }
 
+#endif /* !BTC_HAVE_INT128 */
+
 static void
 fe_pow_core(fe_t z, const fe_t x1, const fe_t x2) {
   /* Exponent: (p - 47) / 64 */
@@ -1056,6 +1529,29 @@ fe_pow_pm3d4(fe_t z, const fe_t x) {
   fe_mul(z, z, x2);
 }
 
+#ifdef BTC_HAVE_INT128
+
+static int
+fe_invert(fe_t z, const fe_t x) {
+  unsigned char raw[32];
+  safegcd_t t;
+
+  fe_export(raw, x);
+
+  safegcd_import(&t, raw);
+  safegcd_invert(&t, &safegcd_field);
+  safegcd_export(raw, &t);
+
+  fe_import(z, raw);
+
+  cleanse(raw, sizeof(raw));
+  cleanse(&t, sizeof(t));
+
+  return fe_is_zero(z) ^ 1;
+}
+
+#else /* !BTC_HAVE_INT128 */
+
 static int
 fe_invert(fe_t z, const fe_t x) {
   /* Exponent: p - 2 */
@@ -1093,6 +1589,8 @@ fe_invert(fe_t z, const fe_t x) {
   return fe_is_zero(z) ^ 1;
 }
 
+#endif /* !BTC_HAVE_INT128 */
+
 static int
 fe_sqrt(fe_t z, const fe_t x) {
   /* Exponent: (p + 1) / 4 */
@@ -9,8 +9,69 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <mako/crypto/hash.h>
 #include <mako/util.h>
+#include "../bio.h"
+
+/*
+ * Lanes
+ */
+
+/* Multi-lane kernels rely on GNU vector extensions. The 4-lane
+ * kernel is built for the baseline target (SSE2 on x86-64, NEON
+ * on aarch64). The 8-lane kernel is built for AVX2 via a function
+ * attribute and is only used if the CPU supports it.
+ */
+#if defined(__GNUC__) && (defined(__SSE2__) || defined(__ARM_NEON))
+#  define HASH160_HAVE_X4
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  if defined(__clang__) || (__GNUC__ * 100 + __GNUC_MINOR__ >= 409)
+#    define HASH160_HAVE_X8
+#  endif
+#endif
+
+#ifdef HASH160_HAVE_X4
+typedef uint32_t hash160_x4_t __attribute__((vector_size(16)));
+
+#define LANE_T hash160_x4_t
+#define LANE_COUNT 4
+#define LANE_FUNC hash160_x4
+#define LANE_ATTR
+#include "hash160_lanes.h"
+#undef LANE_T
+#undef LANE_COUNT
+#undef LANE_FUNC
+#undef LANE_ATTR
+#endif /* HASH160_HAVE_X4 */
+
+#ifdef HASH160_HAVE_X8
+typedef uint32_t hash160_x8_t __attribute__((vector_size(32)));
+
+#define LANE_T hash160_x8_t
+#define LANE_COUNT 8
+#define LANE_FUNC hash160_x8
+#define LANE_ATTR __attribute__((target("avx2")))
+#include "hash160_lanes.h"
+#undef LANE_T
+#undef LANE_COUNT
+#undef LANE_FUNC
+#undef LANE_ATTR
+
+static int
+hash160_has_avx2(void) {
+  static int avx2 = -1;
+
+  if (avx2 == -1) {
+    __builtin_cpu_init();
+    avx2 = __builtin_cpu_supports("avx2") != 0;
+  }
+
+  return avx2;
+}
+#endif /* HASH160_HAVE_X8 */
 
 /*
  * Hash160
@@ -37,3 +98,39 @@ btc_hash160(uint8_t *out, const void *data, size_t size) {
   btc_hash160_update(&ctx, data, size);
   btc_hash160_final(&ctx, out);
 }
+
+void
+btc_hash160_batch(uint8_t *out,
+                  const uint8_t *data,
+                  size_t size,
+                  size_t count) {
+  /* Only single-block messages are vectorized. */
+  if (size <= 55) {
+#ifdef HASH160_HAVE_X8
+    if (count >= 8 && hash160_has_avx2()) {
+      while (count >= 8) {
+        hash160_x8(out, data, size);
+        out += 8 * 20;
+        data += 8 * size;
+        count -= 8;
+      }
+    }
+#endif
+
+#ifdef HASH160_HAVE_X4
+    while (count >= 4) {
+      hash160_x4(out, data, size);
+      out += 4 * 20;
+      data += 4 * size;
+      count -= 4;
+    }
+#endif
+  }
+
+  while (count > 0) {
+    btc_hash160(out, data, size);
+    out += 20;
+    data += size;
+    count -= 1;
+  }
+}
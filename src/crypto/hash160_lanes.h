@@ -0,0 +1,421 @@
+/*!
+ * hash160_lanes.h - multi-lane hash160 for mako
+ * Copyright (c) 2020, Christopher Jeffrey (MIT License).
+ * https://github.com/chjj/mako
+ *
+ * Computes RIPEMD160(SHA256(m)) for LANE_COUNT equal-length messages
+ * of at most 55 bytes (i.e. a single SHA256 block), one message per
+ * vector lane. Included by hash160.c with the following defined:
+ *
+ *   LANE_T     - GNU vector of LANE_COUNT uint32_t's
+ *   LANE_COUNT - number of lanes
+ *   LANE_FUNC  - function name
+ *   LANE_ATTR  - function attributes (e.g. target)
+ */
+
+LANE_ATTR static void
+LANE_FUNC(uint8_t *out, const uint8_t *data, size_t size) {
+  uint32_t words[16][LANE_COUNT];
+  uint32_t digest[5][LANE_COUNT];
+  uint8_t block[64];
+  LANE_T A, B, C, D, E, F, G, H;
+  LANE_T AH, BH, CH, DH, EH, T;
+  LANE_T W[16];
+  LANE_T Z;
+  int i, j;
+
+  /* Pad each message to a single block and transpose. */
+  for (j = 0; j < LANE_COUNT; j++) {
+    memcpy(block, data + j * size, size);
+
+    block[size] = 0x80;
+
+    memset(block + size + 1, 0, 55 - size);
+
+    btc_write64be(block + 56, (uint64_t)size << 3);
+
+    for (i = 0; i < 16; i++)
+      words[i][j] = btc_read32be(block + i * 4);
+  }
+
+  for (i = 0; i < 16; i++)
+    memcpy(&W[i], words[i], sizeof(W[i]));
+
+  memset(&Z, 0, sizeof(Z));
+
+  /*
+   * SHA256
+   */
+
+#define Ch(x, y, z) ((x & (y ^ z)) ^ z)
+#define Maj(x, y, z) ((x & (y | z)) | (y & z))
+#define Sigma0(x) (ROTR32(x,  2) ^ ROTR32(x, 13) ^ ROTR32(x, 22))
+#define Sigma1(x) (ROTR32(x,  6) ^ ROTR32(x, 11) ^ ROTR32(x, 25))
+#define sigma0(x) (ROTR32(x,  7) ^ ROTR32(x, 18) ^ (x >>  3))
+#define sigma1(x) (ROTR32(x, 17) ^ ROTR32(x, 19) ^ (x >> 10))
+
+#define WORD(i) (sigma1(W[(i -  2) & 15]) + W[(i -  7) & 15]  \
+               + sigma0(W[(i - 15) & 15]) + W[(i - 16) & 15])
+
+#define R(a, b, c, d, e, f, g, h, i, k) do { \
+  if (i >= 16) /* Optimized out. */          \
+    W[i & 15] = WORD(i);                     \
+                                             \
+  h += Sigma1(e) + Ch(e, f, g) + k;          \
+  h += W[i & 15];                            \
+  d += h;                                    \
+  h += Sigma0(a) + Maj(a, b, c);             \
+} while (0)
+
+  A = Z + 0x6a09e667;
+  B = Z + 0xbb67ae85;
+  C = Z + 0x3c6ef372;
+  D = Z + 0xa54ff53a;
+  E = Z + 0x510e527f;
+  F = Z + 0x9b05688c;
+  G = Z + 0x1f83d9ab;
+  H = Z + 0x5be0cd19;
+
+  R(A, B, C, D, E, F, G, H,  0, 0x428a2f98);
+  R(H, A, B, C, D, E, F, G,  1, 0x71374491);
+  R(G, H, A, B, C, D, E, F,  2, 0xb5c0fbcf);
+  R(F, G, H, A, B, C, D, E,  3, 0xe9b5dba5);
+  R(E, F, G, H, A, B, C, D,  4, 0x3956c25b);
+  R(D, E, F, G, H, A, B, C,  5, 0x59f111f1);
+  R(C, D, E, F, G, H, A, B,  6, 0x923f82a4);
+  R(B, C, D, E, F, G, H, A,  7, 0xab1c5ed5);
+  R(A, B, C, D, E, F, G, H,  8, 0xd807aa98);
+  R(H, A, B, C, D, E, F, G,  9, 0x12835b01);
+  R(G, H, A, B, C, D, E, F, 10, 0x243185be);
+  R(F, G, H, A, B, C, D, E, 11, 0x550c7dc3);
+  R(E, F, G, H, A, B, C, D, 12, 0x72be5d74);
+  R(D, E, F, G, H, A, B, C, 13, 0x80deb1fe);
+  R(C, D, E, F, G, H, A, B, 14, 0x9bdc06a7);
+  R(B, C, D, E, F, G, H, A, 15, 0xc19bf174);
+  R(A, B, C, D, E, F, G, H, 16, 0xe49b69c1);
+  R(H, A, B, C, D, E, F, G, 17, 0xefbe4786);
+  R(G, H, A, B, C, D, E, F, 18, 0x0fc19dc6);
+  R(F, G, H, A, B, C, D, E, 19, 0x240ca1cc);
+  R(E, F, G, H, A, B, C, D, 20, 0x2de92c6f);
+  R(D, E, F, G, H, A, B, C, 21, 0x4a7484aa);
+  R(C, D, E, F, G, H, A, B, 22, 0x5cb0a9dc);
+  R(B, C, D, E, F, G, H, A, 23, 0x76f988da);
+  R(A, B, C, D, E, F, G, H, 24, 0x983e5152);
+  R(H, A, B, C, D, E, F, G, 25, 0xa831c66d);
+  R(G, H, A, B, C, D, E, F, 26, 0xb00327c8);
+  R(F, G, H, A, B, C, D, E, 27, 0xbf597fc7);
+  R(E, F, G, H, A, B, C, D, 28, 0xc6e00bf3);
+  R(D, E, F, G, H, A, B, C, 29, 0xd5a79147);
+  R(C, D, E, F, G, H, A, B, 30, 0x06ca6351);
+  R(B, C, D, E, F, G, H, A, 31, 0x14292967);
+  R(A, B, C, D, E, F, G, H, 32, 0x27b70a85);
+  R(H, A, B, C, D, E, F, G, 33, 0x2e1b2138);
+  R(G, H, A, B, C, D, E, F, 34, 0x4d2c6dfc);
+  R(F, G, H, A, B, C, D, E, 35, 0x53380d13);
+  R(E, F, G, H, A, B, C, D, 36, 0x650a7354);
+  R(D, E, F, G, H, A, B, C, 37, 0x766a0abb);
+  R(C, D, E, F, G, H, A, B, 38, 0x81c2c92e);
+  R(B, C, D, E, F, G, H, A, 39, 0x92722c85);
+  R(A, B, C, D, E, F, G, H, 40, 0xa2bfe8a1);
+  R(H, A, B, C, D, E, F, G, 41, 0xa81a664b);
+  R(G, H, A, B, C, D, E, F, 42, 0xc24b8b70);
+  R(F, G, H, A, B, C, D, E, 43, 0xc76c51a3);
+  R(E, F, G, H, A, B, C, D, 44, 0xd192e819);
+  R(D, E, F, G, H, A, B, C, 45, 0xd6990624);
+  R(C, D, E, F, G, H, A, B, 46, 0xf40e3585);
+  R(B, C, D, E, F, G, H, A, 47, 0x106aa070);
+  R(A, B, C, D, E, F, G, H, 48, 0x19a4c116);
+  R(H, A, B, C, D, E, F, G, 49, 0x1e376c08);
+  R(G, H, A, B, C, D, E, F, 50, 0x2748774c);
+  R(F, G, H, A, B, C, D, E, 51, 0x34b0bcb5);
+  R(E, F, G, H, A, B, C, D, 52, 0x391c0cb3);
+  R(D, E, F, G, H, A, B, C, 53, 0x4ed8aa4a);
+  R(C, D, E, F, G, H, A, B, 54, 0x5b9cca4f);
+  R(B, C, D, E, F, G, H, A, 55, 0x682e6ff3);
+  R(A, B, C, D, E, F, G, H, 56, 0x748f82ee);
+  R(H, A, B, C, D, E, F, G, 57, 0x78a5636f);
+  R(G, H, A, B, C, D, E, F, 58, 0x84c87814);
+  R(F, G, H, A, B, C, D, E, 59, 0x8cc70208);
+  R(E, F, G, H, A, B, C, D, 60, 0x90befffa);
+  R(D, E, F, G, H, A, B, C, 61, 0xa4506ceb);
+  R(C, D, E, F, G, H, A, B, 62, 0xbef9a3f7);
+  R(B, C, D, E, F, G, H, A, 63, 0xc67178f2);
+
+#undef Ch
+#undef Maj
+#undef Sigma0
+#undef Sigma1
+#undef sigma0
+#undef sigma1
+#undef WORD
+#undef R
+
+  A += 0x6a09e667;
+  B += 0xbb67ae85;
+  C += 0x3c6ef372;
+  D += 0xa54ff53a;
+  E += 0x510e527f;
+  F += 0x9b05688c;
+  G += 0x1f83d9ab;
+  H += 0x5be0cd19;
+
+  /*
+   * RIPEMD160
+   */
+
+  /* The digest is big-endian; RIPEMD160 reads little-endian words. */
+#define BSWAP(x) (((x) << 24) | (((x) << 8) & 0x00ff0000) \
+               | (((x) >> 8) & 0x0000ff00) | ((x) >> 24))
+
+  W[0] = BSWAP(A);
+  W[1] = BSWAP(B);
+  W[2] = BSWAP(C);
+  W[3] = BSWAP(D);
+  W[4] = BSWAP(E);
+  W[5] = BSWAP(F);
+  W[6] = BSWAP(G);
+  W[7] = BSWAP(H);
+  W[8] = Z + 0x00000080;
+
+  for (i = 9; i < 16; i++)
+    W[i] = Z;
+
+  W[14] = Z + (32 << 3);
+
+#undef BSWAP
+
+#define K1 0x00000000
+#define K2 0x5a827999
+#define K3 0x6ed9eba1
+#define K4 0x8f1bbcdc
+#define K5 0xa953fd4e
+
+#define KH1 0x50a28be6
+#define KH2 0x5c4dd124
+#define KH3 0x6d703ef3
+#define KH4 0x7a6d76e9
+#define KH5 0x00000000
+
+#define F1(x, y, z) (x ^ y ^ z)
+#define F2(x, y, z) ((x & y) | (~x & z))
+#define F3(x, y, z) ((x | ~y) ^ z)
+#define F4(x, y, z) ((x & z) | (y & ~z))
+#define F5(x, y, z) (x ^ (y | ~z))
+
+#define R(F, a, b, c, d, e, i, k, s) do { \
+  a += F(b, c, d) + W[i] + k;             \
+  a = ROTL32(a, s) + e;                   \
+  c = ROTL32(c, 10);                      \
+} while (0)
+
+  A = Z + 0x67452301;
+  B = Z + 0xefcdab89;
+  C = Z + 0x98badcfe;
+  D = Z + 0x10325476;
+  E = Z + 0xc3d2e1f0;
+
+  AH = A;
+  BH = B;
+  CH = C;
+  DH = D;
+  EH = E;
+
+  R(F1, A, B, C, D, E,  0, K1, 11);
+  R(F1, E, A, B, C, D,  1, K1, 14);
+  R(F1, D, E, A, B, C,  2, K1, 15);
+  R(F1, C, D, E, A, B,  3, K1, 12);
+  R(F1, B, C, D, E, A,  4, K1,  5);
+  R(F1, A, B, C, D, E,  5, K1,  8);
+  R(F1, E, A, B, C, D,  6, K1,  7);
+  R(F1, D, E, A, B, C,  7, K1,  9);
+  R(F1, C, D, E, A, B,  8, K1, 11);
+  R(F1, B, C, D, E, A,  9, K1, 13);
+  R(F1, A, B, C, D, E, 10, K1, 14);
+  R(F1, E, A, B, C, D, 11, K1, 15);
+  R(F1, D, E, A, B, C, 12, K1,  6);
+  R(F1, C, D, E, A, B, 13, K1,  7);
+  R(F1, B, C, D, E, A, 14, K1,  9);
+  R(F1, A, B, C, D, E, 15, K1,  8);
+  R(F2, E, A, B, C, D,  7, K2,  7);
+  R(F2, D, E, A, B, C,  4, K2,  6);
+  R(F2, C, D, E, A, B, 13, K2,  8);
+  R(F2, B, C, D, E, A,  1, K2, 13);
+  R(F2, A, B, C, D, E, 10, K2, 11);
+  R(F2, E, A, B, C, D,  6, K2,  9);
+  R(F2, D, E, A, B, C, 15, K2,  7);
+  R(F2, C, D, E, A, B,  3, K2, 15);
+  R(F2, B, C, D, E, A, 12, K2,  7);
+  R(F2, A, B, C, D, E,  0, K2, 12);
+  R(F2, E, A, B, C, D,  9, K2, 15);
+  R(F2, D, E, A, B, C,  5, K2,  9);
+  R(F2, C, D, E, A, B,  2, K2, 11);
+  R(F2, B, C, D, E, A, 14, K2,  7);
+  R(F2, A, B, C, D, E, 11, K2, 13);
+  R(F2, E, A, B, C, D,  8, K2, 12);
+  R(F3, D, E, A, B, C,  3, K3, 11);
+  R(F3, C, D, E, A, B, 10, K3, 13);
+  R(F3, B, C, D, E, A, 14, K3,  6);
+  R(F3, A, B, C, D, E,  4, K3,  7);
+  R(F3, E, A, B, C, D,  9, K3, 14);
+  R(F3, D, E, A, B, C, 15, K3,  9);
+  R(F3, C, D, E, A, B,  8, K3, 13);
+  R(F3, B, C, D, E, A,  1, K3, 15);
+  R(F3, A, B, C, D, E,  2, K3, 14);
+  R(F3, E, A, B, C, D,  7, K3,  8);
+  R(F3, D, E, A, B, C,  0, K3, 13);
+  R(F3, C, D, E, A, B,  6, K3,  6);
+  R(F3, B, C, D, E, A, 13, K3,  5);
+  R(F3, A, B, C, D, E, 11, K3, 12);
+  R(F3, E, A, B, C, D,  5, K3,  7);
+  R(F3, D, E, A, B, C, 12, K3,  5);
+  R(F4, C, D, E, A, B,  1, K4, 11);
+  R(F4, B, C, D, E, A,  9, K4, 12);
+  R(F4, A, B, C, D, E, 11, K4, 14);
+  R(F4, E, A, B, C, D, 10, K4, 15);
+  R(F4, D, E, A, B, C,  0, K4, 14);
+  R(F4, C, D, E, A, B,  8, K4, 15);
+  R(F4, B, C, D, E, A, 12, K4,  9);
+  R(F4, A, B, C, D, E,  4, K4,  8);
+  R(F4, E, A, B, C, D, 13, K4,  9);
+  R(F4, D, E, A, B, C,  3, K4, 14);
+  R(F4, C, D, E, A, B,  7, K4,  5);
+  R(F4, B, C, D, E, A, 15, K4,  6);
+  R(F4, A, B, C, D, E, 14, K4,  8);
+  R(F4, E, A, B, C, D,  5, K4,  6);
+  R(F4, D, E, A, B, C,  6, K4,  5);
+  R(F4, C, D, E, A, B,  2, K4, 12);
+  R(F5, B, C, D, E, A,  4, K5,  9);
+  R(F5, A, B, C, D, E,  0, K5, 15);
+  R(F5, E, A, B, C, D,  5, K5,  5);
+  R(F5, D, E, A, B, C,  9, K5, 11);
+  R(F5, C, D, E, A, B,  7, K5,  6);
+  R(F5, B, C, D, E, A, 12, K5,  8);
+  R(F5, A, B, C, D, E,  2, K5, 13);
+  R(F5, E, A, B, C, D, 10, K5, 12);
+  R(F5, D, E, A, B, C, 14, K5,  5);
+  R(F5, C, D, E, A, B,  1, K5, 12);
+  R(F5, B, C, D, E, A,  3, K5, 13);
+  R(F5, A, B, C, D, E,  8, K5, 14);
+  R(F5, E, A, B, C, D, 11, K5, 11);
+  R(F5, D, E, A, B, C,  6, K5,  8);
+  R(F5, C, D, E, A, B, 15, K5,  5);
+  R(F5, B, C, D, E, A, 13, K5,  6);
+
+  R(F5, AH, BH, CH, DH, EH,  5, KH1,  8);
+  R(F5, EH, AH, BH, CH, DH, 14, KH1,  9);
+  R(F5, DH, EH, AH, BH, CH,  7, KH1,  9);
+  R(F5, CH, DH, EH, AH, BH,  0, KH1, 11);
+  R(F5, BH, CH, DH, EH, AH,  9, KH1, 13);
+  R(F5, AH, BH, CH, DH, EH,  2, KH1, 15);
+  R(F5, EH, AH, BH, CH, DH, 11, KH1, 15);
+  R(F5, DH, EH, AH, BH, CH,  4, KH1,  5);
+  R(F5, CH, DH, EH, AH, BH, 13, KH1,  7);
+  R(F5, BH, CH, DH, EH, AH,  6, KH1,  7);
+  R(F5, AH, BH, CH, DH, EH, 15, KH1,  8);
+  R(F5, EH, AH, BH, CH, DH,  8, KH1, 11);
+  R(F5, DH, EH, AH, BH, CH,  1, KH1, 14);
+  R(F5, CH, DH, EH, AH, BH, 10, KH1, 14);
+  R(F5, BH, CH, DH, EH, AH,  3, KH1, 12);
+  R(F5, AH, BH, CH, DH, EH, 12, KH1,  6);
+  R(F4, EH, AH, BH, CH, DH,  6, KH2,  9);
+  R(F4, DH, EH, AH, BH, CH, 11, KH2, 13);
+  R(F4, CH, DH, EH, AH, BH,  3, KH2, 15);
+  R(F4, BH, CH, DH, EH, AH,  7, KH2,  7);
+  R(F4, AH, BH, CH, DH, EH,  0, KH2, 12);
+  R(F4, EH, AH, BH, CH, DH, 13, KH2,  8);
+  R(F4, DH, EH, AH, BH, CH,  5, KH2,  9);
+  R(F4, CH, DH, EH, AH, BH, 10, KH2, 11);
+  R(F4, BH, CH, DH, EH, AH, 14, KH2,  7);
+  R(F4, AH, BH, CH, DH, EH, 15, KH2,  7);
+  R(F4, EH, AH, BH, CH, DH,  8, KH2, 12);
+  R(F4, DH, EH, AH, BH, CH, 12, KH2,  7);
+  R(F4, CH, DH, EH, AH, BH,  4, KH2,  6);
+  R(F4, BH, CH, DH, EH, AH,  9, KH2, 15);
+  R(F4, AH, BH, CH, DH, EH,  1, KH2, 13);
+  R(F4, EH, AH, BH, CH, DH,  2, KH2, 11);
+  R(F3, DH, EH, AH, BH, CH, 15, KH3,  9);
+  R(F3, CH, DH, EH, AH, BH,  5, KH3,  7);
+  R(F3, BH, CH, DH, EH, AH,  1, KH3, 15);
+  R(F3, AH, BH, CH, DH, EH,  3, KH3, 11);
+  R(F3, EH, AH, BH, CH, DH,  7, KH3,  8);
+  R(F3, DH, EH, AH, BH, CH, 14, KH3,  6);
+  R(F3, CH, DH, EH, AH, BH,  6, KH3,  6);
+  R(F3, BH, CH, DH, EH, AH,  9, KH3, 14);
+  R(F3, AH, BH, CH, DH, EH, 11, KH3, 12);
+  R(F3, EH, AH, BH, CH, DH,  8, KH3, 13);
+  R(F3, DH, EH, AH, BH, CH, 12, KH3,  5);
+  R(F3, CH, DH, EH, AH, BH,  2, KH3, 14);
+  R(F3, BH, CH, DH, EH, AH, 10, KH3, 13);
+  R(F3, AH, BH, CH, DH, EH,  0, KH3, 13);
+  R(F3, EH, AH, BH, CH, DH,  4, KH3,  7);
+  R(F3, DH, EH, AH, BH, CH, 13, KH3,  5);
+  R(F2, CH, DH, EH, AH, BH,  8, KH4, 15);
+  R(F2, BH, CH, DH, EH, AH,  6, KH4,  5);
+  R(F2, AH, BH, CH, DH, EH,  4, KH4,  8);
+  R(F2, EH, AH, BH, CH, DH,  1, KH4, 11);
+  R(F2, DH, EH, AH, BH, CH,  3, KH4, 14);
+  R(F2, CH, DH, EH, AH, BH, 11, KH4, 14);
+  R(F2, BH, CH, DH, EH, AH, 15, KH4,  6);
+  R(F2, AH, BH, CH, DH, EH,  0, KH4, 14);
+  R(F2, EH, AH, BH, CH, DH,  5, KH4,  6);
+  R(F2, DH, EH, AH, BH, CH, 12, KH4,  9);
+  R(F2, CH, DH, EH, AH, BH,  2, KH4, 12);
+  R(F2, BH, CH, DH, EH, AH, 13, KH4,  9);
+  R(F2, AH, BH, CH, DH, EH,  9, KH4, 12);
+  R(F2, EH, AH, BH, CH, DH,  7, KH4,  5);
+  R(F2, DH, EH, AH, BH, CH, 10, KH4, 15);
+  R(F2, CH, DH, EH, AH, BH, 14, KH4,  8);
+  R(F1, BH, CH, DH, EH, AH, 12, KH5,  8);
+  R(F1, AH, BH, CH, DH, EH, 15, KH5,  5);
+  R(F1, EH, AH, BH, CH, DH, 10, KH5, 12);
+  R(F1, DH, EH, AH, BH, CH,  4, KH5,  9);
+  R(F1, CH, DH, EH, AH, BH,  1, KH5, 12);
+  R(F1, BH, CH, DH, EH, AH,  5, KH5,  5);
+  R(F1, AH, BH, CH, DH, EH,  8, KH5, 14);
+  R(F1, EH, AH, BH, CH, DH,  7, KH5,  6);
+  R(F1, DH, EH, AH, BH, CH,  6, KH5,  8);
+  R(F1, CH, DH, EH, AH, BH,  2, KH5, 13);
+  R(F1, BH, CH, DH, EH, AH, 13, KH5,  6);
+  R(F1, AH, BH, CH, DH, EH, 14, KH5,  5);
+  R(F1, EH, AH, BH, CH, DH,  0, KH5, 15);
+  R(F1, DH, EH, AH, BH, CH,  3, KH5, 13);
+  R(F1, CH, DH, EH, AH, BH,  9, KH5, 11);
+  R(F1, BH, CH, DH, EH, AH, 11, KH5, 11);
+
+#undef K1
+#undef K2
+#undef K3
+#undef K4
+#undef K5
+#undef KH1
+#undef KH2
+#undef KH3
+#undef KH4
+#undef KH5
+#undef F1
+#undef F2
+#undef F3
+#undef F4
+#undef F5
+#undef R
+
+  T = C + DH + 0xefcdab89;
+
+  C = D + EH + 0x98badcfe;
+  D = E + AH + 0x10325476;
+  E = A + BH + 0xc3d2e1f0;
+  A = B + CH + 0x67452301;
+  B = T;
+
+  /* Transpose back out. */
+  memcpy(digest[0], &B, sizeof(B));
+  memcpy(digest[1], &C, sizeof(C));
+  memcpy(digest[2], &D, sizeof(D));
+  memcpy(digest[3], &E, sizeof(E));
+  memcpy(digest[4], &A, sizeof(A));
+
+  for (j = 0; j < LANE_COUNT; j++) {
+    for (i = 0; i < 5; i++)
+      btc_write32le(out + j * 20 + i * 4, digest[i][j]);
+  }
+}
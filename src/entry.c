@@ -31,6 +31,8 @@ btc_entry_init(btc_entry_t *z) {
   z->block_pos = -1;
   z->undo_file = -1;
   z->undo_pos = -1;
+  z->status = 0;
+  z->max_time = -1;
   z->prev = NULL;
   z->next = NULL;
 }
@@ -50,6 +52,8 @@ btc_entry_copy(btc_entry_t *z, const btc_entry_t *x) {
   z->block_pos = x->block_pos;
   z->undo_file = x->undo_file;
   z->undo_pos = x->undo_pos;
+  z->status = x->status;
+  z->max_time = x->max_time;
   z->prev = NULL;
   z->next = NULL;
 }
@@ -65,6 +69,7 @@ btc_entry_size(const btc_entry_t *x) {
   size += 4;
   size += 4;
   size += 4;
+  size += 4;
 
   return size;
 }
@@ -78,6 +83,7 @@ btc_entry_write(uint8_t *zp, const btc_entry_t *x) {
   zp = btc_int32_write(zp, x->block_pos);
   zp = btc_int32_write(zp, x->undo_file);
   zp = btc_int32_write(zp, x->undo_pos);
+  zp = btc_uint32_write(zp, x->status);
   return zp;
 }
 
@@ -104,8 +110,16 @@ btc_entry_read(btc_entry_t *z, const uint8_t **xp, size_t *xn) {
   if (!btc_int32_read(&z->undo_pos, xp, xn))
     return 0;
 
+  /* Entries written before the status field existed end here. */
+  z->status = 0;
+
+  if (*xn > 0 && !btc_uint32_read(&z->status, xp, xn))
+    return 0;
+
   btc_header_hash(z->hash, &z->header);
 
+  /* Computed once the entry is linked to its parent. */
+  z->max_time = -1;
   z->prev = NULL;
   z->next = NULL;
 
@@ -163,6 +177,11 @@ btc_entry_set_header(btc_entry_t *entry,
 
   btc_entry_get_chainwork(entry->chainwork, entry, prev);
 
+  entry->max_time = entry->header.time;
+
+  if (prev != NULL && prev->max_time > entry->max_time)
+    entry->max_time = prev->max_time;
+
   entry->prev = (btc_entry_t *)prev;
 }
 
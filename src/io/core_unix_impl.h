@@ -206,6 +206,11 @@ btc_fs_rename(const char *from, const char *to) {
   return rename(from, to) == 0;
 }
 
+int
+btc_fs_link(const char *from, const char *to) {
+  return link(from, to) == 0;
+}
+
 int
 btc_fs_unlink(const char *name) {
   return unlink(name) == 0;
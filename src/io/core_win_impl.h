@@ -167,6 +167,39 @@ BTCIsWindowsNT(void) {
   return version < 0x80000000;
 }
 
+static BOOL
+BTCCreateHardLinkW(LPCWSTR to, LPCWSTR from, LPSECURITY_ATTRIBUTES attr) {
+  typedef BOOL (WINAPI *P)(LPCWSTR, LPCWSTR, LPSECURITY_ATTRIBUTES);
+  static volatile long state = 0;
+  static P HardLinkW = NULL;
+  long value;
+
+  while ((value = BTCInterlockedCompareExchange(&state, 1, 0)) == 1)
+    Sleep(0);
+
+  if (value == 0) {
+    HMODULE h = GetModuleHandleA("kernel32.dll");
+
+    if (h == NULL)
+      abort(); /* LCOV_EXCL_LINE */
+
+    /* Windows 2000 and above. */
+    HardLinkW = (P)GetProcAddress(h, "CreateHardLinkW");
+
+    if (BTCInterlockedExchange(&state, 2) != 1)
+      abort(); /* LCOV_EXCL_LINE */
+  } else {
+    assert(value == 2);
+  }
+
+  if (HardLinkW == NULL) {
+    SetLastError(ERROR_CALL_NOT_IMPLEMENTED);
+    return FALSE;
+  }
+
+  return HardLinkW(to, from, attr);
+}
+
 static BOOL
 BTCSetFilePointerEx(HANDLE file,
                     LARGE_INTEGER pos,
@@ -423,6 +456,43 @@ btc_fs_rename(const char *from, const char *to) {
   return 1;
 }
 
+int
+btc_fs_link(const char *from, const char *to) {
+  /* Hard links are NTFS-only and absent on 9x.
+     Where they are unavailable, the file is copied. */
+  if (BTCIsWindowsNT()) {
+    btc_wide_t src, dst;
+    BOOL result;
+
+    if (!btc_wide_import(&src, from))
+      return 0;
+
+    if (!btc_wide_import(&dst, to)) {
+      btc_wide_clear(&src);
+      return 0;
+    }
+
+    result = BTCCreateHardLinkW(dst.data, src.data, NULL);
+
+    if (!result) {
+      DWORD code = GetLastError();
+
+      if (code == ERROR_INVALID_FUNCTION || /* Not NTFS. */
+          code == ERROR_NOT_SAME_DEVICE ||
+          code == ERROR_CALL_NOT_IMPLEMENTED) {
+        result = CopyFileW(src.data, dst.data, TRUE);
+      }
+    }
+
+    btc_wide_clear(&src);
+    btc_wide_clear(&dst);
+
+    return result != 0;
+  }
+
+  return CopyFileA(from, to, TRUE) != 0;
+}
+
 int
 btc_fs_unlink(const char *name) {
   if (BTCIsWindowsNT()) {
@@ -27,6 +27,7 @@ typedef struct http_conn_s {
   struct http_parser parser;
   struct http_parser_settings settings;
   http_req_t *req;
+  http_res_t *pending;
   int last_was_value;
   size_t total_buffered;
 } http_conn_t;
@@ -90,6 +91,7 @@ static void
 http_res_init(http_res_t *res, btc_socket_t *socket) {
   res->socket = socket;
   http_head_init(&res->headers);
+  res->held = 0;
 }
 
 static void
@@ -112,7 +114,15 @@ http_res_destroy(http_res_t *res) {
 
 static int
 http_res_write(http_res_t *res, void *data, size_t size) {
-  int rc = btc_socket_write(res->socket, data, size);
+  int rc;
+
+  /* A held response may outlive its connection. */
+  if (res->socket == NULL) {
+    free(data);
+    return 0;
+  }
+
+  rc = btc_socket_write(res->socket, data, size);
 
   if (rc == -1) {
     btc_socket_close(res->socket);
@@ -271,6 +281,26 @@ http_res_unauthorized(http_res_t *res, const char *realm) {
   http_res_error(res, 401);
 }
 
+void
+http_res_hold(http_res_t *res) {
+  /* Keep the response alive after the request
+     callback returns. It must be sent later
+     and then freed with http_res_release. */
+  res->held = 1;
+}
+
+void
+http_res_release(http_res_t *res) {
+  if (res->socket != NULL) {
+    http_conn_t *conn = btc_socket_get_data(res->socket);
+
+    if (conn->pending == res)
+      conn->pending = NULL;
+  }
+
+  http_res_destroy(res);
+}
+
 /*
  * Basic Auth
  */
@@ -343,6 +373,9 @@ static void
 http_conn_clear(http_conn_t *conn) {
   if (conn->req != NULL)
     http_req_destroy(conn->req);
+
+  if (conn->pending != NULL)
+    conn->pending->socket = NULL;
 }
 
 static http_conn_t *
@@ -524,7 +557,13 @@ on_message_complete(struct http_parser *parser) {
   http_conn_t *conn = parser->data;
   http_server_t *server = conn->server;
   http_req_t *req = conn->req;
-  http_res_t *res = http_res_create(conn->socket);
+  http_res_t *res;
+
+  /* We don't pipeline behind a held response. */
+  if (conn->pending != NULL)
+    return http_conn_abort(conn);
+
+  res = http_res_create(conn->socket);
 
   conn->req = NULL;
   conn->last_was_value = 0;
@@ -534,7 +573,11 @@ on_message_complete(struct http_parser *parser) {
     btc_socket_close(conn->socket);
 
   http_req_destroy(req);
-  http_res_destroy(res);
+
+  if (res->held)
+    conn->pending = res;
+  else
+    http_res_destroy(res);
 
   return 0;
 }
@@ -561,6 +604,7 @@ http_conn_init(http_conn_t *conn, http_server_t *server) {
   conn->settings.on_chunk_complete = NULL;
 
   conn->req = NULL;
+  conn->pending = NULL;
   conn->last_was_value = 0;
   conn->total_buffered = 0;
 }
@@ -23,6 +23,7 @@
 #include <mako/crypto/hash.h>
 #include <mako/entry.h>
 #include <mako/header.h>
+#include <mako/heap.h>
 #include <mako/list.h>
 #include <mako/map.h>
 #include <mako/mpi.h>
@@ -54,11 +55,20 @@ btc_deployment_state_init(btc_deployment_state_t *state) {
  * Orphan Block
  */
 
+/* Orphan blocks live in the chain database; only the entry is kept
+   in memory. The count bounds memory and the size bounds the disk,
+   which is the most the old limit of 20 in-memory blocks could use.
+   Removing an orphan frees its space. */
+#define BTC_MAX_ORPHANS 1000
+#define BTC_MAX_ORPHAN_SIZE (20 * BTC_MAX_RAW_BLOCK_SIZE)
+#define BTC_ORPHAN_EXPIRY (60 * 60 * 1000)
+
 typedef struct btc_orphan_s {
-  uint8_t hash[32];
-  btc_block_t *block;
+  btc_entry_t *entry;
   unsigned int id;
   int64_t time;
+  size_t size;
+  struct btc_orphan_s *next;
 } btc_orphan_t;
 
 DEFINE_OBJECT(btc_orphan, SCOPE_STATIC)
@@ -70,10 +80,10 @@ btc_orphan_init(btc_orphan_t *orphan) {
 
 static void
 btc_orphan_clear(btc_orphan_t *orphan) {
-  if (orphan->block != NULL)
-    btc_block_destroy(orphan->block);
+  if (orphan->entry != NULL)
+    btc_entry_destroy(orphan->entry);
 
-  orphan->block = NULL;
+  orphan->entry = NULL;
 }
 
 static void
@@ -85,8 +95,13 @@ btc_orphan_copy(btc_orphan_t *z, const btc_orphan_t *x) {
  * TX Checker
  */
 
+/* Transactions per work item. Each work item
+   shares a single schnorr signature batch. */
+#define BTC_CHECKER_CHUNK 16
+
 typedef struct btc_txwork_s {
-  const btc_tx_t *tx;
+  const btc_tx_t *txs[BTC_CHECKER_CHUNK];
+  size_t length;
   const btc_view_t *view;
   unsigned int flags;
   int result;
@@ -111,8 +126,24 @@ btc_checker_init(btc_checker_t *checker, btc_workers_t *pool) {
 static void
 btc_checker_work(void *arg) {
   btc_txwork_t *work = arg;
+  btc_sigbatch_t batch;
+  size_t i;
+
+  btc_sigbatch_init(&batch);
 
-  work->result = btc_tx_verify(work->tx, work->view, work->flags);
+  work->result = 1;
+
+  for (i = 0; i < work->length; i++) {
+    if (!btc_tx_verify_batch(work->txs[i], work->view, work->flags, &batch)) {
+      work->result = 0;
+      break;
+    }
+  }
+
+  if (work->result)
+    work->result = btc_sigbatch_verify(&batch);
+
+  btc_sigbatch_clear(&batch);
 }
 
 static void
@@ -120,16 +151,24 @@ btc_checker_push(btc_checker_t *checker,
                  const btc_tx_t *tx,
                  const btc_view_t *view,
                  unsigned int flags) {
-  btc_txwork_t *work = btc_malloc(sizeof(btc_txwork_t));
+  btc_txwork_t *work = checker->tail;
+
+  if (work == NULL || work->length == BTC_CHECKER_CHUNK) {
+    work = btc_malloc(sizeof(btc_txwork_t));
 
-  work->tx = tx;
-  work->view = view;
-  work->flags = flags;
-  work->result = 0;
-  work->next = NULL;
+    work->length = 0;
+    work->view = view;
+    work->flags = flags;
+    work->result = 0;
+    work->next = NULL;
 
-  btc_queue_push(checker, work);
-  btc_workq_push(&checker->batch, btc_checker_work, work);
+    btc_queue_push(checker, work);
+    btc_workq_push(&checker->batch, btc_checker_work, work);
+  }
+
+  CHECK(work->view == view && work->flags == flags);
+
+  work->txs[work->length++] = tx;
 }
 
 static int
@@ -151,19 +190,110 @@ btc_checker_verify(btc_checker_t *checker) {
   return ret;
 }
 
+/*
+ * Block Fetcher
+ */
+
+/* Blocks read ahead during a reorganization. Bounds
+   the memory held by a deep reorg's block data. */
+#define BTC_FETCH_WINDOW 16
+
+typedef struct btc_fetch_s {
+  btc_chaindb_t *db;
+  const btc_entry_t *entry;
+  btc_block_t *block;
+  btc_undo_t *undo;
+  int want_undo;
+} btc_fetch_t;
+
+static void
+btc_fetch_work(void *arg) {
+  btc_fetch_t *item = arg;
+
+  item->block = btc_chaindb_get_block(item->db, item->entry);
+
+  if (item->block != NULL && item->want_undo)
+    item->undo = btc_chaindb_get_undo_coins(item->db, item->entry);
+}
+
+static size_t
+btc_fetch_window(btc_fetch_t *items,
+                 btc_workers_t *pool,
+                 btc_chaindb_t *db,
+                 const btc_vector_t *entries,
+                 size_t start,
+                 int want_undo) {
+  size_t length = entries->length - start;
+  btc_workq_t batch;
+  size_t i;
+
+  if (length > BTC_FETCH_WINDOW)
+    length = BTC_FETCH_WINDOW;
+
+  btc_workq_init(&batch);
+
+  for (i = 0; i < length; i++) {
+    btc_fetch_t *item = &items[i];
+
+    item->db = db;
+    item->entry = entries->items[start + i];
+    item->block = NULL;
+    item->undo = NULL;
+    item->want_undo = want_undo;
+
+    if (pool != NULL)
+      btc_workq_push(&batch, btc_fetch_work, item);
+    else
+      btc_fetch_work(item);
+  }
+
+  if (pool != NULL) {
+    btc_workers_batch(pool, &batch);
+    btc_workers_wait(pool);
+  }
+
+  return length;
+}
+
+static void
+btc_fetch_clear(btc_fetch_t *items, size_t length) {
+  size_t i;
+
+  for (i = 0; i < length; i++) {
+    if (items[i].block != NULL)
+      btc_block_destroy(items[i].block);
+
+    if (items[i].undo != NULL)
+      btc_undo_destroy(items[i].undo);
+
+    items[i].block = NULL;
+    items[i].undo = NULL;
+  }
+}
+
 /*
  * State Cache
  */
 
+/* Deployment states at window boundaries. Misses fall
+   through to the chain database, where every computed
+   state is persisted so that restarts need not recount
+   signalling headers. States are keyed by block hash and
+   therefore remain valid across reorganizations. */
 typedef struct btc_statecache_s {
+  btc_chaindb_t *db;
   btc_hashtab_t *bits[32];
 } btc_statecache_t;
 
 static void
-btc_statecache_init(btc_statecache_t *cache, const btc_network_t *network) {
+btc_statecache_init(btc_statecache_t *cache,
+                    const btc_network_t *network,
+                    btc_chaindb_t *db) {
   const btc_deployment_t *deploy;
   size_t i;
 
+  cache->db = db;
+
   for (i = 0; i < 32; i++)
     cache->bits[i] = NULL;
 
@@ -190,23 +320,87 @@ btc_statecache_clear(btc_statecache_t *cache) {
 
 static void
 btc_statecache_set(btc_statecache_t *cache,
-                   int bit,
+                   const btc_deployment_t *deploy,
                    const btc_entry_t *entry,
                    int state) {
-  btc_hashtab_t *map = cache->bits[bit];
+  btc_hashtab_t *map = cache->bits[deploy->bit];
 
   CHECK(map != NULL);
 
   btc_hashtab_put(map, entry->hash, state);
+
+  btc_chaindb_put_state(cache->db, deploy, entry, state);
 }
 
 static int
-btc_statecache_get(btc_statecache_t *cache, int bit, const btc_entry_t *entry) {
-  btc_hashtab_t *map = cache->bits[bit];
+btc_statecache_get(btc_statecache_t *cache,
+                   const btc_deployment_t *deploy,
+                   const btc_entry_t *entry) {
+  btc_hashtab_t *map = cache->bits[deploy->bit];
+  int state;
 
   CHECK(map != NULL);
 
-  return btc_hashtab_get(map, entry->hash);
+  state = btc_hashtab_get(map, entry->hash);
+
+  if (state == -1) {
+    state = btc_chaindb_get_state(cache->db, deploy, entry);
+
+    if (state != -1)
+      btc_hashtab_put(map, entry->hash, state);
+  }
+
+  return state;
+}
+
+/*
+ * Candidate
+ */
+
+/* A possible chain tip. Candidates are ordered by chainwork and
+   then by sequence, which is negative for precious blocks. Every
+   valid block off the main chain is a candidate, however little
+   work it has: invalidation may rewind the tip below it. */
+typedef struct btc_candidate_s {
+  btc_entry_t *entry;
+  int64_t sequence;
+} btc_candidate_t;
+
+static btc_candidate_t *
+btc_candidate_create(btc_entry_t *entry, int64_t sequence) {
+  btc_candidate_t *item = btc_malloc(sizeof(btc_candidate_t));
+
+  item->entry = entry;
+  item->sequence = sequence;
+
+  return item;
+}
+
+static void
+btc_candidate_destroy(btc_candidate_t *item) {
+  btc_free(item);
+}
+
+static int
+cmp_candidate(const void *ap, const void *bp) {
+  const btc_candidate_t *a = ap;
+  const btc_candidate_t *b = bp;
+  int cmp = btc_hash_compare(b->entry->chainwork, a->entry->chainwork);
+
+  if (cmp != 0)
+    return cmp;
+
+  return (a->sequence > b->sequence) - (a->sequence < b->sequence);
+}
+
+static void
+btc_candidates_reset(btc_vector_t *z) {
+  size_t i;
+
+  for (i = 0; i < z->length; i++)
+    btc_candidate_destroy(z->items[i]);
+
+  btc_vector_reset(z);
 }
 
 /*
@@ -222,8 +416,14 @@ struct btc_chain_s {
   btc_hashset_t invalid;
   btc_hashmap_t orphan_map;
   btc_hashmap_t orphan_prev;
+  size_t orphan_size;
   btc_statecache_t cache;
+  btc_vector_t candidates;
+  btc_hashmap_t candidate_map;
+  int64_t sequence;
+  int64_t reverse;
   btc_entry_t *tip;
+  int64_t tip_sequence;
   int32_t height;
   mpz_t limit;
   btc_deployment_state_t state;
@@ -254,8 +454,13 @@ btc_chain_create(const btc_network_t *network) {
   btc_hashset_init(&chain->invalid);
   btc_hashmap_init(&chain->orphan_map);
   btc_hashmap_init(&chain->orphan_prev);
-  btc_statecache_init(&chain->cache, network);
+  btc_statecache_init(&chain->cache, network, chain->db);
+  btc_vector_init(&chain->candidates);
+  btc_hashmap_init(&chain->candidate_map);
+  chain->sequence = 0;
+  chain->reverse = -1;
   chain->tip = NULL;
+  chain->tip_sequence = 0;
   chain->height = -1;
 
   mpz_init_import(chain->limit, network->pow.limit, 32, -1);
@@ -279,10 +484,14 @@ btc_chain_destroy(btc_chain_t *chain) {
   btc_map_each(&chain->orphan_map, it)
     btc_orphan_destroy(chain->orphan_map.vals[it]);
 
+  btc_candidates_reset(&chain->candidates);
+
   btc_hashset_clear(&chain->invalid);
   btc_hashmap_clear(&chain->orphan_map);
   btc_hashmap_clear(&chain->orphan_prev);
   btc_statecache_clear(&chain->cache);
+  btc_vector_clear(&chain->candidates);
+  btc_hashmap_clear(&chain->candidate_map);
 
   btc_chaindb_destroy(chain->db);
 
@@ -325,6 +534,11 @@ btc_chain_set_cache(btc_chain_t *chain, size_t cache_size) {
   btc_chaindb_set_cache(chain->db, cache_size);
 }
 
+void
+btc_chain_set_rate_limit(btc_chain_t *chain, size_t rate_limit) {
+  btc_chaindb_set_rate_limit(chain->db, rate_limit);
+}
+
 void
 btc_chain_on_block(btc_chain_t *chain, btc_chain_block_cb *handler) {
   chain->on_block = handler;
@@ -392,6 +606,18 @@ btc_chain_maybe_sync(btc_chain_t *chain) {
   chain->synced = 1;
 }
 
+static void
+btc_chain_load_candidates(btc_chain_t *chain);
+
+static int
+btc_chain_activate(btc_chain_t *chain);
+
+static void
+btc_chain_load_orphans(btc_chain_t *chain);
+
+static void
+btc_chain_unload_orphans(btc_chain_t *chain);
+
 int
 btc_chain_open(btc_chain_t *chain, const char *prefix, unsigned int flags) {
   btc_log_info(chain, "Chain is loading.");
@@ -407,11 +633,18 @@ btc_chain_open(btc_chain_t *chain, const char *prefix, unsigned int flags) {
 #endif
 
   chain->tip = (btc_entry_t *)btc_chaindb_tail(chain->db);
+  chain->tip_sequence = 0;
   chain->height = chain->tip->height;
   chain->synced = 0;
 
   btc_chain_get_deployment_state(chain, &chain->state);
 
+  /* Finish any reorganization we were interrupted in. */
+  btc_chain_load_candidates(chain);
+  btc_chain_activate(chain);
+
+  btc_chain_load_orphans(chain);
+
   if (chain->flags & BTC_CHAIN_CHECKPOINTS)
     btc_log_info(chain, "Checkpoints are enabled.");
 
@@ -426,6 +659,10 @@ void
 btc_chain_close(btc_chain_t *chain) {
   btc_log_info(chain, "Closing chain.");
 
+  btc_candidates_reset(&chain->candidates);
+  btc_hashmap_reset(&chain->candidate_map);
+  btc_chain_unload_orphans(chain);
+
   if (chain->workers != NULL) {
     btc_workers_destroy(chain->workers);
     chain->workers = NULL;
@@ -436,18 +673,61 @@ btc_chain_close(btc_chain_t *chain) {
 
 static void
 btc_chain_add_orphan(btc_chain_t *chain, btc_orphan_t *orphan) {
-  btc_header_t *hdr = &orphan->block->header;
+  const uint8_t *prev_block = orphan->entry->header.prev_block;
+  btc_orphan_t *head = btc_hashmap_get(&chain->orphan_prev, prev_block);
+
+  CHECK(btc_hashmap_put(&chain->orphan_map, orphan->entry->hash, orphan));
 
-  CHECK(btc_hashmap_put(&chain->orphan_map, orphan->hash, orphan));
-  CHECK(btc_hashmap_put(&chain->orphan_prev, hdr->prev_block, orphan));
+  chain->orphan_size += orphan->size;
+
+  /* Siblings (a forked orphan chain) share a list. */
+  if (head != NULL) {
+    orphan->next = head->next;
+    head->next = orphan;
+  } else {
+    orphan->next = NULL;
+    CHECK(btc_hashmap_put(&chain->orphan_prev, prev_block, orphan));
+  }
 }
 
 static void
-btc_chain_remove_orphan(btc_chain_t *chain, const btc_orphan_t *orphan) {
-  const btc_header_t *hdr = &orphan->block->header;
+btc_chain_remove_orphan(btc_chain_t *chain, btc_orphan_t *orphan) {
+  const uint8_t *prev_block = orphan->entry->header.prev_block;
+  btc_orphan_t *head = btc_hashmap_get(&chain->orphan_prev, prev_block);
+  btc_orphan_t **link;
+
+  CHECK(btc_hashmap_del(&chain->orphan_map, orphan->entry->hash));
+  CHECK(head != NULL);
+
+  chain->orphan_size -= orphan->size;
+
+  if (head == orphan) {
+    CHECK(btc_hashmap_del(&chain->orphan_prev, prev_block));
+
+    if (orphan->next != NULL) {
+      head = orphan->next;
+      prev_block = head->entry->header.prev_block;
+
+      CHECK(btc_hashmap_put(&chain->orphan_prev, prev_block, head));
+    }
+  } else {
+    for (link = &head->next; *link != orphan; link = &(*link)->next)
+      CHECK(*link != NULL);
+
+    *link = orphan->next;
+  }
 
-  CHECK(btc_hashmap_del(&chain->orphan_map, orphan->hash));
-  CHECK(btc_hashmap_del(&chain->orphan_prev, hdr->prev_block));
+  orphan->next = NULL;
+}
+
+static void
+btc_chain_evict_orphan(btc_chain_t *chain, btc_orphan_t *orphan) {
+  btc_chain_remove_orphan(chain, orphan);
+
+  if (!btc_chaindb_remove_orphan(chain->db, orphan->entry))
+    btc_log_error(chain, "Could not remove orphan: %H.", orphan->entry->hash);
+
+  btc_orphan_destroy(orphan);
 }
 
 int
@@ -455,31 +735,43 @@ btc_chain_has_orphan(btc_chain_t *chain, const uint8_t *hash) {
   return btc_hashmap_has(&chain->orphan_map, hash);
 }
 
-static void
-btc_chain_limit_orphans(btc_chain_t *chain) {
-  int64_t now = btc_time_msec();
+static btc_orphan_t *
+btc_chain_oldest_orphan(btc_chain_t *chain) {
   btc_orphan_t *oldest = NULL;
   btc_mapiter_t it;
 
   btc_map_each(&chain->orphan_map, it) {
     btc_orphan_t *orphan = chain->orphan_map.vals[it];
 
-    if (now >= orphan->time + 60 * 60 * 1000) {
-      btc_chain_remove_orphan(chain, orphan);
-      btc_orphan_destroy(orphan);
-      continue;
-    }
-
     if (oldest == NULL || orphan->time < oldest->time)
       oldest = orphan;
   }
 
-  if (chain->orphan_map.size < 20)
-    return;
+  return oldest;
+}
+
+static void
+btc_chain_limit_orphans(btc_chain_t *chain, size_t size) {
+  int64_t now = btc_time_msec();
+  btc_orphan_t *oldest;
+  btc_mapiter_t it;
+
+  btc_map_each(&chain->orphan_map, it) {
+    btc_orphan_t *orphan = chain->orphan_map.vals[it];
 
-  if (oldest != NULL) {
-    btc_chain_remove_orphan(chain, oldest);
-    btc_orphan_destroy(oldest);
+    if (now >= orphan->time + BTC_ORPHAN_EXPIRY)
+      btc_chain_evict_orphan(chain, orphan);
+  }
+
+  /* Make room for a new orphan of `size` bytes. */
+  while (chain->orphan_map.size >= BTC_MAX_ORPHANS
+         || chain->orphan_size + size > BTC_MAX_ORPHAN_SIZE) {
+    oldest = btc_chain_oldest_orphan(chain);
+
+    if (oldest == NULL)
+      break;
+
+    btc_chain_evict_orphan(chain, oldest);
   }
 }
 
@@ -487,10 +779,9 @@ static btc_orphan_t *
 btc_chain_resolve_orphan(btc_chain_t *chain, const uint8_t *hash) {
   btc_orphan_t *orphan = btc_hashmap_get(&chain->orphan_prev, hash);
 
-  if (orphan == NULL)
-    return NULL;
-
-  btc_chain_remove_orphan(chain, orphan);
+  /* The record is removed once the block is connected. */
+  if (orphan != NULL)
+    btc_chain_remove_orphan(chain, orphan);
 
   return orphan;
 }
@@ -499,34 +790,36 @@ static void
 btc_chain_store_orphan(btc_chain_t *chain,
                        const btc_block_t *block,
                        unsigned int id) {
-  const btc_header_t *hdr = &block->header;
   int32_t height = btc_block_coinbase_height(block);
+  size_t size = btc_block_size(block);
+  btc_entry_t *entry;
   btc_orphan_t *orphan;
 
-  orphan = btc_hashmap_get(&chain->orphan_prev, hdr->prev_block);
+  btc_chain_limit_orphans(chain, size);
 
-  /* The orphan chain forked. */
-  if (orphan != NULL) {
-    btc_log_warn(chain, "Removing forked orphan block: %H (%d).",
-                        orphan->hash, height);
+  entry = btc_entry_create();
 
-    btc_chain_remove_orphan(chain, orphan);
-    btc_orphan_destroy(orphan);
-  }
+  btc_header_hash(entry->hash, &block->header);
+  btc_header_copy(&entry->header, &block->header);
 
-  btc_chain_limit_orphans(chain);
+  entry->status = BTC_ENTRY_ORPHAN;
+
+  if (!btc_chaindb_save_orphan(chain->db, entry, block)) {
+    btc_log_error(chain, "Could not write orphan block: %H.", entry->hash);
+    btc_entry_destroy(entry);
+    return;
+  }
 
   orphan = btc_orphan_create();
-  orphan->block = btc_block_refconst(block);
+  orphan->entry = entry;
   orphan->id = id;
   orphan->time = btc_time_msec();
-
-  btc_header_hash(orphan->hash, hdr);
+  orphan->size = size;
 
   btc_chain_add_orphan(chain, orphan);
 
   btc_log_debug(chain, "Storing orphan block: %H (%d).",
-                       orphan->hash, height);
+                       entry->hash, height);
 }
 
 static int
@@ -534,15 +827,92 @@ btc_chain_has_next_orphan(btc_chain_t *chain, const uint8_t *hash) {
   return btc_hashmap_has(&chain->orphan_prev, hash);
 }
 
+static size_t
+btc_chain_candidate_index(btc_chain_t *chain, const btc_candidate_t *item) {
+  size_t i;
+
+  for (i = 0; i < chain->candidates.length; i++) {
+    if (chain->candidates.items[i] == item)
+      return i;
+  }
+
+  btc_abort(); /* LCOV_EXCL_LINE */
+
+  return 0; /* LCOV_EXCL_LINE */
+}
+
 static void
-btc_chain_set_invalid(btc_chain_t *chain, const uint8_t *hash) {
-  uint8_t *key = btc_hash_clone(hash);
+btc_chain_add_candidate(btc_chain_t *chain,
+                        btc_entry_t *entry,
+                        int64_t sequence) {
+  btc_candidate_t *item;
+
+  if (btc_hashmap_has(&chain->candidate_map, entry->hash))
+    return;
+
+  item = btc_candidate_create(entry, sequence);
+
+  CHECK(btc_hashmap_put(&chain->candidate_map, entry->hash, item));
+
+  btc_heap_insert(&chain->candidates, item, cmp_candidate);
+}
+
+static int
+btc_chain_remove_candidate(btc_chain_t *chain,
+                           const btc_entry_t *entry,
+                           int64_t *sequence) {
+  btc_candidate_t *item = btc_hashmap_get(&chain->candidate_map, entry->hash);
+  size_t i;
+
+  if (item == NULL)
+    return 0;
+
+  i = btc_chain_candidate_index(chain, item);
+
+  CHECK(btc_hashmap_del(&chain->candidate_map, entry->hash));
+  CHECK(btc_heap_remove(&chain->candidates, i, cmp_candidate) == item);
+
+  if (sequence != NULL)
+    *sequence = item->sequence;
+
+  btc_candidate_destroy(item);
+
+  return 1;
+}
+
+static void
+btc_chain_update_candidate(btc_chain_t *chain,
+                           btc_entry_t *entry,
+                           int64_t sequence) {
+  btc_candidate_t *item = btc_hashmap_get(&chain->candidate_map, entry->hash);
+  size_t i;
+
+  if (item == NULL) {
+    btc_chain_add_candidate(chain, entry, sequence);
+    return;
+  }
+
+  i = btc_chain_candidate_index(chain, item);
+
+  item->sequence = sequence;
+
+  btc_heap_fix(&chain->candidates, i, cmp_candidate);
+}
+
+static void
+btc_chain_add_invalid(btc_chain_t *chain, const uint8_t *hash) {
+  uint8_t *key;
+
+  if (btc_hashset_has(&chain->invalid, hash))
+    return;
+
+  key = btc_hash_clone(hash);
 
   if (!btc_hashset_put(&chain->invalid, key))
     btc_free(key); /* Should never happen. */
 }
 
-BTC_UNUSED static void
+static void
 btc_chain_remove_invalid(btc_chain_t *chain, const uint8_t *hash) {
   uint8_t *key = btc_hashset_del(&chain->invalid, hash);
 
@@ -550,20 +920,89 @@ btc_chain_remove_invalid(btc_chain_t *chain, const uint8_t *hash) {
     btc_free(key);
 }
 
+static void
+btc_chain_set_status(btc_chain_t *chain, btc_entry_t *entry, uint32_t status) {
+  if (entry->status == status)
+    return;
+
+  entry->status = status;
+
+  CHECK(btc_chaindb_update(chain->db, entry));
+
+  if (status & BTC_ENTRY_INVALID) {
+    btc_chain_add_invalid(chain, entry->hash);
+    btc_chain_remove_candidate(chain, entry, NULL);
+  } else {
+    btc_chain_remove_invalid(chain, entry->hash);
+  }
+}
+
+static void
+btc_chain_set_failed(btc_chain_t *chain, btc_entry_t *entry, uint32_t flag) {
+  btc_chain_set_status(chain, entry, entry->status | flag);
+}
+
+static void
+btc_chain_set_invalid(btc_chain_t *chain, const uint8_t *hash) {
+  btc_entry_t *entry = (btc_entry_t *)btc_chaindb_by_hash(chain->db, hash);
+
+  /* Blocks we have stored remember their failure. */
+  if (entry != NULL)
+    btc_chain_set_failed(chain, entry, BTC_ENTRY_FAILED);
+  else
+    btc_chain_add_invalid(chain, hash);
+}
+
 int
 btc_chain_has_invalid(btc_chain_t *chain, const uint8_t *hash) {
   return btc_hashset_has(&chain->invalid, hash);
 }
 
+static int
+btc_chain_check_ancestors(btc_chain_t *chain, btc_entry_t *entry) {
+  /* The main chain never contains a failed block, so only the
+     branch between the entry and its fork needs to be checked.
+     Descendants of a failed block are marked lazily as they are
+     found here, which keeps invalidation from walking the index. */
+  btc_entry_t *walk = entry;
+  btc_entry_t *failed = NULL;
+
+  while (!btc_chaindb_is_main(chain->db, walk)) {
+    if (walk->status & BTC_ENTRY_INVALID) {
+      failed = walk;
+      break;
+    }
+
+    walk = walk->prev;
+  }
+
+  if (failed == NULL)
+    return 1;
+
+  for (walk = entry; walk != failed; walk = walk->prev)
+    btc_chain_set_failed(chain, walk, BTC_ENTRY_FAILED_CHILD);
+
+  return 0;
+}
+
 static int
 btc_chain_is_invalid(btc_chain_t *chain,
                      const uint8_t *hash,
                      const btc_header_t *hdr) {
+  btc_entry_t *prev;
+
   if (btc_hashset_has(&chain->invalid, hash))
     return 1;
 
   if (btc_hashset_has(&chain->invalid, hdr->prev_block)) {
-    btc_chain_set_invalid(chain, hash);
+    btc_chain_add_invalid(chain, hash);
+    return 1;
+  }
+
+  prev = (btc_entry_t *)btc_chaindb_by_hash(chain->db, hdr->prev_block);
+
+  if (prev != NULL && !btc_chain_check_ancestors(chain, prev)) {
+    btc_chain_add_invalid(chain, hash);
     return 1;
   }
 
@@ -806,7 +1245,7 @@ btc_chain_get_state(btc_chain_t *chain,
   btc_vector_init(&compute);
 
   while (entry != NULL) {
-    cached = btc_statecache_get(&chain->cache, bit, entry);
+    cached = btc_statecache_get(&chain->cache, deployment, entry);
 
     if (cached != -1) {
       state = cached;
@@ -817,7 +1256,7 @@ btc_chain_get_state(btc_chain_t *chain,
 
     if (time < deployment->start_time) {
       state = BTC_STATE_DEFINED;
-      btc_statecache_set(&chain->cache, bit, entry, state);
+      btc_statecache_set(&chain->cache, deployment, entry, state);
       break;
     }
 
@@ -892,7 +1331,7 @@ btc_chain_get_state(btc_chain_t *chain,
       }
     }
 
-    btc_statecache_set(&chain->cache, bit, entry, state);
+    btc_statecache_set(&chain->cache, deployment, entry, state);
   }
 
   btc_vector_clear(&compute);
@@ -972,6 +1411,17 @@ btc_chain_get_deployments(btc_chain_t *chain,
     state->flags |= BTC_SCRIPT_VERIFY_WITNESS;
     state->flags |= BTC_SCRIPT_VERIFY_NULLDUMMY;
   }
+
+  /* Taproot (bip341) and tapscript (bip342) are now usable. */
+  deploy = btc_network_deployment(network, "taproot");
+
+  if (deploy != NULL)
+    active = btc_chain_is_active(chain, prev, deploy);
+  else
+    active = (height >= network->softforks.taproot.height);
+
+  if (active)
+    state->flags |= BTC_SCRIPT_VERIFY_TAPROOT;
 }
 
 static int
@@ -1490,18 +1940,31 @@ btc_chain_verify_inputs(btc_chain_t *chain,
       goto fail;
     }
   } else {
-    /* Verify all transactions. */
-    for (i = 1; i < block->txs.length; i++) {
+    btc_sigbatch_t batch;
+    int ret = 1;
+
+    /* Verify all transactions (schnorr
+       signatures are batched block-wide). */
+    btc_sigbatch_init(&batch);
+
+    for (i = 1; i < block->txs.length && ret; i++) {
       const btc_tx_t *tx = block->txs.items[i];
 
-      if (!btc_tx_verify(tx, view, state->flags)) {
-        btc_chain_throw(chain, hdr,
-                        BTC_REJECT_INVALID,
-                        "mandatory-script-verify-flag-failed",
-                        100,
-                        0);
-        goto fail;
-      }
+      ret = btc_tx_verify_batch(tx, view, state->flags, &batch);
+    }
+
+    if (ret)
+      ret = btc_sigbatch_verify(&batch);
+
+    btc_sigbatch_clear(&batch);
+
+    if (!ret) {
+      btc_chain_throw(chain, hdr,
+                      BTC_REJECT_INVALID,
+                      "mandatory-script-verify-flag-failed",
+                      100,
+                      0);
+      goto fail;
     }
   }
 
@@ -1537,14 +2000,12 @@ btc_chain_verify_context(btc_chain_t *chain,
 }
 
 static int
-btc_chain_reconnect(btc_chain_t *chain, btc_entry_t *entry) {
+btc_chain_reconnect(btc_chain_t *chain,
+                    btc_entry_t *entry,
+                    const btc_block_t *block) {
   const btc_header_t *hdr = &entry->header;
   btc_deployment_state_t state;
-  btc_block_t *block;
   btc_view_t *view;
-  int ret = 0;
-
-  block = btc_chaindb_get_block(chain->db, entry);
 
   if (block == NULL) {
     btc_log_error(chain, "Block data not found: %H (%d).",
@@ -1566,11 +2027,15 @@ btc_chain_reconnect(btc_chain_t *chain, btc_entry_t *entry) {
     btc_log_warn(chain, "Tried to reconnect invalid block: %H (%d).",
                         entry->hash, entry->height);
 
-    goto fail;
+    return 0;
   }
 
   CHECK(btc_chaindb_reconnect(chain->db, entry, block, view));
 
+  /* The block keeps the sequence it competed with. */
+  if (!btc_chain_remove_candidate(chain, entry, &chain->tip_sequence))
+    chain->tip_sequence = ++chain->sequence;
+
   chain->tip = entry;
   chain->height = entry->height;
   chain->state = state;
@@ -1580,23 +2045,20 @@ btc_chain_reconnect(btc_chain_t *chain, btc_entry_t *entry) {
 
   btc_view_destroy(view);
 
-  ret = 1;
-fail:
-  btc_block_destroy(block);
-  return ret;
+  return 1;
 }
 
 static int
-btc_chain_disconnect(btc_chain_t *chain, btc_entry_t *entry) {
+btc_chain_disconnect(btc_chain_t *chain,
+                     btc_entry_t *entry,
+                     const btc_block_t *block,
+                     btc_undo_t *undo) {
   const btc_header_t *hdr = &entry->header;
   btc_entry_t *tip = entry->prev;
   btc_deployment_state_t state;
-  btc_block_t *block;
   btc_view_t *view;
 
-  block = btc_chaindb_get_block(chain->db, entry);
-
-  if (block == NULL) {
+  if (block == NULL || undo == NULL) {
     btc_log_error(chain, "Block data not found: %H (%d).",
                          entry->hash, entry->height);
 
@@ -1607,13 +2069,16 @@ btc_chain_disconnect(btc_chain_t *chain, btc_entry_t *entry) {
                            1);
   }
 
-  view = btc_chaindb_disconnect(chain->db, entry, block);
-
-  CHECK(view != NULL);
+  view = btc_chaindb_disconnect(chain->db, entry, block, undo);
 
   btc_chain_get_deployments(chain, &state, tip->header.time, tip->prev);
 
+  /* Disconnected blocks compete again. The new tip
+     was ours before any of the other candidates. */
+  btc_chain_add_candidate(chain, entry, chain->tip_sequence);
+
   chain->tip = tip;
+  chain->tip_sequence = 0;
   chain->height = tip->height;
   chain->state = state;
 
@@ -1621,7 +2086,6 @@ btc_chain_disconnect(btc_chain_t *chain, btc_entry_t *entry) {
     chain->on_disconnect(entry, block, view, chain->arg);
 
   btc_view_destroy(view);
-  btc_block_destroy(block);
 
   return 1;
 }
@@ -1641,11 +2105,15 @@ static int
 btc_chain_reorganize(btc_chain_t *chain,
                      const btc_entry_t *fork,
                      btc_entry_t *new_tip) {
+  /* The whole reorganization is written as one chainstate
+     transaction. Block and undo data is read a window at
+     a time ahead of use (in parallel if we have workers). */
+  btc_fetch_t items[BTC_FETCH_WINDOW];
   btc_entry_t *old_tip = chain->tip;
   btc_vector_t disconnect, connect;
   btc_entry_t *entry;
+  size_t i, j, k, n;
   int ret = 1;
-  size_t i;
 
   btc_vector_init(&disconnect);
   btc_vector_init(&connect);
@@ -1654,34 +2122,164 @@ btc_chain_reorganize(btc_chain_t *chain,
   for (entry = old_tip; entry != fork; entry = entry->prev)
     btc_vector_push(&disconnect, entry);
 
-  /* Blocks to connect. */
+  /* Blocks to connect (in order). */
   for (entry = new_tip; entry != fork; entry = entry->prev)
     btc_vector_push(&connect, entry);
 
+  for (i = 0, j = connect.length - 1; i < connect.length / 2; i++, j--) {
+    entry = connect.items[i];
+    connect.items[i] = connect.items[j];
+    connect.items[j] = entry;
+  }
+
+  if (disconnect.length + connect.length > 2) {
+    btc_log_debug(chain, "Reorganizing: disconnect=%zu connect=%zu",
+                         disconnect.length, connect.length);
+  }
+
+  btc_chaindb_begin(chain->db);
+
   /* Disconnect blocks and transactions. */
-  for (i = 0; i < disconnect.length; i++)
-    CHECK(btc_chain_disconnect(chain, disconnect.items[i]));
+  for (i = 0; i < disconnect.length; i += n) {
+    n = btc_fetch_window(items, chain->workers, chain->db,
+                         &disconnect, i, 1);
+
+    for (j = 0; j < n; j++) {
+      CHECK(btc_chain_disconnect(chain, disconnect.items[i + j],
+                                        items[j].block,
+                                        items[j].undo));
+
+      /* Undo coins are consumed. */
+      items[j].undo = NULL;
+    }
+
+    btc_fetch_clear(items, n);
+  }
 
   /* Connect blocks and transactions. */
-  for (i = connect.length - 1; i != (size_t)-1; i--) {
-    if (!btc_chain_reconnect(chain, connect.items[i])) {
-      if (!chain->error.malleated) {
-        while (i--) {
-          entry = connect.items[i];
-          btc_chain_set_invalid(chain, entry->hash);
+  for (i = 0; i < connect.length && ret; i += n) {
+    n = btc_fetch_window(items, chain->workers, chain->db,
+                         &connect, i, 0);
+
+    for (j = 0; j < n; j++) {
+      if (!btc_chain_reconnect(chain, connect.items[i + j], items[j].block)) {
+        if (!chain->error.malleated) {
+          for (k = i + j + 1; k < connect.length; k++) {
+            entry = connect.items[k];
+            btc_chain_set_failed(chain, entry, BTC_ENTRY_FAILED_CHILD);
+          }
         }
+        ret = 0;
+        break;
       }
-      ret = 0;
-      break;
     }
+
+    btc_fetch_clear(items, n);
   }
 
+  CHECK(btc_chaindb_commit(chain->db));
+
   btc_vector_clear(&disconnect);
   btc_vector_clear(&connect);
 
   return ret;
 }
 
+static int
+btc_chain_is_better(btc_chain_t *chain,
+                    const btc_entry_t *entry,
+                    int64_t sequence) {
+  int cmp = btc_hash_compare(entry->chainwork, chain->tip->chainwork);
+
+  if (cmp != 0)
+    return cmp > 0;
+
+  if (entry == chain->tip)
+    return 0;
+
+  return sequence < chain->tip_sequence;
+}
+
+static int
+btc_chain_activate(btc_chain_t *chain) {
+  /* Move to the best valid candidate. The heap keeps the most-work
+     candidate on top, so selection is logarithmic. Candidates leave
+     the heap as they are connected or found to be invalid. */
+  btc_entry_t *tip, *entry;
+  const btc_entry_t *fork;
+  btc_candidate_t *item;
+  int ret = 1;
+
+  while (chain->candidates.length > 0) {
+    item = chain->candidates.items[0];
+    entry = item->entry;
+
+    if (!btc_chain_is_better(chain, entry, item->sequence))
+      break;
+
+    if (!btc_chain_check_ancestors(chain, entry)) {
+      btc_chain_remove_candidate(chain, entry, NULL);
+      continue;
+    }
+
+    tip = chain->tip;
+    fork = btc_chain_find_fork(chain, entry);
+
+    btc_log_info(chain, "Activating best chain: old=%H(%d) new=%H(%d)",
+                        tip->hash, tip->height, entry->hash, entry->height);
+
+    if (!btc_chain_reorganize(chain, fork, entry)) {
+      /* We may be left on a shorter branch, which
+         the old tip now competes with. A block we
+         could not read is not retried. */
+      btc_chain_remove_candidate(chain, entry, NULL);
+
+      if (chain->error.code == BTC_REJECT_INTERNAL)
+        ret = 0;
+
+      continue;
+    }
+
+    if (fork != tip) {
+      btc_log_warn(chain, "Chain reorganization: old=%H(%d) new=%H(%d)",
+                          tip->hash, tip->height, entry->hash, entry->height);
+
+      if (chain->on_reorganize != NULL)
+        chain->on_reorganize(tip, entry, chain->arg);
+    }
+  }
+
+  btc_chain_maybe_sync(chain);
+
+  return ret;
+}
+
+static void
+btc_chain_load_candidates(btc_chain_t *chain) {
+  /* Every valid block off the main chain. */
+  btc_entry_t *entry;
+  btc_vector_t entries;
+  size_t i;
+
+  btc_vector_init(&entries);
+
+  btc_chaindb_entries(chain->db, &entries);
+
+  for (i = 0; i < entries.length; i++) {
+    entry = entries.items[i];
+
+    if (entry->status & BTC_ENTRY_INVALID) {
+      btc_chain_add_invalid(chain, entry->hash);
+      continue;
+    }
+
+    if (!btc_chaindb_is_main(chain->db, entry))
+      btc_chain_add_candidate(chain, entry, ++chain->sequence);
+  }
+
+  btc_vector_clear(&entries);
+}
+
 static int
 btc_chain_save_alternate(btc_chain_t *chain,
                          btc_entry_t *entry,
@@ -1715,6 +2313,8 @@ btc_chain_save_alternate(btc_chain_t *chain,
 
   CHECK(btc_chaindb_save(chain->db, entry, block, NULL));
 
+  btc_chain_add_candidate(chain, entry, ++chain->sequence);
+
   btc_log_warn(chain, "Heads up: Competing chain at height %d:"
                       " tip-height=%d competitor-height=%d"
                       " tip-hash=%H competitor-hash=%H"
@@ -1777,6 +2377,7 @@ btc_chain_set_best_chain(btc_chain_t *chain,
   CHECK(btc_chaindb_save(chain->db, entry, block, view));
 
   chain->tip = entry;
+  chain->tip_sequence = ++chain->sequence;
   chain->height = entry->height;
   chain->state = state;
 
@@ -1848,30 +2449,137 @@ btc_chain_connect(btc_chain_t *chain,
 
 static void
 btc_chain_handle_orphans(btc_chain_t *chain, const btc_entry_t *entry) {
-  btc_orphan_t *orphan = btc_chain_resolve_orphan(chain, entry->hash);
+  const btc_entry_t *child;
+  btc_orphan_t *orphan;
+  btc_block_t *block;
+  btc_vector_t queue;
+
+  btc_vector_init(&queue);
+  btc_vector_push(&queue, entry);
+
+  while (queue.length > 0) {
+    entry = btc_vector_pop(&queue);
 
-  while (orphan != NULL) {
-    entry = btc_chain_connect(chain, entry, orphan->block);
+    while ((orphan = btc_chain_resolve_orphan(chain, entry->hash))) {
+      block = btc_chaindb_get_orphan(chain->db, orphan->entry);
 
-    if (entry == NULL) {
-      btc_log_warn(chain, "Could not resolve orphan block %H: %s.",
-                          orphan->hash, chain->error.reason);
+      if (block == NULL) {
+        btc_log_warn(chain, "Orphan block data not found: %H.",
+                            orphan->entry->hash);
 
-      if (chain->on_badorphan != NULL)
-        chain->on_badorphan(&chain->error, orphan->id, chain->arg);
+        btc_chaindb_remove_orphan(chain->db, orphan->entry);
+        btc_orphan_destroy(orphan);
 
+        continue;
+      }
+
+      child = btc_chain_connect(chain, entry, block);
+
+      if (child == NULL) {
+        btc_log_warn(chain, "Could not resolve orphan block %H: %s.",
+                            orphan->entry->hash, chain->error.reason);
+
+        if (chain->on_badorphan != NULL)
+          chain->on_badorphan(&chain->error, orphan->id, chain->arg);
+      } else {
+        btc_log_debug(chain, "Orphan block was resolved: %H (%d).",
+                             child->hash, child->height);
+
+        btc_vector_push(&queue, child);
+      }
+
+      /* The block now lives in the block files (or was rejected). */
+      if (!btc_chaindb_remove_orphan(chain->db, orphan->entry))
+        btc_log_error(chain, "Could not remove orphan: %H.",
+                             orphan->entry->hash);
+
+      btc_block_destroy(block);
       btc_orphan_destroy(orphan);
+    }
+  }
 
-      break;
+  btc_vector_clear(&queue);
+}
+
+static void
+btc_chain_load_orphans(btc_chain_t *chain) {
+  int64_t now = btc_time_msec();
+  const btc_entry_t *prev;
+  btc_orphan_t *orphan;
+  btc_vector_t entries;
+  btc_entry_t *entry;
+  btc_block_t *block;
+  btc_mapiter_t it;
+  size_t i, size;
+
+  btc_vector_init(&entries);
+
+  btc_chaindb_orphans(chain->db, &entries);
+
+  for (i = 0; i < entries.length; i++) {
+    entry = entries.items[i];
+
+    /* Adopted before we could remove the record. */
+    if (btc_chaindb_by_hash(chain->db, entry->hash) != NULL) {
+      btc_chaindb_remove_orphan(chain->db, entry);
+      btc_entry_destroy(entry);
+      continue;
     }
 
-    btc_orphan_destroy(orphan);
+    block = btc_chaindb_get_orphan(chain->db, entry);
 
-    btc_log_debug(chain, "Orphan block was resolved: %H (%d).",
-                         entry->hash, entry->height);
+    if (block == NULL) {
+      btc_log_warn(chain, "Orphan block data not found: %H.", entry->hash);
+      btc_chaindb_remove_orphan(chain->db, entry);
+      btc_entry_destroy(entry);
+      continue;
+    }
+
+    size = btc_block_size(block);
+
+    btc_block_destroy(block);
+
+    btc_chain_limit_orphans(chain, size);
+
+    orphan = btc_orphan_create();
+    orphan->entry = entry;
+    orphan->id = 0;
+    orphan->time = now;
+    orphan->size = size;
+
+    btc_chain_add_orphan(chain, orphan);
+  }
 
-    orphan = btc_chain_resolve_orphan(chain, entry->hash);
+  /* Connect anything whose parent arrived before we went down. */
+  btc_vector_reset(&entries);
+
+  btc_map_each(&chain->orphan_prev, it) {
+    prev = btc_chaindb_by_hash(chain->db, chain->orphan_prev.keys[it]);
+
+    if (prev != NULL)
+      btc_vector_push(&entries, prev);
   }
+
+  for (i = 0; i < entries.length; i++)
+    btc_chain_handle_orphans(chain, entries.items[i]);
+
+  btc_vector_clear(&entries);
+
+  if (chain->orphan_map.size > 0)
+    btc_log_info(chain, "Loaded %zu orphan blocks.", chain->orphan_map.size);
+}
+
+static void
+btc_chain_unload_orphans(btc_chain_t *chain) {
+  btc_mapiter_t it;
+
+  btc_map_each(&chain->orphan_map, it)
+    btc_orphan_destroy(chain->orphan_map.vals[it]);
+
+  btc_hashmap_reset(&chain->orphan_map);
+  btc_hashmap_reset(&chain->orphan_prev);
+
+  chain->orphan_size = 0;
 }
 
 int
@@ -1983,6 +2691,123 @@ btc_chain_add(btc_chain_t *chain,
   return 1;
 }
 
+int
+btc_chain_invalidate(btc_chain_t *chain, const uint8_t *hash) {
+  btc_entry_t *entry = (btc_entry_t *)btc_chaindb_by_hash(chain->db, hash);
+  btc_entry_t *tip;
+
+  if (entry == NULL || entry->height == 0)
+    return 0;
+
+  btc_log_info(chain, "Invalidating block: %H (%d).",
+                      entry->hash, entry->height);
+
+  /* Rewind the main chain to the block's parent. */
+  if (btc_chaindb_is_main(chain->db, entry)) {
+    tip = chain->tip;
+
+    CHECK(btc_chain_reorganize(chain, entry->prev, entry->prev));
+
+    for (; tip != entry; tip = tip->prev)
+      btc_chain_set_failed(chain, tip, BTC_ENTRY_FAILED_CHILD);
+  }
+
+  /* Other descendants are dropped as activation finds them. */
+  btc_chain_set_failed(chain, entry, BTC_ENTRY_FAILED);
+
+  return btc_chain_activate(chain);
+}
+
+static int
+btc_chain_descends(const btc_entry_t *entry, const btc_entry_t *ancestor) {
+  while (entry->height > ancestor->height)
+    entry = entry->prev;
+
+  return entry == ancestor;
+}
+
+int
+btc_chain_reconsider(btc_chain_t *chain, const uint8_t *hash) {
+  btc_entry_t *entry = (btc_entry_t *)btc_chaindb_by_hash(chain->db, hash);
+  btc_entry_t *child;
+  btc_vector_t children;
+  btc_mapiter_t it;
+  size_t i;
+
+  if (entry == NULL) {
+    if (!btc_hashset_has(&chain->invalid, hash))
+      return 0;
+
+    btc_chain_remove_invalid(chain, hash);
+
+    return 1;
+  }
+
+  btc_log_info(chain, "Reconsidering block: %H (%d).",
+                      entry->hash, entry->height);
+
+  /* Only failed blocks need to be visited. */
+  btc_vector_init(&children);
+
+  btc_map_each(&chain->invalid, it) {
+    child = (btc_entry_t *)btc_chaindb_by_hash(chain->db,
+                                               chain->invalid.keys[it]);
+
+    if (child != NULL && btc_chain_descends(child, entry))
+      btc_vector_push(&children, child);
+  }
+
+  for (i = 0; i < children.length; i++) {
+    child = children.items[i];
+
+    btc_chain_set_status(chain, child, 0);
+    btc_chain_add_candidate(chain, child, ++chain->sequence);
+  }
+
+  btc_vector_clear(&children);
+
+  /* Ancestors are cleared as well. */
+  child = entry;
+
+  while (!btc_chaindb_is_main(chain->db, child)) {
+    btc_chain_set_status(chain, child, 0);
+    btc_chain_add_candidate(chain, child, ++chain->sequence);
+    child = child->prev;
+  }
+
+  return btc_chain_activate(chain);
+}
+
+int
+btc_chain_precious(btc_chain_t *chain, const uint8_t *hash) {
+  btc_entry_t *entry = (btc_entry_t *)btc_chaindb_by_hash(chain->db, hash);
+
+  if (entry == NULL)
+    return 0;
+
+  /* A precious block is preferred over every
+     other block with the same amount of work. */
+  if (btc_hash_compare(entry->chainwork, chain->tip->chainwork) < 0)
+    return 1;
+
+  if (entry == chain->tip) {
+    chain->tip_sequence = chain->reverse--;
+    return 1;
+  }
+
+  if (entry->status & BTC_ENTRY_INVALID)
+    return 1;
+
+  btc_chain_update_candidate(chain, entry, chain->reverse--);
+
+  return btc_chain_activate(chain);
+}
+
+int
+btc_chain_backup(btc_chain_t *chain, const char *prefix) {
+  return btc_chaindb_backup(chain->db, prefix);
+}
+
 const btc_entry_t *
 btc_chain_tip(btc_chain_t *chain) {
   return chain->tip;
@@ -2052,6 +2877,11 @@ btc_chain_by_height(btc_chain_t *chain, int32_t height) {
   return btc_chaindb_by_height(chain->db, height);
 }
 
+const btc_entry_t *
+btc_chain_by_time(btc_chain_t *chain, int64_t time) {
+  return btc_chaindb_by_time(chain->db, time);
+}
+
 int
 btc_chain_is_main(btc_chain_t *chain, const btc_entry_t *entry) {
   return btc_chaindb_is_main(chain->db, entry);
@@ -2106,7 +2936,7 @@ btc_chain_get_orphan_root(btc_chain_t *chain, const uint8_t *hash) {
       break;
 
     root = hash;
-    hash = orphan->block->header.prev_block;
+    hash = orphan->entry->header.prev_block;
   }
 
   return root;
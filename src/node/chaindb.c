@@ -47,10 +47,15 @@
 static uint8_t meta_key_[1] = {'R'};
 static uint8_t blockfile_key_[1] = {'B'};
 static uint8_t undofile_key_[1] = {'U'};
+static uint8_t flush_key_[1] = {'F'};
 
 static const ldb_slice_t meta_key = {meta_key_, 1, 0};
 static const ldb_slice_t blockfile_key = {blockfile_key_, 1, 0};
 static const ldb_slice_t undofile_key = {undofile_key_, 1, 0};
+static const ldb_slice_t flush_key = {flush_key_, 1, 0};
+
+static const ldb_writeopt_t sync_options = {1, 0};
+static const ldb_writeopt_t nowal_options = {0, 1};
 
 #define ENTRY_PREFIX 'e'
 #define ENTRY_KEYLEN 33
@@ -81,6 +86,35 @@ entry_key(uint8_t *key, const uint8_t *hash) {
   return ENTRY_KEYLEN;
 }
 
+#define ORPHAN_PREFIX 'o'
+#define ORPHAN_KEYLEN 33
+
+static uint8_t orphan_min_[ORPHAN_KEYLEN] = {
+  ORPHAN_PREFIX,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static uint8_t orphan_max_[ORPHAN_KEYLEN] = {
+  ORPHAN_PREFIX,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+static const ldb_slice_t orphan_min = {orphan_min_, ORPHAN_KEYLEN, 0};
+static const ldb_slice_t orphan_max = {orphan_max_, ORPHAN_KEYLEN, 0};
+
+static size_t
+orphan_key(uint8_t *key, const uint8_t *hash) {
+  key[0] = ORPHAN_PREFIX;
+  memcpy(key + 1, hash, 32);
+  return ORPHAN_KEYLEN;
+}
+
 #define TIP_PREFIX 'p'
 #define TIP_KEYLEN 33
 
@@ -151,8 +185,8 @@ static uint8_t coin_max_[COIN_KEYLEN] = {
   0xff, 0xff, 0xff, 0xff
 };
 
-BTC_UNUSED static const ldb_slice_t coin_min = {coin_min_, COIN_KEYLEN, 0};
-BTC_UNUSED static const ldb_slice_t coin_max = {coin_max_, COIN_KEYLEN, 0};
+static const ldb_slice_t coin_min = {coin_min_, COIN_KEYLEN, 0};
+static const ldb_slice_t coin_max = {coin_max_, COIN_KEYLEN, 0};
 
 static size_t
 coin_key(uint8_t *key, const uint8_t *hash, uint32_t index) {
@@ -162,6 +196,48 @@ coin_key(uint8_t *key, const uint8_t *hash, uint32_t index) {
   return COIN_KEYLEN;
 }
 
+#define STATE_PREFIX 'v'
+#define STATE_KEYLEN 38
+
+static size_t
+state_key(uint8_t *key,
+          const btc_network_t *network,
+          const btc_deployment_t *deploy,
+          const uint8_t *hash) {
+  /* States are only valid for the parameters they were
+     computed with. Identify the deployment by a digest
+     of those so that a changed deployment (or a reused
+     bit) never picks up a stale state. */
+  int32_t threshold = network->activation_threshold;
+  int32_t window = network->miner_window;
+  uint8_t params[24];
+  uint8_t digest[32];
+  btc_sha256_t ctx;
+
+  if (deploy->threshold != -1)
+    threshold = deploy->threshold;
+
+  if (deploy->window != -1)
+    window = deploy->window;
+
+  btc_write64be(params + 0, deploy->start_time);
+  btc_write64be(params + 8, deploy->timeout);
+  btc_write32be(params + 16, threshold);
+  btc_write32be(params + 20, window);
+
+  btc_sha256_init(&ctx);
+  btc_sha256_update(&ctx, deploy->name, strlen(deploy->name));
+  btc_sha256_update(&ctx, params, sizeof(params));
+  btc_sha256_final(&ctx, digest);
+
+  key[0] = STATE_PREFIX;
+  key[1] = deploy->bit;
+  memcpy(key + 2, digest, 4);
+  memcpy(key + 6, hash, 32);
+
+  return STATE_KEYLEN;
+}
+
 /*
  * Chain File
  */
@@ -293,8 +369,13 @@ struct btc_chaindb_s {
   char prefix[BTC_PATH_MAX - 31];
   unsigned int flags;
   size_t cache_size;
+  size_t rate_limit;
   ldb_t *lsm;
+  ldb_t *coins;
   ldb_lru_t *block_cache;
+  const btc_entry_t *flushed;
+  size_t unflushed;
+  size_t flush_size;
   btc_hashmap_t hashes;
   btc_vector_t heights;
   btc_entry_t *head;
@@ -307,19 +388,30 @@ struct btc_chaindb_s {
   btc_chainfile_t block;
   btc_chainfile_t undo;
   uint8_t *slab;
+  struct btc_chaintxn_s {
+    int active;
+    ldb_batch_t batch;
+    ldb_batch_t coins;
+    btc_view_t view;
+  } txn;
 };
 
 static void
-btc_chaindb_path(btc_chaindb_t *db, char *path, int type, int id) {
+btc_chainfile_path(char *path, const char *prefix, int type, int id) {
   const char *tag = (type == BLOCK_FILE ? "blk" : "rev");
 
 #ifdef _WIN32
-  sprintf(path, "%s\\blocks\\%s%05d.dat", db->prefix, tag, id);
+  sprintf(path, "%s\\blocks\\%s%05d.dat", prefix, tag, id);
 #else
-  sprintf(path, "%s/blocks/%s%05d.dat", db->prefix, tag, id);
+  sprintf(path, "%s/blocks/%s%05d.dat", prefix, tag, id);
 #endif
 }
 
+static void
+btc_chaindb_path(btc_chaindb_t *db, char *path, int type, int id) {
+  btc_chainfile_path(path, db->prefix, type, id);
+}
+
 static void
 btc_chaindb_init(btc_chaindb_t *db, const btc_network_t *network) {
   memset(db, 0, sizeof(*db));
@@ -329,8 +421,10 @@ btc_chaindb_init(btc_chaindb_t *db, const btc_network_t *network) {
   btc_hashmap_init(&db->hashes);
   db->flags = BTC_CHAIN_DEFAULT_FLAGS;
   db->cache_size = 128 << 20;
+  db->rate_limit = 0;
 
   btc_vector_init(&db->heights);
+  btc_view_init(&db->txn.view);
 
   db->slab = (uint8_t *)btc_malloc(24 + BTC_MAX_RAW_BLOCK_SIZE);
 }
@@ -339,6 +433,7 @@ static void
 btc_chaindb_clear(btc_chaindb_t *db) {
   btc_hashmap_clear(&db->hashes);
   btc_vector_clear(&db->heights);
+  btc_view_clear(&db->txn.view);
   btc_free(db->slab);
 
   memset(db, 0, sizeof(*db));
@@ -374,9 +469,76 @@ btc_chaindb_load_prefix(btc_chaindb_t *db, const char *prefix) {
   return 1;
 }
 
+static void
+btc_chaindb_unload_database(btc_chaindb_t *db);
+
+/* Databases from before the coins had a column family of their own
+   keep them in the default family. Move them over in chunks. */
+static int
+btc_chaindb_migrate_coins(btc_chaindb_t *db) {
+  ldb_batch_t batch;
+  ldb_iter_t *it;
+  size_t total = 0;
+  int rc = LDB_OK;
+
+  /* Backends without column families hand us the same handle. */
+  if (db->coins == db->lsm)
+    return 1;
+
+  it = ldb_iterator(db->lsm, 0);
+
+  ldb_iter_seek(it, &coin_min);
+
+  if (!ldb_iter_valid(it) || ldb_iter_compare(it, &coin_max) > 0) {
+    ldb_iter_destroy(it);
+    return 1;
+  }
+
+  fprintf(stderr, "Migrating coins to their own column family...\n");
+
+  ldb_batch_init(&batch);
+
+  ldb_iter_range(it, &coin_min, &coin_max) {
+    ldb_slice_t key = ldb_iter_key(it);
+    ldb_slice_t val = ldb_iter_value(it);
+
+    ldb_batch_put_family(&batch, db->coins, &key, &val);
+    ldb_batch_del(&batch, &key);
+
+    if ((++total & 0xffff) == 0) {
+      rc = ldb_write(db->lsm, &batch, 0);
+
+      if (rc != LDB_OK)
+        break;
+
+      ldb_batch_reset(&batch);
+    }
+  }
+
+  if (rc == LDB_OK)
+    rc = ldb_iter_status(it);
+
+  if (rc == LDB_OK)
+    rc = ldb_write(db->lsm, &batch, 0);
+
+  ldb_batch_clear(&batch);
+  ldb_iter_destroy(it);
+
+  if (rc != LDB_OK) {
+    fprintf(stderr, "ldb_write: %s\n", ldb_strerror(rc));
+    return 0;
+  }
+
+  fprintf(stderr, "Migrated %lu coins.\n", (unsigned long)total);
+
+  return 1;
+}
+
 static int
 btc_chaindb_load_database(btc_chaindb_t *db) {
   ldb_dbopt_t options = *ldb_dbopt_default;
+  ldb_dbopt_t coin_options;
+  ldb_family_t families[1];
   char path[BTC_PATH_MAX];
   int rc;
 
@@ -387,11 +549,14 @@ btc_chaindb_load_database(btc_chaindb_t *db) {
 
   db->block_cache = ldb_lru_create(db->cache_size / 2);
 
+  /* The default family holds the chain index, tips and
+     metadata. It is small and mostly read in order. */
   options.create_if_missing = 1;
   options.block_cache = db->block_cache;
-  options.write_buffer_size = db->cache_size / 4;
+  options.block_size = 16 << 10;
+  options.rate_limit = db->rate_limit;
   options.compression = LDB_NO_COMPRESSION;
-  options.filter_policy = NULL; /* ldb_bloom_default */
+  options.filter_policy = NULL;
   options.use_mmap = 0;
 
   if (options.use_mmap == 0 || sizeof(void *) < 8) {
@@ -412,7 +577,29 @@ btc_chaindb_load_database(btc_chaindb_t *db) {
     }
   }
 
-  rc = ldb_open(path, &options, &db->lsm);
+  /* The coins see nearly all of the writes and point lookups.
+     Keeping them apart means their compactions no longer rewrite
+     the index. Their table indexes and filters are partitioned so
+     that an open table pins only a small top-level index. */
+  coin_options = options;
+  coin_options.write_buffer_size = db->cache_size / 4;
+  coin_options.block_size = 4 << 10;
+  coin_options.block_hash_index = 1;
+  coin_options.index_partition_size = 4 << 10;
+  coin_options.filter_policy = ldb_bloom_default;
+
+  /* Throttled by the chain's limiter: -dbratelimit is a total. */
+  coin_options.rate_limit = 0;
+
+  /* Without the log, coins are flushed well before
+     their memtable would be switched out anyway. */
+  db->flush_size = coin_options.write_buffer_size / 2;
+
+  families[0].name = "coins";
+  families[0].options = &coin_options;
+  families[0].handle = NULL;
+
+  rc = ldb_open_families(path, &options, families, 1, &db->lsm);
 
   if (rc != LDB_OK) {
     fprintf(stderr, "ldb_open: %s\n", ldb_strerror(rc));
@@ -423,6 +610,13 @@ btc_chaindb_load_database(btc_chaindb_t *db) {
     return 0;
   }
 
+  db->coins = families[0].handle;
+
+  if (!btc_chaindb_migrate_coins(db)) {
+    btc_chaindb_unload_database(db);
+    return 0;
+  }
+
   return 1;
 }
 
@@ -432,6 +626,7 @@ btc_chaindb_unload_database(btc_chaindb_t *db) {
   ldb_lru_destroy(db->block_cache);
 
   db->lsm = NULL;
+  db->coins = NULL;
   db->block_cache = NULL;
 }
 
@@ -546,12 +741,35 @@ btc_chaindb_init_index(btc_chaindb_t *db) {
   return 1;
 }
 
+static void
+btc_chaindb_set_max_time(btc_entry_t *entry, btc_vector_t *stack) {
+  int64_t max_time = 0;
+
+  while (entry != NULL && entry->max_time < 0) {
+    btc_vector_push(stack, entry);
+    entry = entry->prev;
+  }
+
+  if (entry != NULL)
+    max_time = entry->max_time;
+
+  while (stack->length > 0) {
+    entry = (btc_entry_t *)btc_vector_pop(stack);
+
+    if (entry->header.time > max_time)
+      max_time = entry->header.time;
+
+    entry->max_time = max_time;
+  }
+}
+
 static int
 btc_chaindb_load_index(btc_chaindb_t *db) {
   btc_entry_t *entry, *tip;
   btc_entry_t *gen = NULL;
   uint8_t tip_hash[32];
   btc_mapiter_t iter;
+  btc_vector_t stack;
   ldb_slice_t val;
   ldb_iter_t *it;
   int rc;
@@ -602,6 +820,14 @@ btc_chaindb_load_index(btc_chaindb_t *db) {
 
   CHECK(gen != NULL);
 
+  /* Compute the running maximum of block times. */
+  btc_vector_init(&stack);
+
+  btc_map_each(&db->hashes, iter)
+    btc_chaindb_set_max_time(db->hashes.vals[iter], &stack);
+
+  btc_vector_clear(&stack);
+
   /* Retrieve tip. */
   tip = btc_hashmap_get(&db->hashes, tip_hash);
 
@@ -650,6 +876,17 @@ btc_chaindb_set_cache(btc_chaindb_t *db, size_t cache_size) {
   db->cache_size = cache_size;
 }
 
+void
+btc_chaindb_set_rate_limit(btc_chaindb_t *db, size_t rate_limit) {
+  db->rate_limit = rate_limit;
+}
+
+static int
+btc_chaindb_recover(btc_chaindb_t *db);
+
+static int
+btc_chaindb_flush(btc_chaindb_t *db);
+
 int
 btc_chaindb_open(btc_chaindb_t *db,
                  const char *prefix,
@@ -668,27 +905,150 @@ btc_chaindb_open(btc_chaindb_t *db,
   if (!btc_chaindb_load_index(db))
     return 0;
 
+  if (!btc_chaindb_recover(db))
+    return 0;
+
   return 1;
 }
 
 void
 btc_chaindb_close(btc_chaindb_t *db) {
+  /* Not fatal: the unflushed blocks are replayed on open. */
+  if (!btc_chaindb_flush(db))
+    fprintf(stderr, "Could not flush coins on close.\n");
+
   btc_chaindb_unload_index(db);
   btc_chaindb_unload_files(db);
   btc_chaindb_unload_database(db);
 }
 
+static int
+btc_chaindb_copy(const char *from, const char *to, uint64_t size) {
+  btc_fd_t rfd = btc_fs_open(from);
+  btc_fd_t wfd = BTC_INVALID_FD;
+  uint8_t buf[16384];
+  int64_t len = 0;
+  int ret = 0;
+
+  if (rfd == BTC_INVALID_FD)
+    return 0;
+
+  wfd = btc_fs_create(to);
+
+  if (wfd == BTC_INVALID_FD)
+    goto done;
+
+  while (size > 0) {
+    len = size < sizeof(buf) ? (int64_t)size : (int64_t)sizeof(buf);
+    len = btc_fs_read(rfd, buf, len);
+
+    if (len <= 0)
+      goto done;
+
+    if (btc_fs_write(wfd, buf, len) != len)
+      goto done;
+
+    size -= len;
+  }
+
+  ret = btc_fs_fsync(wfd);
+done:
+  if (wfd != BTC_INVALID_FD)
+    btc_fs_close(wfd);
+
+  btc_fs_close(rfd);
+
+  return ret;
+}
+
+int
+btc_chaindb_backup(btc_chaindb_t *db, const char *prefix) {
+  char from[BTC_PATH_MAX];
+  char to[BTC_PATH_MAX];
+  btc_chainfile_t *file;
+  uint64_t size;
+  int i;
+
+  if (strlen(prefix) + 1 > sizeof(db->prefix))
+    return 0;
+
+  /* Unlogged coins must reach the tables first. */
+  if (!btc_chaindb_flush(db))
+    return 0;
+
+  btc_fs_fsync(db->block.fd);
+  btc_fs_fsync(db->undo.fd);
+
+  if (!btc_fs_mkdir(prefix))
+    return 0;
+
+  if (!btc_path_join(to, sizeof(to), prefix, "blocks"))
+    return 0;
+
+  if (!btc_fs_mkdir(to))
+    return 0;
+
+  /* Finished files never change and are linked. */
+  for (file = db->files.head; file != NULL; file = file->next) {
+    btc_chaindb_path(db, from, file->type, file->id);
+    btc_chainfile_path(to, prefix, file->type, file->id);
+
+    if (btc_fs_link(from, to))
+      continue;
+
+    if (!btc_fs_size(from, &size))
+      return 0;
+
+    if (!btc_chaindb_copy(from, to, size))
+      return 0;
+  }
+
+  /* The ones being appended to are copied, so the
+     copy never writes to a file we share with it. */
+  for (i = 0; i < 2; i++) {
+    file = (i == 0 ? &db->block : &db->undo);
+
+    btc_chaindb_path(db, from, file->type, file->id);
+    btc_chainfile_path(to, prefix, file->type, file->id);
+
+    if (!btc_chaindb_copy(from, to, file->pos))
+      return 0;
+  }
+
+  if (!btc_path_join(to, sizeof(to), prefix, "chain"))
+    return 0;
+
+  return ldb_backup(db->lsm, to) == LDB_OK;
+}
+
+static const btc_coin_t *
+btc_chaindb_pending(btc_chaindb_t *db, const uint8_t *hash, size_t index) {
+  btc_outpoint_t prevout;
+
+  if (!db->txn.active)
+    return NULL;
+
+  btc_outpoint_set(&prevout, hash, index);
+
+  return btc_view_get(&db->txn.view, &prevout);
+}
+
 btc_coin_t *
 btc_chaindb_coin(btc_chaindb_t *db, const uint8_t *hash, size_t index) {
+  const btc_coin_t *pending = btc_chaindb_pending(db, hash, index);
   uint8_t kbuf[COIN_KEYLEN];
   ldb_slice_t key, val;
   btc_coin_t *coin;
   int rc;
 
+  /* Coins written by an open transaction. */
+  if (pending != NULL)
+    return pending->spent ? NULL : btc_coin_clone(pending);
+
   key.data = kbuf;
   key.size = coin_key(kbuf, hash, index);
 
-  rc = ldb_get(db->lsm, &key, &val, 0);
+  rc = ldb_get(db->coins, &key, &val, 0);
 
   if (rc == LDB_NOTFOUND)
     return NULL;
@@ -732,6 +1092,7 @@ btc_chaindb_save_view(btc_chaindb_t *db,
                       const btc_view_t *view) {
   uint8_t kbuf[COIN_KEYLEN];
   uint8_t *vbuf = db->slab;
+  btc_outpoint_t prevout;
   ldb_slice_t key, val;
   btc_mapiter_t i, j;
 
@@ -752,11 +1113,20 @@ btc_chaindb_save_view(btc_chaindb_t *db,
       coin_key(kbuf, hash, index);
 
       if (coin->spent) {
-        ldb_batch_del(batch, &key);
+        ldb_batch_del_family(batch, db->coins, &key);
+
+        db->unflushed += key.size;
       } else {
         val.size = btc_coin_export(vbuf, coin);
 
-        ldb_batch_put(batch, &key, &val);
+        ldb_batch_put_family(batch, db->coins, &key, &val);
+
+        db->unflushed += key.size + val.size;
+      }
+
+      if (db->txn.active) {
+        btc_outpoint_set(&prevout, hash, index);
+        btc_view_put(&db->txn.view, &prevout, btc_coin_clone(coin));
       }
     }
   }
@@ -861,6 +1231,182 @@ btc_chaindb_read_undo(btc_chaindb_t *db, const btc_entry_t *entry) {
   return undo;
 }
 
+/*
+ * Crash Recovery
+ */
+
+/* With BTC_CHAIN_NOWAL, coin updates from connected blocks skip the
+ * database log. The flush key names a main chain block through which
+ * the coins are known to be durable. It only moves forward once the
+ * coins memtable has been flushed. After an unclean shutdown, blocks
+ * past it are replayed from the block files. Replaying a block simply
+ * rewrites every coin it touches, so it does not matter which of the
+ * unlogged updates survived.
+ *
+ * Disconnections are rare and keep going through the log, moving the
+ * flush key back along with the tip when needed.
+ */
+
+static int
+btc_chaindb_flush(btc_chaindb_t *db) {
+  ldb_slice_t val;
+  int rc;
+
+  if (!(db->flags & BTC_CHAIN_NOWAL))
+    return 1;
+
+  if (db->flushed == db->tail)
+    return 1;
+
+  /* Replay must be able to read every block past the key. */
+  btc_fs_fsync(db->block.fd);
+  btc_fs_fsync(db->undo.fd);
+
+  rc = ldb_flush(db->coins);
+
+  if (rc == LDB_OK) {
+    val.data = db->tail->hash;
+    val.size = 32;
+
+    rc = ldb_put(db->lsm, &flush_key, &val, &sync_options);
+  }
+
+  if (rc != LDB_OK) {
+    fprintf(stderr, "ldb_flush: %s\n", ldb_strerror(rc));
+    return 0;
+  }
+
+  db->flushed = db->tail;
+  db->unflushed = 0;
+
+  return 1;
+}
+
+static int
+btc_chaindb_replay(btc_chaindb_t *db, const btc_entry_t *entry) {
+  const btc_input_t *input;
+  const btc_tx_t *tx;
+  btc_block_t *block;
+  ldb_batch_t batch;
+  btc_coin_t *coin;
+  btc_view_t *view;
+  size_t i, j;
+  int rc;
+
+  block = btc_chaindb_read_block(db, entry);
+
+  if (block == NULL) {
+    fprintf(stderr, "Cannot replay block at height %d.\n", entry->height);
+    return 0;
+  }
+
+  view = btc_view_create();
+
+  /* Spent coins need no lookup: they are deleted. */
+  for (i = 0; i < block->txs.length; i++) {
+    tx = block->txs.items[i];
+
+    if (i > 0) {
+      for (j = 0; j < tx->inputs.length; j++) {
+        input = tx->inputs.items[j];
+        coin = btc_coin_create();
+        coin->spent = 1;
+
+        btc_view_put(view, &input->prevout, coin);
+      }
+    }
+
+    btc_view_add(view, tx, entry->height, 0);
+  }
+
+  ldb_batch_init(&batch);
+
+  btc_chaindb_save_view(db, &batch, view);
+
+  rc = ldb_write(db->lsm, &batch, &nowal_options);
+
+  ldb_batch_clear(&batch);
+  btc_view_destroy(view);
+  btc_block_destroy(block);
+
+  if (rc != LDB_OK) {
+    fprintf(stderr, "ldb_write: %s\n", ldb_strerror(rc));
+    return 0;
+  }
+
+  return 1;
+}
+
+static int
+btc_chaindb_recover(btc_chaindb_t *db) {
+  const btc_entry_t *entry;
+  ldb_slice_t val;
+  int rc;
+
+  rc = ldb_get(db->lsm, &flush_key, &val, 0);
+
+  if (rc == LDB_NOTFOUND) {
+    entry = db->tail;
+  } else {
+    CHECK(rc == LDB_OK);
+    CHECK(val.size == 32);
+
+    entry = btc_hashmap_get(&db->hashes, val.data);
+
+    ldb_free(val.data);
+
+    CHECK(entry != NULL);
+    CHECK(btc_chaindb_is_main(db, entry));
+  }
+
+  /* Replayed coins are flushed below, whichever mode we are in. */
+  db->flushed = entry;
+  db->unflushed = 0;
+
+  for (entry = entry->next; entry != NULL; entry = entry->next) {
+    if (entry->height > 0 && !btc_chaindb_replay(db, entry))
+      return 0;
+  }
+
+  if (db->flags & BTC_CHAIN_NOWAL) {
+    if (rc == LDB_NOTFOUND) {
+      val.data = db->tail->hash;
+      val.size = 32;
+
+      rc = ldb_put(db->lsm, &flush_key, &val, &sync_options);
+
+      if (rc != LDB_OK) {
+        fprintf(stderr, "ldb_put: %s\n", ldb_strerror(rc));
+        return 0;
+      }
+    }
+
+    return btc_chaindb_flush(db);
+  }
+
+  if (rc == LDB_OK) {
+    if (db->flushed != db->tail) {
+      rc = ldb_flush(db->coins);
+
+      if (rc != LDB_OK) {
+        fprintf(stderr, "ldb_flush: %s\n", ldb_strerror(rc));
+        return 0;
+      }
+    }
+
+    rc = ldb_del(db->lsm, &flush_key, &sync_options);
+
+    if (rc != LDB_OK) {
+      fprintf(stderr, "ldb_del: %s\n", ldb_strerror(rc));
+      return 0;
+    }
+  }
+
+  db->flushed = NULL;
+
+  return 1;
+}
+
 static int
 should_sync(const btc_entry_t *entry) {
   if (entry->header.time >= btc_now() - 24 * 60 * 60)
@@ -1047,6 +1593,12 @@ btc_chaindb_prune_files(btc_chaindb_t *db,
   if (target <= db->network->block.prune_after_height)
     return 1;
 
+  /* Blocks past the flush key may still need replaying. */
+  if (db->flushed != NULL && db->flushed->height < target) {
+    if (!btc_chaindb_flush(db))
+      return 0;
+  }
+
   key.data = kbuf;
   key.size = sizeof(kbuf);
 
@@ -1075,6 +1627,7 @@ btc_chaindb_prune_files(btc_chaindb_t *db,
 static int
 btc_chaindb_connect_block(btc_chaindb_t *db,
                           ldb_batch_t *batch,
+                          ldb_batch_t *coins,
                           btc_entry_t *entry,
                           const btc_block_t *block,
                           const btc_view_t *view) {
@@ -1087,7 +1640,7 @@ btc_chaindb_connect_block(btc_chaindb_t *db,
     return 1;
 
   /* Commit new coin state. */
-  btc_chaindb_save_view(db, batch, view);
+  btc_chaindb_save_view(db, coins, view);
 
   /* Write undo coins (if there are any). */
   undo = &view->undo;
@@ -1101,23 +1654,39 @@ btc_chaindb_connect_block(btc_chaindb_t *db,
   return btc_chaindb_prune_files(db, batch, entry);
 }
 
+static void
+btc_chaindb_del_states(btc_chaindb_t *db,
+                       ldb_batch_t *batch,
+                       const btc_entry_t *entry) {
+  const btc_network_t *network = db->network;
+  uint8_t kbuf[STATE_KEYLEN];
+  ldb_slice_t key;
+  size_t i;
+
+  key.data = kbuf;
+  key.size = sizeof(kbuf);
+
+  for (i = 0; i < network->deployments.length; i++) {
+    const btc_deployment_t *deploy = &network->deployments.items[i];
+
+    state_key(kbuf, network, deploy, entry->hash);
+
+    ldb_batch_del(batch, &key);
+  }
+}
+
 static btc_view_t *
 btc_chaindb_disconnect_block(btc_chaindb_t *db,
                              ldb_batch_t *batch,
                              const btc_entry_t *entry,
-                             const btc_block_t *block) {
-  btc_undo_t *undo = btc_chaindb_read_undo(db, entry);
+                             const btc_block_t *block,
+                             btc_undo_t *undo) {
+  btc_view_t *view = btc_view_create();
   const btc_input_t *input;
   const btc_tx_t *tx;
   btc_coin_t *coin;
-  btc_view_t *view;
   size_t i, j;
 
-  if (undo == NULL)
-    return NULL;
-
-  view = btc_view_create();
-
   /* Disconnect all transactions. */
   for (i = block->txs.length - 1; i != (size_t)-1; i--) {
     tx = block->txs.items[i];
@@ -1149,6 +1718,7 @@ btc_chaindb_disconnect_block(btc_chaindb_t *db,
 static int
 btc_chaindb_save_block(btc_chaindb_t *db,
                        ldb_batch_t *batch,
+                       ldb_batch_t *coins,
                        btc_entry_t *entry,
                        const btc_block_t *block,
                        const btc_view_t *view) {
@@ -1161,7 +1731,27 @@ btc_chaindb_save_block(btc_chaindb_t *db,
   if (view == NULL)
     return 1;
 
-  return btc_chaindb_connect_block(db, batch, entry, block, view);
+  return btc_chaindb_connect_block(db, batch, coins, entry, block, view);
+}
+
+/* Coins may bypass the log (see btc_chaindb_flush). They are written
+   after the chain state so they never become durable ahead of it. */
+static ldb_batch_t *
+btc_chaindb_coin_batch(btc_chaindb_t *db, ldb_batch_t *batch,
+                                          ldb_batch_t *coins) {
+  if (!(db->flags & BTC_CHAIN_NOWAL))
+    return batch;
+
+  return coins;
+}
+
+static int
+btc_chaindb_write_coins(btc_chaindb_t *db, ldb_batch_t *batch,
+                                           ldb_batch_t *coins) {
+  if (coins == batch)
+    return 1;
+
+  return ldb_write(db->lsm, coins, &nowal_options) == LDB_OK;
 }
 
 int
@@ -1171,8 +1761,9 @@ btc_chaindb_save(btc_chaindb_t *db,
                  const btc_view_t *view) {
   uint8_t vbuf[BTC_ENTRY_SIZE];
   uint8_t kbuf[ENTRY_KEYLEN];
+  ldb_batch_t batch, coin_batch;
   ldb_slice_t key, val;
-  ldb_batch_t batch;
+  ldb_batch_t *coins;
   int ret = 0;
 
   /* Sanity checks. */
@@ -1181,9 +1772,12 @@ btc_chaindb_save(btc_chaindb_t *db,
 
   /* Begin transaction. */
   ldb_batch_init(&batch);
+  ldb_batch_init(&coin_batch);
+
+  coins = btc_chaindb_coin_batch(db, &batch, &coin_batch);
 
   /* Connect block and save data. */
-  if (!btc_chaindb_save_block(db, &batch, entry, block, view))
+  if (!btc_chaindb_save_block(db, &batch, coins, entry, block, view))
     goto fail;
 
   /* Write entry data. */
@@ -1223,6 +1817,9 @@ btc_chaindb_save(btc_chaindb_t *db,
   if (ldb_write(db->lsm, &batch, 0) != LDB_OK)
     goto fail;
 
+  if (!btc_chaindb_write_coins(db, &batch, coins))
+    goto fail;
+
   /* Update hashes. */
   CHECK(btc_hashmap_put(&db->hashes, entry->hash, entry));
 
@@ -1241,31 +1838,87 @@ btc_chaindb_save(btc_chaindb_t *db,
       db->head = entry;
 
     db->tail = entry;
+
+    if (db->unflushed >= db->flush_size) {
+      if (!btc_chaindb_flush(db))
+        goto fail;
+    }
   }
 
   ret = 1;
 fail:
+  ldb_batch_clear(&coin_batch);
   ldb_batch_clear(&batch);
   return ret;
 }
 
+/*
+ * Transactions
+ */
+
+/* A reorganization is applied as one write. Until it is committed,
+ * coins touched by the transaction are kept in a view which coin
+ * lookups consult before the database.
+ */
+
+void
+btc_chaindb_begin(btc_chaindb_t *db) {
+  CHECK(!db->txn.active);
+
+  ldb_batch_init(&db->txn.batch);
+  ldb_batch_init(&db->txn.coins);
+
+  db->txn.active = 1;
+}
+
+int
+btc_chaindb_commit(btc_chaindb_t *db) {
+  ldb_batch_t *batch = &db->txn.batch;
+  ldb_batch_t *coins;
+  int ret = 0;
+
+  CHECK(db->txn.active);
+
+  coins = btc_chaindb_coin_batch(db, batch, &db->txn.coins);
+
+  if (ldb_write(db->lsm, batch, 0) != LDB_OK)
+    goto fail;
+
+  if (!btc_chaindb_write_coins(db, batch, coins))
+    goto fail;
+
+  ret = 1;
+fail:
+  ldb_batch_clear(&db->txn.coins);
+  ldb_batch_clear(&db->txn.batch);
+  btc_view_reset(&db->txn.view);
+
+  db->txn.active = 0;
+
+  if (ret && db->unflushed >= db->flush_size)
+    ret = btc_chaindb_flush(db);
+
+  return ret;
+}
+
 int
 btc_chaindb_reconnect(btc_chaindb_t *db,
                       btc_entry_t *entry,
                       const btc_block_t *block,
                       const btc_view_t *view) {
+  ldb_batch_t *batch = &db->txn.batch;
   uint8_t vbuf[BTC_ENTRY_SIZE];
   uint8_t kbuf[ENTRY_KEYLEN];
   ldb_slice_t key, val;
-  ldb_batch_t batch;
-  int ret = 0;
+  ldb_batch_t *coins;
 
-  /* Begin transaction. */
-  ldb_batch_init(&batch);
+  CHECK(db->txn.active);
+
+  coins = btc_chaindb_coin_batch(db, batch, &db->txn.coins);
 
   /* Connect inputs. */
-  if (!btc_chaindb_connect_block(db, &batch, entry, block, view))
-    goto fail;
+  if (!btc_chaindb_connect_block(db, batch, coins, entry, block, view))
+    return 0;
 
   /* Re-write entry data (we may have updated the undo pos). */
   key.data = kbuf;
@@ -1274,17 +1927,13 @@ btc_chaindb_reconnect(btc_chaindb_t *db,
   val.data = vbuf;
   val.size = btc_entry_export(vbuf, entry);
 
-  ldb_batch_put(&batch, &key, &val);
+  ldb_batch_put(batch, &key, &val);
 
   /* Commit new chain state. */
   val.data = entry->hash;
   val.size = 32;
 
-  ldb_batch_put(&batch, &meta_key, &val);
-
-  /* Commit transaction. */
-  if (ldb_write(db->lsm, &batch, 0) != LDB_OK)
-    goto fail;
+  ldb_batch_put(batch, &meta_key, &val);
 
   /* Set next pointer. */
   CHECK(entry->prev != NULL);
@@ -1298,38 +1947,39 @@ btc_chaindb_reconnect(btc_chaindb_t *db,
   /* Update tip. */
   db->tail = entry;
 
-  ret = 1;
-fail:
-  ldb_batch_clear(&batch);
-  return ret;
+  return 1;
 }
 
 btc_view_t *
 btc_chaindb_disconnect(btc_chaindb_t *db,
                        btc_entry_t *entry,
-                       const btc_block_t *block) {
-  ldb_batch_t batch;
+                       const btc_block_t *block,
+                       btc_undo_t *undo) {
+  ldb_batch_t *batch = &db->txn.batch;
   btc_view_t *view;
   ldb_slice_t val;
 
-  /* Begin transaction. */
-  ldb_batch_init(&batch);
+  CHECK(db->txn.active);
 
   /* Disconnect inputs. */
-  view = btc_chaindb_disconnect_block(db, &batch, entry, block);
+  view = btc_chaindb_disconnect_block(db, batch, entry, block, undo);
 
-  if (view == NULL)
-    goto fail;
+  /* Forget any deployment states computed at this block. */
+  btc_chaindb_del_states(db, batch, entry);
 
   /* Revert chain state to previous tip. */
   val.data = entry->header.prev_block;
   val.size = 32;
 
-  ldb_batch_put(&batch, &meta_key, &val);
+  ldb_batch_put(batch, &meta_key, &val);
 
-  /* Commit transaction. */
-  if (ldb_write(db->lsm, &batch, 0) != LDB_OK)
-    goto fail;
+  /* Disconnections always go through the log. Coins flushed
+     through this block are now flushed through its parent. */
+  if (db->flushed == entry) {
+    ldb_batch_put(batch, &flush_key, &val);
+
+    db->flushed = entry->prev;
+  }
 
   /* Set next pointer. */
   CHECK(entry->prev != NULL);
@@ -1342,16 +1992,168 @@ btc_chaindb_disconnect(btc_chaindb_t *db,
   /* Revert tip. */
   db->tail = entry->prev;
 
-  ldb_batch_clear(&batch);
-
   return view;
-fail:
-  if (view != NULL)
-    btc_view_destroy(view);
+}
 
-  ldb_batch_clear(&batch);
+/* Orphans are kept in the database rather than the block files
+   so that the space is reclaimed when they are removed. The record
+   holds the entry followed by the block. */
+
+int
+btc_chaindb_save_orphan(btc_chaindb_t *db,
+                        const btc_entry_t *entry,
+                        const btc_block_t *block) {
+  uint8_t kbuf[ORPHAN_KEYLEN];
+  ldb_slice_t key, val;
+  uint8_t *vbuf;
+  size_t len;
+  int rc;
+
+  CHECK(entry->status & BTC_ENTRY_ORPHAN);
+
+  vbuf = btc_malloc(BTC_ENTRY_SIZE + btc_block_size(block));
 
-  return NULL;
+  len = btc_entry_export(vbuf, entry);
+  len += btc_block_export(vbuf + len, block);
+
+  key.data = kbuf;
+  key.size = orphan_key(kbuf, entry->hash);
+
+  val.data = vbuf;
+  val.size = len;
+
+  rc = ldb_put(db->lsm, &key, &val, 0);
+
+  btc_free(vbuf);
+
+  return rc == LDB_OK;
+}
+
+btc_block_t *
+btc_chaindb_get_orphan(btc_chaindb_t *db, const btc_entry_t *entry) {
+  uint8_t kbuf[ORPHAN_KEYLEN];
+  btc_block_t *block = NULL;
+  ldb_slice_t key, val;
+
+  key.data = kbuf;
+  key.size = orphan_key(kbuf, entry->hash);
+
+  if (ldb_get(db->lsm, &key, &val, 0) != LDB_OK)
+    return NULL;
+
+  if (val.size > BTC_ENTRY_SIZE) {
+    block = btc_block_decode((uint8_t *)val.data + BTC_ENTRY_SIZE,
+                             val.size - BTC_ENTRY_SIZE);
+  }
+
+  ldb_free(val.data);
+
+  return block;
+}
+
+int
+btc_chaindb_remove_orphan(btc_chaindb_t *db, const btc_entry_t *entry) {
+  uint8_t kbuf[ORPHAN_KEYLEN];
+  ldb_slice_t key;
+
+  key.data = kbuf;
+  key.size = orphan_key(kbuf, entry->hash);
+
+  return ldb_del(db->lsm, &key, 0) == LDB_OK;
+}
+
+void
+btc_chaindb_orphans(btc_chaindb_t *db, btc_vector_t *entries) {
+  btc_entry_t *entry;
+  ldb_slice_t val;
+  ldb_iter_t *it;
+
+  it = ldb_iterator(db->lsm, 0);
+
+  ldb_iter_range(it, &orphan_min, &orphan_max) {
+    entry = btc_entry_create();
+    val = ldb_iter_value(it);
+
+    CHECK(val.size > BTC_ENTRY_SIZE);
+    CHECK(btc_entry_import(entry, val.data, BTC_ENTRY_SIZE));
+
+    btc_vector_push(entries, entry);
+  }
+
+  CHECK(ldb_iter_status(it) == LDB_OK);
+
+  ldb_iter_destroy(it);
+}
+
+int
+btc_chaindb_update(btc_chaindb_t *db, const btc_entry_t *entry) {
+  uint8_t vbuf[BTC_ENTRY_SIZE];
+  uint8_t kbuf[ENTRY_KEYLEN];
+  ldb_slice_t key, val;
+
+  key.data = kbuf;
+  key.size = entry_key(kbuf, entry->hash);
+
+  val.data = vbuf;
+  val.size = btc_entry_export(vbuf, entry);
+
+  return ldb_put(db->lsm, &key, &val, 0) == LDB_OK;
+}
+
+int
+btc_chaindb_get_state(btc_chaindb_t *db,
+                      const btc_deployment_t *deploy,
+                      const btc_entry_t *entry) {
+  uint8_t kbuf[STATE_KEYLEN];
+  ldb_slice_t key, val;
+  int rc, state;
+
+  key.data = kbuf;
+  key.size = state_key(kbuf, db->network, deploy, entry->hash);
+
+  rc = ldb_get(db->lsm, &key, &val, 0);
+
+  if (rc == LDB_NOTFOUND)
+    return -1;
+
+  CHECK(rc == LDB_OK);
+  CHECK(val.size == 1);
+
+  state = ((uint8_t *)val.data)[0];
+
+  ldb_free(val.data);
+
+  return state;
+}
+
+int
+btc_chaindb_put_state(btc_chaindb_t *db,
+                      const btc_deployment_t *deploy,
+                      const btc_entry_t *entry,
+                      int state) {
+  uint8_t kbuf[STATE_KEYLEN];
+  uint8_t vbuf[1];
+  ldb_slice_t key, val;
+
+  key.data = kbuf;
+  key.size = state_key(kbuf, db->network, deploy, entry->hash);
+
+  vbuf[0] = state;
+
+  val.data = vbuf;
+  val.size = 1;
+
+  return ldb_put(db->lsm, &key, &val, 0) == LDB_OK;
+}
+
+void
+btc_chaindb_entries(btc_chaindb_t *db, btc_vector_t *entries) {
+  btc_mapiter_t it;
+
+  btc_vector_grow(entries, entries->length + db->hashes.size);
+
+  btc_map_each(&db->hashes, it)
+    btc_vector_push(entries, db->hashes.vals[it]);
 }
 
 const btc_entry_t *
@@ -1382,6 +2184,29 @@ btc_chaindb_by_height(btc_chaindb_t *db, int32_t height) {
   return (btc_entry_t *)db->heights.items[height];
 }
 
+const btc_entry_t *
+btc_chaindb_by_time(btc_chaindb_t *db, int64_t time) {
+  /* Block times are not monotonic, but their running
+     maximum is. Find the first entry to reach `time`. */
+  size_t lo = 0;
+  size_t hi = db->heights.length;
+
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    const btc_entry_t *entry = db->heights.items[mid];
+
+    if (entry->max_time < time)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo == db->heights.length)
+    return NULL;
+
+  return (btc_entry_t *)db->heights.items[lo];
+}
+
 int
 btc_chaindb_is_main(btc_chaindb_t *db, const btc_entry_t *entry) {
   if ((size_t)entry->height >= db->heights.length)
@@ -1401,9 +2226,18 @@ btc_chaindb_has_coins(btc_chaindb_t *db, const btc_tx_t *tx) {
   key.size = sizeof(kbuf);
 
   for (i = 0; i < tx->outputs.length; i++) {
+    const btc_coin_t *pending = btc_chaindb_pending(db, tx->hash, i);
+
+    if (pending != NULL) {
+      if (!pending->spent)
+        return 1;
+
+      continue;
+    }
+
     coin_key(kbuf, tx->hash, i);
 
-    rc = ldb_has(db->lsm, &key, 0);
+    rc = ldb_has(db->coins, &key, 0);
 
     if (rc == LDB_OK)
       return 1;
@@ -1432,6 +2266,11 @@ btc_chaindb_get_raw_block(btc_chaindb_t *db,
 
 }
 
+btc_undo_t *
+btc_chaindb_get_undo_coins(btc_chaindb_t *db, const btc_entry_t *entry) {
+  return btc_chaindb_read_undo(db, entry);
+}
+
 btc_view_t *
 btc_chaindb_get_undo(btc_chaindb_t *db,
                      const btc_entry_t *entry,
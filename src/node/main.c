@@ -40,14 +40,18 @@ static const char *node_args[] = {
   "-daemon=",
   "-datadir=",
   "-dbcache=",
+  "-dbchainwal=",
+  "-dbratelimit=",
   "-disablewallet=",
   "-discover=",
   "-externalip=",
   "-listen=",
   "-loglevel=",
+  "-maxblockrelay=",
   "-maxconnections=",
   "-maxinbound=",
   "-maxoutbound=",
+  "-mempoolfullrbf=",
   "-networkactive=",
   "-onion=",
   "-onlynet=",
@@ -101,6 +105,7 @@ set_config(btc_node_t *node, const btc_conf_t *conf) {
 
   btc_chain_set_threads(node->chain, conf->workers);
   btc_chain_set_cache(node->chain, (size_t)conf->cache_size << 20);
+  btc_chain_set_rate_limit(node->chain, (size_t)conf->rate_limit << 20);
 
   btc_pool_set_port(node->pool, conf->port);
 
@@ -116,6 +121,7 @@ set_config(btc_node_t *node, const btc_conf_t *conf) {
   btc_pool_set_proxy(node->pool, &conf->proxy);
   btc_pool_set_maxinbound(node->pool, conf->max_inbound);
   btc_pool_set_maxoutbound(node->pool, conf->max_outbound);
+  btc_pool_set_maxblockrelay(node->pool, conf->max_block_relay);
   btc_pool_set_bantime(node->pool, conf->ban_time);
   btc_pool_set_onlynet(node->pool, conf->only_net);
 
@@ -137,6 +143,12 @@ get_node_flags(const btc_conf_t *conf) {
   if (conf->prune)
     flags |= BTC_CHAIN_PRUNE;
 
+  if (!conf->chain_wal)
+    flags |= BTC_CHAIN_NOWAL;
+
+  if (conf->full_rbf)
+    flags |= BTC_MEMPOOL_FULLRBF;
+
   if (conf->listen)
     flags |= BTC_POOL_LISTEN;
 
@@ -4,6 +4,7 @@
  * https://github.com/chjj/mako
  */
 
+#include <math.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -88,6 +89,9 @@ btc_mpentry_init(btc_mpentry_t *entry) {
   entry->locks = 0;
   entry->desc_fee = 0;
   entry->desc_size = 0;
+  entry->anc_fee = 0;
+  entry->anc_size = 0;
+  entry->anc_count = 0;
 }
 
 static void
@@ -113,6 +117,9 @@ btc_mpentry_copy(btc_mpentry_t *z, const btc_mpentry_t *x) {
   z->locks = x->locks;
   z->desc_fee = x->desc_fee;
   z->desc_size = x->desc_size;
+  z->anc_fee = x->anc_fee;
+  z->anc_size = x->anc_size;
+  z->anc_count = x->anc_count;
 }
 
 static void
@@ -154,6 +161,9 @@ btc_mpentry_set(btc_mpentry_t *entry,
   entry->locks = locks;
   entry->desc_fee = fee;
   entry->desc_size = size;
+  entry->anc_fee = fee;
+  entry->anc_size = size;
+  entry->anc_count = 1;
 }
 
 static size_t
@@ -218,11 +228,15 @@ struct btc_mempool_s {
   const btc_timedata_t *timedata;
   btc_chain_t *chain;
   size_t size;
+  size_t max_size;
   btc_hashmap_t map;
   btc_hashmap_t waiting;
   btc_hashmap_t orphans;
   btc_outmap_t spents;
   btc_filter_t rejects;
+  double min_rate;
+  int64_t min_time;
+  int min_decay;
   btc_verify_error_t error;
   unsigned int flags;
   char file[BTC_PATH_MAX];
@@ -241,6 +255,7 @@ btc_mempool_create(const btc_network_t *network, btc_chain_t *chain) {
 
   mp->network = network;
   mp->chain = chain;
+  mp->max_size = BTC_MEMPOOL_MAX_SIZE;
 
   btc_hashmap_init(&mp->map);
   btc_hashmap_init(&mp->waiting); /* orphan prevout hashes */
@@ -290,6 +305,11 @@ btc_mempool_set_timedata(btc_mempool_t *mp, const btc_timedata_t *td) {
   mp->timedata = td;
 }
 
+void
+btc_mempool_set_max_size(btc_mempool_t *mp, size_t size) {
+  mp->max_size = size;
+}
+
 void
 btc_mempool_on_tx(btc_mempool_t *mp, btc_mempool_tx_cb *handler) {
   mp->on_tx = handler;
@@ -649,8 +669,22 @@ add_fee(btc_mpentry_t *parent, const btc_mpentry_t *child) {
 
 static void
 remove_fee(btc_mpentry_t *parent, const btc_mpentry_t *child) {
-  parent->desc_fee -= child->desc_fee;
-  parent->desc_size -= child->desc_size;
+  parent->desc_fee -= child->delta_fee;
+  parent->desc_size -= child->size;
+}
+
+static void
+add_ancestor(btc_mpentry_t *child, const btc_mpentry_t *parent) {
+  child->anc_fee += parent->delta_fee;
+  child->anc_size += parent->size;
+  child->anc_count += 1;
+}
+
+static void
+remove_ancestor(btc_mpentry_t *child, const btc_mpentry_t *parent) {
+  child->anc_fee -= parent->delta_fee;
+  child->anc_size -= parent->size;
+  child->anc_count -= 1;
 }
 
 BTC_UNUSED static void
@@ -663,65 +697,175 @@ postprioritise(btc_mpentry_t *parent, const btc_mpentry_t *child) {
   parent->desc_fee += child->delta_fee;
 }
 
-static size_t
-traverse_ancestors(btc_mempool_t *mp,
-                   const btc_mpentry_t *entry,
-                   btc_hashset_t *set,
-                   const btc_mpentry_t *child,
-                   void (*map)(btc_mpentry_t *,
-                               const btc_mpentry_t *)) {
+static void
+push_parents(btc_vector_t *out,
+             btc_hashset_t *set,
+             btc_mempool_t *mp,
+             const btc_mpentry_t *entry) {
   const btc_tx_t *tx = entry->tx;
   size_t i;
 
   for (i = 0; i < tx->inputs.length; i++) {
     const btc_input_t *input = tx->inputs.items[i];
-    const btc_outpoint_t *prevout = &input->prevout;
-    btc_mpentry_t *parent = btc_hashmap_get(&mp->map, prevout->hash);
+    btc_mpentry_t *parent = btc_hashmap_get(&mp->map, input->prevout.hash);
 
     if (parent == NULL)
       continue;
 
-    if (btc_hashset_has(set, parent->hash))
-      continue;
+    if (btc_hashset_put(set, parent->hash))
+      btc_vector_push(out, parent);
+  }
+}
 
-    btc_hashset_put(set, parent->hash);
+static void
+push_spenders(btc_vector_t *out,
+              btc_hashset_t *set,
+              btc_mempool_t *mp,
+              const btc_mpentry_t *entry) {
+  btc_mpentry_t *spender;
+  btc_outpoint_t prevout;
+  size_t i;
 
-    if (map != NULL)
-      map(parent, child);
+  for (i = 0; i < entry->tx->outputs.length; i++) {
+    btc_outpoint_set(&prevout, entry->hash, i);
 
-    if (set->size > BTC_MEMPOOL_MAX_ANCESTORS)
-      break;
+    spender = btc_outmap_get(&mp->spents, &prevout);
 
-    traverse_ancestors(mp, parent, set, child, map);
+    if (spender == NULL)
+      continue;
 
-    if (set->size > BTC_MEMPOOL_MAX_ANCESTORS)
-      break;
+    if (btc_hashset_put(set, spender->hash))
+      btc_vector_push(out, spender);
   }
+}
+
+static void
+btc_mempool_ancestors(btc_vector_t *out,
+                      btc_mempool_t *mp,
+                      const btc_mpentry_t *entry,
+                      size_t limit) {
+  btc_hashset_t set;
+  size_t i;
 
-  return set->size;
+  btc_hashset_init(&set);
+
+  push_parents(out, &set, mp, entry);
+
+  /* Breadth-first: the output doubles as our queue. */
+  for (i = 0; i < out->length && out->length <= limit; i++)
+    push_parents(out, &set, mp, out->items[i]);
+
+  btc_hashset_clear(&set);
 }
 
-static size_t
-btc_mempool_update_ancestors(btc_mempool_t *mp,
-                             const btc_mpentry_t *entry,
-                             void (*map)(btc_mpentry_t *,
-                                         const btc_mpentry_t *)) {
+static void
+btc_mempool_descendants(btc_vector_t *out,
+                        btc_mempool_t *mp,
+                        const btc_mpentry_t *entry) {
   btc_hashset_t set;
-  size_t count;
+  size_t i;
 
   btc_hashset_init(&set);
 
-  count = traverse_ancestors(mp, entry, &set, entry, map);
+  push_spenders(out, &set, mp, entry);
+
+  for (i = 0; i < out->length; i++)
+    push_spenders(out, &set, mp, out->items[i]);
 
   btc_hashset_clear(&set);
+}
+
+static void
+btc_mempool_refresh_entry(btc_mempool_t *mp, btc_mpentry_t *entry) {
+  btc_vector_t items;
+  size_t i;
+
+  btc_vector_init(&items);
+
+  entry->anc_fee = entry->delta_fee;
+  entry->anc_size = entry->size;
+  entry->anc_count = 1;
+
+  btc_mempool_ancestors(&items, mp, entry, (size_t)-1);
 
-  return count;
+  for (i = 0; i < items.length; i++)
+    add_ancestor(entry, items.items[i]);
+
+  btc_vector_reset(&items);
+
+  entry->desc_fee = entry->delta_fee;
+  entry->desc_size = entry->size;
+
+  btc_mempool_descendants(&items, mp, entry);
+
+  for (i = 0; i < items.length; i++)
+    add_fee(entry, items.items[i]);
+
+  btc_vector_clear(&items);
 }
 
-static size_t
-btc_mempool_count_ancestors(btc_mempool_t *mp,
-                            const btc_mpentry_t *entry) {
-  return btc_mempool_update_ancestors(mp, entry, NULL);
+static void
+btc_mempool_link_entry(btc_mempool_t *mp, btc_mpentry_t *entry) {
+  btc_vector_t ancs, descs;
+  size_t i;
+
+  btc_vector_init(&ancs);
+  btc_vector_init(&descs);
+
+  btc_mempool_ancestors(&ancs, mp, entry, (size_t)-1);
+  btc_mempool_descendants(&descs, mp, entry);
+
+  if (descs.length == 0) {
+    /* The common case: a new leaf. Its ancestors
+       each gain exactly one descendant (itself). */
+    for (i = 0; i < ancs.length; i++) {
+      btc_mpentry_t *parent = ancs.items[i];
+
+      add_ancestor(entry, parent);
+      add_fee(parent, entry);
+    }
+  } else {
+    /* A reorg resurrected a transaction which already
+       has spenders in the mempool. Some of our ancestors
+       may already be theirs, so recompute everyone whose
+       package changed rather than risk double-counting. */
+    btc_mempool_refresh_entry(mp, entry);
+
+    for (i = 0; i < ancs.length; i++)
+      btc_mempool_refresh_entry(mp, ancs.items[i]);
+
+    for (i = 0; i < descs.length; i++)
+      btc_mempool_refresh_entry(mp, descs.items[i]);
+  }
+
+  btc_vector_clear(&ancs);
+  btc_vector_clear(&descs);
+}
+
+static void
+btc_mempool_unlink_entry(btc_mempool_t *mp, const btc_mpentry_t *entry) {
+  btc_vector_t items;
+  size_t i;
+
+  btc_vector_init(&items);
+
+  if (entry->anc_count > 1) {
+    btc_mempool_ancestors(&items, mp, entry, (size_t)-1);
+
+    for (i = 0; i < items.length; i++)
+      remove_fee(items.items[i], entry);
+
+    btc_vector_reset(&items);
+  }
+
+  if (entry->desc_size > entry->size) {
+    btc_mempool_descendants(&items, mp, entry);
+
+    for (i = 0; i < items.length; i++)
+      remove_ancestor(items.items[i], entry);
+  }
+
+  btc_vector_clear(&items);
 }
 
 static int
@@ -768,7 +912,7 @@ btc_mempool_add_entry(btc_mempool_t *mp,
                       btc_mpentry_t *entry,
                       const btc_view_t *view) {
   btc_mempool_track_entry(mp, entry);
-  btc_mempool_update_ancestors(mp, entry, add_fee);
+  btc_mempool_link_entry(mp, entry);
 
   if (mp->on_tx != NULL)
     mp->on_tx(entry, view, mp->arg);
@@ -799,35 +943,28 @@ btc_mempool_untrack_entry(btc_mempool_t *mp,
 
 static void
 btc_mempool_remove_entry(btc_mempool_t *mp, btc_mpentry_t *entry) {
+  btc_mempool_unlink_entry(mp, entry);
   btc_mempool_untrack_entry(mp, entry);
   btc_mpentry_destroy(entry);
 }
 
 static void
-btc_mempool_remove_spenders(btc_mempool_t *mp,
-                            const btc_mpentry_t *entry) {
-  btc_mpentry_t *spender;
-  btc_outpoint_t prevout;
+btc_mempool_evict_entry(btc_mempool_t *mp, btc_mpentry_t *entry) {
+  btc_vector_t items;
   size_t i;
 
-  for (i = 0; i < entry->tx->outputs.length; i++) {
-    btc_outpoint_set(&prevout, entry->hash, i);
-
-    spender = btc_outmap_get(&mp->spents, &prevout);
+  btc_vector_init(&items);
 
-    if (spender == NULL)
-      continue;
+  btc_mempool_descendants(&items, mp, entry);
 
-    btc_mempool_remove_spenders(mp, spender);
-    btc_mempool_remove_entry(mp, spender);
-  }
-}
+  /* Remove the deepest spenders first so that
+     fewer packages need their totals adjusted. */
+  for (i = items.length - 1; i != (size_t)-1; i--)
+    btc_mempool_remove_entry(mp, items.items[i]);
 
-static void
-btc_mempool_evict_entry(btc_mempool_t *mp, btc_mpentry_t *entry) {
-  btc_mempool_remove_spenders(mp, entry);
-  btc_mempool_update_ancestors(mp, entry, remove_fee);
   btc_mempool_remove_entry(mp, entry);
+
+  btc_vector_clear(&items);
 }
 
 static void
@@ -901,13 +1038,35 @@ cmp_rate(const void *ap, const void *bp) {
   return BTC_CMP(x, y);
 }
 
+static void
+btc_mempool_bump_rate(btc_mempool_t *mp, const btc_mpentry_t *entry) {
+  int64_t fee = entry->delta_fee;
+  int64_t size = entry->size;
+  int64_t rate;
+
+  if (use_desc(entry)) {
+    fee = entry->desc_fee;
+    size = entry->desc_size;
+  }
+
+  /* Anything replacing the evicted package must
+     also pay for its own relay at the minimum. */
+  rate = btc_get_rate(fee < 0 ? 0 : fee, size) + mp->network->min_relay;
+
+  if ((double)rate > mp->min_rate) {
+    mp->min_rate = rate;
+    mp->min_time = btc_timedata_now(mp->timedata);
+    mp->min_decay = 0;
+  }
+}
+
 static int
 btc_mempool_limit_size(btc_mempool_t *mp, const uint8_t *added) {
   btc_vector_t queue;
   btc_mapiter_t it;
   int64_t now;
 
-  if (mp->size <= BTC_MEMPOOL_MAX_SIZE)
+  if (mp->size <= mp->max_size)
     return 0;
 
   now = btc_now();
@@ -932,12 +1091,14 @@ btc_mempool_limit_size(btc_mempool_t *mp, const uint8_t *added) {
     btc_heap_insert(&queue, entry, cmp_rate);
   }
 
-  while (queue.length > 0 && mp->size > BTC_MEMPOOL_THRESHOLD) {
+  /* Trim to 90% so that we are not evicting on every insertion. */
+  while (queue.length > 0 && mp->size > mp->max_size - mp->max_size / 10) {
     btc_mpentry_t *entry = btc_heap_shift(&queue, cmp_rate);
 
     btc_log_debug(mp, "Removing package %H from mempool (low fee).",
                       entry->hash);
 
+    btc_mempool_bump_rate(mp, entry);
     btc_mempool_evict_entry(mp, entry);
   }
 
@@ -946,6 +1107,214 @@ btc_mempool_limit_size(btc_mempool_t *mp, const uint8_t *added) {
   return !btc_hashmap_has(&mp->map, added);
 }
 
+/*
+ * Replace-by-fee
+ */
+
+typedef struct btc_replace_s {
+  btc_vector_t conflicts;
+  btc_hashset_t set;
+  int64_t fee;
+  size_t size;
+} btc_replace_t;
+
+static void
+btc_replace_init(btc_replace_t *rep) {
+  btc_vector_init(&rep->conflicts);
+  btc_hashset_init(&rep->set);
+  rep->fee = 0;
+  rep->size = 0;
+}
+
+static void
+btc_replace_clear(btc_replace_t *rep) {
+  btc_vector_clear(&rep->conflicts);
+  btc_hashset_clear(&rep->set);
+}
+
+static int
+btc_replace_add(btc_replace_t *rep, const btc_mpentry_t *entry) {
+  if (!btc_hashset_put(&rep->set, entry->hash))
+    return 0;
+
+  rep->fee += entry->delta_fee;
+  rep->size += entry->size;
+
+  return 1;
+}
+
+static int
+btc_replace_spends(const btc_replace_t *rep, const uint8_t *hash) {
+  size_t i, j;
+
+  for (i = 0; i < rep->conflicts.length; i++) {
+    const btc_mpentry_t *entry = rep->conflicts.items[i];
+    const btc_tx_t *tx = entry->tx;
+
+    for (j = 0; j < tx->inputs.length; j++) {
+      const btc_input_t *input = tx->inputs.items[j];
+
+      if (btc_hash_equal(input->prevout.hash, hash))
+        return 1;
+    }
+  }
+
+  return 0;
+}
+
+static int
+btc_replace_descendants(btc_replace_t *rep, btc_mempool_t *mp) {
+  btc_vector_t queue;
+  size_t i;
+
+  btc_vector_init(&queue);
+  btc_vector_copy(&queue, &rep->conflicts);
+
+  for (i = 0; i < queue.length; i++) {
+    if (rep->set.size > BTC_MEMPOOL_MAX_REPLACEMENTS)
+      break;
+
+    push_spenders(&queue, &rep->set, mp, queue.items[i]);
+  }
+
+  for (i = rep->conflicts.length; i < queue.length; i++) {
+    const btc_mpentry_t *entry = queue.items[i];
+
+    rep->fee += entry->delta_fee;
+    rep->size += entry->size;
+  }
+
+  btc_vector_clear(&queue);
+
+  return rep->set.size <= BTC_MEMPOOL_MAX_REPLACEMENTS;
+}
+
+static int
+btc_mempool_check_replace(btc_mempool_t *mp,
+                          const btc_mpentry_t *entry,
+                          btc_replace_t *rep) {
+  const btc_tx_t *tx = entry->tx;
+  int64_t minfee;
+  size_t i;
+
+  /* Gather the directly conflicting transactions. */
+  for (i = 0; i < tx->inputs.length; i++) {
+    const btc_input_t *input = tx->inputs.items[i];
+    btc_mpentry_t *spent = btc_outmap_get(&mp->spents, &input->prevout);
+
+    if (spent == NULL)
+      continue;
+
+    if (btc_replace_add(rep, spent))
+      btc_vector_push(&rep->conflicts, spent);
+  }
+
+  /* Every conflict must opt in unless we are running full-rbf. */
+  if (!(mp->flags & BTC_MEMPOOL_FULLRBF)) {
+    for (i = 0; i < rep->conflicts.length; i++) {
+      const btc_mpentry_t *spent = rep->conflicts.items[i];
+
+      if (!btc_tx_is_rbf(spent->tx)) {
+        return btc_mempool_throw(mp, tx,
+                                 BTC_REJECT_DUPLICATE,
+                                 "bad-txns-inputs-spent",
+                                 0,
+                                 0);
+      }
+    }
+  }
+
+  /* The replacement must pay a higher feerate than
+     each of the transactions it directly replaces. */
+  for (i = 0; i < rep->conflicts.length; i++) {
+    const btc_mpentry_t *spent = rep->conflicts.items[i];
+    int64_t x = entry->delta_fee * (int64_t)spent->size;
+    int64_t y = spent->delta_fee * (int64_t)entry->size;
+
+    if (x <= y) {
+      return btc_mempool_throw(mp, tx,
+                               BTC_REJECT_INSUFFICIENTFEE,
+                               "insufficient fee",
+                               0,
+                               0);
+    }
+  }
+
+  /* Collect all descendants which would be evicted. */
+  if (!btc_replace_descendants(rep, mp)) {
+    return btc_mempool_throw(mp, tx,
+                             BTC_REJECT_NONSTANDARD,
+                             "too many potential replacements",
+                             0,
+                             0);
+  }
+
+  for (i = 0; i < tx->inputs.length; i++) {
+    const btc_input_t *input = tx->inputs.items[i];
+    const uint8_t *hash = input->prevout.hash;
+
+    /* The replacement cannot spend anything it evicts. */
+    if (btc_hashset_has(&rep->set, hash)) {
+      return btc_mempool_throw(mp, tx,
+                               BTC_REJECT_INVALID,
+                               "bad-txns-spends-conflicting-tx",
+                               10,
+                               0);
+    }
+
+    /* Nor can it introduce new unconfirmed inputs. */
+    if (btc_hashmap_has(&mp->map, hash) && !btc_replace_spends(rep, hash)) {
+      return btc_mempool_throw(mp, tx,
+                               BTC_REJECT_NONSTANDARD,
+                               "replacement-adds-unconfirmed",
+                               0,
+                               0);
+    }
+  }
+
+  /* It must pay for everything it evicts, plus
+     its own relay bandwidth at the minimum rate. */
+  minfee = btc_get_fee(mp->network->min_relay, entry->size);
+
+  if (entry->delta_fee < rep->fee + minfee) {
+    return btc_mempool_throw(mp, tx,
+                             BTC_REJECT_INSUFFICIENTFEE,
+                             "insufficient fee",
+                             0,
+                             0);
+  }
+
+  return 1;
+}
+
+static void
+btc_mempool_replace(btc_mempool_t *mp, const btc_replace_t *rep) {
+  uint8_t *hashes = btc_malloc(rep->conflicts.length * 32 + 1);
+  btc_mpentry_t *entry;
+  size_t i;
+
+  /* Evicting one conflict may evict another
+     (if it is a descendant), so we must
+     copy the hashes and look them up again. */
+  for (i = 0; i < rep->conflicts.length; i++) {
+    entry = rep->conflicts.items[i];
+    btc_hash_copy(hashes + i * 32, entry->hash);
+  }
+
+  for (i = 0; i < rep->conflicts.length; i++) {
+    entry = btc_hashmap_get(&mp->map, hashes + i * 32);
+
+    if (entry == NULL)
+      continue;
+
+    btc_log_debug(mp, "Replacing %H in mempool (rbf).", entry->hash);
+
+    btc_mempool_evict_entry(mp, entry);
+  }
+
+  btc_free(hashes);
+}
+
 /*
  * TX Handling
  */
@@ -987,8 +1356,10 @@ btc_mempool_verify(btc_mempool_t *mp,
   const btc_deployment_state_t *state = btc_chain_state(mp->chain);
   const btc_entry_t *tip = btc_chain_tip(mp->chain);
   const btc_tx_t *tx = entry->tx;
+  btc_vector_t ancs;
   unsigned int flags;
   int64_t minfee;
+  size_t count;
 
   /* Verify sequence locks. */
   if (!btc_chain_verify_locks(mp->chain, tip, tx, view, lock_flags)) {
@@ -1050,7 +1421,15 @@ btc_mempool_verify(btc_mempool_t *mp,
   }
 
   /* Check ancestor depth. */
-  if (btc_mempool_count_ancestors(mp, entry) + 1 > BTC_MEMPOOL_MAX_ANCESTORS) {
+  btc_vector_init(&ancs);
+
+  btc_mempool_ancestors(&ancs, mp, entry, BTC_MEMPOOL_MAX_ANCESTORS - 1);
+
+  count = ancs.length;
+
+  btc_vector_clear(&ancs);
+
+  if (count + 1 > BTC_MEMPOOL_MAX_ANCESTORS) {
     return btc_mempool_throw(mp, tx,
                              BTC_REJECT_NONSTANDARD,
                              "too-long-mempool-chain",
@@ -1103,8 +1482,10 @@ btc_mempool_insert(btc_mempool_t *mp, const btc_tx_t *tx, unsigned int id) {
   int32_t height = tip->height;
   btc_verify_error_t err;
   btc_mpentry_t *entry;
+  btc_replace_t rep;
   btc_view_t *view;
   int64_t fee;
+  int replace;
 
   /* Basic sanity checks. */
   if (!btc_tx_check_sanity(&err, tx)) {
@@ -1190,22 +1571,9 @@ btc_mempool_insert(btc_mempool_t *mp, const btc_tx_t *tx, unsigned int id) {
 
   /* Quick and dirty test to verify we're
      not double-spending an output in the
-     mempool. */
-  if (btc_mempool_is_double_spend(mp, tx)) {
-    if (btc_tx_is_rbf(tx)) {
-      return btc_mempool_fail(mp, tx,
-                              BTC_REJECT_DUPLICATE,
-                              "replace-by-fee",
-                              0,
-                              0);
-    }
-
-    return btc_mempool_throw(mp, tx,
-                             BTC_REJECT_DUPLICATE,
-                             "bad-txns-inputs-spent",
-                             0,
-                             0);
-  }
+     mempool. If we are, the transaction
+     may be a replacement (bip125). */
+  replace = btc_mempool_is_double_spend(mp, tx);
 
   /* Get coin viewpoint as it pertains to the mempool. */
   view = btc_mempool_view(mp, tx);
@@ -1241,13 +1609,47 @@ btc_mempool_insert(btc_mempool_t *mp, const btc_tx_t *tx, unsigned int id) {
 
   btc_mpentry_set(entry, tx, view, height, fee);
 
+  btc_replace_init(&rep);
+
+  /* Check replacement rules before any script verification. */
+  if (replace && !btc_mempool_check_replace(mp, entry, &rep)) {
+    btc_replace_clear(&rep);
+    btc_view_destroy(view);
+    btc_mpentry_destroy(entry);
+    return 0;
+  }
+
+  /* Once evictions begin, the rolling minimum applies
+     (except to transactions returning from a reorg). */
+  if (id != (unsigned int)-1) {
+    int64_t minfee = btc_get_fee(btc_mempool_min_fee(mp), entry->size);
+
+    if (entry->fee < minfee) {
+      btc_replace_clear(&rep);
+      btc_view_destroy(view);
+      btc_mpentry_destroy(entry);
+      return btc_mempool_throw(mp, tx,
+                               BTC_REJECT_INSUFFICIENTFEE,
+                               "mempool min fee not met",
+                               0,
+                               0);
+    }
+  }
+
   /* Contextual verification. */
   if (!btc_mempool_verify(mp, entry, view)) {
+    btc_replace_clear(&rep);
     btc_view_destroy(view);
     btc_mpentry_destroy(entry);
     return 0;
   }
 
+  /* Evict the conflicts and their descendants. */
+  if (replace)
+    btc_mempool_replace(mp, &rep);
+
+  btc_replace_clear(&rep);
+
   /* Add and index the entry. */
   btc_mempool_add_entry(mp, entry, view);
   btc_view_destroy(view);
@@ -1294,6 +1696,9 @@ btc_mempool_add_block(btc_mempool_t *mp,
   int total = 0;
   size_t i;
 
+  /* The rolling minimum fee may start decaying. */
+  mp->min_decay = 1;
+
   if (mp->map.size == 0)
     return;
 
@@ -1420,6 +1825,39 @@ btc_mempool_error(btc_mempool_t *mp) {
   return &mp->error;
 }
 
+int64_t
+btc_mempool_min_fee(btc_mempool_t *mp) {
+  int64_t min_relay = mp->network->min_relay;
+  int64_t now, rate;
+
+  if (mp->min_decay && mp->min_rate > 0) {
+    now = btc_timedata_now(mp->timedata);
+
+    if (now > mp->min_time + 10) {
+      double halflife = BTC_MEMPOOL_FEE_HALFLIFE;
+
+      /* Decay faster the emptier we are. */
+      if (mp->size < mp->max_size / 4)
+        halflife /= 4;
+      else if (mp->size < mp->max_size / 2)
+        halflife /= 2;
+
+      mp->min_rate /= pow(2.0, (double)(now - mp->min_time) / halflife);
+      mp->min_time = now;
+
+      if (mp->min_rate < (double)min_relay / 2)
+        mp->min_rate = 0;
+    }
+  }
+
+  rate = (int64_t)(mp->min_rate + 0.5);
+
+  if (rate < min_relay)
+    rate = min_relay;
+
+  return rate;
+}
+
 size_t
 btc_mempool_size(btc_mempool_t *mp) {
   return mp->map.size;
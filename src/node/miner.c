@@ -134,8 +134,10 @@ btc_blockentry_set_tx(btc_blockentry_t *z, const btc_tx_t *x) {
   z->rate = 0;
   z->weight = btc_tx_weight(x);
   z->sigops = 0;
-  z->desc_rate = 0;
-  z->dep_count = 0;
+  z->anc_fee = 0;
+  z->anc_size = 0;
+  z->anc_count = 0;
+  z->included = 0;
 }
 
 static void
@@ -152,8 +154,10 @@ btc_blockentry_set_view(btc_blockentry_t *z,
   z->rate = btc_get_rate(z->fee, size);
   z->weight = btc_tx_weight(x);
   z->sigops = sigops;
-  z->desc_rate = z->rate;
-  z->dep_count = 0;
+  z->anc_fee = z->fee;
+  z->anc_size = size;
+  z->anc_count = 1;
+  z->included = 0;
 }
 
 static void
@@ -165,8 +169,10 @@ btc_blockentry_set_mpentry(btc_blockentry_t *z, const btc_mpentry_t *x) {
   z->rate = btc_get_rate(x->delta_fee, x->size);
   z->weight = btc_tx_weight(x->tx);
   z->sigops = x->sigops;
-  z->desc_rate = btc_get_rate(x->desc_fee, x->desc_size);
-  z->dep_count = 0;
+  z->anc_fee = x->anc_fee;
+  z->anc_size = x->anc_size;
+  z->anc_count = x->anc_count;
+  z->included = 0;
 }
 
 /*
@@ -1089,34 +1095,200 @@ btc_miner_update_time(btc_miner_t *miner, btc_tmpl_t *bt) {
   bt->time = now;
 }
 
+/*
+ * Assembly
+ */
+
+typedef struct btc_score_s {
+  btc_blockentry_t *item;
+  int64_t fee;
+  int64_t size;
+} btc_score_t;
+
 static int
-cmp_rate(const void *ap, const void *bp) {
-  const btc_blockentry_t *a = ap;
-  const btc_blockentry_t *b = bp;
+cmp_score(const void *ap, const void *bp) {
+  const btc_score_t *a = ap;
+  const btc_score_t *b = bp;
+  int64_t x = a->fee * b->size;
+  int64_t y = b->fee * a->size;
 
-  int64_t x = a->rate;
-  int64_t y = b->rate;
+  return BTC_CMP(y, x);
+}
 
-  if (a->desc_rate > a->rate)
-    x = a->desc_rate;
+static void
+push_score(btc_vector_t *queue, btc_blockentry_t *item) {
+  btc_score_t *score = btc_malloc(sizeof(btc_score_t));
 
-  if (b->desc_rate > b->rate)
-    y = b->desc_rate;
+  /* Entries are never reordered in place. A
+     modified entry is simply queued again and
+     the stale score is discarded when popped. */
+  score->item = item;
+  score->fee = item->anc_fee;
+  score->size = item->anc_size;
 
-  return BTC_CMP(y, x);
+  btc_heap_insert(queue, score, cmp_score);
+}
+
+static void
+push_parents(btc_vector_t *out,
+             btc_hashset_t *set,
+             const btc_hashmap_t *items,
+             const btc_blockentry_t *item) {
+  const btc_tx_t *tx = item->tx;
+  size_t i;
+
+  for (i = 0; i < tx->inputs.length; i++) {
+    const btc_input_t *input = tx->inputs.items[i];
+    btc_blockentry_t *parent = btc_hashmap_get(items, input->prevout.hash);
+
+    if (parent == NULL || parent->included)
+      continue;
+
+    if (btc_hashset_put(set, parent->hash))
+      btc_vector_push(out, parent);
+  }
+}
+
+static void
+push_children(btc_vector_t *out,
+              btc_hashset_t *set,
+              const btc_hashmap_t *depmap,
+              const btc_blockentry_t *item) {
+  const btc_vector_t *children = btc_hashmap_get(depmap, item->hash);
+  size_t i;
+
+  if (children == NULL)
+    return;
+
+  for (i = 0; i < children->length; i++) {
+    btc_blockentry_t *child = children->items[i];
+
+    if (btc_hashset_put(set, child->hash))
+      btc_vector_push(out, child);
+  }
+}
+
+static void
+sort_package(btc_vector_t *package) {
+  size_t i, j;
+
+  /* A parent always has fewer unconfirmed ancestors
+     than its child, so this is a topological order. */
+  for (i = 1; i < package->length; i++) {
+    btc_blockentry_t *item = package->items[i];
+
+    for (j = i; j > 0; j--) {
+      btc_blockentry_t *prev = package->items[j - 1];
+
+      if (prev->anc_count <= item->anc_count)
+        break;
+
+      package->items[j] = prev;
+    }
+
+    package->items[j] = item;
+  }
+}
+
+static int
+btc_tmpl_fits(const btc_tmpl_t *bt,
+              const btc_vector_t *package,
+              int64_t locktime) {
+  size_t weight = 0;
+  int sigops = 0;
+  size_t i;
+
+  for (i = 0; i < package->length; i++) {
+    const btc_blockentry_t *item = package->items[i];
+
+    if (!btc_tx_is_final(item->tx, bt->height, locktime))
+      return 0;
+
+    if (!(bt->flags & BTC_SCRIPT_VERIFY_WITNESS)) {
+      if (btc_tx_has_witness(item->tx))
+        return 0;
+    }
+
+    weight += item->weight;
+    sigops += item->sigops;
+  }
+
+  if (bt->weight + weight > BTC_MAX_POLICY_BLOCK_WEIGHT)
+    return 0;
+
+  if (bt->sigops + sigops > BTC_MAX_BLOCK_SIGOPS_COST)
+    return 0;
+
+  return 1;
+}
+
+static void
+btc_miner_update_descendants(btc_miner_t *miner,
+                             btc_vector_t *queue,
+                             const btc_hashmap_t *depmap,
+                             const btc_vector_t *package) {
+  btc_vector_t descs, updated;
+  btc_hashset_t set, touched;
+  size_t i, j;
+
+  btc_vector_init(&descs);
+  btc_vector_init(&updated);
+  btc_hashset_init(&touched);
+
+  for (i = 0; i < package->length; i++) {
+    const btc_blockentry_t *item = package->items[i];
+    const btc_mpentry_t *entry = btc_mempool_get(miner->mempool, item->hash);
+
+    CHECK(entry != NULL);
+
+    btc_hashset_init(&set);
+    btc_vector_reset(&descs);
+
+    push_children(&descs, &set, depmap, item);
+
+    for (j = 0; j < descs.length; j++)
+      push_children(&descs, &set, depmap, descs.items[j]);
+
+    btc_hashset_clear(&set);
+
+    /* Descendants no longer pay for this ancestor. */
+    for (j = 0; j < descs.length; j++) {
+      btc_blockentry_t *desc = descs.items[j];
+
+      if (desc->included)
+        continue;
+
+      desc->anc_fee -= entry->delta_fee;
+      desc->anc_size -= entry->size;
+      desc->anc_count -= 1;
+
+      if (btc_hashset_put(&touched, desc->hash))
+        btc_vector_push(&updated, desc);
+    }
+  }
+
+  for (i = 0; i < updated.length; i++)
+    push_score(queue, updated.items[i]);
+
+  btc_vector_clear(&descs);
+  btc_vector_clear(&updated);
+  btc_hashset_clear(&touched);
 }
 
 static void
 btc_miner_assemble(btc_miner_t *miner, btc_tmpl_t *bt) {
   const btc_hashmap_t *map = btc_mempool_map(miner->mempool);
   int64_t locktime = btc_tmpl_locktime(bt);
-  btc_hashmap_t depmap;
-  btc_vector_t queue;
+  btc_hashmap_t items, depmap;
+  btc_vector_t queue, package;
+  btc_hashset_t set;
   btc_mapiter_t it;
   size_t i;
 
+  btc_hashmap_init(&items);
   btc_hashmap_init(&depmap);
   btc_vector_init(&queue);
+  btc_vector_init(&package);
 
   btc_map_each(map, it) {
     const btc_mpentry_t *entry = map->vals[it];
@@ -1124,71 +1296,91 @@ btc_miner_assemble(btc_miner_t *miner, btc_tmpl_t *bt) {
 
     btc_blockentry_set_mpentry(item, entry);
 
+    btc_hashmap_put(&items, item->hash, item);
+
+    push_score(&queue, item);
+  }
+
+  btc_map_each(&items, it) {
+    btc_blockentry_t *item = items.vals[it];
+
     for (i = 0; i < item->tx->inputs.length; i++) {
       const btc_input_t *input = item->tx->inputs.items[i];
       const uint8_t *hash = input->prevout.hash;
 
-      if (!btc_mempool_has(miner->mempool, hash))
+      if (!btc_hashmap_has(&items, hash))
         continue;
 
-      item->dep_count += 1;
-
       if (!btc_hashmap_has(&depmap, hash))
         btc_hashmap_put(&depmap, hash, btc_vector_create());
 
       btc_vector_push(btc_hashmap_get(&depmap, hash), item);
     }
-
-    if (item->dep_count > 0)
-      continue;
-
-    btc_heap_insert(&queue, item, cmp_rate);
   }
 
+  /* Select by ancestor feerate: the best entry is
+     added along with whatever remains of its
+     unconfirmed ancestry (i.e. CPFP packages). */
   while (queue.length > 0) {
-    const btc_blockentry_t *item = btc_heap_shift(&queue, cmp_rate);
-    btc_vector_t *deps;
-
-    if (!btc_tx_is_final(item->tx, bt->height, locktime))
-      continue;
+    btc_score_t *score = btc_heap_shift(&queue, cmp_score);
+    btc_blockentry_t *item = score->item;
+    int stale = score->fee != item->anc_fee
+             || score->size != item->anc_size;
 
-    if (!(bt->flags & BTC_SCRIPT_VERIFY_WITNESS)) {
-      if (btc_tx_has_witness(item->tx))
-        continue;
-    }
+    btc_free(score);
 
-    if (bt->weight + item->weight > BTC_MAX_POLICY_BLOCK_WEIGHT)
+    if (item->included || stale)
       continue;
 
-    if (bt->sigops + item->sigops > BTC_MAX_BLOCK_SIGOPS_COST)
-      continue;
+    btc_vector_reset(&package);
+    btc_vector_push(&package, item);
 
-    bt->weight += item->weight;
-    bt->sigops += item->sigops;
-    bt->fees += item->fee;
+    btc_hashset_init(&set);
 
-    btc_vector_push(&bt->txs, item);
+    for (i = 0; i < package.length; i++)
+      push_parents(&package, &set, &items, package.items[i]);
 
-    deps = btc_hashmap_get(&depmap, item->hash);
+    btc_hashset_clear(&set);
 
-    if (deps == NULL)
+    if (!btc_tmpl_fits(bt, &package, locktime))
       continue;
 
-    for (i = 0; i < deps->length; i++) {
-      btc_blockentry_t *child = deps->items[i];
+    sort_package(&package);
+
+    for (i = 0; i < package.length; i++) {
+      btc_blockentry_t *child = package.items[i];
+
+      bt->weight += child->weight;
+      bt->sigops += child->sigops;
+      bt->fees += child->fee;
 
-      if (--child->dep_count == 0)
-        btc_heap_insert(&queue, child, cmp_rate);
+      child->included = 1;
+
+      btc_vector_push(&bt->txs, child);
     }
+
+    btc_miner_update_descendants(miner, &queue, &depmap, &package);
   }
 
   btc_tmpl_refresh(bt);
 
+  for (i = 0; i < queue.length; i++)
+    btc_free(queue.items[i]);
+
+  btc_map_each(&items, it) {
+    btc_blockentry_t *item = items.vals[it];
+
+    if (!item->included)
+      btc_blockentry_destroy(item);
+  }
+
   btc_map_each(&depmap, it)
     btc_vector_destroy(depmap.vals[it]);
 
+  btc_hashmap_clear(&items);
   btc_hashmap_clear(&depmap);
   btc_vector_clear(&queue);
+  btc_vector_clear(&package);
 }
 
 btc_tmpl_t *
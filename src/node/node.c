@@ -95,6 +95,12 @@ client_by_height(void *state, int32_t height) {
   return btc_chain_by_height(node->chain, height);
 }
 
+static const btc_entry_t *
+client_by_time(void *state, int64_t time) {
+  btc_node_t *node = state;
+  return btc_chain_by_time(node->chain, time);
+}
+
 static btc_block_t *
 client_get_block(void *state, const btc_entry_t *entry) {
   btc_node_t *node = state;
@@ -113,6 +119,20 @@ client_log(void *state, int level, const char *fmt, va_list ap) {
   btc_logger_write(node->logger, level, "wallet", fmt, ap);
 }
 
+static void
+client_init(btc_wclient_t *client, btc_node_t *node) {
+  btc_wclient_init(client);
+
+  client->state = node;
+  client->tip = client_tip;
+  client->by_hash = client_by_hash;
+  client->by_height = client_by_height;
+  client->by_time = client_by_time;
+  client->get_block = client_get_block;
+  client->send = client_send;
+  client->log = client_log;
+}
+
 /*
  * Node
  */
@@ -138,21 +158,15 @@ btc_node_create(const btc_network_t *network) {
     btc_walopt_t opt = *btc_walopt_default;
     btc_wclient_t client;
 
-    btc_wclient_init(&client);
-
-    client.state = node;
-    client.tip = client_tip;
-    client.by_hash = client_by_hash;
-    client.by_height = client_by_height;
-    client.get_block = client_get_block;
-    client.send = client_send;
-    client.log = client_log;
+    client_init(&client, node);
 
     opt.client = &client;
 
     node->wallet = btc_wallet_create(network, &opt);
   }
 
+  node->wallets = btc_walletset_create();
+
   node->rpc = btc_rpc_create(node);
 
   btc_chain_set_logger(node->chain, node->logger);
@@ -182,6 +196,7 @@ btc_node_create(const btc_network_t *network) {
 void
 btc_node_destroy(btc_node_t *node) {
   btc_rpc_destroy(node->rpc);
+  btc_walletset_destroy(node->wallets);
   btc_wallet_destroy(node->wallet);
   btc_pool_destroy(node->pool);
   btc_miner_destroy(node->miner);
@@ -255,6 +270,10 @@ btc_node_open(btc_node_t *node, const char *prefix, unsigned int flags) {
     btc_miner_add_address(node->miner, &addr);
   }
 
+  CHECK(btc_walletset_add(node->wallets, "", node->wallet));
+
+  node->prefix = btc_strdup(prefix);
+
   btc_loop_on_tick(node->loop, btc_wallet_tick, node->wallet);
 
   return 1;
@@ -281,12 +300,26 @@ btc_node_close(btc_node_t *node) {
   btc_loop_off_tick(node->loop, btc_wallet_tick, node->wallet);
 
   btc_rpc_close(node->rpc);
+
+  while (btc_walletset_size(node->wallets) > 1) {
+    char name[64];
+
+    strcpy(name, btc_walletset_name(node->wallets, 1));
+
+    CHECK(btc_node_unload_wallet(node, name));
+  }
+
+  btc_walletset_remove(node->wallets, "");
   btc_wallet_close(node->wallet);
   btc_pool_close(node->pool);
   btc_miner_close(node->miner);
   btc_mempool_close(node->mempool);
   btc_chain_close(node->chain);
   btc_logger_close(node->logger);
+
+  btc_free(node->prefix);
+
+  node->prefix = NULL;
 }
 
 void
@@ -299,6 +332,137 @@ btc_node_stop(btc_node_t *node) {
   btc_loop_stop(node->loop);
 }
 
+/*
+ * Wallets
+ */
+
+static int
+btc_node_wallet_path(char *path, btc_node_t *node, const char *name) {
+  char dir[BTC_PATH_MAX];
+  const char *ch;
+
+  if (*name == '\0' || strlen(name) > 63)
+    return 0;
+
+  for (ch = name; *ch != '\0'; ch++) {
+    if (*ch >= '0' && *ch <= '9')
+      continue;
+
+    if (*ch >= 'A' && *ch <= 'Z')
+      continue;
+
+    if (*ch >= 'a' && *ch <= 'z')
+      continue;
+
+    if (*ch == '-' || *ch == '_')
+      continue;
+
+    return 0;
+  }
+
+  if (!btc_path_join(dir, sizeof(dir), node->prefix, "wallets"))
+    return 0;
+
+  return btc_path_join(path, BTC_PATH_MAX, dir, name);
+}
+
+static btc_wallet_t *
+btc_node_open_wallet(btc_node_t *node,
+                     const char *name,
+                     const btc_walopt_t *options,
+                     int create) {
+  char path[BTC_PATH_MAX];
+  btc_walopt_t opt = *options;
+  btc_wclient_t client;
+  btc_wallet_t *wallet;
+
+  if (node->prefix == NULL)
+    return NULL;
+
+  if (!btc_node_wallet_path(path, node, name))
+    return NULL;
+
+  if (btc_walletset_get(node->wallets, name) != NULL)
+    return NULL;
+
+  if (create) {
+    char dir[BTC_PATH_MAX];
+
+    if (!btc_path_join(dir, sizeof(dir), node->prefix, "wallets"))
+      return NULL;
+
+    btc_fs_mkdir(dir);
+
+    if (btc_fs_exists(path))
+      return NULL;
+  } else {
+    if (!btc_fs_exists(path))
+      return NULL;
+  }
+
+  client_init(&client, node);
+
+  opt.client = &client;
+
+  wallet = btc_wallet_create(node->network, &opt);
+
+  if (!btc_wallet_open(wallet, path)) {
+    btc_log_error(node, "Failed to open wallet %s.", name);
+    btc_wallet_destroy(wallet);
+    return NULL;
+  }
+
+  CHECK(btc_walletset_add(node->wallets, name, wallet));
+
+  btc_loop_on_tick(node->loop, btc_wallet_tick, wallet);
+
+  btc_log_info(node, "Loaded wallet %s.", name);
+
+  return wallet;
+}
+
+btc_wallet_t *
+btc_node_load_wallet(btc_node_t *node, const char *name, int create) {
+  return btc_node_open_wallet(node, name, btc_walopt_default, create);
+}
+
+btc_wallet_t *
+btc_node_create_wallet(btc_node_t *node,
+                       const char *name,
+                       const btc_walopt_t *options) {
+  if (options == NULL)
+    options = btc_walopt_default;
+
+  return btc_node_open_wallet(node, name, options, 1);
+}
+
+int
+btc_node_unload_wallet(btc_node_t *node, const char *name) {
+  btc_wallet_t *wallet;
+
+  /* The default wallet lives as long as the node. */
+  if (*name == '\0')
+    return 0;
+
+  wallet = btc_walletset_remove(node->wallets, name);
+
+  if (wallet == NULL)
+    return 0;
+
+  btc_log_info(node, "Unloading wallet %s.", name);
+
+  btc_loop_off_tick(node->loop, btc_wallet_tick, wallet);
+  btc_wallet_close(wallet);
+  btc_wallet_destroy(wallet);
+
+  return 1;
+}
+
+btc_wallet_t *
+btc_node_get_wallet(btc_node_t *node, const char *name) {
+  return btc_walletset_get(node->wallets, name);
+}
+
 /*
  * Event Handling
  */
@@ -313,7 +477,7 @@ on_connect(const btc_entry_t *entry,
   (void)view;
 
   btc_mempool_add_block(node->mempool, entry, block);
-  btc_wallet_add_block(node->wallet, entry, block);
+  btc_walletset_add_block(node->wallets, entry, block);
 }
 
 static void
@@ -326,7 +490,7 @@ on_disconnect(const btc_entry_t *entry,
   (void)view;
 
   btc_mempool_remove_block(node->mempool, entry, block);
-  btc_wallet_remove_block(node->wallet, entry);
+  btc_walletset_remove_block(node->wallets, entry);
 }
 
 static void
@@ -361,7 +525,7 @@ on_tx(const btc_mpentry_t *entry, const btc_view_t *view, void *arg) {
   (void)view;
 
   btc_pool_announce_tx(node->pool, entry);
-  btc_wallet_add_tx(node->wallet, entry->tx);
+  btc_walletset_add_tx(node->wallets, entry->tx);
 }
 
 static void
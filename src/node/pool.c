@@ -16,6 +16,7 @@
 #include <base/logger.h>
 #include <node/mempool.h>
 #include <node/pool.h>
+#include <node/txreq.h>
 #include <base/timedata.h>
 
 #include <mako/bip37.h>
@@ -97,6 +98,8 @@ typedef struct btc_peer_s {
   enum btc_peer_state state;
   unsigned int id;
   int outbound;
+  int block_relay;
+  int feeler;
   int loader;
   btc_netaddr_t addr;
   btc_netaddr_t local;
@@ -116,6 +119,8 @@ typedef struct btc_peer_s {
   uint8_t last_stop[32];
   uint8_t hash_continue[32];
   int64_t fee_rate;
+  int64_t fee_filter;
+  int64_t fee_timer;
   int compact_mode;
   int compact_witness;
   int syncing;
@@ -126,6 +131,7 @@ typedef struct btc_peer_s {
   int64_t last_pong;
   int64_t last_ping;
   int64_t min_ping;
+  int64_t last_block;
   int64_t block_time;
   int64_t gb_time;
   int64_t gh_time;
@@ -136,7 +142,7 @@ typedef struct btc_peer_s {
   btc_filter_t inv_filter;
   btc_bloom_t *spv_filter;
   btc_hashtab_t block_map;
-  btc_hashtab_t tx_map;
+  btc_txpeer_t txs;
   btc_hashmap_t compact_map;
   struct btc_peer_s *prev;
   struct btc_peer_s *next;
@@ -154,6 +160,8 @@ typedef struct btc_peers_s {
   btc_peer_t *load;
   size_t inbound;
   size_t outbound;
+  size_t block_relay;
+  size_t feeler;
   size_t length;
 } btc_peers_t;
 
@@ -177,14 +185,17 @@ struct btc_pool_s {
   btc_vector_t bind;
   btc_vector_t connect;
   btc_sockaddr_t proxy;
+  btc_addrs_t anchors;
+  char anchor_file[BTC_PATH_MAX];
   size_t max_inbound;
   size_t max_outbound;
+  size_t max_block_relay;
   enum btc_ipnet only_net;
   btc_server_t *server;
   btc_peers_t peers;
   btc_nonces_t nonces;
   btc_hashset_t block_map;
-  btc_hashset_t tx_map;
+  btc_txreqs_t *txreqs;
   btc_hashset_t compact_map;
   int block_mode;
   int checkpoints;
@@ -193,7 +204,12 @@ struct btc_pool_s {
   btc_hdrnode_t *header_tail;
   btc_hdrnode_t *header_next;
   int64_t refill_timer;
+  int64_t feeler_timer;
+  int64_t stale_timer;
+  int64_t tip_time;
+  int extra_outbound;
   int64_t flush_timer;
+  int64_t tx_timer;
   unsigned int id;
   uint64_t required_services;
   int synced;
@@ -490,6 +506,8 @@ btc_peer_create(btc_pool_t *pool) {
   peer->height = -1;
   peer->relay = 1;
   peer->fee_rate = -1;
+  peer->fee_filter = -1;
+  peer->fee_timer = 0;
   peer->compact_mode = -1;
   peer->last_pong = -1;
   peer->last_ping = -1;
@@ -513,7 +531,7 @@ btc_peer_create(btc_pool_t *pool) {
   btc_filter_set(&peer->inv_filter, 50000, 0.000001);
 
   btc_hashtab_init(&peer->block_map);
-  btc_hashtab_init(&peer->tx_map);
+  btc_txpeer_init(&peer->txs);
   btc_hashmap_init(&peer->compact_map);
 
   return peer;
@@ -534,10 +552,6 @@ btc_peer_destroy(btc_peer_t *peer) {
   btc_map_each(&peer->block_map, it)
     btc_free(peer->block_map.keys[it]);
 
-  /* Free TXIDs. */
-  btc_map_each(&peer->tx_map, it)
-    btc_free(peer->tx_map.keys[it]);
-
   /* Free compact blocks. */
   btc_map_each(&peer->compact_map, it)
     btc_cmpct_destroy(peer->compact_map.vals[it]);
@@ -551,7 +565,7 @@ btc_peer_destroy(btc_peer_t *peer) {
     btc_bloom_destroy(peer->spv_filter);
 
   btc_hashtab_clear(&peer->block_map);
-  btc_hashtab_clear(&peer->tx_map);
+  btc_txpeer_clear(&peer->txs);
   btc_hashmap_clear(&peer->compact_map);
 
   btc_free(peer);
@@ -573,6 +587,7 @@ btc_peer_open(btc_peer_t *peer, const btc_netaddr_t *addr) {
   peer->socket = socket;
   peer->addr = *addr;
   peer->outbound = 1;
+  peer->txs.outbound = 1;
   peer->time = btc_time_msec();
   peer->nonce = btc_nonces_alloc(&peer->pool->nonces);
 
@@ -599,6 +614,7 @@ btc_peer_accept(btc_peer_t *peer, btc_socket_t *socket) {
   btc_netaddr_set_sockaddr(&peer->addr, &sa);
 
   peer->outbound = 0;
+  peer->txs.outbound = 0;
   peer->time = btc_time_msec();
   peer->nonce = btc_nonces_alloc(&peer->pool->nonces);
 
@@ -711,7 +727,7 @@ btc_peer_send_version(btc_peer_t *peer) {
   strcpy(msg.agent, BTC_NET_USER_AGENT);
 
   msg.height = btc_chain_height(pool->chain);
-  msg.relay = ((pool->flags & BTC_POOL_BLOCKSONLY) == 0);
+  msg.relay = ((pool->flags & BTC_POOL_BLOCKSONLY) == 0 && !peer->block_relay);
 
   return btc_peer_sendmsg(peer, BTC_MSG_VERSION, &msg);
 }
@@ -910,6 +926,53 @@ btc_peer_send_sendcmpct(btc_peer_t *peer, uint8_t mode) {
   return 1;
 }
 
+static int
+btc_peer_send_feefilter(btc_peer_t *peer, int64_t rate) {
+  btc_feefilter_t msg;
+
+  msg.rate = rate;
+
+  peer->fee_filter = rate;
+
+  return btc_peer_sendmsg(peer, BTC_MSG_FEEFILTER, &msg);
+}
+
+static void
+btc_peer_maybe_feefilter(btc_peer_t *peer, int64_t now) {
+  static const int64_t interval = 10 * 60 * 1000;
+  static const int64_t max_delay = 5 * 60 * 1000;
+  btc_pool_t *pool = peer->pool;
+  int64_t rate, filter;
+
+  if (peer->version < BTC_NET_FEEFILTER_VERSION)
+    return;
+
+  if (peer->block_relay)
+    return;
+
+  if (pool->flags & BTC_POOL_BLOCKSONLY)
+    return;
+
+  /* No point in receiving transactions while syncing. */
+  if (btc_chain_synced(pool->chain))
+    rate = btc_mempool_min_fee(pool->mempool);
+  else
+    rate = BTC_MAX_MONEY;
+
+  if (now >= peer->fee_timer) {
+    filter = btc_round_filter(rate, peer->network->min_relay);
+
+    if (filter != peer->fee_filter)
+      btc_peer_send_feefilter(peer, filter);
+
+    peer->fee_timer = now + interval / 2 + btc_uniform(interval);
+  } else if (now + max_delay < peer->fee_timer && peer->fee_filter > 0) {
+    /* Send early if the minimum moved substantially. */
+    if (rate < (peer->fee_filter * 3) / 4 || rate > (peer->fee_filter * 4) / 3)
+      peer->fee_timer = now + btc_uniform(max_delay);
+  }
+}
+
 static int
 btc_peer_send_inv(btc_peer_t *peer, const btc_zinv_t *msg) {
   size_t i;
@@ -1232,6 +1295,10 @@ btc_peer_announce_tx(btc_peer_t *peer, const btc_mpentry_t *entry) {
   if (!peer->relay)
     return 0;
 
+  /* Nor over our own block-relay-only connections. */
+  if (peer->block_relay)
+    return 0;
+
   /* Don't send if they already have it. */
   if (btc_filter_has(&peer->inv_filter, entry->hash, 32))
     return 0;
@@ -1408,6 +1475,8 @@ btc_peer_on_pong(btc_peer_t *peer, const btc_pong_t *msg) {
 
     if (now < peer->min_ping)
       peer->min_ping = now;
+
+    peer->txs.ping = peer->min_ping;
   } else {
     btc_peer_debug(peer, "Timing mismatch (what?) (%N).", &peer->addr);
   }
@@ -1877,6 +1946,12 @@ static void
 btc_peer_maybe_timeout(btc_peer_t *peer, int64_t now) {
   btc_chain_t *chain = peer->pool->chain;
 
+  if (peer->feeler && now > peer->time + 30000) {
+    btc_peer_debug(peer, "Feeler timed out (%N).", &peer->addr);
+    btc_peer_close(peer);
+    return;
+  }
+
   if (!btc_chain_synced(chain)) {
     if (peer->gb_time != -1 && now > peer->gb_time + 30000) {
       btc_peer_error(peer, "Peer is stalling (inv) (%N).", &peer->addr);
@@ -1912,16 +1987,6 @@ btc_peer_maybe_timeout(btc_peer_t *peer, int64_t now) {
       }
     }
 
-    btc_map_each(&peer->tx_map, it) {
-      int64_t ts = peer->tx_map.vals[it];
-
-      if (now > ts + 120000) {
-        btc_peer_error(peer, "Peer is stalling (tx) (%N).", &peer->addr);
-        btc_peer_close(peer);
-        return;
-      }
-    }
-
     btc_map_each(&peer->compact_map, it) {
       btc_cmpct_t *block = peer->compact_map.vals[it];
 
@@ -1986,6 +2051,8 @@ btc_peer_on_tick(btc_peer_t *peer, int64_t now) {
     peer->inv_timer = now;
   }
 
+  btc_peer_maybe_feefilter(peer, now);
+
   if (now >= peer->stall_timer + 5000) {
     btc_peer_maybe_timeout(peer, now);
     peer->stall_timer = now;
@@ -2014,6 +2081,8 @@ btc_peers_init(btc_peers_t *list) {
   list->load = NULL;
   list->inbound = 0;
   list->outbound = 0;
+  list->block_relay = 0;
+  list->feeler = 0;
   list->length = 0;
 }
 
@@ -2030,7 +2099,11 @@ btc_peers_add(btc_peers_t *list, btc_peer_t *peer) {
 
   btc_list_push(list, peer, btc_peer_t);
 
-  if (peer->outbound)
+  if (peer->feeler)
+    list->feeler += 1;
+  else if (peer->block_relay)
+    list->block_relay += 1;
+  else if (peer->outbound)
     list->outbound += 1;
   else
     list->inbound += 1;
@@ -2049,7 +2122,11 @@ btc_peers_remove(btc_peers_t *list, btc_peer_t *peer) {
     list->load = NULL;
   }
 
-  if (peer->outbound)
+  if (peer->feeler)
+    list->feeler -= 1;
+  else if (peer->block_relay)
+    list->block_relay -= 1;
+  else if (peer->outbound)
     list->outbound -= 1;
   else
     list->inbound -= 1;
@@ -2125,14 +2202,17 @@ btc_pool_create(const btc_network_t *network,
   btc_vector_init(&pool->bind);
   btc_vector_init(&pool->connect);
   btc_sockaddr_import(&pool->proxy, "0.0.0.0", 0);
+  btc_addrs_init(&pool->anchors);
+  pool->anchor_file[0] = '\0';
   pool->max_inbound = 128;
   pool->max_outbound = 8;
+  pool->max_block_relay = 2;
   pool->only_net = BTC_IPNET_NONE;
   pool->server = btc_server_create(loop);
   btc_peers_init(&pool->peers);
   btc_nonces_init(&pool->nonces);
   btc_hashset_init(&pool->block_map);
-  btc_hashset_init(&pool->tx_map);
+  pool->txreqs = btc_txreqs_create();
   btc_hashset_init(&pool->compact_map);
   pool->block_mode = 0;
   pool->checkpoints = 0;
@@ -2141,7 +2221,12 @@ btc_pool_create(const btc_network_t *network,
   pool->header_tail = NULL;
   pool->header_next = NULL;
   pool->refill_timer = 0;
+  pool->feeler_timer = 0;
+  pool->stale_timer = 0;
+  pool->tip_time = 0;
+  pool->extra_outbound = 0;
   pool->flush_timer = 0;
+  pool->tx_timer = 0;
   pool->id = 0;
   pool->required_services = BTC_NET_LOCAL_SERVICES;
   pool->synced = 0;
@@ -2165,11 +2250,12 @@ btc_pool_destroy(btc_pool_t *pool) {
   btc_addrman_destroy(pool->addrman);
   btc_vector_clear(&pool->bind);
   btc_vector_clear(&pool->connect);
+  btc_addrs_clear(&pool->anchors);
   btc_server_destroy(pool->server);
   btc_peers_clear(&pool->peers);
   btc_nonces_clear(&pool->nonces);
   btc_hashset_clear(&pool->block_map);
-  btc_hashset_clear(&pool->tx_map);
+  btc_txreqs_destroy(pool->txreqs);
   btc_hashset_clear(&pool->compact_map);
   btc_free(pool);
 }
@@ -2229,6 +2315,11 @@ btc_pool_set_maxoutbound(btc_pool_t *pool, size_t max_outbound) {
   pool->max_outbound = max_outbound;
 }
 
+void
+btc_pool_set_maxblockrelay(btc_pool_t *pool, size_t max_block_relay) {
+  pool->max_block_relay = max_block_relay;
+}
+
 void
 btc_pool_set_bantime(btc_pool_t *pool, int64_t ban_time) {
   btc_addrman_set_bantime(pool->addrman, ban_time);
@@ -2395,6 +2486,81 @@ btc_pool_reset_chain(btc_pool_t *pool) {
   }
 }
 
+static void
+btc_pool_read_anchors(btc_pool_t *pool) {
+  const char *file = pool->anchor_file;
+  const uint8_t *xp;
+  uint8_t *data;
+  size_t xn;
+
+  /* Only the -connect peers are dialed. Leave the
+     file for the next session that uses addrman. */
+  if (pool->flags & BTC_POOL_CONNECT)
+    return;
+
+  if (!btc_fs_read_file(file, &data, &xn))
+    return;
+
+  /* Anchors are only good for a single restart. */
+  btc_fs_unlink(file);
+
+  xp = data;
+
+  if (!btc_addrs_read(&pool->anchors, &xp, &xn)) {
+    btc_pool_warn(pool, "Could not read %s.", file);
+    btc_addrs_reset(&pool->anchors);
+  }
+
+  btc_free(data);
+
+  while (pool->anchors.length > pool->max_block_relay)
+    btc_addrs_drop(&pool->anchors);
+
+  btc_pool_info(pool, "Loaded %zu anchor peers.", pool->anchors.length);
+}
+
+static void
+btc_pool_write_anchors(btc_pool_t *pool) {
+  btc_addrs_t addrs;
+  btc_peer_t *peer;
+  uint8_t *zp;
+  size_t zn;
+
+  if (pool->anchor_file[0] == '\0')
+    return;
+
+  btc_addrs_init(&addrs);
+
+  for (peer = pool->peers.head; peer != NULL; peer = peer->next) {
+    if (peer->state != BTC_PEER_CONNECTED || !peer->block_relay)
+      continue;
+
+    if (peer->feeler)
+      continue;
+
+    btc_addrs_push(&addrs, &peer->addr);
+  }
+
+  if (addrs.length > 0) {
+    zn = btc_addrs_size(&addrs);
+    zp = btc_malloc(zn);
+
+    btc_addrs_write(zp, &addrs);
+
+    if (!btc_fs_write_file(pool->anchor_file, zp, zn))
+      btc_pool_warn(pool, "Could not write %s.", pool->anchor_file);
+    else
+      btc_pool_info(pool, "Saved %zu anchor peers.", addrs.length);
+
+    btc_free(zp);
+  }
+
+  /* The addresses belong to the peers. */
+  addrs.length = 0;
+
+  btc_addrs_clear(&addrs);
+}
+
 int
 btc_pool_open(btc_pool_t *pool, const char *prefix, unsigned int flags) {
   char file[BTC_PATH_MAX];
@@ -2415,6 +2581,14 @@ btc_pool_open(btc_pool_t *pool, const char *prefix, unsigned int flags) {
   if (!btc_addrman_open(pool->addrman, file, flags))
     return 0;
 
+  if (!btc_path_join(pool->anchor_file, sizeof(pool->anchor_file),
+                     prefix, "anchors.dat")) {
+    btc_addrman_close(pool->addrman);
+    return 0;
+  }
+
+  btc_pool_read_anchors(pool);
+
   if (pool->flags & BTC_POOL_LISTEN) {
     if (!btc_pool_listen(pool)) {
       btc_addrman_close(pool->addrman);
@@ -2428,6 +2602,7 @@ btc_pool_open(btc_pool_t *pool, const char *prefix, unsigned int flags) {
   }
 
   pool->synced = btc_chain_synced(pool->chain);
+  pool->tip_time = btc_time_msec();
 
   btc_pool_reset_chain(pool);
 
@@ -2443,11 +2618,42 @@ btc_pool_close(btc_pool_t *pool) {
   btc_loop_off_tick(pool->loop, on_tick, pool);
 
   btc_server_close(pool->server);
+  btc_pool_write_anchors(pool);
   btc_peers_close(&pool->peers);
   btc_pool_clear_chain(pool);
   btc_addrman_close(pool->addrman);
 }
 
+static int
+btc_pool_is_dialable(btc_pool_t *pool, const btc_netaddr_t *addr) {
+  if (btc_peers_has(&pool->peers, addr))
+    return 0;
+
+  if (btc_addrman_has_local(pool->addrman, addr))
+    return 0;
+
+  if (btc_addrman_is_banned(pool->addrman, addr))
+    return 0;
+
+  if (!btc_netaddr_is_valid(addr))
+    return 0;
+
+  if ((addr->services & pool->required_services) != pool->required_services)
+    return 0;
+
+  if (!(pool->flags & BTC_POOL_ONION)) {
+    if (btc_netaddr_is_onion(addr))
+      return 0;
+  }
+
+  if (pool->only_net != BTC_IPNET_NONE) {
+    if (btc_netaddr_network(addr) != pool->only_net)
+      return 0;
+  }
+
+  return 1;
+}
+
 static const btc_netaddr_t *
 btc_pool_get_addr(btc_pool_t *pool) {
   int64_t now = btc_timedata_now(pool->timedata);
@@ -2476,37 +2682,15 @@ btc_pool_get_addr(btc_pool_t *pool) {
 
     addr = &entry->addr;
 
-    if (btc_peers_has(&pool->peers, addr))
-      continue;
-
-    if (btc_addrman_has_local(pool->addrman, addr))
-      continue;
-
-    if (btc_addrman_is_banned(pool->addrman, addr))
-      continue;
-
-    if (!btc_netaddr_is_valid(addr))
-      continue;
-
-    if ((addr->services & pool->required_services) != pool->required_services)
+    if (!btc_pool_is_dialable(pool, addr))
       continue;
 
-    if (!(pool->flags & BTC_POOL_ONION)) {
-      if (btc_netaddr_is_onion(addr))
-        continue;
-    }
-
     if (i < 30 && now - entry->last_attempt < 600)
       continue;
 
     if (i < 50 && addr->port != pool->network->port)
       continue;
 
-    if (pool->only_net != BTC_IPNET_NONE) {
-      if (btc_netaddr_network(addr) != pool->only_net)
-        continue;
-    }
-
     return addr;
   }
 
@@ -2527,12 +2711,19 @@ btc_pool_ban(btc_pool_t *pool, const btc_netaddr_t *addr) {
 }
 
 static btc_peer_t *
-btc_pool_create_outbound(btc_pool_t *pool, const btc_netaddr_t *addr) {
+btc_pool_create_outbound(btc_pool_t *pool,
+                         const btc_netaddr_t *addr,
+                         int block_relay) {
   btc_peer_t *peer = btc_peer_create(pool);
 
   btc_addrman_mark_attempt(pool->addrman, addr);
 
-  btc_pool_debug(pool, "Connecting to %N.", addr);
+  if (block_relay)
+    btc_pool_debug(pool, "Connecting to %N (block-relay-only).", addr);
+  else
+    btc_pool_debug(pool, "Connecting to %N.", addr);
+
+  peer->block_relay = block_relay;
 
   if (!btc_peer_open(peer, addr)) {
     const char *msg = btc_loop_strerror(pool->loop);
@@ -2546,13 +2737,23 @@ btc_pool_create_outbound(btc_pool_t *pool, const btc_netaddr_t *addr) {
   return peer;
 }
 
+static size_t
+btc_pool_target_outbound(btc_pool_t *pool) {
+  return pool->max_outbound + (pool->extra_outbound != 0);
+}
+
 static int
-btc_pool_add_outbound(btc_pool_t *pool) {
+btc_pool_add_outbound(btc_pool_t *pool, int block_relay) {
   const btc_netaddr_t *addr;
   btc_peer_t *peer;
 
-  if (pool->peers.outbound >= pool->max_outbound)
-    return 0;
+  if (block_relay) {
+    if (pool->peers.block_relay >= pool->max_block_relay)
+      return 0;
+  } else {
+    if (pool->peers.outbound >= btc_pool_target_outbound(pool))
+      return 0;
+  }
 
   /* Hang back if we don't have a loader peer yet. */
   if (pool->peers.load == NULL)
@@ -2563,7 +2764,7 @@ btc_pool_add_outbound(btc_pool_t *pool) {
   if (addr == NULL)
     return 0;
 
-  peer = btc_pool_create_outbound(pool, addr);
+  peer = btc_pool_create_outbound(pool, addr, block_relay);
 
   if (peer == NULL)
     return 0;
@@ -2597,7 +2798,7 @@ btc_pool_send_locator(btc_pool_t *pool,
     return 0;
 
   /* Ask for the mempool if we're synced. */
-  if (pool->network->request_mempool) {
+  if (pool->network->request_mempool && !peer->block_relay) {
     if (peer->loader && btc_chain_synced(pool->chain))
       btc_peer_send_mempool(peer);
   }
@@ -2653,7 +2854,7 @@ btc_pool_add_loader(btc_pool_t *pool) {
   CHECK(pool->peers.load == NULL);
 
   for (peer = pool->peers.head; peer != NULL; peer = peer->next) {
-    if (!peer->outbound)
+    if (!peer->outbound || peer->feeler)
       continue;
 
     btc_pool_info(pool, "Repurposing peer for loader (%N).", &peer->addr);
@@ -2668,7 +2869,7 @@ btc_pool_add_loader(btc_pool_t *pool) {
   if (addr == NULL)
     return 0;
 
-  peer = btc_pool_create_outbound(pool, addr);
+  peer = btc_pool_create_outbound(pool, addr, 0);
 
   if (peer == NULL)
     return 0;
@@ -2682,19 +2883,135 @@ btc_pool_add_loader(btc_pool_t *pool) {
   return 1;
 }
 
+static void
+btc_pool_add_anchors(btc_pool_t *pool) {
+  btc_netaddr_t *addr;
+  btc_peer_t *peer;
+
+  if (pool->flags & BTC_POOL_CONNECT)
+    return;
+
+  while (pool->anchors.length > 0) {
+    if (pool->peers.block_relay >= pool->max_block_relay)
+      break;
+
+    addr = btc_addrs_pop(&pool->anchors);
+
+    if (!btc_peers_has(&pool->peers, addr)
+        && !btc_addrman_is_banned(pool->addrman, addr)) {
+      peer = btc_pool_create_outbound(pool, addr, 1);
+
+      if (peer != NULL) {
+        btc_pool_info(pool, "Adding anchor peer (%N).", &peer->addr);
+        btc_peers_add(&pool->peers, peer);
+      }
+    }
+
+    btc_netaddr_destroy(addr);
+  }
+}
+
+static const btc_netaddr_t *
+btc_pool_get_feeler(btc_pool_t *pool) {
+  int64_t now = btc_timedata_now(pool->timedata);
+  const btc_addrent_t *entry;
+  size_t i;
+
+  /* Probe used entries that a new address wants to evict. */
+  btc_addrman_resolve_collisions(pool->addrman);
+
+  entry = btc_addrman_get_collision(pool->addrman);
+
+  if (entry != NULL && btc_pool_is_dialable(pool, &entry->addr))
+    return &entry->addr;
+
+  /* Otherwise test a fresh address we have never connected to. */
+  for (i = 0; i < 30; i++) {
+    entry = btc_addrman_get_fresh(pool->addrman);
+
+    if (entry == NULL)
+      break;
+
+    if (!btc_pool_is_dialable(pool, &entry->addr))
+      continue;
+
+    if (now - entry->last_attempt < 600)
+      continue;
+
+    return &entry->addr;
+  }
+
+  return NULL;
+}
+
+static int
+btc_pool_add_feeler(btc_pool_t *pool) {
+  const btc_netaddr_t *addr;
+  btc_peer_t *peer;
+
+  if (pool->flags & BTC_POOL_CONNECT)
+    return 0;
+
+  /* Only probe once our outbound slots are full. */
+  if (pool->peers.outbound < pool->max_outbound)
+    return 0;
+
+  if (pool->peers.feeler > 0)
+    return 0;
+
+  addr = btc_pool_get_feeler(pool);
+
+  if (addr == NULL)
+    return 0;
+
+  peer = btc_pool_create_outbound(pool, addr, 1);
+
+  if (peer == NULL)
+    return 0;
+
+  btc_pool_debug(pool, "Adding feeler peer (%N).", &peer->addr);
+
+  peer->feeler = 1;
+
+  btc_peers_add(&pool->peers, peer);
+
+  return 1;
+}
+
 static int
 btc_pool_fill_outbound(btc_pool_t *pool) {
+  size_t target = btc_pool_target_outbound(pool);
   size_t i, total, need;
 
+  /* Reconnect to last session's block-relay peers first. */
+  btc_pool_add_anchors(pool);
+
   if (pool->peers.load == NULL) {
     if (!btc_pool_add_loader(pool))
       return 0;
   }
 
-  if (pool->peers.outbound >= pool->max_outbound)
+  /* Block-relay-only peers come from the address manager
+     and are only made once our full-relay peers are. */
+  if (pool->peers.outbound >= target) {
+    if (pool->flags & BTC_POOL_CONNECT)
+      return 1;
+
+    if (pool->peers.block_relay >= pool->max_block_relay)
+      return 1;
+
+    need = pool->max_block_relay - pool->peers.block_relay;
+
+    btc_pool_debug(pool, "Refilling %zu block-relay peers (%zu/%zu).", need,
+                   pool->peers.block_relay, pool->max_block_relay);
+
+    for (i = 0; i < need; i++)
+      btc_pool_add_outbound(pool, 1);
+
     return 1;
+  }
 
-  need = pool->max_outbound - pool->peers.outbound;
+  need = target - pool->peers.outbound;
   total = btc_addrman_total(pool->addrman);
 
   if (pool->flags & BTC_POOL_CONNECT)
@@ -2707,14 +3024,87 @@ btc_pool_fill_outbound(btc_pool_t *pool) {
     return 0;
 
   btc_pool_debug(pool, "Refilling %zu peers (%zu/%zu).", need,
-                 pool->peers.outbound, pool->max_outbound);
+                 pool->peers.outbound, target);
 
   for (i = 0; i < need; i++)
-    btc_pool_add_outbound(pool);
+    btc_pool_add_outbound(pool, 0);
 
   return 1;
 }
 
+static void
+btc_pool_check_stale(btc_pool_t *pool, int64_t now) {
+  int64_t stale = 3 * pool->network->pow.target_spacing * 1000;
+
+  if (pool->flags & BTC_POOL_CONNECT)
+    return;
+
+  if (!pool->synced)
+    return;
+
+  if (now - pool->tip_time <= stale) {
+    pool->extra_outbound = 0;
+    return;
+  }
+
+  /* Blocks are on their way. */
+  if (pool->block_map.size > 0)
+    return;
+
+  if (!pool->extra_outbound) {
+    btc_pool_info(pool, "Potential stale tip detected (%T seconds)."
+                        " Trying an extra outbound peer.",
+                  (now - pool->tip_time) / 1000);
+  }
+
+  pool->extra_outbound = 1;
+}
+
+static void
+btc_pool_evict_extra(btc_pool_t *pool, int64_t now) {
+  btc_peer_t *worst = NULL;
+  btc_peer_t *peer;
+
+  if (pool->peers.outbound <= pool->max_outbound)
+    return;
+
+  /* Find the full-relay peer which has gone the longest
+     without giving us a new block, preferring younger
+     connections on a tie. */
+  for (peer = pool->peers.head; peer != NULL; peer = peer->next) {
+    if (!peer->outbound || peer->block_relay)
+      continue;
+
+    if (peer->state != BTC_PEER_CONNECTED)
+      continue;
+
+    if (worst == NULL
+        || peer->last_block < worst->last_block
+        || (peer->last_block == worst->last_block && peer->id > worst->id)) {
+      worst = peer;
+    }
+  }
+
+  if (worst == NULL)
+    return;
+
+  /* Give new peers a chance to send us headers. */
+  if (now - worst->time < 30000)
+    return;
+
+  /* Don't drop a peer with blocks in flight. */
+  if (worst->block_map.size > 0)
+    return;
+
+  btc_pool_info(pool, "Disconnecting extra outbound peer (%N).",
+                      &worst->addr);
+
+  btc_peer_close(worst);
+}
+
+static void
+btc_pool_fetch_txs(btc_pool_t *pool, btc_peer_t *peer, int64_t now);
+
 static void
 btc_pool_on_tick(btc_pool_t *pool, int64_t now) {
   if (now >= pool->refill_timer + 3000) {
@@ -2722,10 +3112,35 @@ btc_pool_on_tick(btc_pool_t *pool, int64_t now) {
     pool->refill_timer = now;
   }
 
+  if (now >= pool->stale_timer + 45000) {
+    btc_pool_evict_extra(pool, now);
+    btc_pool_check_stale(pool, now);
+    pool->stale_timer = now;
+  }
+
+  if (now >= pool->feeler_timer + 2 * 60 * 1000) {
+    btc_pool_add_feeler(pool);
+    pool->feeler_timer = now;
+  }
+
   if (now >= pool->flush_timer + 10 * 60 * 1000) {
     btc_addrman_flush(pool->addrman);
     pool->flush_timer = now;
   }
+
+  if (now >= pool->tx_timer + 1000) {
+    btc_peer_t *peer;
+
+    for (peer = pool->peers.head; peer != NULL; peer = peer->next) {
+      if (peer->state != BTC_PEER_CONNECTED)
+        continue;
+
+      if (peer->txs.announced.size > 0 || peer->txs.requested.size > 0)
+        btc_pool_fetch_txs(pool, peer, now);
+    }
+
+    pool->tx_timer = now;
+  }
 }
 
 static void
@@ -2778,7 +3193,15 @@ static void
 btc_pool_on_complete(btc_pool_t *pool, btc_peer_t *peer) {
   const btc_netaddr_t *addr;
 
-  if (peer->outbound) {
+  /* Feelers only test reachability. */
+  if (peer->feeler) {
+    btc_pool_debug(pool, "Feeler succeeded (%N).", &peer->addr);
+    btc_addrman_mark_ack(pool->addrman, &peer->addr, peer->services);
+    btc_peer_close(peer);
+    return;
+  }
+
+  if (peer->outbound && !peer->block_relay) {
     /* Advertise our address. */
     if ((pool->flags & BTC_POOL_LISTEN) && btc_chain_synced(pool->chain)) {
       addr = btc_addrman_get_local(pool->addrman, &peer->addr, pool->services);
@@ -2855,19 +3278,74 @@ btc_pool_resolve_block(btc_pool_t *pool,
 }
 
 static int
-btc_pool_resolve_tx(btc_pool_t *pool,
-                    btc_peer_t *peer,
-                    const uint8_t *hash) {
-  uint8_t *key = btc_hashtab_del(&peer->tx_map, hash);
+btc_pool_has_tx(btc_pool_t *pool, const uint8_t *hash) {
+  /* Check the mempool. */
+  if (btc_mempool_has(pool->mempool, hash))
+    return 1;
 
-  if (key == NULL)
-    return 0;
+  /* Check for orphans. */
+  if (btc_mempool_has_orphan(pool->mempool, hash))
+    return 1;
 
-  CHECK(btc_hashset_del(&pool->tx_map, hash) == key);
+  /* If we recently rejected this item. Ignore. */
+  if (btc_mempool_has_reject(pool->mempool, hash)) {
+    btc_pool_spam(pool, "Saw known reject of %H.", hash);
+    return 1;
+  }
 
-  btc_free(key);
+  return 0;
+}
 
-  return 1;
+/*
+ * TX Requests
+ */
+
+static void
+btc_pool_fetch_txs(btc_pool_t *pool, btc_peer_t *peer, int64_t now) {
+  btc_vector_t hashes;
+  btc_zinv_t inv;
+  size_t i, expired;
+
+  btc_vector_init(&hashes);
+  btc_zinv_init(&inv);
+
+  expired = btc_txreqs_poll(&hashes, pool->txreqs, &peer->txs, now);
+
+  if (expired > 0) {
+    btc_pool_debug(pool, "Timed out waiting for %zu txs (%N).",
+                         expired, &peer->addr);
+  }
+
+  for (i = 0; i < hashes.length; i++) {
+    const uint8_t *hash = hashes.items[i];
+
+    if (btc_pool_has_tx(pool, hash)) {
+      btc_txreqs_forget(pool->txreqs, hash);
+      continue;
+    }
+
+    btc_zinv_push(&inv, btc_peer_tx_type(peer), hash);
+  }
+
+  if (inv.length > 0) {
+    btc_pool_debug(pool, "Requesting %zu/%zu txs from peer with getdata (%N).",
+                         inv.length, btc_txreqs_size(pool->txreqs),
+                         &peer->addr);
+
+    btc_peer_send_getdata(peer, &inv);
+  }
+
+  btc_zinv_clear(&inv);
+  btc_vector_clear(&hashes);
+}
+
+static int
+btc_pool_resolve_tx(btc_pool_t *pool,
+                    btc_peer_t *peer,
+                    const uint8_t *hash) {
+  /* The peer could not deliver the tx. Another
+     announcer is asked on the next tx tick. */
+  return btc_txreqs_notfound(pool->txreqs, &peer->txs, hash);
 }
 
 static int
@@ -2899,9 +3377,8 @@ btc_pool_remove_peer(btc_pool_t *pool, btc_peer_t *peer) {
   btc_map_each(&peer->block_map, it)
     CHECK(btc_hashset_del(&pool->block_map, peer->block_map.keys[it]));
 
-  /* Remove TXIDs. */
-  btc_map_each(&peer->tx_map, it)
-    CHECK(btc_hashset_del(&pool->tx_map, peer->tx_map.keys[it]));
+  /* Remove tx announcements. Others are asked for what was in flight. */
+  btc_txreqs_remove(pool->txreqs, &peer->txs);
 
   /* Remove compact block hashes. */
   btc_map_each(&peer->compact_map, it)
@@ -3065,6 +3542,12 @@ btc_pool_on_addr(btc_pool_t *pool,
     return;
   }
 
+  if (peer->block_relay) {
+    btc_pool_debug(pool, "Ignoring addr from block-relay peer (%N).",
+                         &peer->addr);
+    return;
+  }
+
   btc_vector_init(&relay);
 
   for (i = 0; i < addrs->length; i++) {
@@ -3111,7 +3594,7 @@ btc_pool_on_addr(btc_pool_t *pool,
     btc_vector_init(&peers);
 
     for (it = pool->peers.head; it != NULL; it = it->next) {
-      if (it->state == BTC_PEER_CONNECTED)
+      if (it->state == BTC_PEER_CONNECTED && !it->block_relay)
         btc_vector_push(&peers, it);
     }
 
@@ -3290,7 +3773,6 @@ static void
 btc_pool_request_txs(btc_pool_t *pool,
                      btc_peer_t *peer,
                      const btc_vector_t *hashes) {
-  btc_zinv_t inv;
   int64_t now;
   size_t i;
 
@@ -3300,67 +3782,22 @@ btc_pool_request_txs(btc_pool_t *pool,
     return;
   }
 
-  now = btc_time_msec();
-
-  btc_zinv_init(&inv);
-  btc_zinv_grow(&inv, hashes->length);
-
-  for (i = 0; i < hashes->length; i++) {
-    const uint8_t *hash = hashes->items[i];
-    uint8_t *key;
-
-    if (btc_hashset_has(&pool->tx_map, hash))
-      continue;
-
-    key = btc_hash_clone(hash);
-
-    btc_hashset_put(&pool->tx_map, key);
-    btc_hashtab_put(&peer->tx_map, key, now);
-
-    if (btc_chain_synced(pool->chain))
-      now += 50;
-
-    btc_zinv_push(&inv, btc_peer_tx_type(peer), hash);
-  }
-
-  if (inv.length == 0) {
-    btc_zinv_clear(&inv);
-    return;
-  }
-
-  if (peer->tx_map.size >= BTC_NET_MAX_TX_REQUEST) {
-    btc_zinv_clear(&inv);
+  if (peer->txs.announced.size + hashes->length > BTC_NET_MAX_TX_REQUEST) {
     btc_pool_warn(pool, "Peer advertised too many txs (%N).",
                         &peer->addr);
     btc_peer_close(peer);
     return;
   }
 
-  btc_pool_debug(pool, "Requesting %zu/%zu txs from peer with getdata (%N).",
-                       inv.length, (size_t)pool->tx_map.size, &peer->addr);
-
-  btc_peer_send_getdata(peer, &inv);
-
-  btc_zinv_clear(&inv);
-}
-
-static int
-btc_pool_has_tx(btc_pool_t *pool, const uint8_t *hash) {
-  /* Check the mempool. */
-  if (btc_mempool_has(pool->mempool, hash))
-    return 1;
+  if (hashes->length == 0)
+    return;
 
-  /* Check for orphans. */
-  if (btc_mempool_has_orphan(pool->mempool, hash))
-    return 1;
+  now = btc_time_msec();
 
-  /* If we recently rejected this item. Ignore. */
-  if (btc_mempool_has_reject(pool->mempool, hash)) {
-    btc_pool_spam(pool, "Saw known reject of %H.", hash);
-    return 1;
-  }
+  for (i = 0; i < hashes->length; i++)
+    btc_txreqs_announce(pool->txreqs, &peer->txs, hashes->items[i], now);
 
-  return 0;
+  btc_pool_fetch_txs(pool, peer, now);
 }
 
 static void
@@ -3372,6 +3809,13 @@ btc_pool_on_txinv(btc_pool_t *pool,
 
   CHECK(hashes->length > 0);
 
+  if (peer->block_relay) {
+    btc_pool_warn(pool, "Peer sent tx inv on block-relay connection (%N).",
+                        &peer->addr);
+    btc_peer_close(peer);
+    return;
+  }
+
   if (!btc_chain_synced(pool->chain))
     return;
 
@@ -3882,6 +4326,12 @@ btc_pool_add_block(btc_pool_t *pool,
     btc_pool_resync(pool, 0);
   }
 
+  /* Track who gives us new tips. */
+  if (btc_hash_equal(btc_chain_tip(pool->chain)->hash, hash)) {
+    peer->last_block = btc_time_msec();
+    pool->tip_time = peer->last_block;
+  }
+
   height = btc_chain_height(pool->chain);
 
   if (height % 20 == 0) {
@@ -3915,13 +4365,18 @@ btc_pool_on_block(btc_pool_t *pool,
 
 static void
 btc_pool_on_tx(btc_pool_t *pool, btc_peer_t *peer, const btc_tx_t *tx) {
-  if (!btc_pool_resolve_tx(pool, peer, tx->hash)) {
+  /* A late reply to a timed out request is still welcome. */
+  if (!btc_txreqs_received(pool->txreqs, &peer->txs, tx->hash)) {
     btc_pool_warn(pool, "Peer sent unrequested tx: %H (%N).",
                         tx->hash, &peer->addr);
     btc_peer_close(peer);
     return;
   }
 
+  /* Another announcer may have beaten it. */
+  if (btc_pool_has_tx(pool, tx->hash))
+    return;
+
   if (!btc_mempool_add(pool->mempool, tx, peer->id)) {
     btc_peer_reject(peer, "tx", btc_mempool_error(pool->mempool));
     return;
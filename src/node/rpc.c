@@ -96,7 +96,8 @@ enum rpc_error {
   RPC_WALLET_PASSPHRASE_INCORRECT = -14,
   RPC_WALLET_WRONG_ENC_STATE = -15,
   RPC_WALLET_ENCRYPTION_FAILED = -16,
-  RPC_WALLET_ALREADY_UNLOCKED = -17
+  RPC_WALLET_ALREADY_UNLOCKED = -17,
+  RPC_WALLET_NOT_FOUND = -18
 };
 
 /*
@@ -268,6 +269,8 @@ struct btc_rpc_s {
   btc_pool_t *pool;
   btc_wallet_t *wallet;
   http_server_t *http;
+  http_res_t *current;
+  const json_value *current_id;
   unsigned int flags;
   int port;
   btc_vector_t bind;
@@ -418,6 +421,61 @@ btc_rpc_close(btc_rpc_t *rpc) {
 #define THROW_TYPE(name, type) \
   THROW(RPC_TYPE_ERROR, "`" #name "` must be a(n) " #type)
 
+/*
+ * Deferred Calls
+ */
+
+typedef struct rpc_job_s {
+  http_res_t *res;
+  json_value *id;
+} rpc_job_t;
+
+static rpc_job_t *
+rpc_job_create(btc_rpc_t *rpc) {
+  const json_value *id = rpc->current_id;
+  rpc_job_t *job;
+
+  /* Only single calls made over HTTP can be deferred. */
+  if (rpc->current == NULL)
+    return NULL;
+
+  job = btc_malloc(sizeof(rpc_job_t));
+  job->res = rpc->current;
+  job->id = NULL;
+
+  if (id != NULL && id->type == json_integer)
+    job->id = json_integer_new(id->u.integer);
+  else if (id != NULL && id->type == json_string)
+    job->id = json_string_new(id->u.string.ptr);
+
+  return job;
+}
+
+static void
+rpc_job_destroy(rpc_job_t *job) {
+  if (job->id != NULL)
+    json_builder_free(job->id);
+
+  btc_free(job);
+}
+
+static void
+rpc_job_defer(rpc_job_t *job) {
+  http_res_hold(job->res);
+}
+
+static void
+rpc_job_finish(rpc_job_t *job, rpc_res_t *res) {
+  json_value *output = rpc_res_encode(res, job->id);
+
+  http_res_send_json(job->res, output);
+  http_res_release(job->res);
+
+  json_builder_free(output);
+
+  rpc_job_destroy(job);
+}
+
 /*
  * Call Helpers
  */
@@ -447,6 +505,24 @@ btc_rpc_get_depth(btc_rpc_t *rpc,
  * Blockchain
  */
 
+static void
+btc_rpc_dumpchainstate(btc_rpc_t *rpc,
+                       const json_params *params,
+                       rpc_res_t *res) {
+  const char *dst;
+
+  if (params->help || params->length != 1)
+    THROW_MISC("dumpchainstate \"destination\"");
+
+  if (!json_string_get(&dst, params->values[0]))
+    THROW_TYPE(destination, string);
+
+  if (!btc_chain_backup(rpc->chain, dst))
+    THROW(RPC_DATABASE_ERROR, "Could not backup chain");
+
+  res->result = json_null_new();
+}
+
 static void
 btc_rpc_getbestblockhash(btc_rpc_t *rpc,
                          const json_params *params,
@@ -762,6 +838,44 @@ btc_rpc_gettxoutsetinfo(btc_rpc_t *rpc,
     THROW_MISC("gettxoutsetinfo");
 }
 
+static void
+btc_rpc_invalidateblock(btc_rpc_t *rpc,
+                        const json_params *params,
+                        rpc_res_t *res) {
+  uint8_t hash[32];
+
+  if (params->help || params->length != 1)
+    THROW_MISC("invalidateblock \"blockhash\"");
+
+  if (!json_hash_get(hash, params->values[0]))
+    THROW_TYPE(blockhash, hash);
+
+  if (!btc_chain_has_hash(rpc->chain, hash))
+    THROW(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+  if (!btc_chain_invalidate(rpc->chain, hash))
+    THROW(RPC_DATABASE_ERROR, "Could not invalidate block");
+}
+
+static void
+btc_rpc_preciousblock(btc_rpc_t *rpc,
+                      const json_params *params,
+                      rpc_res_t *res) {
+  uint8_t hash[32];
+
+  if (params->help || params->length != 1)
+    THROW_MISC("preciousblock \"blockhash\"");
+
+  if (!json_hash_get(hash, params->values[0]))
+    THROW_TYPE(blockhash, hash);
+
+  if (!btc_chain_has_hash(rpc->chain, hash))
+    THROW(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+  if (!btc_chain_precious(rpc->chain, hash))
+    THROW(RPC_DATABASE_ERROR, "Could not activate best chain");
+}
+
 static void
 btc_rpc_pruneblockchain(btc_rpc_t *rpc,
                         const json_params *params,
@@ -772,6 +886,22 @@ btc_rpc_pruneblockchain(btc_rpc_t *rpc,
     THROW_MISC("pruneblockchain height");
 }
 
+static void
+btc_rpc_reconsiderblock(btc_rpc_t *rpc,
+                        const json_params *params,
+                        rpc_res_t *res) {
+  uint8_t hash[32];
+
+  if (params->help || params->length != 1)
+    THROW_MISC("reconsiderblock \"blockhash\"");
+
+  if (!json_hash_get(hash, params->values[0]))
+    THROW_TYPE(blockhash, hash);
+
+  if (!btc_chain_reconsider(rpc->chain, hash))
+    THROW(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+}
+
 static void
 btc_rpc_savemempool(btc_rpc_t *rpc,
                     const json_params *params,
@@ -1678,6 +1808,71 @@ btc_rpc_createaccount(btc_rpc_t *rpc,
   res->result = json_boolean_new(1);
 }
 
+static void
+btc_rpc_createwallet(btc_rpc_t *rpc,
+                     const json_params *params,
+                     rpc_res_t *res) {
+  btc_walopt_t opt = *btc_walopt_default;
+  const char *name, *seed = NULL;
+  btc_mnemonic_t mnemonic;
+  btc_hdnode_t chain;
+  json_value *obj;
+  uint64_t time;
+  int ok;
+
+  if (params->help || params->length < 1 || params->length > 3)
+    THROW_MISC("createwallet \"name\" ( \"seed\" timestamp )");
+
+  if (!json_string_get(&name, params->values[0]))
+    THROW_TYPE(name, string);
+
+  if (params->length > 1 && params->values[1]->type != json_null) {
+    if (!json_string_get(&seed, params->values[1]))
+      THROW_TYPE(seed, string);
+  }
+
+  /* Imported keys are scanned for from their birth. */
+  if (params->length > 2 && params->values[2]->type != json_null) {
+    if (!json_uint64_get(&time, params->values[2]) || time > INT64_MAX)
+      THROW_TYPE(timestamp, integer);
+
+    if (seed == NULL)
+      THROW(RPC_INVALID_PARAMETER, "Timestamp requires a seed");
+
+    opt.birth = time;
+  }
+
+  if (btc_node_get_wallet(rpc->node, name) != NULL)
+    THROW(RPC_WALLET_ERROR, "Wallet already loaded");
+
+  btc_mnemonic_init(&mnemonic);
+  btc_hdpriv_init(&chain);
+
+  /* The seed is either a BIP39 phrase or a master xprv. */
+  if (seed != NULL) {
+    if (btc_mnemonic_set_phrase(&mnemonic, seed))
+      opt.mnemonic = &mnemonic;
+    else if (btc_hdpriv_set_str(&chain, seed, rpc->network))
+      opt.chain = &chain;
+    else
+      THROW(RPC_INVALID_PARAMETER, "Invalid seed");
+  }
+
+  ok = (btc_node_create_wallet(rpc->node, name, &opt) != NULL);
+
+  btc_mnemonic_clear(&mnemonic);
+  btc_hdpriv_clear(&chain);
+
+  if (!ok)
+    THROW(RPC_WALLET_ERROR, "Could not create wallet");
+
+  obj = json_object_new(1);
+
+  json_object_push(obj, "name", json_string_new(name));
+
+  res->result = obj;
+}
+
 static void
 btc_rpc_deleteaccount(btc_rpc_t *rpc,
                       const json_params *params,
@@ -2465,6 +2660,47 @@ btc_rpc_listunspent(btc_rpc_t *rpc, const json_params *params, rpc_res_t *res) {
   res->result = coins;
 }
 
+static void
+btc_rpc_listwallets(btc_rpc_t *rpc, const json_params *params, rpc_res_t *res) {
+  btc_walletset_t *set = rpc->node->wallets;
+  json_value *obj;
+  size_t i;
+
+  if (params->help || params->length != 0)
+    THROW_MISC("listwallets");
+
+  obj = json_array_new(btc_walletset_size(set));
+
+  for (i = 0; i < btc_walletset_size(set); i++)
+    json_array_push(obj, json_string_new(btc_walletset_name(set, i)));
+
+  res->result = obj;
+}
+
+static void
+btc_rpc_loadwallet(btc_rpc_t *rpc, const json_params *params, rpc_res_t *res) {
+  const char *name;
+  json_value *obj;
+
+  if (params->help || params->length != 1)
+    THROW_MISC("loadwallet \"name\"");
+
+  if (!json_string_get(&name, params->values[0]))
+    THROW_TYPE(name, string);
+
+  if (btc_node_get_wallet(rpc->node, name) != NULL)
+    THROW(RPC_WALLET_ERROR, "Wallet already loaded");
+
+  if (!btc_node_load_wallet(rpc->node, name, 0))
+    THROW(RPC_WALLET_NOT_FOUND, "Could not load wallet");
+
+  obj = json_object_new(1);
+
+  json_object_push(obj, "name", json_string_new(name));
+
+  res->result = obj;
+}
+
 static void
 btc_rpc_lockunspent(btc_rpc_t *rpc, const json_params *params, rpc_res_t *res) {
   const json_value *items;
@@ -2859,6 +3095,27 @@ btc_rpc_signrawtransactionwithwallet(btc_rpc_t *rpc,
   btc_tx_destroy(tx);
 }
 
+static void
+btc_rpc_unloadwallet(btc_rpc_t *rpc,
+                     const json_params *params,
+                     rpc_res_t *res) {
+  const char *name;
+
+  if (params->help || params->length != 1)
+    THROW_MISC("unloadwallet \"name\"");
+
+  if (!json_string_get(&name, params->values[0]))
+    THROW_TYPE(name, string);
+
+  if (*name == '\0')
+    THROW(RPC_WALLET_ERROR, "Cannot unload the default wallet");
+
+  if (!btc_node_unload_wallet(rpc->node, name))
+    THROW(RPC_WALLET_NOT_FOUND, "Requested wallet is not loaded");
+
+  res->result = json_null_new();
+}
+
 static void
 btc_rpc_walletlock(btc_rpc_t *rpc, const json_params *params, rpc_res_t *res) {
   if (params->help || params->length != 0)
@@ -2872,12 +3129,29 @@ btc_rpc_walletlock(btc_rpc_t *rpc, const json_params *params, rpc_res_t *res) {
   res->result = json_null_new();
 }
 
+static void
+on_unlock(int result, void *arg) {
+  rpc_job_t *job = arg;
+  rpc_res_t res;
+
+  rpc_res_init(&res);
+
+  if (result)
+    res.result = json_null_new();
+  else
+    rpc_res_error(&res, RPC_WALLET_PASSPHRASE_INCORRECT,
+                        "Could not unlock wallet");
+
+  rpc_job_finish(job, &res);
+}
+
 static void
 btc_rpc_walletpassphrase(btc_rpc_t *rpc,
                          const json_params *params,
                          rpc_res_t *res) {
   int64_t msec = -1;
   const char *pass;
+  rpc_job_t *job;
   int timeout;
 
   if (params->help || params->length != 2)
@@ -2895,6 +3169,20 @@ btc_rpc_walletpassphrase(btc_rpc_t *rpc,
   if (timeout >= 0)
     msec = (int64_t)timeout * 1000;
 
+  /* Key derivation is slow. Run it on a worker
+     thread and respond once it completes. */
+  job = rpc_job_create(rpc);
+
+  if (job != NULL) {
+    if (btc_wallet_unlock_async(rpc->wallet, pass, msec, on_unlock, job)) {
+      rpc_job_defer(job);
+      btc_memzero((void *)pass, strlen(pass));
+      return;
+    }
+
+    rpc_job_destroy(job);
+  }
+
   if (!btc_wallet_unlock(rpc->wallet, pass, msec))
     THROW(RPC_WALLET_PASSPHRASE_INCORRECT, "Could not unlock wallet");
 
@@ -2946,12 +3234,14 @@ static void
 btc_rpc_watchaccount(btc_rpc_t *rpc,
                      const json_params *params,
                      rpc_res_t *res) {
-  const char *name, *xpub;
+  const char *name, *xpub, *type = NULL;
+  int64_t birth = -1;
   btc_hdnode_t key;
+  uint64_t time;
   size_t len;
 
-  if (params->help || params->length != 2)
-    THROW_MISC("watchaccount \"name\" \"xpubkey\"");
+  if (params->help || params->length < 2 || params->length > 4)
+    THROW_MISC("watchaccount \"name\" \"xpubkey\" ( timestamp \"type\" )");
 
   if (!json_string_get(&name, params->values[0]))
     THROW_TYPE(name, string);
@@ -2959,6 +3249,18 @@ btc_rpc_watchaccount(btc_rpc_t *rpc,
   if (!json_string_get(&xpub, params->values[1]))
     THROW_TYPE(xpubkey, string);
 
+  if (params->length > 2 && params->values[2]->type != json_null) {
+    if (!json_uint64_get(&time, params->values[2]) || time > INT64_MAX)
+      THROW_TYPE(timestamp, integer);
+
+    birth = time;
+  }
+
+  if (params->length > 3) {
+    if (!json_string_get(&type, params->values[3]))
+      THROW_TYPE(type, string);
+  }
+
   len = strlen(name);
 
   if (len == 0 || len > 63 ||
@@ -2970,19 +3272,43 @@ btc_rpc_watchaccount(btc_rpc_t *rpc,
   if (!btc_hdpub_set_str(&key, xpub, rpc->network))
     THROW(RPC_TYPE_ERROR, "Invalid xpubkey");
 
+  /* SLIP-132 has no taproot prefix: a BIP86 account
+     is an xpub which must be flagged explicitly. */
+  if (type != NULL) {
+    enum btc_bip32_type want;
+
+    if (strcmp(type, "legacy") == 0)
+      want = BTC_BIP32_STANDARD;
+    else if (strcmp(type, "p2sh-segwit") == 0)
+      want = BTC_BIP32_NESTED_P2WPKH;
+    else if (strcmp(type, "bech32") == 0)
+      want = BTC_BIP32_P2WPKH;
+    else if (strcmp(type, "bech32m") == 0)
+      want = BTC_BIP32_P2TR;
+    else
+      THROW(RPC_INVALID_PARAMETER, "Unknown address type");
+
+    if (want == BTC_BIP32_P2TR && key.type == BTC_BIP32_STANDARD)
+      key.type = want;
+
+    if (key.type != want)
+      THROW(RPC_INVALID_PARAMETER, "Address type does not match xpubkey");
+  }
+
   switch (key.type) {
     case BTC_BIP32_STANDARD:
     case BTC_BIP32_P2WPKH:
     case BTC_BIP32_NESTED_P2WPKH:
+    case BTC_BIP32_P2TR:
       break;
     default:
       THROW(RPC_TYPE_ERROR, "Invalid xpubkey type");
   }
 
-  if (key.depth != 2 || !(key.index & BTC_BIP32_HARDEN))
+  if (key.depth != 3 || !(key.index & BTC_BIP32_HARDEN))
     THROW(RPC_TYPE_ERROR, "Invalid xpubkey depth/index");
 
-  if (!btc_wallet_create_watcher(rpc->wallet, name, &key))
+  if (!btc_wallet_create_watcher(rpc->wallet, name, &key, birth))
     THROW(RPC_WALLET_ERROR, "Account already exists");
 
   res->result = json_boolean_new(1);
@@ -3008,10 +3334,12 @@ static const struct {
   { "clearbanned", btc_rpc_clearbanned },
   { "createaccount", btc_rpc_createaccount },
   { "createrawtransaction", btc_rpc_createrawtransaction },
+  { "createwallet", btc_rpc_createwallet },
   { "decoderawtransaction", btc_rpc_decoderawtransaction },
   { "decodescript", btc_rpc_decodescript },
   { "deleteaccount", btc_rpc_deleteaccount },
   { "disconnectnode", btc_rpc_disconnectnode },
+  { "dumpchainstate", btc_rpc_dumpchainstate },
   { "dumpprivkey", btc_rpc_dumpprivkey },
   { "dumpwallet", btc_rpc_dumpwallet },
   { "encryptwallet", btc_rpc_encryptwallet },
@@ -3059,16 +3387,21 @@ static const struct {
   { "getwalletinfo", btc_rpc_getwalletinfo },
   { "getwork", btc_rpc_getwork },
   { "help", btc_rpc_help },
+  { "invalidateblock", btc_rpc_invalidateblock },
   { "listaccounts", btc_rpc_listaccounts },
   { "listbanned", btc_rpc_listbanned },
   { "listlockunspent", btc_rpc_listlockunspent },
   { "listsinceblock", btc_rpc_listsinceblock },
   { "listtransactions", btc_rpc_listtransactions },
   { "listunspent", btc_rpc_listunspent },
+  { "listwallets", btc_rpc_listwallets },
+  { "loadwallet", btc_rpc_loadwallet },
   { "lockunspent", btc_rpc_lockunspent },
   { "ping", btc_rpc_ping },
+  { "preciousblock", btc_rpc_preciousblock },
   { "prioritisetransaction", btc_rpc_prioritisetransaction },
   { "pruneblockchain", btc_rpc_pruneblockchain },
+  { "reconsiderblock", btc_rpc_reconsiderblock },
   { "renameaccount", btc_rpc_renameaccount },
   { "rescanblockchain", btc_rpc_rescanblockchain },
   { "resendwallettransactions", btc_rpc_resendwallettransactions },
@@ -3090,6 +3423,7 @@ static const struct {
   { "stop", btc_rpc_stop },
   { "submitblock", btc_rpc_submitblock },
   { "testmempoolaccept", btc_rpc_testmempoolaccept },
+  { "unloadwallet", btc_rpc_unloadwallet },
   { "uptime", btc_rpc_uptime },
   { "validateaddress", btc_rpc_validateaddress },
   { "verifychain", btc_rpc_verifychain },
@@ -3136,6 +3470,12 @@ btc_rpc_handle(btc_rpc_t *rpc, const rpc_req_t *req, rpc_res_t *res) {
     return;
   }
 
+  if (rpc->wallet == NULL) {
+    rpc_res_error(res, RPC_WALLET_NOT_FOUND,
+                  "Requested wallet does not exist or is not loaded");
+    return;
+  }
+
   btc_log_debug(rpc, "Handling RPC call: %s.", req->method);
 
   if (req->params == NULL || req->params->type == json_null) {
@@ -3191,7 +3531,13 @@ on_request(http_server_t *server, http_req_t *req, http_res_t *res) {
     return 1;
   }
 
-  if (req->path.length != 1 || req->path.data[0] != '/') {
+  if (req->path.length == 1 && req->path.data[0] == '/') {
+    rpc->wallet = rpc->node->wallet;
+  } else if (btc_starts_with(req->path.data, "/wallet/")) {
+    const char *name = req->path.data + 8;
+
+    rpc->wallet = btc_node_get_wallet(rpc->node, name);
+  } else {
     http_res_error(res, 404);
     return 1;
   }
@@ -3231,11 +3577,25 @@ on_request(http_server_t *server, http_req_t *req, http_res_t *res) {
     rpc_req_init(&rreq);
     rpc_res_init(&rres);
 
-    if (!rpc_req_set(&rreq, input))
+    if (!rpc_req_set(&rreq, input)) {
       rpc_res_error(&rres, RPC_INVALID_REQUEST, "Invalid request");
-    else
+    } else {
+      rpc->current = res;
+      rpc->current_id = rreq.id;
+
       btc_rpc_handle(rpc, &rreq, &rres);
 
+      rpc->current = NULL;
+      rpc->current_id = NULL;
+    }
+
+    /* The handler will respond later. */
+    if (res->held) {
+      rpc->wallet = rpc->node->wallet;
+      json_value_free(input);
+      return 1;
+    }
+
     output = rpc_res_encode(&rres, rreq.id);
   }
 
@@ -3244,6 +3604,8 @@ on_request(http_server_t *server, http_req_t *req, http_res_t *res) {
   json_value_free(input); /* Accepts NULL. */
   json_builder_free(output);
 
+  rpc->wallet = rpc->node->wallet;
+
   return 1;
 }
 
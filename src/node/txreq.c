@@ -0,0 +1,420 @@
+/*!
+ * txreq.c - tx request tracker for mako
+ * Copyright (c) 2021, Christopher Jeffrey (MIT License).
+ * https://github.com/chjj/mako
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <node/txreq.h>
+
+#include <mako/map.h>
+#include <mako/net.h>
+#include <mako/util.h>
+#include <mako/vector.h>
+
+#include "../impl.h"
+#include "../internal.h"
+
+/* Every peer announcing a txid is remembered, but the tx is only
+ * requested from one of them at a time. Outbound peers are preferred
+ * over inbound ones, then peers with a lower ping. Inbound announcements
+ * wait a moment before they can be acted upon, giving outbound peers a
+ * chance to announce the same tx. If the request times out or the peer
+ * replies with notfound, that peer's announcement is dropped and the tx
+ * is requested from the next best announcer on the next poll.
+ *
+ * Each peer also remembers what was actually requested from it. A tx
+ * or notfound arriving after the request timed out, or after another
+ * announcer delivered first, is then recognized as a reply and not
+ * mistaken for unrequested data.
+ */
+
+/*
+ * Types
+ */
+
+typedef struct btc_txann_s {
+  btc_txpeer_t *peer;
+  int64_t time;
+  struct btc_txann_s *next;
+} btc_txann_t;
+
+typedef struct btc_txreq_s {
+  uint8_t hash[32];
+  btc_txann_t *head;
+  btc_txpeer_t *peer;
+  int64_t expires;
+} btc_txreq_t;
+
+struct btc_txreqs_s {
+  btc_hashmap_t map;
+};
+
+/*
+ * TX Peer
+ */
+
+void
+btc_txpeer_init(btc_txpeer_t *peer) {
+  peer->outbound = 0;
+  peer->ping = -1;
+  peer->inflight = 0;
+
+  btc_hashset_init(&peer->announced);
+  btc_hashtab_init(&peer->requested);
+}
+
+void
+btc_txpeer_clear(btc_txpeer_t *peer) {
+  btc_mapiter_t it;
+
+  /* Announcements belong to the tracker. */
+  CHECK(peer->announced.size == 0);
+
+  btc_map_each(&peer->requested, it)
+    btc_free(peer->requested.keys[it]);
+
+  btc_hashset_clear(&peer->announced);
+  btc_hashtab_clear(&peer->requested);
+}
+
+static void
+btc_txpeer_mark(btc_txpeer_t *peer, const uint8_t *hash, int64_t now) {
+  uint8_t *key = btc_hashtab_del(&peer->requested, hash);
+
+  if (key == NULL)
+    key = btc_hash_clone(hash);
+
+  CHECK(btc_hashtab_put(&peer->requested, key, now));
+}
+
+static int
+btc_txpeer_unmark(btc_txpeer_t *peer, const uint8_t *hash) {
+  uint8_t *key = btc_hashtab_del(&peer->requested, hash);
+
+  if (key == NULL)
+    return 0;
+
+  btc_free(key);
+
+  return 1;
+}
+
+static void
+btc_txpeer_expire(btc_txpeer_t *peer, int64_t now) {
+  btc_mapiter_t it;
+
+  btc_map_each(&peer->requested, it) {
+    if (now < peer->requested.vals[it] + BTC_NET_TX_LATE_TIMEOUT)
+      continue;
+
+    btc_free(peer->requested.keys[it]);
+
+    btc_hashtab_remove(&peer->requested, it);
+  }
+}
+
+/*
+ * TX Request
+ */
+
+static btc_txreq_t *
+btc_txreq_create(const uint8_t *hash) {
+  btc_txreq_t *req = (btc_txreq_t *)btc_malloc(sizeof(btc_txreq_t));
+
+  btc_hash_copy(req->hash, hash);
+
+  req->head = NULL;
+  req->peer = NULL;
+  req->expires = 0;
+
+  return req;
+}
+
+static void
+btc_txreq_destroy(btc_txreq_t *req) {
+  btc_txann_t *ann, *next;
+
+  for (ann = req->head; ann != NULL; ann = next) {
+    next = ann->next;
+    btc_free(ann);
+  }
+
+  btc_free(req);
+}
+
+static void
+btc_txreq_add(btc_txreq_t *req, btc_txpeer_t *peer, int64_t time) {
+  btc_txann_t *ann = (btc_txann_t *)btc_malloc(sizeof(btc_txann_t));
+
+  ann->peer = peer;
+  ann->time = time;
+  ann->next = req->head;
+
+  req->head = ann;
+}
+
+static void
+btc_txreq_remove(btc_txreq_t *req, const btc_txpeer_t *peer) {
+  btc_txann_t **link = &req->head;
+  btc_txann_t *ann;
+
+  while (*link != NULL) {
+    ann = *link;
+
+    if (ann->peer == peer) {
+      *link = ann->next;
+      btc_free(ann);
+      return;
+    }
+
+    link = &ann->next;
+  }
+}
+
+static int
+btc_txann_better(const btc_txann_t *x, const btc_txann_t *y) {
+  const btc_txpeer_t *a = x->peer;
+  const btc_txpeer_t *b = y->peer;
+
+  if (a->outbound != b->outbound)
+    return a->outbound;
+
+  if (a->ping != b->ping) {
+    if (a->ping == -1)
+      return 0;
+
+    if (b->ping == -1)
+      return 1;
+
+    return a->ping < b->ping;
+  }
+
+  return x->time < y->time;
+}
+
+static btc_txpeer_t *
+btc_txreq_select(const btc_txreq_t *req, int64_t now) {
+  const btc_txann_t *best = NULL;
+  const btc_txann_t *ann;
+
+  for (ann = req->head; ann != NULL; ann = ann->next) {
+    if (ann->time > now)
+      continue;
+
+    if (ann->peer->inflight >= BTC_NET_MAX_TX_INFLIGHT)
+      continue;
+
+    if (best == NULL || btc_txann_better(ann, best))
+      best = ann;
+  }
+
+  return best != NULL ? best->peer : NULL;
+}
+
+/*
+ * TX Requests
+ */
+
+btc_txreqs_t *
+btc_txreqs_create(void) {
+  btc_txreqs_t *reqs = (btc_txreqs_t *)btc_malloc(sizeof(btc_txreqs_t));
+
+  btc_hashmap_init(&reqs->map);
+
+  return reqs;
+}
+
+void
+btc_txreqs_destroy(btc_txreqs_t *reqs) {
+  btc_mapiter_t it;
+
+  btc_map_each(&reqs->map, it)
+    btc_txreq_destroy(reqs->map.vals[it]);
+
+  btc_hashmap_clear(&reqs->map);
+
+  btc_free(reqs);
+}
+
+size_t
+btc_txreqs_size(const btc_txreqs_t *reqs) {
+  return reqs->map.size;
+}
+
+int
+btc_txreqs_has(const btc_txreqs_t *reqs, const uint8_t *hash) {
+  return btc_hashmap_has(&reqs->map, hash);
+}
+
+static void
+btc_txreqs_assign(btc_txreq_t *req, btc_txpeer_t *peer, int64_t now) {
+  CHECK(req->peer == NULL);
+
+  req->peer = peer;
+  req->expires = now + BTC_NET_TX_TIMEOUT;
+
+  peer->inflight++;
+
+  btc_txpeer_mark(peer, req->hash, now);
+}
+
+static void
+btc_txreqs_drop(btc_txreqs_t *reqs, btc_txreq_t *req, btc_txpeer_t *peer) {
+  CHECK(btc_hashset_del(&peer->announced, req->hash));
+
+  btc_txreq_remove(req, peer);
+
+  if (req->peer == peer) {
+    req->peer = NULL;
+    peer->inflight--;
+  }
+
+  if (req->head == NULL) {
+    CHECK(btc_hashmap_del(&reqs->map, req->hash));
+    btc_txreq_destroy(req);
+  }
+}
+
+static void
+btc_txreqs_delete(btc_txreqs_t *reqs, btc_txreq_t *req) {
+  btc_txann_t *ann;
+
+  for (ann = req->head; ann != NULL; ann = ann->next)
+    CHECK(btc_hashset_del(&ann->peer->announced, req->hash));
+
+  if (req->peer != NULL)
+    req->peer->inflight--;
+
+  CHECK(btc_hashmap_del(&reqs->map, req->hash));
+
+  btc_txreq_destroy(req);
+}
+
+void
+btc_txreqs_announce(btc_txreqs_t *reqs,
+                    btc_txpeer_t *peer,
+                    const uint8_t *hash,
+                    int64_t now) {
+  btc_txreq_t *req = btc_hashmap_get(&reqs->map, hash);
+
+  if (req == NULL) {
+    req = btc_txreq_create(hash);
+
+    CHECK(btc_hashmap_put(&reqs->map, req->hash, req));
+  }
+
+  if (!btc_hashset_put(&peer->announced, req->hash))
+    return;
+
+  if (!peer->outbound)
+    now += BTC_NET_TX_INBOUND_DELAY;
+
+  btc_txreq_add(req, peer, now);
+}
+
+size_t
+btc_txreqs_poll(btc_vector_t *out,
+                btc_txreqs_t *reqs,
+                btc_txpeer_t *peer,
+                int64_t now) {
+  /* Returns the number of requests which timed out. */
+  size_t expired = 0;
+  btc_mapiter_t it;
+
+  btc_txpeer_expire(peer, now);
+
+  btc_map_each(&peer->announced, it) {
+    btc_txreq_t *req = btc_hashmap_get(&reqs->map, peer->announced.keys[it]);
+
+    CHECK(req != NULL);
+
+    if (req->peer == peer) {
+      if (now < req->expires)
+        continue;
+
+      btc_txreqs_drop(reqs, req, peer);
+
+      expired++;
+
+      continue;
+    }
+
+    if (req->peer != NULL)
+      continue;
+
+    if (btc_txreq_select(req, now) != peer)
+      continue;
+
+    btc_txreqs_assign(req, peer, now);
+
+    btc_vector_push(out, req->hash);
+  }
+
+  return expired;
+}
+
+int
+btc_txreqs_received(btc_txreqs_t *reqs,
+                    btc_txpeer_t *peer,
+                    const uint8_t *hash) {
+  /* Returns false if the tx was neither announced by nor requested
+     from the peer. */
+  btc_txreq_t *req = btc_hashmap_get(&reqs->map, hash);
+  int requested = btc_txpeer_unmark(peer, hash);
+
+  if (req != NULL) {
+    if (!requested && !btc_hashset_has(&peer->announced, hash))
+      return 0;
+
+    btc_txreqs_delete(reqs, req);
+
+    return 1;
+  }
+
+  return requested;
+}
+
+int
+btc_txreqs_notfound(btc_txreqs_t *reqs,
+                    btc_txpeer_t *peer,
+                    const uint8_t *hash) {
+  /* Returns false if the tx was never requested from the peer. */
+  btc_txreq_t *req = btc_hashmap_get(&reqs->map, hash);
+
+  if (!btc_txpeer_unmark(peer, hash))
+    return 0;
+
+  if (req != NULL && req->peer == peer)
+    btc_txreqs_drop(reqs, req, peer);
+
+  return 1;
+}
+
+void
+btc_txreqs_forget(btc_txreqs_t *reqs, const uint8_t *hash) {
+  btc_txreq_t *req = btc_hashmap_get(&reqs->map, hash);
+
+  if (req != NULL)
+    btc_txreqs_delete(reqs, req);
+}
+
+void
+btc_txreqs_remove(btc_txreqs_t *reqs, btc_txpeer_t *peer) {
+  /* In-flight requests go to the next
+     best announcer on the next poll. */
+  btc_mapiter_t it;
+
+  btc_map_each(&peer->announced, it) {
+    btc_txreq_t *req = btc_hashmap_get(&reqs->map, peer->announced.keys[it]);
+
+    CHECK(req != NULL);
+
+    btc_txreqs_drop(reqs, req, peer);
+  }
+
+  CHECK(peer->inflight == 0);
+}
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <mako/crypto/rand.h>
 #include <mako/policy.h>
 #include "internal.h"
 
@@ -57,3 +58,22 @@ btc_get_rate(int64_t fee, size_t size) {
 
   return (fee * 1000) / (int64_t)size;
 }
+
+int64_t
+btc_round_filter(int64_t rate, int64_t min_relay) {
+  /* Round to one of a fixed set of buckets spaced 10%
+     apart, usually the one below, so that the filter we
+     advertise does not fingerprint our mempool. */
+  double bucket = min_relay < 2 ? 1 : min_relay / 2;
+  double prev = -1;
+
+  while (bucket < rate && bucket <= 1e7) {
+    prev = bucket;
+    bucket *= 1.1;
+  }
+
+  if (bucket > 1e7 || (prev >= 0 && btc_uniform(3) != 0))
+    bucket = prev;
+
+  return (int64_t)bucket;
+}
@@ -1068,6 +1068,33 @@ btc_script_set_p2wsh(btc_script_t *script, const uint8_t *hash) {
   memcpy(zp + 2, hash, 32);
 }
 
+int
+btc_script_is_p2tr(const btc_script_t *script) {
+  return script->length == 34
+      && script->data[0] == BTC_OP_1
+      && script->data[1] == 32;
+}
+
+int
+btc_script_get_p2tr(const uint8_t **key, const btc_script_t *script) {
+  if (!btc_script_is_p2tr(script))
+    return 0;
+
+  *key = script->data + 2;
+
+  return 1;
+}
+
+void
+btc_script_set_p2tr(btc_script_t *script, const uint8_t *key) {
+  uint8_t *zp = btc_script_resize(script, 34);
+
+  zp[0] = BTC_OP_1;
+  zp[1] = 32;
+
+  memcpy(zp + 2, key, 32);
+}
+
 int
 btc_script_is_unknown(const btc_script_t *script) {
   return !btc_script_is_p2pk(script)
@@ -1075,6 +1102,7 @@ btc_script_is_unknown(const btc_script_t *script) {
       && !btc_script_is_p2sh(script)
       && !btc_script_is_p2wpkh(script)
       && !btc_script_is_p2wsh(script)
+      && !btc_script_is_p2tr(script)
       && !btc_script_is_multisig(script)
       && !btc_script_is_nulldata(script);
 }
@@ -1594,18 +1622,130 @@ checksig(const uint8_t *msg, const btc_buffer_t *sig, const btc_buffer_t *key) {
   return btc_ecdsa_verify(msg, 32, tmp, key->data, key->length);
 }
 
-#define THROW(x) do { err = (x); goto done; } while (0)
+/*
+ * Tapscript Execution
+ */
 
-int
-btc_script_execute(const btc_script_t *script,
-                   btc_stack_t *stack,
+typedef struct btc_execdata_s {
+  const btc_script_t *output;
+  const btc_buffer_t *annex;
+  uint8_t leaf[32];
+  uint32_t codesep;
+  int64_t weight;
+} btc_execdata_t;
+
+static void
+btc_execdata_init(btc_execdata_t *exec, const btc_script_t *output) {
+  exec->output = output;
+  exec->annex = NULL;
+  memset(exec->leaf, 0, 32);
+  exec->codesep = UINT32_MAX;
+  exec->weight = 0;
+}
+
+static int
+is_op_success(int value) {
+  return value == 80 || value == 98
+      || (value >= 126 && value <= 129)
+      || (value >= 131 && value <= 134)
+      || (value >= 137 && value <= 138)
+      || (value >= 141 && value <= 142)
+      || (value >= 149 && value <= 153)
+      || (value >= 187 && value <= 254);
+}
+
+static int
+checksig_schnorr(const btc_buffer_t *sig,
+                 const uint8_t *key,
+                 const btc_tx_t *tx,
+                 size_t index,
+                 int64_t value,
+                 btc_tx_cache_t *cache,
+                 const btc_execdata_t *exec,
+                 int tapscript) {
+  uint8_t hash[32];
+  int type = 0;
+
+  if (sig->length == 65) {
+    type = sig->data[64];
+
+    /* SIGHASH_DEFAULT must be implicit. */
+    if (type == 0)
+      return BTC_SCRIPT_ERR_SCHNORR_SIG_HASHTYPE;
+  } else if (sig->length != 64) {
+    return BTC_SCRIPT_ERR_SCHNORR_SIG_SIZE;
+  }
+
+  if (tx == NULL || cache == NULL || !cache->has_taproot)
+    return BTC_SCRIPT_ERR_UNKNOWN_ERROR;
+
+  if (!btc_tx_sighash_taproot(hash, tx, index, exec->output, value, type,
+                              exec->annex, tapscript ? exec->leaf : NULL,
+                              exec->codesep, cache)) {
+    return BTC_SCRIPT_ERR_SCHNORR_SIG_HASHTYPE;
+  }
+
+  /* Defer to the batch if we have one. */
+  if (cache->batch != NULL) {
+    btc_sigbatch_push(cache->batch, hash, sig->data, key);
+    return BTC_SCRIPT_ERR_OK;
+  }
+
+  if (!btc_bip340_verify(hash, 32, sig->data, key))
+    return BTC_SCRIPT_ERR_SCHNORR_SIG;
+
+  return BTC_SCRIPT_ERR_OK;
+}
+
+static int
+checksig_tapscript(int *res,
+                   const btc_buffer_t *sig,
+                   const btc_buffer_t *key,
                    unsigned int flags,
                    const btc_tx_t *tx,
                    size_t index,
                    int64_t value,
-                   int version,
-                   btc_tx_cache_t *cache) {
+                   btc_tx_cache_t *cache,
+                   btc_execdata_t *exec) {
+  *res = (sig->length > 0);
+
+  if (*res) {
+    exec->weight -= BTC_VALIDATION_WEIGHT_PER_SIGOP;
+
+    if (exec->weight < 0)
+      return BTC_SCRIPT_ERR_TAPSCRIPT_VALIDATION_WEIGHT;
+  }
+
+  if (key->length == 0)
+    return BTC_SCRIPT_ERR_PUBKEYTYPE;
+
+  if (key->length == 32) {
+    if (*res)
+      return checksig_schnorr(sig, key->data, tx, index,
+                              value, cache, exec, 1);
+  } else {
+    /* Unknown key types succeed (for now). */
+    if (flags & BTC_SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_PUBKEYTYPE)
+      return BTC_SCRIPT_ERR_DISCOURAGE_UPGRADABLE_PUBKEYTYPE;
+  }
+
+  return BTC_SCRIPT_ERR_OK;
+}
+
+#define THROW(x) do { err = (x); goto done; } while (0)
+
+static int
+btc_script_exec(const btc_script_t *script,
+                btc_stack_t *stack,
+                unsigned int flags,
+                const btc_tx_t *tx,
+                size_t index,
+                int64_t value,
+                int version,
+                btc_tx_cache_t *cache,
+                btc_execdata_t *exec) {
   int err = BTC_SCRIPT_ERR_OK;
+  uint32_t position = 0;
   int opcount = 0;
   int negate = 0;
   int minimal = 0;
@@ -1617,7 +1757,7 @@ btc_script_execute(const btc_script_t *script,
   btc_script_t subscript;
   btc_opcode_t op;
 
-  if (script->length > BTC_MAX_SCRIPT_SIZE)
+  if (version < 2 && script->length > BTC_MAX_SCRIPT_SIZE)
     return BTC_SCRIPT_ERR_SCRIPT_SIZE;
 
   if (flags & BTC_SCRIPT_VERIFY_MINIMALDATA)
@@ -1633,11 +1773,17 @@ btc_script_execute(const btc_script_t *script,
     if (!btc_reader_next(&op, &reader))
       THROW(BTC_SCRIPT_ERR_BAD_OPCODE);
 
+    /* Opcode position (for tapscript codeseparators). */
+    position += 1;
+
     if (op.length > BTC_MAX_SCRIPT_PUSH)
       THROW(BTC_SCRIPT_ERR_PUSH_SIZE);
 
-    if (op.value > BTC_OP_16 && ++opcount > BTC_MAX_SCRIPT_OPS)
-      THROW(BTC_SCRIPT_ERR_OP_COUNT);
+    /* Tapscript has no opcode limit. */
+    if (version < 2) {
+      if (op.value > BTC_OP_16 && ++opcount > BTC_MAX_SCRIPT_OPS)
+        THROW(BTC_SCRIPT_ERR_OP_COUNT);
+    }
 
     if (btc_opcode_is_disabled(&op))
       THROW(BTC_SCRIPT_ERR_DISABLED_OPCODE);
@@ -1771,6 +1917,17 @@ btc_script_execute(const btc_script_t *script,
               THROW(BTC_SCRIPT_ERR_MINIMALIF);
           }
 
+          /* MINIMALIF is consensus in tapscript. */
+          if (version == 2) {
+            const btc_buffer_t *item = btc_stack_get(stack, -1);
+
+            if (item->length > 1)
+              THROW(BTC_SCRIPT_ERR_TAPSCRIPT_MINIMALIF);
+
+            if (item->length == 1 && item->data[0] != 1)
+              THROW(BTC_SCRIPT_ERR_TAPSCRIPT_MINIMALIF);
+          }
+
           val = btc_stack_get_bool(stack, -1);
 
           if (op.value == BTC_OP_NOTIF)
@@ -2306,6 +2463,10 @@ btc_script_execute(const btc_script_t *script,
       case BTC_OP_CODESEPARATOR: {
         begin.data = reader.data;
         begin.length = reader.length;
+
+        if (version == 2)
+          exec->codesep = position - 1;
+
         break;
       }
       case BTC_OP_CHECKSIG:
@@ -2323,6 +2484,25 @@ btc_script_execute(const btc_script_t *script,
         sig = btc_stack_get(stack, -2);
         key = btc_stack_get(stack, -1);
 
+        if (version == 2) {
+          if ((err = checksig_tapscript(&res, sig, key, flags, tx,
+                                        index, value, cache, exec))) {
+            goto done;
+          }
+
+          btc_stack_drop(stack);
+          btc_stack_drop(stack);
+
+          if (op.value == BTC_OP_CHECKSIGVERIFY) {
+            if (!res)
+              THROW(BTC_SCRIPT_ERR_CHECKSIGVERIFY);
+          } else {
+            btc_stack_push_robool(stack, res);
+          }
+
+          break;
+        }
+
         btc_script_set(&subscript, begin.data, begin.length);
 
         if (version == 0)
@@ -2364,6 +2544,39 @@ btc_script_execute(const btc_script_t *script,
 
         break;
       }
+      case BTC_OP_CHECKSIGADD: {
+        const btc_buffer_t *sig, *key;
+        int64_t num;
+        int res;
+
+        if (version != 2)
+          THROW(BTC_SCRIPT_ERR_BAD_OPCODE);
+
+        if (tx == NULL)
+          THROW(BTC_SCRIPT_ERR_UNKNOWN_ERROR);
+
+        if (stack->length < 3)
+          THROW(BTC_SCRIPT_ERR_INVALID_STACK_OPERATION);
+
+        sig = btc_stack_get(stack, -3);
+        key = btc_stack_get(stack, -1);
+
+        if (!btc_stack_get_num(&num, stack, -2, minimal, 4))
+          THROW(BTC_SCRIPT_ERR_UNKNOWN_ERROR);
+
+        if ((err = checksig_tapscript(&res, sig, key, flags, tx,
+                                      index, value, cache, exec))) {
+          goto done;
+        }
+
+        btc_stack_drop(stack);
+        btc_stack_drop(stack);
+        btc_stack_drop(stack);
+
+        btc_stack_push_num(stack, num + res);
+
+        break;
+      }
       case BTC_OP_CHECKMULTISIG:
       case BTC_OP_CHECKMULTISIGVERIFY: {
         int i, j, m, n, okey, ikey, isig;
@@ -2371,6 +2584,9 @@ btc_script_execute(const btc_script_t *script,
         uint8_t hash[32];
         int res, type;
 
+        if (version == 2)
+          THROW(BTC_SCRIPT_ERR_TAPSCRIPT_CHECKMULTISIG);
+
         if (tx == NULL)
           THROW(BTC_SCRIPT_ERR_UNKNOWN_ERROR);
 
@@ -2504,15 +2720,185 @@ done:
   return err;
 }
 
+int
+btc_script_execute(const btc_script_t *script,
+                   btc_stack_t *stack,
+                   unsigned int flags,
+                   const btc_tx_t *tx,
+                   size_t index,
+                   int64_t value,
+                   int version,
+                   btc_tx_cache_t *cache) {
+  CHECK(version == 0 || version == 1);
+  return btc_script_exec(script, stack, flags, tx,
+                         index, value, version, cache, NULL);
+}
+
 static int
-btc_script_verify_program(const btc_stack_t *witness,
+btc_script_execute_tapscript(const btc_script_t *script,
+                             btc_stack_t *stack,
+                             unsigned int flags,
+                             const btc_tx_t *tx,
+                             size_t index,
+                             int64_t value,
+                             btc_tx_cache_t *cache,
+                             btc_execdata_t *exec) {
+  btc_reader_t reader;
+  btc_opcode_t op;
+  size_t i;
+  int err;
+
+  /* OP_SUCCESSx short-circuits everything, including parse errors
+     occurring after it. This is what makes upgrades possible. */
+  btc_reader_init(&reader, script);
+
+  while (reader.length > 0) {
+    if (!btc_reader_next(&op, &reader))
+      return BTC_SCRIPT_ERR_BAD_OPCODE;
+
+    if (is_op_success(op.value)) {
+      if (flags & BTC_SCRIPT_VERIFY_DISCOURAGE_OP_SUCCESS)
+        return BTC_SCRIPT_ERR_DISCOURAGE_OP_SUCCESS;
+
+      return BTC_SCRIPT_ERR_OK;
+    }
+  }
+
+  /* Initial stack limits. */
+  if (stack->length > BTC_MAX_SCRIPT_STACK)
+    return BTC_SCRIPT_ERR_STACK_SIZE;
+
+  for (i = 0; i < stack->length; i++) {
+    if (stack->items[i]->length > BTC_MAX_SCRIPT_PUSH)
+      return BTC_SCRIPT_ERR_PUSH_SIZE;
+  }
+
+  if ((err = btc_script_exec(script, stack, flags, tx,
+                             index, value, 2, cache, exec))) {
+    return err;
+  }
+
+  /* Tapscript always requires a clean stack. */
+  if (stack->length != 1)
+    return BTC_SCRIPT_ERR_CLEANSTACK;
+
+  if (!btc_stack_get_bool(stack, -1))
+    return BTC_SCRIPT_ERR_EVAL_FALSE;
+
+  return BTC_SCRIPT_ERR_OK;
+}
+
+static int
+btc_script_verify_taproot(const btc_stack_t *witness,
                           const btc_script_t *output,
+                          const uint8_t *key,
                           unsigned int flags,
                           const btc_tx_t *tx,
                           size_t index,
                           int64_t value,
                           btc_tx_cache_t *cache) {
   int err = BTC_SCRIPT_ERR_OK;
+  btc_buffer_t *annex = NULL;
+  btc_buffer_t *control = NULL;
+  btc_script_t *script = NULL;
+  btc_execdata_t exec;
+  btc_stack_t stack;
+  uint8_t root[32];
+  uint8_t tweak[32];
+  int version;
+
+  if (witness->length == 0)
+    return BTC_SCRIPT_ERR_WITNESS_PROGRAM_WITNESS_EMPTY;
+
+  btc_execdata_init(&exec, output);
+
+  btc_stack_init(&stack);
+  btc_stack_assign(&stack, witness);
+
+  /* Remove the annex, if present. */
+  if (stack.length >= 2) {
+    const btc_buffer_t *item = btc_stack_get(&stack, -1);
+
+    if (item->length > 0 && item->data[0] == BTC_TAPROOT_ANNEX_TAG) {
+      annex = btc_stack_pop(&stack);
+      exec.annex = annex;
+    }
+  }
+
+  /* Key path spend. */
+  if (stack.length == 1) {
+    err = checksig_schnorr(btc_stack_get(&stack, -1), key, tx,
+                           index, value, cache, &exec, 0);
+    goto done;
+  }
+
+  /* Script path spend. */
+  control = btc_stack_pop(&stack);
+  script = btc_stack_pop(&stack);
+
+  if (control->length < BTC_TAPROOT_CONTROL_BASE_SIZE)
+    THROW(BTC_SCRIPT_ERR_TAPROOT_WRONG_CONTROL_SIZE);
+
+  if (control->length > BTC_TAPROOT_CONTROL_BASE_SIZE
+                      + BTC_TAPROOT_CONTROL_NODE_SIZE
+                      * BTC_TAPROOT_CONTROL_MAX_NODES) {
+    THROW(BTC_SCRIPT_ERR_TAPROOT_WRONG_CONTROL_SIZE);
+  }
+
+  if ((control->length - BTC_TAPROOT_CONTROL_BASE_SIZE)
+      % BTC_TAPROOT_CONTROL_NODE_SIZE != 0) {
+    THROW(BTC_SCRIPT_ERR_TAPROOT_WRONG_CONTROL_SIZE);
+  }
+
+  version = control->data[0] & BTC_TAPROOT_LEAF_MASK;
+
+  btc_taproot_leaf_hash(exec.leaf, version, script);
+
+  btc_taproot_root(root, exec.leaf,
+                   control->data + BTC_TAPROOT_CONTROL_BASE_SIZE,
+                   (control->length - BTC_TAPROOT_CONTROL_BASE_SIZE)
+                   / BTC_TAPROOT_CONTROL_NODE_SIZE);
+
+  btc_taproot_tweak_hash(tweak, control->data + 1, root);
+
+  if (!btc_bip340_pubkey_tweak_add_check(control->data + 1, tweak,
+                                         key, control->data[0] & 1)) {
+    THROW(BTC_SCRIPT_ERR_WITNESS_PROGRAM_MISMATCH);
+  }
+
+  if (version == BTC_TAPROOT_LEAF_TAPSCRIPT) {
+    exec.weight = btc_stack_size(witness) + BTC_VALIDATION_WEIGHT_OFFSET;
+
+    err = btc_script_execute_tapscript(script, &stack, flags, tx,
+                                       index, value, cache, &exec);
+    goto done;
+  }
+
+  /* Unknown leaf versions succeed (for now). */
+  if (flags & BTC_SCRIPT_VERIFY_DISCOURAGE_UPGRADABLE_TAPROOT_VERSION)
+    THROW(BTC_SCRIPT_ERR_DISCOURAGE_UPGRADABLE_TAPROOT_VERSION);
+
+done:
+  btc_stack_clear(&stack);
+  if (annex != NULL)
+    btc_buffer_destroy(annex);
+  if (control != NULL)
+    btc_buffer_destroy(control);
+  if (script != NULL)
+    btc_script_destroy(script);
+  return err;
+}
+
+static int
+btc_script_verify_program(const btc_stack_t *witness,
+                          const btc_script_t *output,
+                          unsigned int flags,
+                          const btc_tx_t *tx,
+                          size_t index,
+                          int64_t value,
+                          btc_tx_cache_t *cache,
+                          int p2sh) {
+  int err = BTC_SCRIPT_ERR_OK;
   btc_script_t *redeem = NULL;
   btc_program_t program;
   btc_stack_t stack;
@@ -2522,6 +2908,15 @@ btc_script_verify_program(const btc_stack_t *witness,
   CHECK((flags & BTC_SCRIPT_VERIFY_WITNESS) != 0);
   CHECK(btc_script_get_program(&program, output));
 
+  /* Taproot cannot be nested inside P2SH. */
+  if (program.version == 1 && program.length == 32 && !p2sh) {
+    if (!(flags & BTC_SCRIPT_VERIFY_TAPROOT))
+      return BTC_SCRIPT_ERR_OK;
+
+    return btc_script_verify_taproot(witness, output, program.data,
+                                     flags, tx, index, value, cache);
+  }
+
   btc_stack_init(&stack);
   btc_stack_assign(&stack, witness);
 
@@ -2630,7 +3025,7 @@ btc_script_verify(const btc_script_t *input,
 
     /* Verify the program in the output script. */
     if ((err = btc_script_verify_program(witness, output, flags,
-                                         tx, index, value, cache))) {
+                                         tx, index, value, cache, 0))) {
       goto done;
     }
 
@@ -2673,7 +3068,7 @@ btc_script_verify(const btc_script_t *input,
 
       /* Verify the program in the redeem script. */
       if ((err = btc_script_verify_program(witness, redeem, flags,
-                                           tx, index, value, cache))) {
+                                           tx, index, value, cache, 1))) {
         goto done;
       }
 
@@ -2706,6 +3101,213 @@ done:
 
 #undef THROW
 
+/*
+ * Taproot
+ */
+
+static void
+btc_taproot_leaf_init(btc_sha256_t *ctx) {
+  /* "TapLeaf" */
+  ctx->state[0] = 0x9ce0e4e6;
+  ctx->state[1] = 0x7c116c39;
+  ctx->state[2] = 0x38b3caf2;
+  ctx->state[3] = 0xc30f5089;
+  ctx->state[4] = 0xd3f3936c;
+  ctx->state[5] = 0x47636e60;
+  ctx->state[6] = 0x7db33eea;
+  ctx->state[7] = 0xddc6f0c9;
+  ctx->size = 64;
+}
+
+static void
+btc_taproot_branch_init(btc_sha256_t *ctx) {
+  /* "TapBranch" */
+  ctx->state[0] = 0x23a865a9;
+  ctx->state[1] = 0xb8a40da7;
+  ctx->state[2] = 0x977c1e04;
+  ctx->state[3] = 0xc49e246f;
+  ctx->state[4] = 0xb5be1376;
+  ctx->state[5] = 0x9d24c9b7;
+  ctx->state[6] = 0xb583b5d4;
+  ctx->state[7] = 0xa8d226d2;
+  ctx->size = 64;
+}
+
+static void
+btc_taproot_tweak_init(btc_sha256_t *ctx) {
+  /* "TapTweak" */
+  ctx->state[0] = 0xd129a2f3;
+  ctx->state[1] = 0x701c655d;
+  ctx->state[2] = 0x6583b6c3;
+  ctx->state[3] = 0xb9419727;
+  ctx->state[4] = 0x95f4e232;
+  ctx->state[5] = 0x94fd54f4;
+  ctx->state[6] = 0xa2ae8d85;
+  ctx->state[7] = 0x47ca590b;
+  ctx->size = 64;
+}
+
+void
+btc_taproot_leaf_hash(uint8_t *hash, int version, const btc_script_t *script) {
+  btc_sha256_t ctx;
+
+  btc_taproot_leaf_init(&ctx);
+  btc_uint8_update(&ctx, version & BTC_TAPROOT_LEAF_MASK);
+  btc_script_update(&ctx, script);
+  btc_sha256_final(&ctx, hash);
+}
+
+void
+btc_taproot_branch_hash(uint8_t *hash,
+                        const uint8_t *left,
+                        const uint8_t *right) {
+  btc_sha256_t ctx;
+
+  /* Branches are hashed in lexicographical order. */
+  if (memcmp(left, right, 32) > 0) {
+    const uint8_t *tmp = left;
+    left = right;
+    right = tmp;
+  }
+
+  btc_taproot_branch_init(&ctx);
+  btc_sha256_update(&ctx, left, 32);
+  btc_sha256_update(&ctx, right, 32);
+  btc_sha256_final(&ctx, hash);
+}
+
+void
+btc_taproot_tweak_hash(uint8_t *hash, const uint8_t *key, const uint8_t *root) {
+  btc_sha256_t ctx;
+
+  btc_taproot_tweak_init(&ctx);
+  btc_sha256_update(&ctx, key, 32);
+
+  if (root != NULL)
+    btc_sha256_update(&ctx, root, 32);
+
+  btc_sha256_final(&ctx, hash);
+}
+
+void
+btc_taproot_root(uint8_t *root,
+                 const uint8_t *leaf,
+                 const uint8_t *path,
+                 size_t length) {
+  size_t i;
+
+  memcpy(root, leaf, 32);
+
+  for (i = 0; i < length; i++)
+    btc_taproot_branch_hash(root, root, path + i * 32);
+}
+
+/*
+ * Signature Batch
+ */
+
+struct btc_sigentry_s {
+  uint8_t msg[32];
+  uint8_t sig[64];
+  uint8_t key[32];
+};
+
+/* Points per multi-scalar multiplication (two per signature). */
+#define BTC_SIGBATCH_SCRATCH 64
+
+void
+btc_sigbatch_init(btc_sigbatch_t *batch) {
+  batch->items = NULL;
+  batch->alloc = 0;
+  batch->length = 0;
+  batch->scratch = NULL;
+}
+
+void
+btc_sigbatch_clear(btc_sigbatch_t *batch) {
+  if (batch->items != NULL)
+    btc_free(batch->items);
+
+  if (batch->scratch != NULL)
+    btc_scratch_destroy(batch->scratch);
+
+  btc_sigbatch_init(batch);
+}
+
+void
+btc_sigbatch_reset(btc_sigbatch_t *batch) {
+  batch->length = 0;
+}
+
+void
+btc_sigbatch_push(btc_sigbatch_t *batch,
+                  const uint8_t *msg,
+                  const uint8_t *sig,
+                  const uint8_t *key) {
+  struct btc_sigentry_s *item;
+
+  if (batch->length == batch->alloc) {
+    size_t alloc = batch->alloc == 0 ? 16 : batch->alloc * 2;
+
+    batch->items = (struct btc_sigentry_s *)btc_realloc(batch->items,
+                                                        alloc * sizeof(*item));
+    batch->alloc = alloc;
+  }
+
+  item = &batch->items[batch->length++];
+
+  memcpy(item->msg, msg, 32);
+  memcpy(item->sig, sig, 64);
+  memcpy(item->key, key, 32);
+}
+
+int
+btc_sigbatch_verify(btc_sigbatch_t *batch) {
+  const struct btc_sigentry_s *item;
+  const uint8_t **msgs, **sigs, **keys;
+  size_t i, *lens;
+  int ret;
+
+  if (batch->length == 0)
+    return 1;
+
+  if (batch->length == 1) {
+    item = &batch->items[0];
+    ret = btc_bip340_verify(item->msg, 32, item->sig, item->key);
+    batch->length = 0;
+    return ret;
+  }
+
+  if (batch->scratch == NULL)
+    batch->scratch = btc_scratch_create(BTC_SIGBATCH_SCRATCH);
+
+  msgs = (const uint8_t **)btc_malloc(batch->length * sizeof(uint8_t *));
+  sigs = (const uint8_t **)btc_malloc(batch->length * sizeof(uint8_t *));
+  keys = (const uint8_t **)btc_malloc(batch->length * sizeof(uint8_t *));
+  lens = (size_t *)btc_malloc(batch->length * sizeof(size_t));
+
+  for (i = 0; i < batch->length; i++) {
+    item = &batch->items[i];
+
+    msgs[i] = item->msg;
+    sigs[i] = item->sig;
+    keys[i] = item->key;
+    lens[i] = 32;
+  }
+
+  ret = btc_bip340_verify_batch(msgs, lens, sigs, keys,
+                                batch->length, batch->scratch);
+
+  btc_free(msgs);
+  btc_free(sigs);
+  btc_free(keys);
+  btc_free(lens);
+
+  batch->length = 0;
+
+  return ret;
+}
+
 /*
  * Reader
  */
@@ -2929,6 +3531,8 @@ asm_opcode(int value) {
     X(OP_NOP9);
     X(OP_NOP10);
 
+    X(OP_CHECKSIGADD);
+
     X(OP_INVALIDOPCODE);
 #undef X
   }
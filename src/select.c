@@ -94,6 +94,12 @@ estimate_input_size(const btc_script_t *prev) {
     wit += 1;
     /* 2-of-3 multisig input */
     wit += 149;
+  } else if (btc_script_is_p2tr(prev)) {
+    /* P2TR (key path) */
+    /* varint-items-len */
+    wit += 1;
+    /* varint-len [signature] */
+    wit += 1 + 64;
   } else if (btc_script_is_program(prev)) {
     /* Unknown witness program. */
     wit += 110;
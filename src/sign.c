@@ -12,6 +12,7 @@
 #include <mako/consensus.h>
 #include <mako/crypto/ecc.h>
 #include <mako/crypto/hash.h>
+#include <mako/crypto/rand.h>
 #include <mako/map.h>
 #include <mako/policy.h>
 #include <mako/script.h>
@@ -31,6 +32,7 @@ typedef struct btc_keypair_s {
   uint8_t pub65[65];
   uint8_t hash33[20];
   uint8_t hash65[20];
+  uint8_t output[32];
 } btc_keypair_t;
 
 static int
@@ -44,6 +46,16 @@ btc_keypair_init(btc_keypair_t *key, const uint8_t *priv) {
   btc_hash160(key->hash33, key->pub33, 33);
   btc_hash160(key->hash65, key->pub65, 65);
 
+  /* Taproot output key with no script path (bip86). */
+  {
+    uint8_t tweak[32];
+
+    btc_taproot_tweak_hash(tweak, key->pub33 + 1, NULL);
+
+    if (!btc_bip340_pubkey_tweak_add(key->output, NULL, key->pub33 + 1, tweak))
+      return 0;
+  }
+
   memcpy(key->priv, priv, 32);
 
   return 1;
@@ -297,6 +309,67 @@ btc_tx_sign_p2sh(btc_tx_t *tx,
   return 1;
 }
 
+static int
+btc_tx_sign_p2tr(btc_tx_t *tx,
+                 size_t index,
+                 const btc_output_t *coin,
+                 const btc_keypair_t *key,
+                 int type,
+                 btc_tx_cache_t *cache) {
+  btc_input_t *input = tx->inputs.items[index];
+  uint8_t tweak[32];
+  uint8_t priv[32];
+  uint8_t aux[32];
+  uint8_t msg[32];
+  uint8_t sig[65];
+  size_t sig_len = 64;
+  const uint8_t *pub;
+
+  if (!btc_script_get_p2tr(&pub, &coin->script))
+    return 0;
+
+  if (memcmp(pub, key->output, 32) != 0)
+    return 0;
+
+  if (!cache->has_taproot)
+    return 0;
+
+  /* SIGHASH_ALL is implied by a 64 byte signature. */
+  if (type == BTC_SIGHASH_ALL)
+    type = 0;
+
+  if (!btc_tx_sighash_taproot(msg,
+                              tx,
+                              index,
+                              &coin->script,
+                              coin->value,
+                              type,
+                              NULL,
+                              NULL,
+                              0xffffffff,
+                              cache)) {
+    return 0;
+  }
+
+  btc_taproot_tweak_hash(tweak, key->pub33 + 1, NULL);
+
+  CHECK(btc_bip340_privkey_tweak_add(priv, key->priv, tweak));
+
+  btc_getrandom(aux, 32);
+
+  CHECK(btc_bip340_sign(sig, msg, 32, priv, aux));
+
+  btc_memzero(priv, 32);
+
+  if (type != 0)
+    sig[sig_len++] = type;
+
+  btc_stack_reset(&input->witness);
+  btc_stack_push_data(&input->witness, sig, sig_len);
+
+  return 1;
+}
+
 static int
 btc_tx_sign_input(btc_tx_t *tx,
                   size_t index,
@@ -316,6 +389,9 @@ btc_tx_sign_input(btc_tx_t *tx,
   if (btc_tx_sign_p2sh(tx, index, coin, key, type, cache))
     return 1;
 
+  if (btc_tx_sign_p2tr(tx, index, coin, key, type, cache))
+    return 1;
+
   return 0;
 }
 
@@ -333,6 +409,9 @@ btc_tx_sign_step(btc_tx_t *tx,
   if (!btc_keypair_init(&key, priv))
     return 0;
 
+  if (!cache->has_taproot)
+    btc_tx_precompute(cache, tx, view);
+
   for (i = 0; i < tx->inputs.length; i++) {
     input = tx->inputs.items[i];
     coin = btc_view_get(view, &input->prevout);
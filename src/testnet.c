@@ -619,6 +619,16 @@ static const btc_deployment_t testnet_deployments[] = {
     /* .required = */ 1,
     /* .force = */ 0
   },
+  {
+    /* .name = */ "taproot",
+    /* .bit = */ 2,
+    /* .start_time = */ 1619222400, /* April 24th, 2021 */
+    /* .timeout = */ 1628640000, /* August 11th, 2021 */
+    /* .threshold = */ -1,
+    /* .window = */ -1,
+    /* .required = */ 0,
+    /* .force = */ 1
+  },
   {
     /* .name = */ "testdummy",
     /* .bit = */ 28,
@@ -749,6 +759,15 @@ static const btc_network_t testnet = {
         0x93, 0xfd, 0x48, 0xa2, 0xaa, 0x9d, 0x72, 0xcd,
         0x0f, 0x98, 0x2b, 0x00, 0x00, 0x00, 0x00, 0x00
       }
+    },
+    /* .taproot = */ {
+      -1,
+      {
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+      }
     }
   },
   /* .activation_threshold = */ 1512, /* 75% for testchains */
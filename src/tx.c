@@ -373,8 +373,219 @@ btc_tx_sighash(uint8_t *hash,
   btc_abort(); /* LCOV_EXCL_LINE */
 }
 
+static void
+btc_taproot_sighash_init(btc_sha256_t *ctx) {
+  /* "TapSighash" */
+  ctx->state[0] = 0xf504a425;
+  ctx->state[1] = 0xd7f8783b;
+  ctx->state[2] = 0x1363868a;
+  ctx->state[3] = 0xe3e55658;
+  ctx->state[4] = 0x6eee945d;
+  ctx->state[5] = 0xbc7888dd;
+  ctx->state[6] = 0x02a6e2c3;
+  ctx->state[7] = 0x1873fe9f;
+  ctx->size = 64;
+}
+
+int
+btc_tx_sighash_taproot(uint8_t *hash,
+                       const btc_tx_t *tx,
+                       size_t index,
+                       const btc_script_t *prev,
+                       int64_t value,
+                       int type,
+                       const btc_buffer_t *annex,
+                       const uint8_t *leaf,
+                       uint32_t codesep,
+                       const btc_tx_cache_t *cache) {
+  /**
+   * BIP341 signature message.
+   *
+   * Unlike the previous sighash algorithms, this
+   * commits to every spent amount and script (the
+   * per-transaction hashes live in the cache, see
+   * btc_tx_precompute) and to the annex and leaf
+   * being executed, if any.
+   *
+   * Returns zero if the hash type is invalid or
+   * SIGHASH_SINGLE has no corresponding output.
+   */
+  const btc_input_t *input = tx->inputs.items[index];
+  int output_type = (type == 0) ? BTC_SIGHASH_ALL : (type & 3);
+  int anyonecanpay = (type & BTC_SIGHASH_ANYONECANPAY) != 0;
+  btc_sha256_t ctx;
+  uint8_t tmp[32];
+
+  CHECK(cache != NULL && cache->has_taproot);
+
+  if (!(type <= 0x03 || (type >= 0x81 && type <= 0x83)))
+    return 0;
+
+  if (output_type == BTC_SIGHASH_SINGLE && index >= tx->outputs.length)
+    return 0;
+
+  btc_taproot_sighash_init(&ctx);
+
+  /* Epoch. */
+  btc_uint8_update(&ctx, 0);
+
+  /* Transaction data. */
+  btc_uint8_update(&ctx, type);
+  btc_uint32_update(&ctx, tx->version);
+  btc_uint32_update(&ctx, tx->locktime);
+
+  if (!anyonecanpay) {
+    btc_raw_update(&ctx, cache->sha_prevouts, 32);
+    btc_raw_update(&ctx, cache->sha_amounts, 32);
+    btc_raw_update(&ctx, cache->sha_scriptpubkeys, 32);
+    btc_raw_update(&ctx, cache->sha_sequences, 32);
+  }
+
+  if (output_type != BTC_SIGHASH_NONE && output_type != BTC_SIGHASH_SINGLE)
+    btc_raw_update(&ctx, cache->sha_outputs, 32);
+
+  /* Data about this input. */
+  btc_uint8_update(&ctx, (leaf != NULL) * 2 + (annex != NULL));
+
+  if (anyonecanpay) {
+    btc_outpoint_update(&ctx, &input->prevout);
+    btc_int64_update(&ctx, value);
+    btc_script_update(&ctx, prev);
+    btc_uint32_update(&ctx, input->sequence);
+  } else {
+    btc_uint32_update(&ctx, index);
+  }
+
+  if (annex != NULL) {
+    btc_sha256_t actx;
+
+    btc_sha256_init(&actx);
+    btc_buffer_update(&actx, annex);
+    btc_sha256_final(&actx, tmp);
+
+    btc_raw_update(&ctx, tmp, 32);
+  }
+
+  /* Data about this output. */
+  if (output_type == BTC_SIGHASH_SINGLE) {
+    btc_sha256_t octx;
+
+    btc_sha256_init(&octx);
+    btc_output_update(&octx, tx->outputs.items[index]);
+    btc_sha256_final(&octx, tmp);
+
+    btc_raw_update(&ctx, tmp, 32);
+  }
+
+  /* BIP342 extension. */
+  if (leaf != NULL) {
+    btc_raw_update(&ctx, leaf, 32);
+    btc_uint8_update(&ctx, 0);
+    btc_uint32_update(&ctx, codesep);
+  }
+
+  btc_sha256_final(&ctx, hash);
+
+  return 1;
+}
+
+int
+btc_tx_precompute(btc_tx_cache_t *cache,
+                  const btc_tx_t *tx,
+                  const btc_view_t *view) {
+  /**
+   * Compute the BIP341 per-transaction hashes.
+   *
+   * These are only needed when a taproot output
+   * is being spent, so we avoid hashing every
+   * spent script for the common case.
+   */
+  btc_sha256_t amounts, scripts, prevouts, sequences, outputs;
+  const btc_input_t *input;
+  const btc_coin_t *coin;
+  int taproot = 0;
+  size_t i;
+
+  for (i = 0; i < tx->inputs.length; i++) {
+    input = tx->inputs.items[i];
+    coin = btc_view_get(view, &input->prevout);
+
+    if (coin == NULL)
+      return 0;
+
+    if (btc_script_is_p2tr(&coin->output.script))
+      taproot = 1;
+  }
+
+  if (!taproot)
+    return 1;
+
+  btc_sha256_init(&prevouts);
+  btc_sha256_init(&amounts);
+  btc_sha256_init(&scripts);
+  btc_sha256_init(&sequences);
+  btc_sha256_init(&outputs);
+
+  for (i = 0; i < tx->inputs.length; i++) {
+    input = tx->inputs.items[i];
+    coin = btc_view_get(view, &input->prevout);
+
+    btc_outpoint_update(&prevouts, &input->prevout);
+    btc_int64_update(&amounts, coin->output.value);
+    btc_script_update(&scripts, &coin->output.script);
+    btc_uint32_update(&sequences, input->sequence);
+  }
+
+  for (i = 0; i < tx->outputs.length; i++)
+    btc_output_update(&outputs, tx->outputs.items[i]);
+
+  btc_sha256_final(&prevouts, cache->sha_prevouts);
+  btc_sha256_final(&amounts, cache->sha_amounts);
+  btc_sha256_final(&scripts, cache->sha_scriptpubkeys);
+  btc_sha256_final(&sequences, cache->sha_sequences);
+  btc_sha256_final(&outputs, cache->sha_outputs);
+
+  /* The segwit v0 hashes are the
+     same data, hashed twice. */
+  btc_sha256(cache->prevouts, cache->sha_prevouts, 32);
+  btc_sha256(cache->sequences, cache->sha_sequences, 32);
+  btc_sha256(cache->outputs, cache->sha_outputs, 32);
+
+  cache->has_prevouts = 1;
+  cache->has_sequences = 1;
+  cache->has_outputs = 1;
+  cache->has_taproot = 1;
+
+  return 1;
+}
+
 int
 btc_tx_verify(const btc_tx_t *tx, const btc_view_t *view, unsigned int flags) {
+  btc_sigbatch_t batch;
+  int ret;
+
+  btc_sigbatch_init(&batch);
+
+  ret = btc_tx_verify_batch(tx, view, flags, &batch)
+     && btc_sigbatch_verify(&batch);
+
+  btc_sigbatch_clear(&batch);
+
+  return ret;
+}
+
+int
+btc_tx_verify_batch(const btc_tx_t *tx,
+                    const btc_view_t *view,
+                    unsigned int flags,
+                    btc_sigbatch_t *batch) {
+  /**
+   * Verify all inputs, deferring schnorr
+   * signatures to `batch` (if non-null).
+   *
+   * The caller must call btc_sigbatch_verify
+   * before considering the transaction valid.
+   */
   const btc_input_t *input;
   const btc_coin_t *coin;
   btc_tx_cache_t cache;
@@ -382,6 +593,13 @@ btc_tx_verify(const btc_tx_t *tx, const btc_view_t *view, unsigned int flags) {
 
   memset(&cache, 0, sizeof(cache));
 
+  cache.batch = batch;
+
+  if (flags & BTC_SCRIPT_VERIFY_TAPROOT) {
+    if (!btc_tx_precompute(&cache, tx, view))
+      return 0;
+  }
+
   for (i = 0; i < tx->inputs.length; i++) {
     input = tx->inputs.items[i];
     coin = btc_view_get(view, &input->prevout);
@@ -873,6 +1091,7 @@ btc_tx_has_standard_witness(const btc_tx_t *tx, const btc_view_t *view) {
   const btc_coin_t *coin;
   btc_script_t prev;
   size_t i, j;
+  int p2sh;
 
   if (btc_tx_is_coinbase(tx))
     return 1;
@@ -891,7 +1110,9 @@ btc_tx_has_standard_witness(const btc_tx_t *tx, const btc_view_t *view) {
 
     btc_script_rocopy(&prev, &coin->output.script);
 
-    if (btc_script_is_p2sh(&prev)) {
+    p2sh = btc_script_is_p2sh(&prev);
+
+    if (p2sh) {
       if (!btc_script_get_redeem(&prev, &input->script))
         return 0;
     }
@@ -913,6 +1134,34 @@ btc_tx_has_standard_witness(const btc_tx_t *tx, const btc_view_t *view) {
 
       continue;
     }
+
+    if (btc_script_is_p2tr(&prev) && !p2sh) {
+      const btc_buffer_t *item = btc_stack_top(witness);
+      size_t length = witness->length;
+
+      /* Annexes are reserved for future upgrades. */
+      if (length >= 2 && item->length > 0
+                      && item->data[0] == BTC_TAPROOT_ANNEX_TAG) {
+        return 0;
+      }
+
+      /* Key path spends have no further limits. */
+      if (length < 2)
+        continue;
+
+      /* Tapscript stack items are limited. */
+      item = witness->items[length - 1];
+
+      if (item->length > 0 && (item->data[0] & BTC_TAPROOT_LEAF_MASK)
+                              == BTC_TAPROOT_LEAF_TAPSCRIPT) {
+        for (j = 0; j < length - 2; j++) {
+          if (witness->items[j]->length > BTC_MAX_TAPSCRIPT_PUSH)
+            return 0;
+        }
+      }
+
+      continue;
+    }
   }
 
   return 1;
@@ -11,6 +11,8 @@
 #include <mako/address.h>
 #include <mako/bip32.h>
 #include <mako/bloom.h>
+#include <mako/crypto/ecc.h>
+#include <mako/crypto/hash.h>
 #include <mako/script.h>
 #include <mako/util.h>
 
@@ -37,7 +39,10 @@ btc_account_init(btc_account_t *acct, btc_bloom_t *filter) {
 
   btc_hdpub_init(&acct->key);
 
+  acct->birth = 0;
+
   acct->filter = filter;
+  acct->shared = NULL;
 }
 
 void
@@ -47,7 +52,7 @@ btc_account_clear(btc_account_t *acct) {
 
 size_t
 btc_account_size(const btc_account_t *acct) {
-  return btc_string_size(acct->name) + 17 + btc_bip32_size(&acct->key);
+  return btc_string_size(acct->name) + 25 + btc_bip32_size(&acct->key);
 }
 
 uint8_t *
@@ -59,6 +64,7 @@ btc_account_write(uint8_t *zp, const btc_account_t *x) {
   zp = btc_uint32_write(zp, x->lookahead);
   zp = btc_uint8_write(zp, x->watch_only);
   zp = btc_bip32_write(zp, &x->key);
+  zp = btc_int64_write(zp, x->birth);
   return zp;
 }
 
@@ -85,6 +91,12 @@ btc_account_read(btc_account_t *z, const uint8_t **xp, size_t *xn) {
   if (!btc_bip32_read(&z->key, xp, xn))
     return 0;
 
+  /* Accounts written before the birth field existed end here. */
+  z->birth = 0;
+
+  if (*xn > 0 && !btc_int64_read(&z->birth, xp, xn))
+    return 0;
+
   return 1;
 }
 
@@ -145,6 +157,19 @@ btc_account_address(btc_address_t *addr,
       break;
     }
 
+    case BTC_BIP32_P2TR: {
+      uint8_t tweak[32];
+      uint8_t out[32];
+
+      btc_taproot_tweak_hash(tweak, key.pubkey + 1, NULL);
+
+      CHECK(btc_bip340_pubkey_tweak_add(out, NULL, key.pubkey + 1, tweak));
+
+      btc_address_set_p2tr(addr, out);
+
+      break;
+    }
+
     default: {
       btc_abort();
       break;
@@ -162,36 +187,91 @@ btc_account_change(btc_address_t *addr, const btc_account_t *acct) {
   btc_account_address(addr, acct, 1, acct->change_index);
 }
 
+static void
+btc_account_put(const btc_account_t *acct,
+                ldb_batch_t *batch,
+                const btc_address_t *addr,
+                uint32_t change,
+                uint32_t index) {
+  btc_path_t path = btc_path(acct->index, change, index);
+
+  db_put_path(batch, addr, &path);
+  db_put_apath(batch, acct->index, addr);
+
+  if (acct->filter != NULL)
+    btc_bloom_add(acct->filter, addr->hash, addr->length);
+
+  if (acct->shared != NULL)
+    btc_bloom_add(acct->shared, addr->hash, addr->length);
+}
+
 void
 btc_account_path(const btc_account_t *acct,
                  ldb_batch_t *batch,
                  uint32_t change,
                  uint32_t index) {
-  btc_path_t path = btc_path(acct->index, change, index);
   btc_address_t addr;
 
   btc_account_address(&addr, acct, change, index);
 
-  db_put_path(batch, &addr, &path);
-  db_put_apath(batch, acct->index, &addr);
+  btc_account_put(acct, batch, &addr, change, index);
+}
 
-  if (acct->filter != NULL)
-    btc_bloom_add(acct->filter, addr.hash, addr.length);
+void
+btc_account_paths(const btc_account_t *acct,
+                  ldb_batch_t *batch,
+                  uint32_t change,
+                  uint32_t index,
+                  uint32_t count) {
+  uint8_t keys[8 * 33];
+  uint8_t hashes[8 * 20];
+  btc_address_t addr;
+  btc_hdnode_t key;
+  uint32_t i, n;
+
+  /* Only p2pkh and p2wpkh hash the bare key. */
+  if (acct->key.type != BTC_BIP32_STANDARD
+      && acct->key.type != BTC_BIP32_P2WPKH) {
+    for (i = 0; i < count; i++)
+      btc_account_path(acct, batch, change, index + i);
+
+    return;
+  }
+
+  while (count > 0) {
+    n = count < 8 ? count : 8;
+
+    for (i = 0; i < n; i++) {
+      btc_account_leaf(&key, acct, change, index + i);
+      memcpy(keys + i * 33, key.pubkey, 33);
+    }
+
+    btc_hash160_batch(hashes, keys, 33, n);
+
+    for (i = 0; i < n; i++) {
+      if (acct->key.type == BTC_BIP32_STANDARD)
+        btc_address_set_p2pkh(&addr, hashes + i * 20);
+      else
+        btc_address_set_p2wpkh(&addr, hashes + i * 20);
+
+      btc_account_put(acct, batch, &addr, change, index + i);
+    }
+
+    index += n;
+    count -= n;
+  }
 }
 
 void
 btc_account_setup(const btc_account_t *acct, ldb_batch_t *batch) {
   static const btc_balance_t bal = {0, 0, 0, 0};
-  uint32_t i;
 
   db_put_account(batch, acct->index, acct);
   db_put_balance(batch, acct->index, &bal);
   db_put_index(batch, acct->name, acct->index);
 
-  for (i = 0; i < acct->lookahead + 1; i++) {
-    btc_account_path(acct, batch, 0, i);
-    btc_account_path(acct, batch, 1, i);
-  }
+  btc_account_paths(acct, batch, 0, 0, acct->lookahead + 1);
+  btc_account_paths(acct, batch, 1, 0, acct->lookahead + 1);
 }
 
 void
@@ -201,22 +281,28 @@ btc_account_sync(btc_account_t *acct,
                  uint32_t change) {
   uint32_t lookahead = acct->lookahead;
   uint32_t update = 0;
-  uint32_t i;
+  uint32_t count;
 
   if (receive >= acct->receive_index) {
-    for (i = acct->receive_index; i <= receive; i++)
-      btc_account_path(acct, batch, 0, i + lookahead + 1);
+    count = receive - acct->receive_index + 1;
 
-    acct->receive_index = i;
+    btc_account_paths(acct, batch, 0,
+                      acct->receive_index + lookahead + 1,
+                      count);
+
+    acct->receive_index += count;
 
     update = 1;
   }
 
   if (change >= acct->change_index) {
-    for (i = acct->change_index; i <= change; i++)
-      btc_account_path(acct, batch, 1, i + lookahead + 1);
+    count = change - acct->change_index + 1;
+
+    btc_account_paths(acct, batch, 1,
+                      acct->change_index + lookahead + 1,
+                      count);
 
-    acct->change_index = i;
+    acct->change_index += count;
 
     update = 1;
   }
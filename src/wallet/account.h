@@ -61,6 +61,13 @@ btc_account_path(const btc_account_t *acct,
                  uint32_t change,
                  uint32_t index);
 
+void
+btc_account_paths(const btc_account_t *acct,
+                  ldb_batch_t *batch,
+                  uint32_t change,
+                  uint32_t index,
+                  uint32_t count);
+
 void
 btc_account_setup(const btc_account_t *acct, ldb_batch_t *batch);
 
@@ -60,6 +60,14 @@ btc_wclient_by_height(const btc_wclient_t *client, int32_t height) {
   return client->by_height(client->state, height);
 }
 
+const btc_entry_t *
+btc_wclient_by_time(const btc_wclient_t *client, int64_t time) {
+  if (client->by_time == NULL)
+    return NULL;
+
+  return client->by_time(client->state, time);
+}
+
 btc_block_t *
 btc_wclient_get_block(const btc_wclient_t *client, const btc_entry_t *entry) {
   if (client->get_block == NULL)
@@ -453,7 +453,7 @@ db_put_flags(ldb_batch_t *batch, uint32_t magic, uint32_t flags) {
 BTC_UNUSED static void
 db_put_wallet(ldb_batch_t *batch, const btc_wallet_t *wallet) {
   ldb_slice_t val;
-  uint8_t zp[80];
+  uint8_t zp[88];
 
   val.data = zp;
   val.size = btc_wallet_export(zp, wallet);
@@ -491,7 +491,7 @@ db_put_account(ldb_batch_t *batch,
                const btc_account_t *acct) {
   uint8_t buf[KEY_ACCOUNT_LEN];
   ldb_slice_t key, val;
-  uint8_t zp[156];
+  uint8_t zp[164];
 
   key = key_account(account, buf);
 
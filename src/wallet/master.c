@@ -32,6 +32,66 @@
 
 #define MAX_PLAINTEXT_SIZE (BTC_MNEMONIC_SIZE + BTC_HDNODE_SIZE) /* 179 */
 
+/*
+ * Passphrase Key
+ */
+
+void
+btc_passkey_init(btc_passkey_t *pk, const btc_master_t *key) {
+  pk->algorithm = key->algorithm;
+
+  memcpy(pk->nonce, key->nonce, 24);
+
+  pk->N = key->N;
+  pk->r = key->r;
+  pk->p = key->p;
+
+  memset(pk->key, 0, 32);
+}
+
+void
+btc_passkey_clear(btc_passkey_t *pk) {
+  btc_memzero(pk, sizeof(*pk));
+}
+
+int
+btc_passkey_derive(btc_passkey_t *pk, const char *pass) {
+  switch (pk->algorithm) {
+    case BTC_KDF_NONE: {
+      memset(pk->key, 0, 32);
+      return 1;
+    }
+
+    case BTC_KDF_PBKDF2: {
+      btc_pbkdf512_derive(pk->key, (const uint8_t *)pass,
+                                   strlen(pass),
+                                   pk->nonce,
+                                   24,
+                                   pk->N,
+                                   32);
+      return 1;
+    }
+
+#if 0
+    case BTC_KDF_SCRYPT: {
+      return btc_scrypt_derive(pk->key, (const uint8_t *)pass,
+                                        strlen(pass),
+                                        pk->nonce,
+                                        24,
+                                        pk->N,
+                                        pk->r,
+                                        pk->p,
+                                        32);
+    }
+#endif
+
+    default: {
+      btc_abort();
+      return 0;
+    }
+  }
+}
+
 /*
  * Master Key
  */
@@ -91,6 +151,9 @@ btc_plaintext_read(btc_master_t *z, const uint8_t **xp, size_t *xn) {
   if (!btc_hdpriv_read(&z->chain, xp, xn, z->network))
     return 0;
 
+  /* Taproot keys share the standard prefix. */
+  z->chain.type = z->type;
+
   return 1;
 }
 
@@ -173,49 +236,11 @@ btc_master_import(btc_master_t *z, const uint8_t *xp, size_t xn) {
   return btc_master_read(z, &xp, &xn);
 }
 
-static int
-btc_master_derive(uint8_t *ck, const btc_master_t *key, const char *pass) {
-  switch (key->algorithm) {
-    case BTC_KDF_NONE: {
-      memset(ck, 0, 32);
-      return 1;
-    }
-
-    case BTC_KDF_PBKDF2: {
-      btc_pbkdf512_derive(ck, (const uint8_t *)pass,
-                              strlen(pass),
-                              key->nonce,
-                              24,
-                              key->N,
-                              32);
-      return 1;
-    }
-
-#if 0
-    case BTC_KDF_SCRYPT: {
-      return btc_scrypt_derive(ck, (const uint8_t *)pass,
-                                   strlen(pass),
-                                   key->nonce,
-                                   24,
-                                   key->N,
-                                   key->r,
-                                   key->p,
-                                   32);
-    }
-#endif
-
-    default: {
-      btc_abort();
-      return 0;
-    }
-  }
-}
-
 int
 btc_master_encrypt(btc_master_t *key, uint8_t algorithm, const char *pass) {
   uint8_t ct[16 + MAX_PLAINTEXT_SIZE];
   uint8_t pt[MAX_PLAINTEXT_SIZE];
-  uint8_t ck[32];
+  btc_passkey_t pk;
   size_t pn;
 
   if (key->locked)
@@ -260,10 +285,14 @@ btc_master_encrypt(btc_master_t *key, uint8_t algorithm, const char *pass) {
   } else {
     btc_getrandom(key->nonce, 24);
 
-    if (!btc_master_derive(ck, key, pass))
+    btc_passkey_init(&pk, key);
+
+    if (!btc_passkey_derive(&pk, pass))
       return 0;
 
-    btc_secretbox_seal(ct, pt, pn, ck, key->nonce);
+    btc_secretbox_seal(ct, pt, pn, pk.key, key->nonce);
+
+    btc_passkey_clear(&pk);
 
     btc_buffer_set(&key->payload, ct, pn + 16);
 
@@ -277,7 +306,6 @@ btc_master_encrypt(btc_master_t *key, uint8_t algorithm, const char *pass) {
 
   btc_memzero(ct, sizeof(ct));
   btc_memzero(pt, sizeof(pt));
-  btc_memzero(ck, sizeof(ck));
 
   return 1;
 }
@@ -308,34 +336,62 @@ btc_master_maybe_lock(btc_master_t *key) {
 
 int
 btc_master_unlock(btc_master_t *key, const char *pass, int64_t msec) {
+  btc_passkey_t pk;
+  int ret;
+
+  if (key->algorithm == BTC_KDF_NONE)
+    return 1;
+
+  if (pass == NULL)
+    return 0;
+
+  btc_passkey_init(&pk, key);
+
+  ret = btc_passkey_derive(&pk, pass)
+     && btc_master_unlock_passkey(key, &pk, msec);
+
+  btc_passkey_clear(&pk);
+
+  return ret;
+}
+
+int
+btc_master_unlock_passkey(btc_master_t *key,
+                          const btc_passkey_t *pk,
+                          int64_t msec) {
   const uint8_t *xp = key->payload.data;
   size_t xn = key->payload.length;
   uint8_t pt[MAX_PLAINTEXT_SIZE];
-  uint8_t ck[32];
 
-  if (!key->locked)
+  if (key->algorithm == BTC_KDF_NONE)
     return 1;
 
-  if (pass == NULL)
+  /* The passphrase may have changed since the key was derived. */
+  if (pk->algorithm != key->algorithm)
     return 0;
 
-  if (xn < 16 || xn > 16 + MAX_PLAINTEXT_SIZE)
+  if (!btc_memequal(pk->nonce, key->nonce, 24))
     return 0;
 
-  if (!btc_master_derive(ck, key, pass))
+  if (xn < 16 || xn > 16 + MAX_PLAINTEXT_SIZE)
     return 0;
 
-  if (!btc_secretbox_open(pt, xp, xn, ck, key->nonce))
+  /* Re-unlocking an unlocked key verifies the
+     passphrase the same way: by opening the box. */
+  if (!btc_secretbox_open(pt, xp, xn, pk->key, key->nonce))
     return 0;
 
-  if (!btc_plaintext_import(key, pt, xn - 16))
-    return 0;
+  if (key->locked) {
+    if (!btc_plaintext_import(key, pt, xn - 16)) {
+      btc_memzero(pt, sizeof(pt));
+      return 0;
+    }
+  }
 
   key->locked = 0;
   key->deadline = msec >= 0 ? btc_time_msec() + msec : 0;
 
   btc_memzero(pt, sizeof(pt));
-  btc_memzero(ck, sizeof(ck));
 
   return 1;
 }
@@ -19,6 +19,19 @@ enum {
   BTC_KDF_SCRYPT = 2
 };
 
+/*
+ * Passphrase Key
+ */
+
+void
+btc_passkey_init(btc_passkey_t *pk, const btc_master_t *key);
+
+void
+btc_passkey_clear(btc_passkey_t *pk);
+
+int
+btc_passkey_derive(btc_passkey_t *pk, const char *pass);
+
 /*
  * Master Key
  */
@@ -59,6 +72,11 @@ btc_master_maybe_lock(btc_master_t *key);
 int
 btc_master_unlock(btc_master_t *key, const char *pass, int64_t msec);
 
+int
+btc_master_unlock_passkey(btc_master_t *key,
+                          const btc_passkey_t *pk,
+                          int64_t msec);
+
 void
 btc_master_generate(btc_master_t *key, enum btc_bip32_type type);
 
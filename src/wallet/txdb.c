@@ -694,7 +694,9 @@ fail:
 }
 
 static int
-hash_from_script(const uint8_t **hash, const btc_script_t *script) {
+hash_from_script(const uint8_t **hash, size_t *len, const btc_script_t *script) {
+  *len = 20;
+
   if (btc_script_get_p2wpkh(hash, script))
     return 1;
 
@@ -704,22 +706,36 @@ hash_from_script(const uint8_t **hash, const btc_script_t *script) {
   if (btc_script_get_p2pkh(hash, script))
     return 1;
 
+  *len = 32;
+
+  if (btc_script_get_p2tr(hash, script))
+    return 1;
+
   return 0;
 }
 
 static int
 tx_is_ours(btc_txdb_t *txdb, const btc_tx_t *tx) {
+  return btc_txdb_test(&txdb->filter, tx);
+}
+
+/*
+ * API
+ */
+
+int
+btc_txdb_test(const btc_bloom_t *filter, const btc_tx_t *tx) {
   const uint8_t *hash;
   uint8_t raw[36];
-  size_t i;
+  size_t i, len;
 
   for (i = 0; i < tx->outputs.length; i++) {
     const btc_output_t *output = tx->outputs.items[i];
 
-    if (!hash_from_script(&hash, &output->script))
+    if (!hash_from_script(&hash, &len, &output->script))
       continue;
 
-    if (btc_bloom_has(&txdb->filter, hash, 20))
+    if (btc_bloom_has(filter, hash, len))
       return 1;
   }
 
@@ -728,17 +744,13 @@ tx_is_ours(btc_txdb_t *txdb, const btc_tx_t *tx) {
 
     btc_outpoint_write(raw, &input->prevout);
 
-    if (btc_bloom_has(&txdb->filter, raw, 36))
+    if (btc_bloom_has(filter, raw, 36))
       return 1;
   }
 
   return 0;
 }
 
-/*
- * API
- */
-
 int
 btc_txdb_add(btc_txdb_t *txdb,
              const btc_tx_t *tx,
@@ -13,6 +13,9 @@
  * TXDB
  */
 
+int
+btc_txdb_test(const btc_bloom_t *filter, const btc_tx_t *tx);
+
 int
 btc_txdb_add(btc_txdb_t *txdb,
              const btc_tx_t *tx,
@@ -12,6 +12,8 @@
 
 #include <lcdb.h>
 
+#include <io/core.h>
+
 #include <mako/impl.h>
 #include <mako/types.h>
 
@@ -29,7 +31,9 @@ typedef struct btc_account_s {
   uint32_t lookahead;
   uint8_t watch_only;
   btc_hdnode_t key;
+  int64_t birth;
   btc_bloom_t *filter;
+  btc_bloom_t *shared;
 } btc_account_t;
 
 typedef struct btc_delta_s {
@@ -54,6 +58,15 @@ typedef struct btc_master_s {
   btc_buffer_t payload;
 } btc_master_t;
 
+typedef struct btc_passkey_s {
+  uint8_t algorithm;
+  uint8_t nonce[24];
+  uint64_t N;
+  uint32_t r;
+  uint32_t p;
+  uint8_t key[32];
+} btc_passkey_t;
+
 typedef struct btc_state_s {
   int32_t start_height;
   uint8_t start_hash[32];
@@ -75,12 +88,17 @@ struct btc_wallet_s {
   ldb_lru_t *cache;
   btc_state_t state;
   btc_bloom_t filter;
+  btc_bloom_t *shared;
   uint32_t account_index;
   uint32_t watch_index;
   uint64_t unique_id;
   btc_balance_t balance;
   btc_balance_t watched;
+  int64_t birth;
   btc_master_t master;
+  struct btc_workers_s *workers;
+  btc_mutex_t mutex;
+  btc_vector_t unlocks;
 };
 
 #endif /* BTC_WALLET_TYPES_H_ */
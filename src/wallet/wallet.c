@@ -10,6 +10,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <io/core.h>
+#include <io/workers.h>
+
 #include <mako/address.h>
 #include <mako/bip32.h>
 #include <mako/bip39.h>
@@ -43,6 +46,9 @@
  * Constants
  */
 
+/* Block timestamps may trail real time by up to two hours. */
+#define BTC_WALLET_TIME_WINDOW (2 * 60 * 60)
+
 enum {
   LOG_NONE = 0,
   LOG_ERROR = 1,
@@ -61,11 +67,113 @@ static const btc_walopt_t walopt_default = {
   /* .checkpoints = */ 1,
   /* .type = */ BTC_BIP32_P2WPKH,
   /* .mnemonic = */ NULL,
-  /* .chain = */ NULL
+  /* .chain = */ NULL,
+  /* .birth = */ 0
 };
 
 const btc_walopt_t *btc_walopt_default = &walopt_default;
 
+/*
+ * Asynchronous Unlock
+ */
+
+typedef struct btc_unlock_s {
+  btc_wallet_t *wallet;
+  btc_passkey_t pk;
+  char *pass;
+  int64_t msec;
+  int result;
+  int done;
+  btc_wallet_unlock_cb *callback;
+  void *arg;
+} btc_unlock_t;
+
+static btc_unlock_t *
+btc_unlock_create(btc_wallet_t *wallet,
+                  const char *pass,
+                  int64_t msec,
+                  btc_wallet_unlock_cb *callback,
+                  void *arg) {
+  btc_unlock_t *job = btc_malloc(sizeof(btc_unlock_t));
+  size_t len = strlen(pass);
+
+  job->wallet = wallet;
+
+  btc_passkey_init(&job->pk, &wallet->master);
+
+  job->pass = btc_malloc(len + 1);
+  job->msec = msec;
+  job->result = 0;
+  job->done = 0;
+  job->callback = callback;
+  job->arg = arg;
+
+  memcpy(job->pass, pass, len + 1);
+
+  return job;
+}
+
+static void
+btc_unlock_destroy(btc_unlock_t *job) {
+  btc_memzero(job->pass, strlen(job->pass));
+  btc_passkey_clear(&job->pk);
+  btc_free(job->pass);
+  btc_free(job);
+}
+
+static void
+btc_unlock_work(void *arg) {
+  /* Runs on a worker thread. */
+  btc_unlock_t *job = arg;
+  btc_wallet_t *wallet = job->wallet;
+  int result = btc_passkey_derive(&job->pk, job->pass);
+
+  btc_mutex_lock(&wallet->mutex);
+
+  job->result = result;
+  job->done = 1;
+
+  btc_mutex_unlock(&wallet->mutex);
+}
+
+static void
+btc_wallet_finish_unlocks(btc_wallet_t *wallet, int force) {
+  btc_vector_t finished;
+  size_t i, j;
+
+  btc_vector_init(&finished);
+
+  btc_mutex_lock(&wallet->mutex);
+
+  for (i = 0, j = 0; i < wallet->unlocks.length; i++) {
+    btc_unlock_t *job = wallet->unlocks.items[i];
+
+    if (job->done || force)
+      btc_vector_push(&finished, job);
+    else
+      wallet->unlocks.items[j++] = job;
+  }
+
+  wallet->unlocks.length = j;
+
+  btc_mutex_unlock(&wallet->mutex);
+
+  /* Apply the derived keys on the event loop, in order. */
+  for (i = 0; i < finished.length; i++) {
+    btc_unlock_t *job = finished.items[i];
+    int result = 0;
+
+    if (job->done && job->result)
+      result = btc_master_unlock_passkey(&wallet->master, &job->pk, job->msec);
+
+    job->callback(result, job->arg);
+
+    btc_unlock_destroy(job);
+  }
+
+  btc_vector_clear(&finished);
+}
+
 /*
  * Wallet
  */
@@ -114,14 +222,22 @@ btc_wallet_create(const btc_network_t *network, const btc_walopt_t *options) {
   btc_state_init(&wallet->state, wallet->network);
   btc_bloom_init(&wallet->filter);
 
+  wallet->shared = NULL;
+
   wallet->account_index = 0;
   wallet->watch_index = 0;
   wallet->unique_id = 0;
 
   btc_balance_init(&wallet->balance);
   btc_balance_init(&wallet->watched);
+  wallet->birth = 0;
   btc_master_init(&wallet->master, network);
 
+  wallet->workers = NULL;
+
+  btc_mutex_init(&wallet->mutex);
+  btc_vector_init(&wallet->unlocks);
+
   return wallet;
 }
 
@@ -132,6 +248,12 @@ btc_wallet_destroy(btc_wallet_t *wallet) {
   btc_map_each(&wallet->frozen, it)
     btc_outpoint_destroy(wallet->frozen.keys[it]);
 
+  CHECK(wallet->workers == NULL);
+  CHECK(wallet->unlocks.length == 0);
+
+  btc_vector_clear(&wallet->unlocks);
+  btc_mutex_destroy(&wallet->mutex);
+
   btc_master_clear(&wallet->master);
   btc_bloom_clear(&wallet->filter);
   btc_outset_clear(&wallet->frozen);
@@ -214,6 +336,24 @@ btc_wallet_load_flags(btc_wallet_t *wallet) {
   return 1;
 }
 
+static const btc_entry_t *
+btc_wallet_by_time(btc_wallet_t *wallet, int64_t time) {
+  const btc_wclient_t *client = &wallet->client;
+  const btc_entry_t *entry;
+
+  time -= BTC_WALLET_TIME_WINDOW;
+
+  if (time <= 0 || client->by_time == NULL)
+    return btc_wclient_by_height(client, 0);
+
+  entry = btc_wclient_by_time(client, time);
+
+  if (entry == NULL)
+    return btc_wclient_tip(client);
+
+  return entry;
+}
+
 static int
 btc_wallet_init_state(btc_wallet_t *wallet) {
   const btc_wclient_t *client = &wallet->client;
@@ -227,6 +367,15 @@ btc_wallet_init_state(btc_wallet_t *wallet) {
     const btc_entry_t *entry = btc_wclient_tip(client);
     int32_t left = wallet->network->block.keep_blocks;
 
+    /* Imported keys can only have been used after their birth.
+       Start there and let the sync rescan up to the tip. */
+    if (wallet->options.mnemonic || wallet->options.chain) {
+      entry = btc_wallet_by_time(wallet, wallet->options.birth);
+
+      btc_log(wallet, LOG_INFO, "Importing keys from height %d.",
+                                entry->height);
+    }
+
     btc_state_set(&wallet->state, entry);
 
     while (entry != NULL && left != 0) {
@@ -277,6 +426,7 @@ btc_wallet_init_data(btc_wallet_t *wallet) {
     case BTC_BIP32_STANDARD:
     case BTC_BIP32_P2WPKH:
     case BTC_BIP32_NESTED_P2WPKH:
+    case BTC_BIP32_P2TR:
       break;
     default:
       return 0;
@@ -299,6 +449,11 @@ btc_wallet_init_data(btc_wallet_t *wallet) {
   btc_balance_init(&wallet->balance);
   btc_balance_init(&wallet->watched);
 
+  if (wallet->options.mnemonic || wallet->options.chain)
+    wallet->birth = wallet->options.birth;
+  else
+    wallet->birth = btc_now();
+
   if (wallet->options.mnemonic) {
     btc_master_import_mnemonic(&wallet->master,
                                wallet->options.type,
@@ -316,6 +471,9 @@ btc_wallet_init_data(btc_wallet_t *wallet) {
   db_batch(&batch);
 
   btc_account_init(&acct, NULL);
+
+  acct.birth = wallet->birth;
+
   btc_account_generate(&acct, &batch, "default", &wallet->master, 0);
 
   db_put_master(&batch, &wallet->master);
@@ -347,39 +505,36 @@ btc_wallet_unload_data(btc_wallet_t *wallet) {
   btc_master_init(&wallet->master, wallet->network);
 }
 
-static int
-btc_wallet_load_filter(btc_wallet_t *wallet) {
-  size_t alloc = 100000; /* ~2.3mb */
-  size_t paths = 0;
-  size_t coins = 0;
-  size_t items = 0;
-  ldb_iter_t *it;
+static void
+btc_wallet_count_filter(size_t *paths, size_t *coins, btc_wallet_t *wallet) {
+  ldb_iter_t *it = ldb_iterator(wallet->db, 0);
 
-  it = ldb_iterator(wallet->db, 0);
+  *paths = 0;
+  *coins = 0;
 
   ldb_iter_range(it, &key_path_min, &key_path_max)
-    paths++;
+    *paths += 1;
 
   CHECK(ldb_iter_status(it) == LDB_OK);
 
   ldb_iter_range(it, &key_coin_min, &key_coin_max)
-    coins++;
+    *coins += 1;
 
   CHECK(ldb_iter_status(it) == LDB_OK);
 
-  items = paths + coins;
-
-  if (items > (alloc / 2))
-    alloc = items * 2;
+  ldb_iter_destroy(it);
+}
 
-  btc_bloom_set(&wallet->filter, alloc, 0.0001, BTC_BLOOM_INTERNAL);
+static void
+btc_wallet_fill_filter(btc_bloom_t *filter, btc_wallet_t *wallet) {
+  ldb_iter_t *it = ldb_iterator(wallet->db, 0);
 
   ldb_iter_range(it, &key_path_min, &key_path_max) {
     ldb_slice_t key = ldb_iter_key(it);
     const uint8_t *hash = (uint8_t *)key.data + 2;
     size_t len = key.size - 2;
 
-    btc_bloom_add(&wallet->filter, hash, len);
+    btc_bloom_add(filter, hash, len);
   }
 
   CHECK(ldb_iter_status(it) == LDB_OK);
@@ -387,14 +542,34 @@ btc_wallet_load_filter(btc_wallet_t *wallet) {
   ldb_iter_range(it, &key_coin_min, &key_coin_max) {
     ldb_slice_t key = ldb_iter_key(it);
     const uint8_t *hash = (uint8_t *)key.data + 1;
-    uint32_t index = btc_read32be(hash + 32);
+    uint8_t raw[36];
+
+    btc_raw_write(raw, hash, 32);
+    btc_uint32_write(raw + 32, btc_read32be(hash + 32));
 
-    btc_wallet_watch(wallet, hash, index);
+    btc_bloom_add(filter, raw, 36);
   }
 
   CHECK(ldb_iter_status(it) == LDB_OK);
 
   ldb_iter_destroy(it);
+}
+
+static int
+btc_wallet_load_filter(btc_wallet_t *wallet) {
+  size_t alloc = 100000; /* ~2.3mb */
+  size_t paths, coins, items;
+
+  btc_wallet_count_filter(&paths, &coins, wallet);
+
+  items = paths + coins;
+
+  if (items > (alloc / 2))
+    alloc = items * 2;
+
+  btc_bloom_set(&wallet->filter, alloc, 0.0001, BTC_BLOOM_INTERNAL);
+
+  btc_wallet_fill_filter(&wallet->filter, wallet);
 
   btc_log(wallet, LOG_INFO, "Added %zu hashes to filter.", paths);
   btc_log(wallet, LOG_INFO, "Added %zu outpoints to filter.", coins);
@@ -499,6 +674,13 @@ void
 btc_wallet_close(btc_wallet_t *wallet) {
   const btc_wclient_t *client = &wallet->client;
 
+  if (wallet->workers != NULL) {
+    btc_workers_destroy(wallet->workers);
+    wallet->workers = NULL;
+  }
+
+  btc_wallet_finish_unlocks(wallet, 1);
+
   btc_wallet_unload_filter(wallet);
   btc_wallet_unload_data(wallet);
   btc_wallet_unload_state(wallet);
@@ -516,6 +698,8 @@ btc_wallet_account(btc_account_t *acct,
 
   btc_account_init(acct, (btc_bloom_t *)&wallet->filter);
 
+  acct->shared = wallet->shared;
+
   return db_get_account(wallet->db, account, acct);
 }
 
@@ -590,6 +774,10 @@ btc_wallet_rate(btc_wallet_t *wallet, int64_t rate) {
 void
 btc_wallet_tick(void *ptr) {
   btc_wallet_t *wallet = ptr;
+
+  if (wallet->unlocks.length > 0)
+    btc_wallet_finish_unlocks(wallet, 0);
+
   btc_master_maybe_lock(&wallet->master);
 }
 
@@ -618,6 +806,32 @@ btc_wallet_unlock(btc_wallet_t *wallet, const char *pass, int64_t msec) {
   return btc_master_unlock(&wallet->master, pass, msec);
 }
 
+int
+btc_wallet_unlock_async(btc_wallet_t *wallet,
+                        const char *pass,
+                        int64_t msec,
+                        btc_wallet_unlock_cb *callback,
+                        void *arg) {
+  btc_unlock_t *job;
+
+  /* Only an encrypted wallet needs the KDF. Anything
+     else is cheap enough to do synchronously. Note that
+     re-unlocking runs the KDF as well: the passphrase is
+     only ever checked by opening the encrypted payload. */
+  if (wallet->master.algorithm == BTC_KDF_NONE || pass == NULL)
+    return 0;
+
+  if (wallet->workers == NULL)
+    wallet->workers = btc_workers_create(1, 1);
+
+  job = btc_unlock_create(wallet, pass, msec, callback, arg);
+
+  btc_vector_push(&wallet->unlocks, job);
+  btc_workers_add(wallet->workers, btc_unlock_work, job);
+
+  return 1;
+}
+
 int
 btc_wallet_encrypt(btc_wallet_t *wallet, const char *pass) {
   ldb_batch_t batch;
@@ -923,6 +1137,10 @@ btc_wallet_create_account(btc_wallet_t *wallet,
   db_batch(&batch);
 
   btc_account_init(&acct, &wallet->filter);
+
+  acct.shared = wallet->shared;
+  acct.birth = btc_now();
+
   btc_account_generate(&acct, &batch, name, &wallet->master, account);
 
   db_put_wallet(&batch, wallet);
@@ -937,7 +1155,9 @@ btc_wallet_create_account(btc_wallet_t *wallet,
 int
 btc_wallet_create_watcher(btc_wallet_t *wallet,
                           const char *name,
-                          const btc_hdnode_t *node) {
+                          const btc_hdnode_t *node,
+                          int64_t birth) {
+  const btc_entry_t *entry;
   size_t len = strlen(name);
   btc_account_t acct;
   ldb_batch_t batch;
@@ -952,12 +1172,13 @@ btc_wallet_create_watcher(btc_wallet_t *wallet,
     case BTC_BIP32_STANDARD:
     case BTC_BIP32_P2WPKH:
     case BTC_BIP32_NESTED_P2WPKH:
+    case BTC_BIP32_P2TR:
       break;
     default:
       return 0;
   }
 
-  if (node->depth != 2 || !(node->index & BTC_BIP32_HARDEN))
+  if (node->depth != 3 || !(node->index & BTC_BIP32_HARDEN))
     return 0;
 
   if (db_has_index(wallet->db, name))
@@ -966,12 +1187,26 @@ btc_wallet_create_watcher(btc_wallet_t *wallet,
   db_batch(&batch);
 
   btc_account_init(&acct, &wallet->filter);
+
+  acct.shared = wallet->shared;
+  acct.birth = birth >= 0 ? birth : btc_now();
+
   btc_account_watch(&acct, &batch, name, node, ++wallet->watch_index);
 
   db_put_wallet(&batch, wallet);
 
   db_write(wallet->db, &batch);
 
+  if (birth < 0 || !wallet->options.client)
+    return 1;
+
+  /* Pick up the history of the key without
+     scanning blocks that predate it. */
+  entry = btc_wallet_by_time(wallet, birth);
+
+  if (entry != NULL && entry->height <= wallet->state.height)
+    btc_wallet_rescan(wallet, entry->height);
+
   return 1;
 }
 
@@ -1279,10 +1514,8 @@ btc_wallet_add_tx(btc_wallet_t *wallet, const btc_tx_t *tx) {
   return btc_wallet_insert(wallet, tx, NULL, -1);
 }
 
-int
-btc_wallet_add_block(btc_wallet_t *wallet,
-                     const btc_entry_t *entry,
-                     const btc_block_t *block) {
+static int
+btc_wallet_check_block(btc_wallet_t *wallet, const btc_entry_t *entry) {
   const btc_state_t *state = &wallet->state;
 
   if (entry->height < state->height) {
@@ -1310,6 +1543,16 @@ btc_wallet_add_block(btc_wallet_t *wallet,
     }
   }
 
+  return 1;
+}
+
+int
+btc_wallet_add_block(btc_wallet_t *wallet,
+                     const btc_entry_t *entry,
+                     const btc_block_t *block) {
+  if (!btc_wallet_check_block(wallet, entry))
+    return 0;
+
   return btc_wallet_connect(wallet, entry, block);
 }
 
@@ -1369,8 +1612,15 @@ btc_wallet_rollback(btc_wallet_t *wallet, int32_t height) {
 
   tip.height = height;
 
-  if (!db_get_block(wallet->db, height, tip.hash))
-    return 0;
+  if (!db_get_block(wallet->db, height, tip.hash)) {
+    /* Deeper than the blocks we remember. */
+    const btc_entry_t *entry = btc_wclient_by_height(&wallet->client, height);
+
+    if (entry == NULL)
+      return 0;
+
+    btc_hash_copy(tip.hash, entry->hash);
+  }
 
   total = btc_txdb_revert(wallet, height + 1);
 
@@ -1487,11 +1737,14 @@ btc_wallet_watch(btc_wallet_t *wallet, const uint8_t *hash, uint32_t index) {
   btc_uint32_write(raw + 32, index);
 
   btc_bloom_add(&wallet->filter, raw, 36);
+
+  if (wallet->shared != NULL)
+    btc_bloom_add(wallet->shared, raw, 36);
 }
 
 size_t
 btc_wallet_size(const btc_wallet_t *wallet) {
-  return 16 + btc_balance_size(&wallet->balance)
+  return 24 + btc_balance_size(&wallet->balance)
             + btc_balance_size(&wallet->watched);
 }
 
@@ -1502,6 +1755,7 @@ btc_wallet_write(uint8_t *zp, const btc_wallet_t *x) {
   zp = btc_uint64_write(zp, x->unique_id);
   zp = btc_balance_write(zp, &x->balance);
   zp = btc_balance_write(zp, &x->watched);
+  zp = btc_int64_write(zp, x->birth);
   return zp;
 }
 
@@ -1522,6 +1776,12 @@ btc_wallet_read(btc_wallet_t *z, const uint8_t **xp, size_t *xn) {
   if (!btc_balance_read(&z->watched, xp, xn))
     return 0;
 
+  /* Wallets written before the birth field existed end here. */
+  z->birth = 0;
+
+  if (*xn > 0 && !btc_int64_read(&z->birth, xp, xn))
+    return 0;
+
   return 1;
 }
 
@@ -1534,3 +1794,241 @@ int
 btc_wallet_import(btc_wallet_t *z, const uint8_t *xp, size_t xn) {
   return btc_wallet_read(z, &xp, &xn);
 }
+
+/*
+ * Wallet Set
+ */
+
+typedef struct btc_walletent_s {
+  char name[64];
+  btc_wallet_t *wallet;
+  int active;
+  int total;
+} btc_walletent_t;
+
+struct btc_walletset_s {
+  btc_vector_t items;
+  btc_bloom_t filter;
+};
+
+btc_walletset_t *
+btc_walletset_create(void) {
+  btc_walletset_t *set = btc_malloc(sizeof(btc_walletset_t));
+
+  btc_vector_init(&set->items);
+  btc_bloom_init(&set->filter);
+
+  return set;
+}
+
+void
+btc_walletset_destroy(btc_walletset_t *set) {
+  size_t i;
+
+  for (i = 0; i < set->items.length; i++) {
+    btc_walletent_t *item = set->items.items[i];
+
+    item->wallet->shared = NULL;
+
+    btc_free(item);
+  }
+
+  btc_vector_clear(&set->items);
+  btc_bloom_clear(&set->filter);
+  btc_free(set);
+}
+
+static void
+btc_walletset_rebuild(btc_walletset_t *set) {
+  /* The combined filter cannot forget items, so it is
+     rebuilt from the databases whenever the set changes. */
+  size_t alloc = 100000;
+  size_t items = 0;
+  size_t i;
+
+  for (i = 0; i < set->items.length; i++) {
+    btc_walletent_t *item = set->items.items[i];
+    size_t paths, coins;
+
+    btc_wallet_count_filter(&paths, &coins, item->wallet);
+
+    items += paths + coins;
+  }
+
+  if (items > (alloc / 2))
+    alloc = items * 2;
+
+  btc_bloom_set(&set->filter, alloc, 0.0001, BTC_BLOOM_INTERNAL);
+
+  for (i = 0; i < set->items.length; i++) {
+    btc_walletent_t *item = set->items.items[i];
+
+    btc_wallet_fill_filter(&set->filter, item->wallet);
+
+    item->wallet->shared = &set->filter;
+  }
+}
+
+int
+btc_walletset_add(btc_walletset_t *set,
+                  const char *name,
+                  btc_wallet_t *wallet) {
+  btc_walletent_t *item;
+
+  if (btc_walletset_get(set, name) != NULL)
+    return 0;
+
+  item = btc_malloc(sizeof(btc_walletent_t));
+
+  if (!btc_strcpy(item->name, sizeof(item->name), name)) {
+    btc_free(item);
+    return 0;
+  }
+
+  item->wallet = wallet;
+  item->active = 0;
+  item->total = 0;
+
+  btc_vector_push(&set->items, item);
+
+  btc_walletset_rebuild(set);
+
+  return 1;
+}
+
+btc_wallet_t *
+btc_walletset_remove(btc_walletset_t *set, const char *name) {
+  btc_walletent_t *item;
+  btc_wallet_t *wallet;
+  size_t i;
+
+  for (i = 0; i < set->items.length; i++) {
+    item = set->items.items[i];
+
+    if (strcmp(item->name, name) == 0)
+      break;
+  }
+
+  if (i == set->items.length)
+    return NULL;
+
+  for (; i + 1 < set->items.length; i++)
+    set->items.items[i] = set->items.items[i + 1];
+
+  set->items.length--;
+
+  wallet = item->wallet;
+  wallet->shared = NULL;
+
+  btc_free(item);
+
+  btc_walletset_rebuild(set);
+
+  return wallet;
+}
+
+btc_wallet_t *
+btc_walletset_get(btc_walletset_t *set, const char *name) {
+  size_t i;
+
+  for (i = 0; i < set->items.length; i++) {
+    btc_walletent_t *item = set->items.items[i];
+
+    if (strcmp(item->name, name) == 0)
+      return item->wallet;
+  }
+
+  return NULL;
+}
+
+size_t
+btc_walletset_size(btc_walletset_t *set) {
+  return set->items.length;
+}
+
+const char *
+btc_walletset_name(btc_walletset_t *set, size_t index) {
+  const btc_walletent_t *item = set->items.items[index];
+  return item->name;
+}
+
+btc_wallet_t *
+btc_walletset_wallet(btc_walletset_t *set, size_t index) {
+  const btc_walletent_t *item = set->items.items[index];
+  return item->wallet;
+}
+
+void
+btc_walletset_add_tx(btc_walletset_t *set, const btc_tx_t *tx) {
+  size_t i;
+
+  if (!btc_txdb_test(&set->filter, tx))
+    return;
+
+  for (i = 0; i < set->items.length; i++) {
+    btc_walletent_t *item = set->items.items[i];
+
+    btc_wallet_add_tx(item->wallet, tx);
+  }
+}
+
+void
+btc_walletset_add_block(btc_walletset_t *set,
+                        const btc_entry_t *entry,
+                        const btc_block_t *block) {
+  size_t active = 0;
+  size_t i, j;
+
+  for (i = 0; i < set->items.length; i++) {
+    btc_walletent_t *item = set->items.items[i];
+
+    item->active = btc_wallet_check_block(item->wallet, entry);
+    item->total = 0;
+
+    if (item->active) {
+      btc_wallet_set_tip(item->wallet, entry);
+      active++;
+    }
+  }
+
+  if (active == 0)
+    return;
+
+  /* A single pass over the block. Transactions missing the
+     combined filter are skipped without consulting any wallet.
+     Matches update the filter, so spends of outputs created
+     earlier in the block are still caught. */
+  for (i = 0; i < block->txs.length; i++) {
+    const btc_tx_t *tx = block->txs.items[i];
+
+    if (!btc_txdb_test(&set->filter, tx))
+      continue;
+
+    for (j = 0; j < set->items.length; j++) {
+      btc_walletent_t *item = set->items.items[j];
+
+      if (item->active)
+        item->total += btc_wallet_insert(item->wallet, tx, entry, i);
+    }
+  }
+
+  for (i = 0; i < set->items.length; i++) {
+    btc_walletent_t *item = set->items.items[i];
+
+    if (item->total > 0) {
+      btc_log(item->wallet, LOG_INFO, "Connected block %H (tx=%d).",
+                                      entry->hash, item->total);
+    }
+  }
+}
+
+void
+btc_walletset_remove_block(btc_walletset_t *set, const btc_entry_t *entry) {
+  size_t i;
+
+  for (i = 0; i < set->items.length; i++) {
+    btc_walletent_t *item = set->items.items[i];
+
+    btc_wallet_remove_block(item->wallet, entry);
+  }
+}
@@ -0,0 +1,505 @@
+/*
+ * Generated with an independent bip340/bip341 implementation.
+ *
+ * Inputs:
+ *   0. key path, SIGHASH_DEFAULT
+ *   1. key path, SIGHASH_SINGLE | SIGHASH_ANYONECANPAY
+ *   2. script path, <a> CHECKSIG <b> CHECKSIGADD 2 EQUAL
+ *   3. script path, <a> CHECKSIG, SIGHASH_ALL, with annex
+ */
+
+typedef struct test_taproot_coin_s {
+  btc_outpoint_t outpoint;
+  const uint8_t *output_raw;
+  size_t output_len;
+} test_taproot_coin_t;
+
+static const uint8_t test_taproot_tx[] = {
+  0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x04, 0x0d,
+  0x1d, 0xa0, 0xa8, 0x8f, 0xff, 0xff, 0x8a, 0x10,
+  0xe9, 0xc5, 0xa6, 0xcc, 0xf7, 0x6a, 0xf0, 0xb2,
+  0x66, 0x47, 0x58, 0x68, 0xe4, 0x97, 0x22, 0x16,
+  0xc4, 0x7b, 0x7c, 0xc6, 0x17, 0x81, 0x90, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0xfd, 0xff, 0xff, 0xff,
+  0x85, 0x4e, 0x0a, 0x73, 0x4b, 0x85, 0x5d, 0x8a,
+  0x38, 0xd0, 0xb8, 0x0d, 0x17, 0xc6, 0x28, 0x37,
+  0xa9, 0xea, 0xa7, 0x35, 0x58, 0x97, 0x57, 0x3f,
+  0xf6, 0x85, 0xf8, 0xf6, 0xfc, 0x2b, 0xde, 0x6c,
+  0x01, 0x00, 0x00, 0x00, 0x00, 0xfc, 0xff, 0xff,
+  0xff, 0x14, 0x21, 0x21, 0xe5, 0x25, 0x86, 0x24,
+  0xfc, 0xe9, 0xc3, 0xaa, 0x31, 0xdf, 0x2c, 0xc9,
+  0x7e, 0x22, 0x4a, 0x73, 0xc6, 0x03, 0x6b, 0x61,
+  0x52, 0xf1, 0x83, 0x45, 0xee, 0xdc, 0x99, 0x60,
+  0x59, 0x02, 0x00, 0x00, 0x00, 0x00, 0xfb, 0xff,
+  0xff, 0xff, 0xf7, 0x0f, 0x1b, 0x8b, 0x44, 0xfa,
+  0x4b, 0x89, 0xd5, 0x2d, 0xdb, 0xc8, 0xb0, 0x11,
+  0x59, 0x73, 0xb4, 0xd9, 0xad, 0x3a, 0xf7, 0x66,
+  0xad, 0xca, 0xef, 0xd8, 0x33, 0xef, 0xe0, 0xc7,
+  0x17, 0x0b, 0x03, 0x00, 0x00, 0x00, 0x00, 0xfa,
+  0xff, 0xff, 0xff, 0x03, 0xf0, 0x49, 0x02, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x22, 0x51, 0x20, 0xa9,
+  0x74, 0xd7, 0xc4, 0x3c, 0xac, 0x80, 0xbb, 0x24,
+  0x08, 0xcf, 0x25, 0x41, 0x9e, 0x1e, 0x07, 0x91,
+  0x74, 0xe9, 0x10, 0xc5, 0xe4, 0xc3, 0x79, 0x34,
+  0x71, 0x46, 0x6e, 0x64, 0x25, 0xba, 0x5b, 0x90,
+  0xd0, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x16,
+  0x00, 0x14, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+  0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+  0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x70, 0x64,
+  0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x22, 0x51,
+  0x20, 0x4e, 0x2e, 0xfd, 0x0d, 0x6d, 0xea, 0x5d,
+  0x54, 0xab, 0xb7, 0x1d, 0x29, 0xf8, 0xf5, 0x36,
+  0xeb, 0x2a, 0x1d, 0x6e, 0x36, 0x35, 0x0e, 0x24,
+  0x95, 0x90, 0x90, 0x28, 0xb3, 0xa9, 0x15, 0x62,
+  0x53, 0x01, 0x40, 0x0a, 0xaa, 0x26, 0x2f, 0x03,
+  0x9d, 0x66, 0xc4, 0x2b, 0x49, 0x74, 0x89, 0x85,
+  0x80, 0x18, 0x55, 0xe9, 0x48, 0xb9, 0xba, 0x96,
+  0xb9, 0x1c, 0xd7, 0x79, 0x55, 0x21, 0x71, 0x2d,
+  0x91, 0xef, 0x8a, 0x8a, 0x72, 0xf4, 0x84, 0x69,
+  0x31, 0xfd, 0xd8, 0x57, 0xa8, 0xa8, 0xba, 0x0c,
+  0xcc, 0xe1, 0x9e, 0xf8, 0x22, 0x74, 0x4b, 0x98,
+  0xcd, 0xdd, 0x8c, 0xa0, 0xee, 0x0c, 0xbc, 0x62,
+  0x62, 0x1f, 0x8c, 0x01, 0x41, 0xe4, 0x21, 0x2e,
+  0xd5, 0x1e, 0x1b, 0xe4, 0x1f, 0x5b, 0x99, 0x7b,
+  0xbf, 0xab, 0xf3, 0x5a, 0xa6, 0x64, 0x4e, 0x36,
+  0xf5, 0xb5, 0x1e, 0x95, 0x7c, 0xfb, 0x39, 0x0d,
+  0xec, 0xca, 0x15, 0x3e, 0x86, 0x1b, 0x9e, 0x3d,
+  0x73, 0xff, 0x56, 0xe6, 0xc6, 0x07, 0x30, 0xf3,
+  0xa7, 0x40, 0xb5, 0xb2, 0x4c, 0x67, 0xd9, 0x62,
+  0x10, 0x58, 0xd4, 0x2f, 0x47, 0x14, 0x83, 0xad,
+  0x72, 0x04, 0x70, 0x06, 0x0b, 0x83, 0x04, 0x40,
+  0xd4, 0x2b, 0x48, 0x83, 0x67, 0x30, 0xd9, 0x93,
+  0xa4, 0xcb, 0xb3, 0x33, 0x4d, 0x85, 0x48, 0xf8,
+  0x8b, 0xd7, 0x15, 0x7c, 0x0e, 0xa6, 0x21, 0xc9,
+  0xd6, 0xd6, 0x05, 0x35, 0x5f, 0xb3, 0x43, 0xe6,
+  0xe7, 0x78, 0x74, 0x8f, 0xea, 0x7c, 0x9a, 0xd0,
+  0x5b, 0x08, 0x95, 0x7f, 0x57, 0xe3, 0x35, 0xc6,
+  0x95, 0xae, 0x69, 0x89, 0x9f, 0x9f, 0xf0, 0x3c,
+  0x1e, 0xcd, 0x2f, 0x3b, 0x20, 0xb8, 0x1d, 0x13,
+  0x40, 0x29, 0xca, 0x21, 0x4e, 0xc1, 0xfe, 0x9b,
+  0x8e, 0xc0, 0xa5, 0xce, 0x3d, 0xb1, 0x34, 0x2b,
+  0x90, 0xe8, 0x54, 0x7e, 0x81, 0x1e, 0xdc, 0x45,
+  0xb2, 0xdb, 0xad, 0x97, 0xa7, 0xf7, 0xf4, 0x30,
+  0x55, 0x71, 0x25, 0xe9, 0x92, 0x84, 0x4e, 0x7d,
+  0x86, 0xb6, 0xb1, 0xf9, 0x72, 0xc0, 0x00, 0x43,
+  0x5a, 0xfb, 0xf0, 0x27, 0xf0, 0xff, 0xf5, 0x46,
+  0xaf, 0x76, 0x22, 0xdb, 0x5a, 0x76, 0x92, 0x44,
+  0xd5, 0x46, 0x20, 0x84, 0xc8, 0xf0, 0x51, 0x81,
+  0x18, 0x5c, 0x0b, 0xd2, 0x57, 0x1d, 0x5a, 0xa7,
+  0xf5, 0xf0, 0xe3, 0x81, 0xde, 0x4e, 0x46, 0xd0,
+  0x42, 0x45, 0xfb, 0x04, 0x0b, 0x78, 0x07, 0x83,
+  0x42, 0xd2, 0x8b, 0xac, 0x20, 0x34, 0x59, 0x1a,
+  0x79, 0x53, 0x5e, 0x93, 0x29, 0x29, 0xdd, 0x68,
+  0xa0, 0xb2, 0xc7, 0xb4, 0x00, 0x59, 0x86, 0xca,
+  0x52, 0x6a, 0x40, 0x29, 0xe7, 0x23, 0x6b, 0x58,
+  0xd8, 0x2e, 0x58, 0x8f, 0x7a, 0xba, 0x52, 0x87,
+  0x41, 0xc0, 0x98, 0x8f, 0xc2, 0x14, 0xd2, 0x5c,
+  0x91, 0x22, 0x45, 0xb9, 0xca, 0xb7, 0x50, 0x74,
+  0x20, 0xe6, 0x2c, 0x32, 0x66, 0x56, 0x32, 0x35,
+  0xeb, 0xd6, 0xfe, 0x40, 0xf0, 0x0e, 0xa7, 0x03,
+  0xd7, 0x4c, 0x80, 0x15, 0x94, 0x8e, 0xe7, 0x30,
+  0xc8, 0xfa, 0x7a, 0xe4, 0x61, 0x86, 0x15, 0x4b,
+  0x53, 0xb3, 0x22, 0x6d, 0x28, 0xf4, 0xea, 0x14,
+  0xa5, 0xf2, 0xb8, 0x97, 0xd6, 0x79, 0x3f, 0xba,
+  0x91, 0xd0, 0x04, 0x41, 0x39, 0x30, 0xe8, 0x58,
+  0x07, 0xc6, 0xd4, 0x0c, 0x72, 0xf8, 0x43, 0x8d,
+  0xba, 0xb1, 0x57, 0x03, 0x8e, 0x7f, 0xa0, 0xb5,
+  0xc1, 0x69, 0xbf, 0x82, 0x84, 0x04, 0x2e, 0x37,
+  0x3e, 0xe2, 0x70, 0xd1, 0xf0, 0x90, 0xca, 0x0b,
+  0xd1, 0xc3, 0x15, 0x17, 0xde, 0x21, 0xe5, 0xae,
+  0xb0, 0x74, 0xdd, 0x40, 0xd8, 0xdd, 0x2c, 0xa4,
+  0x50, 0xb6, 0x08, 0x85, 0x76, 0x77, 0xbe, 0x13,
+  0xab, 0x87, 0x9e, 0x01, 0x01, 0x22, 0x20, 0x84,
+  0xc8, 0xf0, 0x51, 0x81, 0x18, 0x5c, 0x0b, 0xd2,
+  0x57, 0x1d, 0x5a, 0xa7, 0xf5, 0xf0, 0xe3, 0x81,
+  0xde, 0x4e, 0x46, 0xd0, 0x42, 0x45, 0xfb, 0x04,
+  0x0b, 0x78, 0x07, 0x83, 0x42, 0xd2, 0x8b, 0xac,
+  0x41, 0xc0, 0x3d, 0x90, 0x7b, 0x10, 0xc3, 0x62,
+  0x3f, 0xf2, 0x17, 0x09, 0x7b, 0xfa, 0x27, 0xf6,
+  0x22, 0x68, 0x25, 0x16, 0x02, 0x71, 0x55, 0x2e,
+  0xca, 0x8b, 0x5c, 0x3c, 0x1c, 0x53, 0x1b, 0x6b,
+  0xde, 0xbf, 0x28, 0x2c, 0xea, 0x0f, 0x25, 0xf0,
+  0xe7, 0x4d, 0x26, 0xf6, 0x3d, 0xb9, 0x4e, 0xdd,
+  0xcd, 0x43, 0x35, 0xa0, 0x8e, 0x1b, 0xa3, 0x2c,
+  0x4e, 0x23, 0x48, 0xdd, 0x2d, 0x5e, 0xe7, 0x4b,
+  0xb4, 0x53, 0x03, 0x50, 0x01, 0x02, 0x00, 0x00,
+  0x00, 0x00,
+};
+
+static const uint8_t test_taproot_output_0[] = {
+  0xa0, 0x86, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x22, 0x51, 0x20, 0xa9, 0x74, 0xd7, 0xc4, 0x3c,
+  0xac, 0x80, 0xbb, 0x24, 0x08, 0xcf, 0x25, 0x41,
+  0x9e, 0x1e, 0x07, 0x91, 0x74, 0xe9, 0x10, 0xc5,
+  0xe4, 0xc3, 0x79, 0x34, 0x71, 0x46, 0x6e, 0x64,
+  0x25, 0xba, 0x5b,
+};
+
+static const uint8_t test_taproot_output_1[] = {
+  0x40, 0x0d, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x22, 0x51, 0x20, 0x4e, 0x2e, 0xfd, 0x0d, 0x6d,
+  0xea, 0x5d, 0x54, 0xab, 0xb7, 0x1d, 0x29, 0xf8,
+  0xf5, 0x36, 0xeb, 0x2a, 0x1d, 0x6e, 0x36, 0x35,
+  0x0e, 0x24, 0x95, 0x90, 0x90, 0x28, 0xb3, 0xa9,
+  0x15, 0x62, 0x53,
+};
+
+static const uint8_t test_taproot_output_2[] = {
+  0xe0, 0x93, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x22, 0x51, 0x20, 0x11, 0x61, 0xfe, 0xee, 0xcf,
+  0xad, 0xa3, 0x27, 0xf1, 0x37, 0xe2, 0x06, 0x2e,
+  0x4a, 0xa8, 0x1f, 0x6f, 0x1f, 0x0c, 0x0b, 0x76,
+  0x68, 0x9f, 0xb6, 0x46, 0xe2, 0x36, 0x46, 0x7c,
+  0x0e, 0x9d, 0xa0,
+};
+
+static const uint8_t test_taproot_output_3[] = {
+  0x80, 0x1a, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x22, 0x51, 0x20, 0x4c, 0x24, 0x8b, 0x27, 0x38,
+  0x24, 0x4c, 0x58, 0x7a, 0x60, 0x61, 0x72, 0xe0,
+  0x62, 0x33, 0x2a, 0x2a, 0xac, 0x7e, 0xbc, 0xd3,
+  0xa1, 0xc6, 0x69, 0x43, 0xb8, 0xb9, 0xb0, 0xaf,
+  0xd0, 0xb0, 0x13,
+};
+
+static const test_taproot_coin_t test_taproot_coins[] = {
+  {
+    {
+      {
+        0x0d, 0x1d, 0xa0, 0xa8, 0x8f, 0xff, 0xff, 0x8a,
+        0x10, 0xe9, 0xc5, 0xa6, 0xcc, 0xf7, 0x6a, 0xf0,
+        0xb2, 0x66, 0x47, 0x58, 0x68, 0xe4, 0x97, 0x22,
+        0x16, 0xc4, 0x7b, 0x7c, 0xc6, 0x17, 0x81, 0x90
+      },
+      0
+    },
+    test_taproot_output_0,
+    sizeof(test_taproot_output_0)
+  },
+  {
+    {
+      {
+        0x85, 0x4e, 0x0a, 0x73, 0x4b, 0x85, 0x5d, 0x8a,
+        0x38, 0xd0, 0xb8, 0x0d, 0x17, 0xc6, 0x28, 0x37,
+        0xa9, 0xea, 0xa7, 0x35, 0x58, 0x97, 0x57, 0x3f,
+        0xf6, 0x85, 0xf8, 0xf6, 0xfc, 0x2b, 0xde, 0x6c
+      },
+      1
+    },
+    test_taproot_output_1,
+    sizeof(test_taproot_output_1)
+  },
+  {
+    {
+      {
+        0x14, 0x21, 0x21, 0xe5, 0x25, 0x86, 0x24, 0xfc,
+        0xe9, 0xc3, 0xaa, 0x31, 0xdf, 0x2c, 0xc9, 0x7e,
+        0x22, 0x4a, 0x73, 0xc6, 0x03, 0x6b, 0x61, 0x52,
+        0xf1, 0x83, 0x45, 0xee, 0xdc, 0x99, 0x60, 0x59
+      },
+      2
+    },
+    test_taproot_output_2,
+    sizeof(test_taproot_output_2)
+  },
+  {
+    {
+      {
+        0xf7, 0x0f, 0x1b, 0x8b, 0x44, 0xfa, 0x4b, 0x89,
+        0xd5, 0x2d, 0xdb, 0xc8, 0xb0, 0x11, 0x59, 0x73,
+        0xb4, 0xd9, 0xad, 0x3a, 0xf7, 0x66, 0xad, 0xca,
+        0xef, 0xd8, 0x33, 0xef, 0xe0, 0xc7, 0x17, 0x0b
+      },
+      3
+    },
+    test_taproot_output_3,
+    sizeof(test_taproot_output_3)
+  }
+};
+
+/*
+ * BIP341 wallet test vectors (bip-0341/wallet-test-vectors.json).
+ *
+ * scriptPubKey: each leaf is given with the control block
+ * spending it, which also encodes the path to the root.
+ *
+ * keyPathSpending: signatures use all-zero aux randomness.
+ * Inputs 2 and 5 are not taproot and are not spent.
+ */
+
+typedef struct test_bip341_leaf_s {
+  const char *script;
+  int version;
+  const char *hash;
+  const char *control;
+} test_bip341_leaf_t;
+
+typedef struct test_bip341_script_s {
+  const char *internal_key;
+  test_bip341_leaf_t leaves[3];
+  const char *root;
+  const char *tweaked_key;
+  const char *address;
+} test_bip341_script_t;
+
+typedef struct test_bip341_utxo_s {
+  const char *script;
+  int64_t value;
+} test_bip341_utxo_t;
+
+typedef struct test_bip341_spend_s {
+  size_t index;
+  const char *priv;
+  const char *root;
+  int type;
+  const char *sighash;
+  const char *sig;
+} test_bip341_spend_t;
+
+static const test_bip341_script_t test_bip341_scripts[] = {
+  {
+    "d6889cb081036e0faefa3a35157ad71086b123b2b144b649798b494c300a961d",
+    {
+      {NULL, 0, NULL, NULL}
+    },
+    NULL,
+    "53a1f6e454df1aa2776a2814a721372d6258050de330b3c6d10ee8f4e0dda343",
+    "bc1p2wsldez5mud2yam29q22wgfh9439spgduvct83k3pm50fcxa5dps59h4z5"
+  },
+  {
+    "187791b6f712a8ea41c8ecdd0ee77fab3e85263b37e1ec18a3651926b3a6cf27",
+    {
+      {
+        "20d85a959b0290bf19bb89ed43c916be835475d013da4b362117393e25a48229b8ac",
+        0xc0,
+        "5b75adecf53548f3ec6ad7d78383bf84cc57b55a3127c72b9a2481752dd88b21",
+        "c1187791b6f712a8ea41c8ecdd0ee77fab3e85263b37e1ec18a3651926b3a6cf27"
+      }
+    },
+    "5b75adecf53548f3ec6ad7d78383bf84cc57b55a3127c72b9a2481752dd88b21",
+    "147c9c57132f6e7ecddba9800bb0c4449251c92a1e60371ee77557b6620f3ea3",
+    "bc1pz37fc4cn9ah8anwm4xqqhvxygjf9rjf2resrw8h8w4tmvcs0863sa2e586"
+  },
+  {
+    "93478e9488f956df2396be2ce6c5cced75f900dfa18e7dabd2428aae78451820",
+    {
+      {
+        "20b617298552a72ade070667e86ca63b8f5789a9fe8731ef91202a91c9f3459007ac",
+        0xc0,
+        "c525714a7f49c28aedbbba78c005931a81c234b2f6c99a73e4d06082adc8bf2b",
+        "c093478e9488f956df2396be2ce6c5cced75f900dfa18e7dabd2428aae78451820"
+      }
+    },
+    "c525714a7f49c28aedbbba78c005931a81c234b2f6c99a73e4d06082adc8bf2b",
+    "e4d810fd50586274face62b8a807eb9719cef49c04177cc6b76a9a4251d5450e",
+    "bc1punvppl2stp38f7kwv2u2spltjuvuaayuqsthe34hd2dyy5w4g58qqfuag5"
+  },
+  {
+    "ee4fe085983462a184015d1f782d6a5f8b9c2b60130aff050ce221ecf3786592",
+    {
+      {
+        "20387671353e273264c495656e27e39ba899ea8fee3bb69fb2a680e22093447d48ac",
+        0xc0,
+        "8ad69ec7cf41c2a4001fd1f738bf1e505ce2277acdcaa63fe4765192497f47a7",
+        "c0ee4fe085983462a184015d1f782d6a5f8b9c2b60130aff050ce221ecf3786592"
+        "f224a923cd0021ab202ab139cc56802ddb92dcfc172b9212261a539df79a112a"
+      },
+      {
+        "06424950333431",
+        0xfa,
+        "f224a923cd0021ab202ab139cc56802ddb92dcfc172b9212261a539df79a112a",
+        "faee4fe085983462a184015d1f782d6a5f8b9c2b60130aff050ce221ecf3786592"
+        "8ad69ec7cf41c2a4001fd1f738bf1e505ce2277acdcaa63fe4765192497f47a7"
+      }
+    },
+    "6c2dc106ab816b73f9d07e3cd1ef2c8c1256f519748e0813e4edd2405d277bef",
+    "712447206d7a5238acc7ff53fbe94a3b64539ad291c7cdbc490b7577e4b17df5",
+    "bc1pwyjywgrd0ffr3tx8laflh6228dj98xkjj8rum0zfpd6h0e930h6saqxrrm"
+  },
+  {
+    "f9f400803e683727b14f463836e1e78e1c64417638aa066919291a225f0e8dd8",
+    {
+      {
+        "2044b178d64c32c4a05cc4f4d1407268f764c940d20ce97abfd44db5c3592b72fdac",
+        0xc0,
+        "64512fecdb5afa04f98839b50e6f0cb7b1e539bf6f205f67934083cdcc3c8d89",
+        "c1f9f400803e683727b14f463836e1e78e1c64417638aa066919291a225f0e8dd8"
+        "2cb2b90daa543b544161530c925f285b06196940d6085ca9474d41dc3822c5cb"
+      },
+      {
+        "07546170726f6f74",
+        0xc0,
+        "2cb2b90daa543b544161530c925f285b06196940d6085ca9474d41dc3822c5cb",
+        "c1f9f400803e683727b14f463836e1e78e1c64417638aa066919291a225f0e8dd8"
+        "64512fecdb5afa04f98839b50e6f0cb7b1e539bf6f205f67934083cdcc3c8d89"
+      }
+    },
+    "ab179431c28d3b68fb798957faf5497d69c883c6fb1e1cd9f81483d87bac90cc",
+    "77e30a5522dd9f894c3f8b8bd4c4b2cf82ca7da8a3ea6a239655c39c050ab220",
+    "bc1pwl3s54fzmk0cjnpl3w9af39je7pv5ldg504x5guk2hpecpg2kgsqaqstjq"
+  },
+  {
+    "e0dfe2300b0dd746a3f8674dfd4525623639042569d829c7f0eed9602d263e6f",
+    {
+      {
+        "2072ea6adcf1d371dea8fba1035a09f3d24ed5a059799bae114084130ee5898e69ac",
+        0xc0,
+        "2645a02e0aac1fe69d69755733a9b7621b694bb5b5cde2bbfc94066ed62b9817",
+        "c0e0dfe2300b0dd746a3f8674dfd4525623639042569d829c7f0eed9602d263e6f"
+        "ffe578e9ea769027e4f5a3de40732f75a88a6353a09d767ddeb66accef85e553"
+      },
+      {
+        "202352d137f2f3ab38d1eaa976758873377fa5ebb817372c71e2c542313d4abda8ac",
+        0xc0,
+        "ba982a91d4fc552163cb1c0da03676102d5b7a014304c01f0c77b2b8e888de1c",
+        "c0e0dfe2300b0dd746a3f8674dfd4525623639042569d829c7f0eed9602d263e6f"
+        "9e31407bffa15fefbf5090b149d53959ecdf3f62b1246780238c24501d5ceaf6"
+        "2645a02e0aac1fe69d69755733a9b7621b694bb5b5cde2bbfc94066ed62b9817"
+      },
+      {
+        "207337c0dd4253cb86f2c43a2351aadd82cccb12a172cd120452b9bb8324f2186aac",
+        0xc0,
+        "9e31407bffa15fefbf5090b149d53959ecdf3f62b1246780238c24501d5ceaf6",
+        "c0e0dfe2300b0dd746a3f8674dfd4525623639042569d829c7f0eed9602d263e6f"
+        "ba982a91d4fc552163cb1c0da03676102d5b7a014304c01f0c77b2b8e888de1c"
+        "2645a02e0aac1fe69d69755733a9b7621b694bb5b5cde2bbfc94066ed62b9817"
+      }
+    },
+    "ccbd66c6f7e8fdab47b3a486f59d28262be857f30d4773f2d5ea47f7761ce0e2",
+    "91b64d5324723a985170e4dc5a0f84c041804f2cd12660fa5dec09fc21783605",
+    "bc1pjxmy65eywgafs5tsunw95ruycpqcqnev6ynxp7jaasylcgtcxczs6n332e"
+  },
+  {
+    "55adf4e8967fbd2e29f20ac896e60c3b0f1d5b0efa9d34941b5958c7b0a0312d",
+    {
+      {
+        "2071981521ad9fc9036687364118fb6ccd2035b96a423c59c5430e98310a11abe2ac",
+        0xc0,
+        "f154e8e8e17c31d3462d7132589ed29353c6fafdb884c5a6e04ea938834f0d9d",
+        "c155adf4e8967fbd2e29f20ac896e60c3b0f1d5b0efa9d34941b5958c7b0a0312d"
+        "3cd369a528b326bc9d2133cbd2ac21451acb31681a410434672c8e34fe757e91"
+      },
+      {
+        "20d5094d2dbe9b76e2c245a2b89b6006888952e2faa6a149ae318d69e520617748ac",
+        0xc0,
+        "737ed1fe30bc42b8022d717b44f0d93516617af64a64753b7a06bf16b26cd711",
+        "c155adf4e8967fbd2e29f20ac896e60c3b0f1d5b0efa9d34941b5958c7b0a0312d"
+        "d7485025fceb78b9ed667db36ed8b8dc7b1f0b307ac167fa516fe4352b9f4ef7"
+        "f154e8e8e17c31d3462d7132589ed29353c6fafdb884c5a6e04ea938834f0d9d"
+      },
+      {
+        "20c440b462ad48c7a77f94cd4532d8f2119dcebbd7c9764557e62726419b08ad4cac",
+        0xc0,
+        "d7485025fceb78b9ed667db36ed8b8dc7b1f0b307ac167fa516fe4352b9f4ef7",
+        "c155adf4e8967fbd2e29f20ac896e60c3b0f1d5b0efa9d34941b5958c7b0a0312d"
+        "737ed1fe30bc42b8022d717b44f0d93516617af64a64753b7a06bf16b26cd711"
+        "f154e8e8e17c31d3462d7132589ed29353c6fafdb884c5a6e04ea938834f0d9d"
+      }
+    },
+    "2f6b2c5397b6d68ca18e09a3f05161668ffe93a988582d55c6f07bd5b3329def",
+    "75169f4001aa68f15bbed28b218df1d0a62cbbcf1188c6665110c293c907b831",
+    "bc1pw5tf7sqp4f50zka7629jrr036znzew70zxyvvej3zrpf8jg8hqcssyuewe"
+  }
+};
+
+static const char test_bip341_tx[] =
+  "02000000097de20cbff686da83a54981d2b9bab3586f4ca7e48f57f5b55963115f3b33"
+  "4e9c010000000000000000d7b7cab57b1393ace2d064f4d4a2cb8af6def61273e12751"
+  "7d44759b6dafdd990000000000fffffffff8e1f583384333689228c5d28eac13366be0"
+  "82dc57441760d957275419a418420000000000fffffffff0689180aa63b30cb162a73c"
+  "6d2a38b7eeda2a83ece74310fda0843ad604853b0100000000feffffffaa5202bdf6d8"
+  "ccd2ee0f0202afbbb7461d9264a25e5bfd3c5a52ee1239e0ba6c0000000000feffffff"
+  "956149bdc66faa968eb2be2d2faa29718acbfe3941215893a2a3446d32acd050000000"
+  "000000000000e664b9773b88c09c32cb70a2a3e4da0ced63b7ba3b22f848531bbb1d5d"
+  "5f4c94010000000000000000e9aa6b8e6c9de67619e6a3924ae25696bb7b694bb677a6"
+  "32a74ef7eadfd4eabf0000000000ffffffffa778eb6a263dc090464cd125c466b5a996"
+  "67720b1c110468831d058aa1b82af10100000000ffffffff0200ca9a3b000000001976"
+  "a91406afd46bcdfd22ef94ac122aa11f241244a37ecc88ac807840cb0000000020ac9a"
+  "87f5594be208f8532db38cff670c450ed2fea8fcdefcc9a663f78bab962b0065cd1d";
+
+static const test_bip341_utxo_t test_bip341_utxos[] = {
+  {"512053a1f6e454df1aa2776a2814a721372d6258050de330b3c6d10ee8f4e0dda343",
+   420000000},
+  {"5120147c9c57132f6e7ecddba9800bb0c4449251c92a1e60371ee77557b6620f3ea3",
+   462000000},
+  {"76a914751e76e8199196d454941c45d1b3a323f1433bd688ac",
+   294000000},
+  {"5120e4d810fd50586274face62b8a807eb9719cef49c04177cc6b76a9a4251d5450e",
+   504000000},
+  {"512091b64d5324723a985170e4dc5a0f84c041804f2cd12660fa5dec09fc21783605",
+   630000000},
+  {"00147dd65592d0ab2fe0d0257d571abf032cd9db93dc",
+   378000000},
+  {"512075169f4001aa68f15bbed28b218df1d0a62cbbcf1188c6665110c293c907b831",
+   672000000},
+  {"5120712447206d7a5238acc7ff53fbe94a3b64539ad291c7cdbc490b7577e4b17df5",
+   546000000},
+  {"512077e30a5522dd9f894c3f8b8bd4c4b2cf82ca7da8a3ea6a239655c39c050ab220",
+   588000000}
+};
+
+static const test_bip341_spend_t test_bip341_spends[] = {
+  {
+    0,
+    "6b973d88838f27366ed61c9ad6367663045cb456e28335c109e30717ae0c6baa",
+    NULL,
+    0x03,
+    "2514a6272f85cfa0f45eb907fcb0d121b808ed37c6ea160a5a9046ed5526d555",
+    "ed7c1647cb97379e76892be0cacff57ec4a7102aa24296ca39af7541246d8ff1"
+    "4d38958d4cc1e2e478e4d4a764bbfd835b16d4e314b72937b29833060b87276c03"
+  },
+  {
+    1,
+    "1e4da49f6aaf4e5cd175fe08a32bb5cb4863d963921255f33d3bc31e1343907f",
+    "5b75adecf53548f3ec6ad7d78383bf84cc57b55a3127c72b9a2481752dd88b21",
+    0x83,
+    "325a644af47e8a5a2591cda0ab0723978537318f10e6a63d4eed783b96a71a4d",
+    "052aedffc554b41f52b521071793a6b88d6dbca9dba94cf34c83696de0c1ec35"
+    "ca9c5ed4ab28059bd606a4f3a657eec0bb96661d42921b5f50a95ad33675b54f83"
+  },
+  {
+    3,
+    "d3c7af07da2d54f7a7735d3d0fc4f0a73164db638b2f2f7c43f711f6d4aa7e64",
+    "c525714a7f49c28aedbbba78c005931a81c234b2f6c99a73e4d06082adc8bf2b",
+    0x01,
+    "bf013ea93474aa67815b1b6cc441d23b64fa310911d991e713cd34c7f5d46669",
+    "ff45f742a876139946a149ab4d9185574b98dc919d2eb6754f8abaa59d18b025"
+    "637a3aa043b91817739554f4ed2026cf8022dbd83e351ce1fabc272841d2510a01"
+  },
+  {
+    4,
+    "f36bb07a11e469ce941d16b63b11b9b9120a84d9d87cff2c84a8d4affb438f4e",
+    "ccbd66c6f7e8fdab47b3a486f59d28262be857f30d4773f2d5ea47f7761ce0e2",
+    0x00,
+    "4f900a0bae3f1446fd48490c2958b5a023228f01661cda3496a11da502a7f7ef",
+    "b4010dd48a617db09926f729e79c33ae0b4e94b79f04a1ae93ede6315eb3669d"
+    "e185a17d2b0ac9ee09fd4c64b678a0b61a0a86fa888a273c8511be83bfd6810f"
+  },
+  {
+    6,
+    "415cfe9c15d9cea27d8104d5517c06e9de48e2f986b695e4f5ffebf230e725d8",
+    "2f6b2c5397b6d68ca18e09a3f05161668ffe93a988582d55c6f07bd5b3329def",
+    0x02,
+    "15f25c298eb5cdc7eb1d638dd2d45c97c4c59dcaec6679cfc16ad84f30876b85",
+    "a3785919a2ce3c4ce26f298c3d51619bc474ae24014bcdd31328cd8cfbab2eff"
+    "3395fa0a16fe5f486d12f22a9cedded5ae74feb4bbe5351346508c5405bcfee002"
+  },
+  {
+    7,
+    "c7b0e81f0a9a0b0499e112279d718cca98e79a12e2f137c72ae5b213aad0d103",
+    "6c2dc106ab816b73f9d07e3cd1ef2c8c1256f519748e0813e4edd2405d277bef",
+    0x82,
+    "cd292de50313804dabe4685e83f923d2969577191a3e1d2882220dca88cbeb10",
+    "ea0c6ba90763c2d3a296ad82ba45881abb4f426b3f87af162dd24d5109edc1cd"
+    "d11915095ba47c3a9963dc1e6c432939872bc49212fe34c632cd3ab9fed429c482"
+  },
+  {
+    8,
+    "77863416be0d0665e517e1c375fd6f75839544eca553675ef7fdf4949518ebaa",
+    "ab179431c28d3b68fb798957faf5497d69c883c6fb1e1cd9f81483d87bac90cc",
+    0x81,
+    "cccb739eca6c13a8a89e6e5cd317ffe55669bbda23f2fd37b0f18755e008edd2",
+    "bbc9584a11074e83bc8c6759ec55401f0ae7b03ef290c3139814f545b58a9f81"
+    "27258000874f44bc46db7646322107d4d86aec8e73b8719a61fff761d75b5dd981"
+  }
+};
@@ -52,12 +52,18 @@
 #  define TEST_NORETURN
 #endif
 
+#ifdef _WIN32
+#  define BTC_TMPDIR ".\\tmp"
+#  define BTC_TMPPATH(name) BTC_TMPDIR "\\" name
+#else
+#  define BTC_TMPDIR "./tmp"
+#  define BTC_TMPPATH(name) BTC_TMPDIR "/" name
+#endif
+
+/* Tests touching the disk define their own prefix
+   (BTC_TMPPATH) so they can be run in parallel. */
 #ifndef BTC_PREFIX
-#  ifdef _WIN32
-#    define BTC_PREFIX ".\\tmp"
-#  else
-#    define BTC_PREFIX "./tmp"
-#  endif
+#  define BTC_PREFIX BTC_TMPDIR
 #endif
 
 TEST_NORETURN void
@@ -170,6 +170,36 @@ static const struct addr_vector {
     },
     "tb1qqqqqp399et2xygdj5xreqhjjvcmzhxw4aywxecjdzew6hylgvsesrxh6hy",
     BTC_NETWORK_TESTNET
+  },
+  {
+    {
+      BTC_ADDRESS_WITNESS,
+      1,
+      {
+        0x79, 0xbe, 0x66, 0x7e, 0xf9, 0xdc, 0xbb, 0xac,
+        0x55, 0xa0, 0x62, 0x95, 0xce, 0x87, 0x0b, 0x07,
+        0x02, 0x9b, 0xfc, 0xdb, 0x2d, 0xce, 0x28, 0xd9,
+        0x59, 0xf2, 0x81, 0x5b, 0x16, 0xf8, 0x17, 0x98
+      },
+      32
+    },
+    "bc1p0xlxvlhemja6c4dqv22uapctqupfhlxm9h8z3k2e72q4k9hcz7vqzk5jj0",
+    BTC_NETWORK_MAINNET
+  },
+  {
+    {
+      BTC_ADDRESS_WITNESS,
+      1,
+      {
+        0x00, 0x00, 0x00, 0xc4, 0xa5, 0xca, 0xd4, 0x62,
+        0x21, 0xb2, 0xa1, 0x87, 0x90, 0x5e, 0x52, 0x66,
+        0x36, 0x2b, 0x99, 0xd5, 0xe9, 0x1c, 0x6c, 0xe2,
+        0x4d, 0x16, 0x5d, 0xab, 0x93, 0xe8, 0x64, 0x33
+      },
+      32
+    },
+    "tb1pqqqqp399et2xygdj5xreqhjjvcmzhxw4aywxecjdzew6hylgvsesf3hn0c",
+    BTC_NETWORK_TESTNET
   }
 };
 
@@ -185,7 +215,12 @@ static const char *invalid_vectors[] = {
    "fs4nce4xj0gdcccefvpysxf3q0sL5k7"),
   "tb1pw508d6qejxtdg4y5r3zarqfsj6c3", /* zero padding of more than 4 bits */
   ("tb1qrp33g0q5c5txsp9arysrx4k6zdk" /* non-zero padding in 8-to-5 conversion */
-   "fs4nce4xj0gdcccefvpysxf3pjxtptv")
+   "fs4nce4xj0gdcccefvpysxf3pjxtptv"),
+  ("bc1p0xlxvlhemja6c4dqv22uapctqupfh" /* bech32 checksum for v1 */
+   "lxm9h8z3k2e72q4k9hcz7vqh2y7hd"),
+  "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kemeawh", /* bech32m checksum for v0 */
+  ("tb1q0xlxvlhemja6c4dqv22uapctqupfh" /* bech32m checksum for v0 */
+   "lxm9h8z3k2e72q4k9hcz7vq24jc47")
 };
 
 /*
@@ -217,10 +252,13 @@ test_valid(void) {
         ASSERT(btc_address_is_p2sh(&addr));
         break;
       case BTC_ADDRESS_WITNESS:
-        ASSERT(item->data.version == 0);
+        ASSERT(item->data.version <= 1);
         ASSERT(item->data.length == 20 || item->data.length == 32);
 
-        if (item->data.length == 20) {
+        if (item->data.version == 1) {
+          btc_address_set_p2tr(&addr, item->data.hash);
+          ASSERT(btc_address_is_p2tr(&addr));
+        } else if (item->data.length == 20) {
           btc_address_set_p2wpkh(&addr, item->data.hash);
           ASSERT(btc_address_is_p2wpkh(&addr));
         } else {
@@ -262,7 +300,9 @@ test_valid(void) {
       case BTC_ADDRESS_WITNESS:
         ASSERT(btc_script_is_program(&script));
 
-        if (item->data.length == 20)
+        if (item->data.version == 1)
+          ASSERT(btc_script_is_p2tr(&script));
+        else if (item->data.length == 20)
           ASSERT(btc_script_is_p2wpkh(&script));
         else
           ASSERT(btc_script_is_p2wsh(&script));
@@ -1,14 +1,204 @@
 /*!
- * t-stub.c - stub test for mako
+ * t-addrman.c - addrman test for mako
  * Copyright (c) 2021, Christopher Jeffrey (MIT License).
  * https://github.com/chjj/mako
  */
 
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <base/addrman.h>
+#include <base/timedata.h>
+#include <mako/map.h>
+#include <mako/netaddr.h>
+#include <mako/network.h>
+#include <mako/util.h>
 #include "lib/tests.h"
 
+static void
+test_fresh(void) {
+  btc_addrman_t *man = btc_addrman_create(btc_mainnet);
+  const btc_addrent_t *entry;
+  btc_netaddr_t addr;
+
+  ASSERT(btc_addrman_get_fresh(man) == NULL);
+  ASSERT(btc_addrman_get_collision(man) == NULL);
+
+  btc_netaddr_set(&addr, "93.184.216.34", 8333);
+
+  addr.time = btc_now();
+  addr.services = 1;
+
+  ASSERT(btc_addrman_add(man, &addr, NULL));
+
+  entry = btc_addrman_get_fresh(man);
+
+  ASSERT(entry != NULL);
+  ASSERT(btc_netaddr_equal(&entry->addr, &addr));
+  ASSERT(!entry->used);
+
+  /* A successful handshake moves it to the used table. */
+  btc_addrman_mark_ack(man, &addr, 1);
+
+  ASSERT(btc_addrman_get_fresh(man) == NULL);
+
+  entry = btc_addrman_get(man);
+
+  ASSERT(entry != NULL);
+  ASSERT(entry->used);
+  ASSERT(entry->last_success != 0);
+
+  btc_addrman_resolve_collisions(man);
+
+  ASSERT(btc_addrman_get_collision(man) == NULL);
+  ASSERT(btc_addrman_total(man) == 1);
+
+  btc_addrman_destroy(man);
+}
+
+static const btc_addrent_t *
+lookup(btc_addrman_t *man, btc_netaddr_t *addr) {
+  return btc_netmap_get(btc_addrman_map(man), addr);
+}
+
+static void
+fill_bucket(btc_addrman_t *man,
+            const btc_timedata_t *td,
+            btc_netaddr_t *addr,
+            btc_netaddr_t *old) {
+  /* Promote addresses from one group until one of
+     them lands in a full used bucket. A /16 spreads
+     over at most eight used buckets of 256 each. */
+  const btc_addrent_t *entry;
+  char host[32];
+  int i;
+
+  for (i = 0; i < 65536; i++) {
+    sprintf(host, "93.184.%d.%d", i >> 8, i & 0xff);
+
+    btc_netaddr_set(addr, host, 8333);
+
+    addr->time = btc_timedata_now(td) - 65536 + i;
+    addr->services = 1;
+
+    ASSERT(btc_addrman_add(man, addr, NULL));
+
+    btc_addrman_mark_ack(man, addr, 1);
+
+    entry = btc_addrman_get_collision(man);
+
+    if (entry != NULL) {
+      btc_netaddr_copy(old, &entry->addr);
+      break;
+    }
+
+    ASSERT(lookup(man, addr)->used);
+  }
+
+  ASSERT(i < 65536);
+  ASSERT(i >= 256);
+
+  /* Tested before evicting: both stay where they are. */
+  ASSERT(!lookup(man, addr)->used);
+  ASSERT(lookup(man, old)->used);
+}
+
+static void
+test_collision_keep(void) {
+  btc_addrman_t *man = btc_addrman_create(btc_mainnet);
+  btc_netaddr_t addr, old;
+  btc_timedata_t td;
+
+  btc_timedata_init(&td);
+  btc_addrman_set_timedata(man, &td);
+
+  fill_bucket(man, &td, &addr, &old);
+
+  /* The used entry connected recently. */
+  btc_addrman_resolve_collisions(man);
+
+  ASSERT(btc_addrman_get_collision(man) == NULL);
+  ASSERT(!lookup(man, &addr)->used);
+  ASSERT(lookup(man, &old)->used);
+
+  btc_addrman_destroy(man);
+}
+
+static void
+test_collision_probe(void) {
+  btc_addrman_t *man = btc_addrman_create(btc_mainnet);
+  btc_netaddr_t addr, old;
+  btc_timedata_t td;
+
+  btc_timedata_init(&td);
+  btc_addrman_set_timedata(man, &td);
+
+  fill_bucket(man, &td, &addr, &old);
+
+  /* Long after the used entry was last seen, a
+     feeler probes it and the connection fails. */
+  td.offset = 5 * 60 * 60;
+
+  btc_addrman_mark_attempt(man, &old);
+
+  /* The probe gets a minute to complete. */
+  btc_addrman_resolve_collisions(man);
+
+  ASSERT(btc_addrman_get_collision(man) != NULL);
+  ASSERT(!lookup(man, &addr)->used);
+
+  td.offset += 61;
+
+  btc_addrman_resolve_collisions(man);
+
+  ASSERT(btc_addrman_get_collision(man) == NULL);
+  ASSERT(lookup(man, &addr)->used);
+  ASSERT(!lookup(man, &old)->used);
+
+  btc_addrman_destroy(man);
+}
+
+static void
+test_collision_timeout(void) {
+  btc_addrman_t *man = btc_addrman_create(btc_mainnet);
+  btc_netaddr_t addr, old;
+  btc_timedata_t td;
+
+  btc_timedata_init(&td);
+  btc_addrman_set_timedata(man, &td);
+
+  fill_bucket(man, &td, &addr, &old);
+
+  /* The new entry connects again long after the used
+     entry was last seen. Nobody probes the used one. */
+  td.offset = 5 * 60 * 60;
+
+  btc_addrman_mark_ack(man, &addr, 1);
+
+  td.offset += 39 * 60;
+
+  btc_addrman_resolve_collisions(man);
+
+  ASSERT(btc_addrman_get_collision(man) != NULL);
+  ASSERT(!lookup(man, &addr)->used);
+
+  /* After 40 minutes we stop waiting. */
+  td.offset += 2 * 60;
+
+  btc_addrman_resolve_collisions(man);
+
+  ASSERT(btc_addrman_get_collision(man) == NULL);
+  ASSERT(lookup(man, &addr)->used);
+  ASSERT(!lookup(man, &old)->used);
+
+  btc_addrman_destroy(man);
+}
+
 int main(void) {
+  test_fresh();
+  test_collision_keep();
+  test_collision_probe();
+  test_collision_timeout();
   return 0;
 }
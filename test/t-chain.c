@@ -6,15 +6,36 @@
 
 #include <stddef.h>
 #include <string.h>
+#ifndef _WIN32
+#  include <sys/types.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+#include <io/core.h>
 #include <node/chain.h>
+#include <node/chaindb.h>
+#include <node/mempool.h>
+#include <node/miner.h>
+#include <mako/address.h>
 #include <mako/block.h>
+#include <mako/coins.h>
+#include <mako/entry.h>
+#include <mako/header.h>
 #include <mako/network.h>
+#include <mako/tx.h>
+#include <mako/util.h>
+
+#define BTC_PREFIX BTC_TMPPATH("chain")
+
 #include "lib/tests.h"
 #include "data/chain_vectors_main.h"
 #include "data/chain_vectors_testnet.h"
 
 static void
-test_chain(const btc_network_t *network, const char **vectors, size_t length) {
+test_chain(const btc_network_t *network,
+           const char **vectors,
+           size_t length,
+           unsigned int chain_flags) {
   unsigned int flags = BTC_BLOCK_DEFAULT_FLAGS;
   btc_chain_t *chain = btc_chain_create(network);
   unsigned char data[65536];
@@ -23,7 +44,7 @@ test_chain(const btc_network_t *network, const char **vectors, size_t length) {
 
   btc_rimraf(BTC_PREFIX);
 
-  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, chain_flags));
 
   for (i = 0; i < length; i++) {
     size_t size = sizeof(data);
@@ -38,6 +59,677 @@ test_chain(const btc_network_t *network, const char **vectors, size_t length) {
     btc_block_clear(&block);
   }
 
+  btc_chain_close(chain);
+
+  /* The tip survives a reopen however the coins were written. */
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_height(chain) == (int32_t)length);
+
+  btc_chain_close(chain);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_invalidate(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  const btc_entry_t *a6, *a8, *a9, *a10, *b8;
+  btc_address_t addr1, addr2;
+  uint8_t hash[32];
+
+  btc_rimraf(BTC_PREFIX);
+
+  btc_address_init(&addr1);
+  btc_address_init(&addr2);
+
+  addr1.hash[0] = 1;
+  addr2.hash[0] = 2;
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  btc_miner_generate(miner, 10, &addr1);
+
+  a6 = btc_chain_by_height(chain, 6);
+  a8 = btc_chain_by_height(chain, 8);
+  a9 = btc_chain_by_height(chain, 9);
+  a10 = btc_chain_tip(chain);
+
+  /* Invalidating rewinds to the parent. */
+  ASSERT(btc_chain_invalidate(chain, a6->hash));
+  ASSERT(btc_chain_height(chain) == 5);
+  ASSERT(btc_chain_has_invalid(chain, a6->hash));
+  ASSERT(btc_chain_has_invalid(chain, a10->hash));
+  ASSERT(a6->status == BTC_ENTRY_FAILED);
+  ASSERT(a10->status == BTC_ENTRY_FAILED_CHILD);
+
+  /* A shorter competing branch. */
+  btc_miner_generate(miner, 3, &addr2);
+
+  b8 = btc_chain_tip(chain);
+
+  ASSERT(b8->height == 8);
+
+  /* Reconsidering returns to the most work. */
+  ASSERT(btc_chain_reconsider(chain, a6->hash));
+  ASSERT(btc_chain_tip(chain) == a10);
+  ASSERT(!btc_chain_has_invalid(chain, a6->hash));
+  ASSERT(a10->status == 0);
+
+  /* The losing branch still competes once the tip falls below it. */
+  ASSERT(btc_chain_invalidate(chain, a8->hash));
+  ASSERT(btc_chain_tip(chain) == b8);
+
+  ASSERT(btc_chain_reconsider(chain, a8->hash));
+  ASSERT(btc_chain_tip(chain) == a10);
+
+  /* Equal work keeps the first tip until another is precious. */
+  ASSERT(btc_chain_invalidate(chain, a9->hash));
+  ASSERT(btc_chain_tip(chain) == a8);
+
+  ASSERT(btc_chain_precious(chain, b8->hash));
+  ASSERT(btc_chain_tip(chain) == b8);
+
+  ASSERT(btc_chain_precious(chain, a8->hash));
+  ASSERT(btc_chain_tip(chain) == a8);
+
+  /* Failures survive a restart. */
+  btc_hash_copy(hash, a9->hash);
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_has_invalid(chain, hash));
+  ASSERT(btc_chain_height(chain) == 8);
+
+  ASSERT(btc_chain_reconsider(chain, hash));
+  ASSERT(btc_chain_height(chain) == 10);
+
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static btc_block_t *
+mine_block(btc_miner_t *miner,
+           const btc_block_t *prev,
+           int32_t height,
+           const btc_tx_t *tx,
+           int tag) {
+  btc_tmpl_t *bt = btc_miner_template(miner);
+  btc_block_t *block;
+
+  btc_header_hash(bt->prev_block, &prev->header);
+
+  bt->time = prev->header.time + 1;
+  bt->mtp = prev->header.time;
+  bt->height = height;
+  bt->address.hash[0] = tag;
+
+  if (tx != NULL)
+    btc_tmpl_push(bt, tx, NULL);
+
+  btc_tmpl_refresh(bt);
+
+  block = btc_tmpl_mine(bt);
+
+  btc_tmpl_destroy(bt);
+
+  return block;
+}
+
+static void
+test_partial(void) {
+  unsigned int flags = BTC_BLOCK_DEFAULT_FLAGS;
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, NULL);
+  btc_block_t *a1, *b2, *c2, *b3, *b4;
+  uint8_t hash2[32], hash3[32], hash4[32];
+  btc_outpoint_t prevout;
+  btc_address_t addr;
+  btc_tx_t *tx;
+
+  btc_rimraf(BTC_PREFIX);
+
+  btc_address_init(&addr);
+
+  addr.hash[0] = 1;
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+
+  btc_miner_generate(miner, 5, &addr);
+
+  a1 = btc_chain_get_block(chain, btc_chain_by_height(chain, 1));
+
+  ASSERT(a1 != NULL);
+
+  /* Spends a coin which does not exist. */
+  btc_outpoint_init(&prevout);
+  memset(prevout.hash, 0xaa, 32);
+
+  tx = btc_tx_create();
+
+  btc_tx_add_outpoint(tx, &prevout);
+  btc_tx_add_output(tx, &addr, 1);
+  btc_tx_refresh(tx);
+
+  /* Two branches off a1, received in the order b2, c2, b3, b4. */
+  b2 = mine_block(miner, a1, 2, NULL, 2);
+  c2 = mine_block(miner, a1, 2, NULL, 3);
+  b3 = mine_block(miner, b2, 3, tx, 2);
+  b4 = mine_block(miner, b3, 4, NULL, 2);
+
+  ASSERT(btc_chain_add(chain, b2, flags, -1));
+  ASSERT(btc_chain_add(chain, c2, flags, -1));
+  ASSERT(btc_chain_add(chain, b3, flags, -1));
+  ASSERT(btc_chain_add(chain, b4, flags, -1));
+  ASSERT(btc_chain_height(chain) == 5);
+
+  btc_header_hash(hash2, &b2->header);
+  btc_header_hash(hash3, &b3->header);
+  btc_header_hash(hash4, &b4->header);
+
+  /* The reorganization to b4 stops at b3. b2 was
+     received before c2, so it stays the tip. */
+  ASSERT(btc_chain_invalidate(chain, btc_chain_by_height(chain, 2)->hash));
+  ASSERT(btc_chain_has_invalid(chain, hash3));
+  ASSERT(btc_chain_has_invalid(chain, hash4));
+  ASSERT(btc_hash_equal(btc_chain_tip(chain)->hash, hash2));
+
+  btc_chain_close(chain);
+
+  btc_tx_destroy(tx);
+  btc_block_destroy(a1);
+  btc_block_destroy(b2);
+  btc_block_destroy(c2);
+  btc_block_destroy(b3);
+  btc_block_destroy(b4);
+  btc_miner_destroy(miner);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+coinbase_hash(uint8_t *hash, btc_chain_t *chain, const btc_entry_t *entry) {
+  btc_block_t *block = btc_chain_get_block(chain, entry);
+
+  ASSERT(block != NULL);
+
+  btc_hash_copy(hash, block->txs.items[0]->hash);
+
+  btc_block_destroy(block);
+}
+
+static int
+has_coin(btc_chain_t *chain, const uint8_t *hash) {
+  btc_coin_t *coin = btc_chain_coin(chain, hash, 0);
+
+  if (coin == NULL)
+    return 0;
+
+  btc_coin_destroy(coin);
+
+  return 1;
+}
+
+static void
+test_reorganize(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  uint8_t a1[32], b1[32], a50[32], tip[32];
+  btc_address_t addr1, addr2;
+  const btc_entry_t *entry;
+
+  btc_rimraf(BTC_PREFIX);
+
+  btc_address_init(&addr1);
+  btc_address_init(&addr2);
+
+  addr1.hash[0] = 1;
+  addr2.hash[0] = 2;
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  btc_miner_generate(miner, 100, &addr1);
+
+  entry = btc_chain_by_height(chain, 1);
+
+  btc_hash_copy(a1, entry->hash);
+  btc_hash_copy(tip, btc_chain_tip(chain)->hash);
+
+  coinbase_hash(a50, chain, btc_chain_by_height(chain, 50));
+
+  /* Rewind a hundred blocks in one go. */
+  ASSERT(btc_chain_invalidate(chain, a1));
+  ASSERT(btc_chain_height(chain) == 0);
+  ASSERT(!has_coin(chain, a50));
+
+  btc_miner_generate(miner, 99, &addr2);
+
+  coinbase_hash(b1, chain, btc_chain_by_height(chain, 1));
+
+  ASSERT(has_coin(chain, b1));
+
+  /* Deep reorganization back to the heavier chain. */
+  ASSERT(btc_chain_reconsider(chain, a1));
+  ASSERT(btc_chain_height(chain) == 100);
+  ASSERT(btc_hash_equal(btc_chain_tip(chain)->hash, tip));
+  ASSERT(has_coin(chain, a50));
+  ASSERT(!has_coin(chain, b1));
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  /* The coins were committed along with the tip. */
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_height(chain) == 100);
+  ASSERT(has_coin(chain, a50));
+  ASSERT(!has_coin(chain, b1));
+
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_orphans(void) {
+  unsigned int flags = BTC_BLOCK_DEFAULT_FLAGS;
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  btc_block_t *blocks[3];
+  btc_address_t addr;
+  int i;
+
+  btc_rimraf(BTC_PREFIX);
+
+  btc_address_init(&addr);
+
+  addr.hash[0] = 1;
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  btc_miner_generate(miner, 3, &addr);
+
+  for (i = 0; i < 3; i++) {
+    blocks[i] = btc_chain_get_block(chain, btc_chain_by_height(chain, i + 1));
+
+    ASSERT(blocks[i] != NULL);
+  }
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  btc_rimraf(BTC_PREFIX);
+
+  /* Blocks arriving ahead of their parent are kept on disk. */
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_add(chain, blocks[2], flags, -1));
+  ASSERT(btc_chain_add(chain, blocks[1], flags, -1));
+  ASSERT(btc_chain_height(chain) == 0);
+  ASSERT(btc_chain_has_orphan(chain, blocks[2]->header.prev_block));
+
+  btc_chain_close(chain);
+
+  /* They survive a restart and connect once the parent arrives. */
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_has_orphan(chain, blocks[2]->header.prev_block));
+  ASSERT(btc_chain_add(chain, blocks[0], flags, -1));
+  ASSERT(btc_chain_height(chain) == 3);
+  ASSERT(!btc_chain_has_orphan(chain, blocks[2]->header.prev_block));
+
+  btc_chain_close(chain);
+
+  /* Connected orphans are moved to the block files. */
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_height(chain) == 3);
+  ASSERT(!btc_chain_has_orphan(chain, blocks[2]->header.prev_block));
+
+  for (i = 0; i < 3; i++) {
+    btc_block_t *block = btc_chain_get_block(chain,
+                                             btc_chain_by_height(chain, i + 1));
+
+    ASSERT(block != NULL);
+    ASSERT(btc_block_size(block) == btc_block_size(blocks[i]));
+
+    btc_block_destroy(block);
+  }
+
+  btc_chain_close(chain);
+
+  for (i = 0; i < 3; i++)
+    btc_block_destroy(blocks[i]);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_by_time(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  const btc_entry_t *entry, *found;
+  int64_t times[21];
+  btc_address_t addr;
+  int32_t i;
+
+  btc_rimraf(BTC_PREFIX);
+
+  btc_address_init(&addr);
+
+  addr.hash[0] = 1;
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  btc_miner_generate(miner, 20, &addr);
+
+  for (i = 0; i <= 20; i++) {
+    entry = btc_chain_by_height(chain, i);
+
+    ASSERT(entry->max_time >= entry->header.time);
+    ASSERT(i == 0 || entry->max_time >= entry->prev->max_time);
+
+    times[i] = entry->max_time;
+  }
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  /* The running maximum is rebuilt on load. */
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+
+  for (i = 0; i <= 20; i++) {
+    entry = btc_chain_by_height(chain, i);
+    found = btc_chain_by_time(chain, times[i]);
+
+    ASSERT(entry->max_time == times[i]);
+    ASSERT(found != NULL);
+    ASSERT(found->height <= i);
+    ASSERT(found->max_time >= times[i]);
+    ASSERT(found->height == 0 || found->prev->max_time < times[i]);
+  }
+
+  ASSERT(btc_chain_by_time(chain, 0) == btc_chain_by_height(chain, 0));
+  ASSERT(btc_chain_by_time(chain, times[20] + 1) == NULL);
+
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_backup(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  const char *backup = BTC_PREFIX "_backup";
+  uint8_t tip[32], cb[32];
+  btc_address_t addr;
+
+  btc_rimraf(BTC_PREFIX);
+  btc_rimraf(backup);
+
+  btc_address_init(&addr);
+
+  addr.hash[0] = 1;
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, BTC_CHAIN_NOWAL));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  btc_miner_generate(miner, 10, &addr);
+
+  btc_hash_copy(tip, btc_chain_tip(chain)->hash);
+
+  coinbase_hash(cb, chain, btc_chain_by_height(chain, 10));
+
+  ASSERT(btc_chain_backup(chain, backup));
+  ASSERT(!btc_chain_backup(chain, backup));
+
+  /* Writing to the original leaves the copy alone. */
+  btc_miner_generate(miner, 5, &addr);
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  ASSERT(btc_chain_open(chain, backup, 0));
+  ASSERT(btc_chain_height(chain) == 10);
+  ASSERT(btc_hash_equal(btc_chain_tip(chain)->hash, tip));
+  ASSERT(has_coin(chain, cb));
+
+  btc_chain_close(chain);
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_height(chain) == 15);
+
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+  btc_rimraf(backup);
+}
+
+#ifndef _WIN32
+static void
+replay_child(int fd) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  uint8_t hashes[6 * 32];
+  btc_address_t addr;
+  int i;
+
+  btc_address_init(&addr);
+
+  addr.hash[0] = 2;
+
+  if (!btc_chain_open(chain, BTC_PREFIX, BTC_CHAIN_NOWAL))
+    _exit(1);
+
+  if (!btc_mempool_open(mp, NULL, 0))
+    _exit(1);
+
+  btc_miner_generate(miner, 5, &addr);
+
+  btc_hash_copy(hashes, btc_chain_tip(chain)->hash);
+
+  for (i = 0; i < 5; i++) {
+    const btc_entry_t *entry = btc_chain_by_height(chain, 11 + i);
+
+    coinbase_hash(hashes + (i + 1) * 32, chain, entry);
+  }
+
+  if (write(fd, hashes, sizeof(hashes)) != (ssize_t)sizeof(hashes))
+    _exit(1);
+
+  /* Die without flushing the coins. */
+  _exit(0);
+}
+
+static void
+test_replay(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  uint8_t hashes[6 * 32], cb[32];
+  btc_address_t addr;
+  int fds[2];
+  int status;
+  pid_t pid;
+  int i;
+
+  btc_rimraf(BTC_PREFIX);
+
+  btc_address_init(&addr);
+
+  addr.hash[0] = 1;
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, BTC_CHAIN_NOWAL));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  btc_miner_generate(miner, 10, &addr);
+
+  coinbase_hash(cb, chain, btc_chain_by_height(chain, 10));
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  /* Connect blocks past the flush key and crash. */
+  ASSERT(pipe(fds) == 0);
+
+  pid = fork();
+
+  ASSERT(pid != -1);
+
+  if (pid == 0) {
+    close(fds[0]);
+    replay_child(fds[1]);
+  }
+
+  close(fds[1]);
+
+  ASSERT(read(fds[0], hashes, sizeof(hashes)) == (ssize_t)sizeof(hashes));
+  ASSERT(waitpid(pid, &status, 0) == pid);
+  ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  close(fds[0]);
+
+  /* Their coins are replayed from the block files. */
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, BTC_CHAIN_NOWAL));
+  ASSERT(btc_chain_height(chain) == 15);
+  ASSERT(btc_hash_equal(btc_chain_tip(chain)->hash, hashes));
+  ASSERT(has_coin(chain, cb));
+
+  for (i = 0; i < 5; i++)
+    ASSERT(has_coin(chain, hashes + (i + 1) * 32));
+
+  btc_chain_close(chain);
+
+  /* And were flushed while recovering. */
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_chain_height(chain) == 15);
+
+  for (i = 0; i < 5; i++)
+    ASSERT(has_coin(chain, hashes + (i + 1) * 32));
+
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+#endif /* !_WIN32 */
+
+static void
+test_states(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  const btc_deployment_t *deploy;
+  const btc_entry_t *entry;
+  btc_deployment_t other;
+  uint32_t mask;
+  btc_address_t addr;
+  btc_chaindb_t *db;
+
+  btc_rimraf(BTC_PREFIX);
+
+  btc_address_init(&addr);
+
+  addr.hash[0] = 1;
+
+  deploy = btc_network_deployment(network, "testdummy");
+
+  ASSERT(deploy != NULL);
+
+  mask = UINT32_C(1) << deploy->bit;
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  /* Cross the first window boundary. */
+  btc_miner_generate(miner, network->miner_window + 6, &addr);
+
+  ASSERT(btc_chain_compute_version(chain, btc_chain_tip(chain)) & mask);
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  /* The boundary state was written out. */
+  db = btc_chaindb_create(network);
+
+  ASSERT(btc_chaindb_open(db, BTC_PREFIX, 0));
+
+  entry = btc_chaindb_by_height(db, network->miner_window - 1);
+
+  ASSERT(entry != NULL);
+  ASSERT(btc_chaindb_get_state(db, deploy, entry) == BTC_STATE_STARTED);
+
+  /* But not for a deployment with other parameters on the same bit. */
+  other = *deploy;
+  other.start_time += 1;
+
+  ASSERT(btc_chaindb_get_state(db, &other, entry) == -1);
+
+  other = *deploy;
+  other.threshold = network->activation_threshold + 1;
+
+  ASSERT(btc_chaindb_get_state(db, &other, entry) == -1);
+
+  /* Plant a state that counting would never produce. */
+  ASSERT(btc_chaindb_put_state(db, deploy, entry, BTC_STATE_FAILED));
+
+  btc_chaindb_close(db);
+  btc_chaindb_destroy(db);
+
+  /* A restarted chain reads it back instead of recounting. */
+  chain = btc_chain_create(network);
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(!(btc_chain_compute_version(chain, btc_chain_tip(chain)) & mask));
+
   btc_chain_close(chain);
   btc_chain_destroy(chain);
 
@@ -46,11 +738,27 @@ test_chain(const btc_network_t *network, const char **vectors, size_t length) {
 
 int
 main(void) {
+  btc_fs_mkdir(BTC_TMPDIR);
+
   test_chain(btc_mainnet, chain_vectors_main,
-                          lengthof(chain_vectors_main));
+                          lengthof(chain_vectors_main), 0);
 
   test_chain(btc_testnet, chain_vectors_testnet,
-                          lengthof(chain_vectors_testnet));
+                          lengthof(chain_vectors_testnet), 0);
+
+  test_chain(btc_mainnet, chain_vectors_main,
+                          lengthof(chain_vectors_main), BTC_CHAIN_NOWAL);
+
+  test_invalidate();
+  test_reorganize();
+  test_partial();
+  test_orphans();
+  test_by_time();
+  test_backup();
+#ifndef _WIN32
+  test_replay();
+#endif
+  test_states();
 
   return 0;
 }
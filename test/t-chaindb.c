@@ -6,13 +6,18 @@
 
 #include <stddef.h>
 #include <string.h>
+#include <io/core.h>
 #include <node/chaindb.h>
 #include <mako/network.h>
+
+#define BTC_PREFIX BTC_TMPPATH("chaindb")
+
 #include "lib/tests.h"
 
 int main(void) {
   btc_chaindb_t *db = btc_chaindb_create(btc_mainnet);
 
+  btc_fs_mkdir(BTC_TMPDIR);
   btc_rimraf(BTC_PREFIX);
 
   ASSERT(btc_chaindb_open(db, BTC_PREFIX, BTC_CHAIN_DEFAULT_FLAGS));
@@ -0,0 +1,221 @@
+/*!
+ * t-ecc.c - ecc internals test for mako
+ * Copyright (c) 2021, Christopher Jeffrey (MIT License).
+ * https://github.com/chjj/mako
+ */
+
+/* Field and scalar arithmetic is private to ecc.c. */
+#include "../src/crypto/ecc.c"
+
+#include <stddef.h>
+#include <string.h>
+#include <mako/crypto/drbg.h>
+#include <mako/mpi.h>
+#include "lib/tests.h"
+
+/*
+ * Edge Cases
+ */
+
+static const char *field_edges[] = {
+  "0000000000000000000000000000000000000000000000000000000000000000",
+  "0000000000000000000000000000000000000000000000000000000000000001",
+  "0000000000000000000000000000000000000000000000000000000000000002",
+  "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140",
+  "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e"
+};
+
+static const char *scalar_edges[] = {
+  "0000000000000000000000000000000000000000000000000000000000000000",
+  "0000000000000000000000000000000000000000000000000000000000000001",
+  "0000000000000000000000000000000000000000000000000000000000000002",
+  "7fffffffffffffffffffffffffffffff5d576e7357a4501ddfe92f46681b20a0",
+  "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364140"
+};
+
+/*
+ * Reference
+ */
+
+static int
+ref_invert(unsigned char *zp,
+           const unsigned char *xp,
+           const mp_limb_t *mp,
+           mp_size_t mn) {
+  mp_limb_t scratch[MPN_INVERT_ITCH(FIELD_LIMBS)];
+  mp_limb_t tp[FIELD_LIMBS];
+  int ret;
+
+  ASSERT(mn <= FIELD_LIMBS);
+
+  mpn_import(tp, mn, xp, 32, 1);
+
+  ret = mpn_invert_n(tp, tp, mp, mn, scratch);
+
+  mpn_export(zp, 32, tp, mn, 1);
+
+  return ret;
+}
+
+/*
+ * Field
+ */
+
+static void
+check_fe_invert(const unsigned char *raw) {
+  unsigned char expect[32];
+  unsigned char out[32];
+  int ret = ref_invert(expect, raw, field_p, FIELD_LIMBS);
+  fe_t x, z, t;
+
+  ASSERT(fe_import(x, raw));
+
+  ASSERT(fe_invert(z, x) == ret);
+
+  fe_export(out, z);
+
+  ASSERT(memcmp(out, expect, 32) == 0);
+
+  ASSERT(fe_invert_var(z, x) == ret);
+
+  fe_export(out, z);
+
+  ASSERT(memcmp(out, expect, 32) == 0);
+
+  if (ret) {
+    fe_mul(t, x, z);
+
+    ASSERT(fe_equal(t, field_one));
+  } else {
+    ASSERT(fe_is_zero(z));
+  }
+}
+
+static void
+test_fe_invert(btc_drbg_t *rng) {
+  unsigned char raw[32];
+  size_t i;
+
+  for (i = 0; i < lengthof(field_edges); i++) {
+    hex_parse(raw, 32, field_edges[i]);
+
+    check_fe_invert(raw);
+  }
+
+  for (i = 0; i < 256; i++) {
+    fe_t x;
+
+    btc_drbg_generate(rng, raw, 32);
+
+    if (!fe_import(x, raw))
+      continue;
+
+    check_fe_invert(raw);
+  }
+}
+
+#ifndef BTC_HAVE_INT128
+static void
+test_fe_limbs(btc_drbg_t *rng) {
+  unsigned char raw[32];
+  unsigned char out[32];
+  mp_limb_t zp[FIELD_LIMBS];
+  fe_t x, z;
+  size_t i;
+
+  for (i = 0; i < 256; i++) {
+    btc_drbg_generate(rng, raw, 32);
+
+    if (!fe_import(x, raw))
+      continue;
+
+    fe_get_limbs(zp, x);
+
+    ASSERT(fe_set_limbs(z, zp));
+    ASSERT(fe_equal(z, x));
+
+    fe_export(out, z);
+
+    ASSERT(memcmp(out, raw, 32) == 0);
+  }
+
+  mpn_copyi(zp, field_p, FIELD_LIMBS);
+
+  ASSERT(!fe_set_limbs(z, zp));
+}
+#endif /* !BTC_HAVE_INT128 */
+
+/*
+ * Scalar
+ */
+
+static void
+check_sc_invert(const unsigned char *raw) {
+  unsigned char expect[32];
+  unsigned char out[32];
+  int ret = ref_invert(expect, raw, scalar_n, SCALAR_LIMBS);
+  sc_t x, z, t;
+
+  ASSERT(sc_import(x, raw));
+
+  ASSERT(sc_invert(z, x) == ret);
+
+  sc_export(out, z);
+
+  ASSERT(memcmp(out, expect, 32) == 0);
+
+  ASSERT(sc_invert_var(z, x) == ret);
+
+  sc_export(out, z);
+
+  ASSERT(memcmp(out, expect, 32) == 0);
+
+  if (ret) {
+    sc_mul(t, x, z);
+
+    ASSERT(sc_cmp_var(t, scalar_one) == 0);
+  } else {
+    ASSERT(sc_is_zero(z));
+  }
+}
+
+static void
+test_sc_invert(btc_drbg_t *rng) {
+  unsigned char raw[32];
+  size_t i;
+
+  for (i = 0; i < lengthof(scalar_edges); i++) {
+    hex_parse(raw, 32, scalar_edges[i]);
+
+    check_sc_invert(raw);
+  }
+
+  for (i = 0; i < 256; i++) {
+    sc_t x;
+
+    btc_drbg_generate(rng, raw, 32);
+
+    if (!sc_import(x, raw))
+      continue;
+
+    check_sc_invert(raw);
+  }
+}
+
+/*
+ * Main
+ */
+
+int main(void) {
+  btc_drbg_t rng;
+
+  btc_drbg_init(&rng, NULL, 0);
+
+  test_fe_invert(&rng);
+#ifndef BTC_HAVE_INT128
+  test_fe_limbs(&rng);
+#endif
+  test_sc_invert(&rng);
+
+  return 0;
+}
@@ -1,5 +1,5 @@
 /*!
- * t-stub.c - stub test for mako
+ * t-hash160.c - hash160 test for mako
  * Copyright (c) 2021, Christopher Jeffrey (MIT License).
  * https://github.com/chjj/mako
  */
@@ -7,8 +7,41 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <mako/crypto/hash.h>
 #include "lib/tests.h"
 
+static void
+test_batch(void) {
+  static const size_t sizes[] = {0, 1, 20, 32, 33, 55, 56, 65, 100};
+  uint8_t data[19 * 100];
+  uint8_t out[19 * 20];
+  uint8_t exp[20];
+  size_t i, j, k;
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = (uint8_t)(i * 7 + 3);
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    size_t size = sizes[i];
+
+    for (j = 0; j <= 19; j++) {
+      memset(out, 0xaa, sizeof(out));
+
+      btc_hash160_batch(out, data, size, j);
+
+      for (k = 0; k < j; k++) {
+        btc_hash160(exp, data + k * size, size);
+
+        ASSERT(memcmp(out + k * 20, exp, 20) == 0);
+      }
+
+      for (k = j * 20; k < sizeof(out); k++)
+        ASSERT(out[k] == 0xaa);
+    }
+  }
+}
+
 int main(void) {
+  test_batch();
   return 0;
 }
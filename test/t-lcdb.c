@@ -0,0 +1,627 @@
+/*!
+ * t-lcdb.c - lcdb test for mako
+ * Copyright (c) 2021, Christopher Jeffrey (MIT License).
+ * https://github.com/chjj/mako
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <io/core.h>
+#include <lcdb.h>
+
+#define BTC_PREFIX BTC_TMPPATH("lcdb")
+
+#include "lib/tests.h"
+
+/*
+ * Helpers
+ */
+
+static int
+check_value(ldb_t *db,
+            const ldb_snapshot_t *snapshot,
+            const char *key,
+            const char *expect) {
+  ldb_slice_t k = ldb_string(key);
+  ldb_readopt_t options = *ldb_readopt_default;
+  ldb_slice_t val;
+  int rc, ret;
+
+  options.snapshot = snapshot;
+
+  rc = ldb_get(db, &k, &val, &options);
+
+  if (expect == NULL)
+    return rc == LDB_NOTFOUND;
+
+  if (rc != LDB_OK)
+    return 0;
+
+  ret = val.size == strlen(expect) && memcmp(val.data, expect, val.size) == 0;
+
+  ldb_free(val.data);
+
+  return ret;
+}
+
+static int
+level_files(ldb_t *db, int level) {
+  char name[64];
+  char *value;
+  int ret;
+
+  sprintf(name, "leveldb.num-files-at-level%d", level);
+
+  ASSERT(ldb_property(db, name, &value));
+
+  ret = atoi(value);
+
+  ldb_free(value);
+
+  return ret;
+}
+
+static int
+open_families(ldb_t **db, ldb_family_t *families, const char *names) {
+  /* Takes a space separated list of up to four names. */
+  static char buf[4][16];
+  ldb_dbopt_t options = *ldb_dbopt_default;
+  const char *name = names;
+  int length = 0;
+
+  options.create_if_missing = 1;
+
+  while (*name != '\0') {
+    size_t len = strcspn(name, " ");
+
+    ASSERT(length < 4 && len < 16);
+
+    memcpy(buf[length], name, len);
+
+    buf[length][len] = '\0';
+
+    families[length].name = buf[length];
+    families[length].options = NULL;
+    families[length].handle = NULL;
+
+    length++;
+
+    name += len;
+
+    if (*name == ' ')
+      name++;
+  }
+
+  return ldb_open_families(BTC_PREFIX, &options, families, length, db);
+}
+
+/*
+ * Model
+ */
+
+#define MODEL_KEYS 4000
+
+static const char *
+model_value(char *buf, int i, int phase) {
+  /* Only even keys exist. The second phase overwrites
+     some of them, the third deletes some and writes a
+     third version of others. */
+  int version = 1;
+
+  if (i < 0 || i >= MODEL_KEYS || (i & 1))
+    return NULL;
+
+  if (phase >= 2 && i % 3 == 0)
+    version = 2;
+
+  if (phase >= 3) {
+    if (i % 7 == 0)
+      version = 3;
+    else if (i % 5 == 0)
+      return NULL;
+  }
+
+  sprintf(buf, "%d.%d", version, i);
+
+  return buf;
+}
+
+static void
+model_write(ldb_t *db, int phase) {
+  char key[32], prev[32], next[32];
+  const char *x, *y;
+  ldb_slice_t k, v;
+  ldb_batch_t batch;
+  int i;
+
+  ldb_batch_init(&batch);
+
+  for (i = 0; i < MODEL_KEYS; i++) {
+    x = phase > 1 ? model_value(prev, i, phase - 1) : NULL;
+    y = model_value(next, i, phase);
+
+    if (x == NULL && y == NULL)
+      continue;
+
+    if (x != NULL && y != NULL && strcmp(x, y) == 0)
+      continue;
+
+    sprintf(key, "key%06d", i);
+
+    k = ldb_string(key);
+
+    if (y == NULL) {
+      ldb_batch_del(&batch, &k);
+    } else {
+      v = ldb_string(y);
+      ldb_batch_put(&batch, &k, &v);
+    }
+  }
+
+  ASSERT(ldb_write(db, &batch, 0) == LDB_OK);
+
+  ldb_batch_clear(&batch);
+}
+
+static void
+model_build(ldb_t *db, const ldb_snapshot_t **snaps) {
+  /* Older versions survive compaction while
+     a snapshot still refers to them. */
+  model_write(db, 1);
+  snaps[0] = ldb_snapshot(db);
+
+  model_write(db, 2);
+  snaps[1] = ldb_snapshot(db);
+
+  model_write(db, 3);
+
+  ldb_compact(db, NULL, NULL);
+
+  ASSERT(level_files(db, 0) == 0);
+}
+
+static void
+model_check(ldb_t *db, const ldb_snapshot_t *snap, int phase) {
+  char key[32], val[32];
+  int i;
+
+  for (i = -1; i <= MODEL_KEYS; i++) {
+    sprintf(key, "key%06d", i);
+
+    ASSERT(check_value(db, snap, key, model_value(val, i, phase)));
+  }
+}
+
+static void
+model_scan(ldb_t *db) {
+  /* Walk and seek the latest versions. */
+  ldb_iter_t *iter = ldb_iterator(db, 0);
+  char key[32], val[32];
+  ldb_slice_t k, v;
+  int i;
+
+  ldb_iter_first(iter);
+
+  for (i = 0; i < MODEL_KEYS; i++) {
+    if (model_value(val, i, 3) == NULL)
+      continue;
+
+    sprintf(key, "key%06d", i);
+
+    ASSERT(ldb_iter_valid(iter));
+
+    k = ldb_iter_key(iter);
+    v = ldb_iter_value(iter);
+
+    ASSERT(k.size == strlen(key) && memcmp(k.data, key, k.size) == 0);
+    ASSERT(v.size == strlen(val) && memcmp(v.data, val, v.size) == 0);
+
+    ldb_iter_next(iter);
+  }
+
+  ASSERT(!ldb_iter_valid(iter));
+
+  /* Absent keys land on the next present one. */
+  for (i = 1; i < MODEL_KEYS; i += 50) {
+    int j = i;
+
+    while (j < MODEL_KEYS && model_value(val, j, 3) == NULL)
+      j++;
+
+    sprintf(key, "key%06d", i);
+
+    k = ldb_string(key);
+
+    ldb_iter_seek(iter, &k);
+
+    if (j == MODEL_KEYS) {
+      ASSERT(!ldb_iter_valid(iter));
+      continue;
+    }
+
+    sprintf(key, "key%06d", j);
+
+    ASSERT(ldb_iter_valid(iter));
+
+    k = ldb_iter_key(iter);
+
+    ASSERT(k.size == strlen(key) && memcmp(k.data, key, k.size) == 0);
+  }
+
+  ASSERT(ldb_iter_status(iter) == LDB_OK);
+
+  ldb_iter_destroy(iter);
+}
+
+static void
+model_test(const ldb_dbopt_t *options) {
+  const ldb_snapshot_t *snaps[2];
+  ldb_t *db;
+
+  btc_rimraf(BTC_PREFIX);
+
+  ASSERT(ldb_open(BTC_PREFIX, options, &db) == LDB_OK);
+
+  model_build(db, snaps);
+
+  model_check(db, snaps[0], 1);
+  model_check(db, snaps[1], 2);
+  model_check(db, NULL, 3);
+  model_scan(db);
+
+  ldb_release(db, snaps[0]);
+  ldb_release(db, snaps[1]);
+
+  ldb_close(db);
+
+  /* Latest versions, read back from the tables only. */
+  ASSERT(ldb_open(BTC_PREFIX, options, &db) == LDB_OK);
+
+  model_check(db, NULL, 3);
+  model_scan(db);
+
+  ldb_close(db);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+/*
+ * Column Families
+ */
+
+static void
+test_families_batch(void) {
+  ldb_slice_t key, val;
+  ldb_family_t cf[4];
+  const ldb_snapshot_t *snap;
+  ldb_batch_t batch;
+  ldb_t *db;
+
+  btc_rimraf(BTC_PREFIX);
+
+  ASSERT(open_families(&db, cf, "coins index") == LDB_OK);
+
+  key = ldb_string("gone");
+  val = ldb_string("x");
+
+  ASSERT(ldb_put(cf[1].handle, &key, &val, 0) == LDB_OK);
+
+  snap = ldb_snapshot(db);
+
+  /* One batch touching the parent and both families. */
+  ldb_batch_init(&batch);
+
+  key = ldb_string("k");
+
+  val = ldb_string("0");
+  ldb_batch_put(&batch, &key, &val);
+
+  val = ldb_string("1");
+  ldb_batch_put_family(&batch, cf[0].handle, &key, &val);
+
+  val = ldb_string("2");
+  ldb_batch_put_family(&batch, cf[1].handle, &key, &val);
+
+  key = ldb_string("gone");
+  ldb_batch_del_family(&batch, cf[1].handle, &key);
+
+  ASSERT(ldb_write(db, &batch, 0) == LDB_OK);
+
+  ldb_batch_clear(&batch);
+
+  ASSERT(check_value(db, NULL, "k", "0"));
+  ASSERT(check_value(cf[0].handle, NULL, "k", "1"));
+  ASSERT(check_value(cf[1].handle, NULL, "k", "2"));
+  ASSERT(check_value(cf[1].handle, NULL, "gone", NULL));
+  ASSERT(check_value(db, NULL, "gone", NULL));
+
+  /* The families share one sequence space: a snapshot
+     taken before the batch sees none of it anywhere. */
+  ASSERT(check_value(db, snap, "k", NULL));
+  ASSERT(check_value(cf[0].handle, snap, "k", NULL));
+  ASSERT(check_value(cf[1].handle, snap, "k", NULL));
+  ASSERT(check_value(cf[1].handle, snap, "gone", "x"));
+
+  ldb_release(db, snap);
+
+  /* Nothing was flushed. Closing leaves the batch
+     only in the log, just as a crash would. */
+  ASSERT(level_files(db, 0) == 0);
+  ASSERT(level_files(cf[0].handle, 0) == 0);
+  ASSERT(level_files(cf[1].handle, 0) == 0);
+
+  ldb_close(db);
+
+  /* Each record is replayed into its own family. */
+  ASSERT(open_families(&db, cf, "coins index") == LDB_OK);
+
+  ASSERT(check_value(db, NULL, "k", "0"));
+  ASSERT(check_value(cf[0].handle, NULL, "k", "1"));
+  ASSERT(check_value(cf[1].handle, NULL, "k", "2"));
+  ASSERT(check_value(cf[1].handle, NULL, "gone", NULL));
+  ASSERT(check_value(cf[0].handle, NULL, "gone", NULL));
+
+  /* The families flushed what they recovered, and a
+     second replay of the old log must not happen. */
+  ASSERT(level_files(cf[0].handle, 0) == 1);
+  ASSERT(level_files(cf[1].handle, 0) == 1);
+
+  ldb_close(db);
+
+  ASSERT(open_families(&db, cf, "coins index") == LDB_OK);
+
+  ASSERT(check_value(db, NULL, "k", "0"));
+  ASSERT(check_value(cf[0].handle, NULL, "k", "1"));
+  ASSERT(check_value(cf[1].handle, NULL, "k", "2"));
+  ASSERT(level_files(cf[0].handle, 0) == 1);
+  ASSERT(level_files(cf[1].handle, 0) == 1);
+
+  ldb_close(db);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_families_mismatch(void) {
+  ldb_family_t cf[4];
+  ldb_t *db;
+
+  btc_rimraf(BTC_PREFIX);
+
+  ASSERT(open_families(&db, cf, "coins index") == LDB_OK);
+
+  ldb_close(db);
+
+  /* Ids are positional. */
+  ASSERT(open_families(&db, cf, "index coins") == LDB_INVALID);
+  ASSERT(db == NULL);
+
+  /* Families cannot be dropped... */
+  ASSERT(open_families(&db, cf, "coins") == LDB_INVALID);
+  ASSERT(ldb_open(BTC_PREFIX, ldb_dbopt_default, &db) == LDB_INVALID);
+
+  /* ...or renamed. */
+  ASSERT(open_families(&db, cf, "coins other") == LDB_INVALID);
+
+  /* But they can be appended. */
+  ASSERT(open_families(&db, cf, "coins index extra") == LDB_OK);
+
+  ldb_close(db);
+
+  ASSERT(open_families(&db, cf, "coins index") == LDB_INVALID);
+  ASSERT(open_families(&db, cf, "coins index extra") == LDB_OK);
+
+  ldb_close(db);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+/*
+ * Hash Index
+ */
+
+static void
+test_hash_index(void) {
+  ldb_dbopt_t options = *ldb_dbopt_default;
+
+  options.create_if_missing = 1;
+  options.block_size = 1024;
+  options.compression = LDB_NO_COMPRESSION;
+
+  /* Binary search only. Every layout below must agree
+     with the model and therefore with this one. */
+  model_test(&options);
+
+  /* Buckets pointing at restart intervals, with several
+     keys per interval and keys missing from the block. */
+  options.block_hash_index = 1;
+
+  model_test(&options);
+
+  /* One key per interval: the versions of a key sit in
+     different intervals and always share a bucket, and
+     ~100 keys in ~130 buckets collide with each other. */
+  options.block_restart_interval = 1;
+
+  model_test(&options);
+}
+
+/*
+ * Partitioned Index
+ */
+
+static void
+test_partitioned(void) {
+  ldb_dbopt_t options = *ldb_dbopt_default;
+
+  options.create_if_missing = 1;
+  options.block_size = 256;
+  options.compression = LDB_NO_COMPRESSION;
+  options.filter_policy = ldb_bloom_default;
+
+  /* Monolithic index and filter. */
+  model_test(&options);
+
+  /* A few data blocks per partition, each partition
+     with its own filter, under a top-level index. */
+  options.index_partition_size = 256;
+
+  model_test(&options);
+
+  /* As the chain database uses it. */
+  options.block_hash_index = 1;
+
+  model_test(&options);
+}
+
+/*
+ * Rate Limit
+ */
+
+static void
+test_rate_limit(void) {
+  ldb_dbopt_t options = *ldb_dbopt_default;
+  char key[32], val[1024];
+  ldb_slice_t k, v;
+  int64_t start;
+  ldb_t *db;
+  int i;
+
+  btc_rimraf(BTC_PREFIX);
+
+  options.create_if_missing = 1;
+  options.compression = LDB_NO_COMPRESSION;
+  options.rate_limit = 128 << 10;
+
+  ASSERT(ldb_open(BTC_PREFIX, &options, &db) == LDB_OK);
+
+  /* The log is never throttled. */
+  for (i = 0; i < 256; i++) {
+    sprintf(key, "key%06d", i);
+    memset(val, 'a' + i % 26, sizeof(val));
+
+    k = ldb_string(key);
+    v = ldb_slice(val, sizeof(val));
+
+    ASSERT(ldb_put(db, &k, &v, 0) == LDB_OK);
+  }
+
+  /* The table is: 256kb at 128kb/s, less a 100ms burst. */
+  start = btc_time_msec();
+
+  ASSERT(ldb_flush(db) == LDB_OK);
+  ASSERT(btc_time_msec() - start >= 1500);
+
+  ldb_close(db);
+
+  ASSERT(ldb_open(BTC_PREFIX, &options, &db) == LDB_OK);
+
+  for (i = 0; i < 256; i++) {
+    ldb_slice_t out;
+
+    sprintf(key, "key%06d", i);
+    memset(val, 'a' + i % 26, sizeof(val));
+
+    k = ldb_string(key);
+
+    ASSERT(ldb_get(db, &k, &out, 0) == LDB_OK);
+    ASSERT(out.size == sizeof(val));
+    ASSERT(memcmp(out.data, val, sizeof(val)) == 0);
+
+    ldb_free(out.data);
+  }
+
+  ldb_close(db);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+flush_thread(void *arg) {
+  ASSERT(ldb_flush((ldb_t *)arg) == LDB_OK);
+}
+
+static void
+test_rate_limit_families(void) {
+  ldb_dbopt_t options = *ldb_dbopt_default;
+  char key[32], val[1024];
+  btc_thread_t thread;
+  ldb_family_t cf[1];
+  ldb_slice_t k, v;
+  int64_t start;
+  ldb_t *db;
+  int i;
+
+  btc_rimraf(BTC_PREFIX);
+
+  options.create_if_missing = 1;
+  options.compression = LDB_NO_COMPRESSION;
+  options.rate_limit = 128 << 10;
+
+  /* The family asks for a limit of its own. */
+  cf[0].name = "coins";
+  cf[0].options = &options;
+  cf[0].handle = NULL;
+
+  ASSERT(ldb_open_families(BTC_PREFIX, &options, cf, 1, &db) == LDB_OK);
+
+  for (i = 0; i < 256; i++) {
+    sprintf(key, "key%06d", i);
+    memset(val, 'a' + i % 26, sizeof(val));
+
+    k = ldb_string(key);
+    v = ldb_slice(val, sizeof(val));
+
+    ASSERT(ldb_put(i & 1 ? cf[0].handle : db, &k, &v, 0) == LDB_OK);
+  }
+
+  /* Both tables are written at once: 256kb at a
+     shared 128kb/s, not 128kb each at 128kb/s. */
+  start = btc_time_msec();
+
+  btc_thread_create(&thread, flush_thread, cf[0].handle);
+
+  ASSERT(ldb_flush(db) == LDB_OK);
+
+  btc_thread_join(&thread);
+
+  ASSERT(btc_time_msec() - start >= 1500);
+
+  for (i = 0; i < 256; i++) {
+    ldb_slice_t out;
+
+    sprintf(key, "key%06d", i);
+    memset(val, 'a' + i % 26, sizeof(val));
+
+    k = ldb_string(key);
+
+    ASSERT(ldb_get(i & 1 ? cf[0].handle : db, &k, &out, 0) == LDB_OK);
+    ASSERT(out.size == sizeof(val));
+    ASSERT(memcmp(out.data, val, sizeof(val)) == 0);
+
+    ldb_free(out.data);
+  }
+
+  ldb_close(db);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+/*
+ * Main
+ */
+
+int
+main(void) {
+  btc_fs_mkdir(BTC_TMPDIR);
+
+  test_families_batch();
+  test_families_mismatch();
+  test_hash_index();
+  test_partitioned();
+  test_rate_limit();
+  test_rate_limit_families();
+  return 0;
+}
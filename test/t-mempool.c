@@ -1,5 +1,5 @@
 /*!
- * t-stub.c - stub test for mako
+ * t-mempool.c - mempool test for mako
  * Copyright (c) 2021, Christopher Jeffrey (MIT License).
  * https://github.com/chjj/mako
  */
@@ -7,8 +7,482 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+
+#include <base/timedata.h>
+#include <io/core.h>
+
+#include <node/chain.h>
+#include <node/mempool.h>
+#include <node/miner.h>
+
+#include <mako/address.h>
+#include <mako/block.h>
+#include <mako/coins.h>
+#include <mako/consensus.h>
+#include <mako/crypto/ecc.h>
+#include <mako/entry.h>
+#include <mako/network.h>
+#include <mako/policy.h>
+#include <mako/tx.h>
+#include <mako/util.h>
+
+
+#define BTC_PREFIX BTC_TMPPATH("mempool")
+
 #include "lib/tests.h"
 
-int main(void) {
+/*
+ * Helpers
+ */
+
+static const uint8_t test_priv[32] = {
+  0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+  0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+  0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+  0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+};
+
+static void
+get_coinbase(btc_outpoint_t *prevout, btc_chain_t *chain, int32_t height) {
+  const btc_entry_t *entry = btc_chain_by_height(chain, height);
+  btc_block_t *block;
+
+  ASSERT(entry != NULL);
+
+  block = btc_chain_get_block(chain, entry);
+
+  ASSERT(block != NULL);
+
+  btc_outpoint_set(prevout, block->txs.items[0]->hash, 0);
+
+  btc_block_destroy(block);
+}
+
+static btc_tx_t *
+create_spend(btc_mempool_t *mp,
+             const btc_outpoint_t *prevout,
+             const btc_address_t *addr,
+             uint32_t sequence,
+             int64_t fee) {
+  btc_tx_t *tx = btc_tx_create();
+  btc_tx_cache_t cache;
+  const btc_coin_t *coin;
+  btc_view_t *view;
+
+  btc_tx_add_outpoint(tx, prevout);
+
+  tx->inputs.items[0]->sequence = sequence;
+
+  view = btc_mempool_view(mp, tx);
+  coin = btc_view_get(view, prevout);
+
+  ASSERT(coin != NULL);
+
+  btc_tx_add_output(tx, addr, coin->output.value - fee);
+
+  memset(&cache, 0, sizeof(cache));
+
+  ASSERT(btc_tx_sign_step(tx, view, test_priv, &cache) == 1);
+
+  btc_tx_refresh(tx);
+  btc_view_destroy(view);
+
+  return tx;
+}
+
+static int
+has_error(btc_mempool_t *mp, const char *reason) {
+  return strcmp(btc_mempool_error(mp)->reason, reason) == 0;
+}
+
+/*
+ * Tests
+ */
+
+static void
+test_replace(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  btc_tx_t *tx1, *tx2, *tx3, *tx4, *tx5;
+  btc_outpoint_t cb1, cb2, child;
+  btc_address_t addr;
+  uint8_t pub[33];
+
+  btc_rimraf(BTC_PREFIX);
+
+  ASSERT(btc_ecdsa_pubkey_create(pub, test_priv, 1));
+
+  btc_address_set_p2pk(&addr, pub, 33);
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+  ASSERT(btc_mempool_min_fee(mp) == network->min_relay);
+
+  btc_miner_generate(miner, BTC_COINBASE_MATURITY + 2, &addr);
+
+  get_coinbase(&cb1, chain, 1);
+  get_coinbase(&cb2, chain, 2);
+
+  /* Signaling parent with a child. */
+  tx1 = create_spend(mp, &cb1, &addr, 0xfffffffd, 1000);
+
+  ASSERT(btc_mempool_add(mp, tx1, 0));
+
+  btc_outpoint_set(&child, tx1->hash, 0);
+
+  tx2 = create_spend(mp, &child, &addr, 0xffffffff, 1000);
+
+  ASSERT(btc_mempool_add(mp, tx2, 0));
+
+  /* Does not pay for the evicted package. */
+  tx3 = create_spend(mp, &cb1, &addr, 0xffffffff, 1500);
+
+  ASSERT(!btc_mempool_add(mp, tx3, 0));
+  ASSERT(has_error(mp, "insufficient fee"));
+  ASSERT(btc_mempool_has(mp, tx1->hash));
+  ASSERT(btc_mempool_has(mp, tx2->hash));
+
+  btc_tx_destroy(tx3);
+
+  /* Pays for the package and its own relay. */
+  tx3 = create_spend(mp, &cb1, &addr, 0xffffffff, 10000);
+
+  ASSERT(btc_mempool_add(mp, tx3, 0));
+  ASSERT(!btc_mempool_has(mp, tx1->hash));
+  ASSERT(!btc_mempool_has(mp, tx2->hash));
+  ASSERT(btc_mempool_has(mp, tx3->hash));
+  ASSERT(btc_mempool_size(mp) == 1);
+
+  /* Non-signaling conflicts are not replaceable... */
+  tx4 = create_spend(mp, &cb2, &addr, 0xffffffff, 1000);
+
+  ASSERT(btc_mempool_add(mp, tx4, 0));
+
+  tx5 = create_spend(mp, &cb2, &addr, 0xffffffff, 10000);
+
+  ASSERT(!btc_mempool_add(mp, tx5, 0));
+  ASSERT(has_error(mp, "bad-txns-inputs-spent"));
+
+  btc_tx_destroy(tx5);
+
+  /* ...unless we are running full-rbf. */
+  ASSERT(btc_mempool_open(mp, NULL, BTC_MEMPOOL_FULLRBF));
+
+  tx5 = create_spend(mp, &cb2, &addr, 0xffffffff, 20000);
+
+  ASSERT(btc_mempool_add(mp, tx5, 0));
+  ASSERT(!btc_mempool_has(mp, tx4->hash));
+  ASSERT(btc_mempool_has(mp, tx5->hash));
+  ASSERT(btc_mempool_size(mp) == 2);
+
+  btc_tx_destroy(tx1);
+  btc_tx_destroy(tx2);
+  btc_tx_destroy(tx3);
+  btc_tx_destroy(tx4);
+  btc_tx_destroy(tx5);
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_cpfp(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  const btc_mpentry_t *parent, *child, *grandchild;
+  const btc_blockentry_t *item;
+  btc_outpoint_t cb1, cb2, prevout;
+  btc_tx_t *tx1, *tx2, *tx3, *tx4;
+  btc_address_t addr;
+  btc_block_t *block;
+  btc_tmpl_t *bt;
+  uint8_t pub[33];
+
+  btc_rimraf(BTC_PREFIX);
+
+  ASSERT(btc_ecdsa_pubkey_create(pub, test_priv, 1));
+
+  btc_address_set_p2pk(&addr, pub, 33);
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  btc_miner_generate(miner, BTC_COINBASE_MATURITY + 2, &addr);
+
+  get_coinbase(&cb1, chain, 1);
+  get_coinbase(&cb2, chain, 2);
+
+  /* Cheap parent, generous child. */
+  tx1 = create_spend(mp, &cb1, &addr, 0xffffffff, 1000);
+
+  ASSERT(btc_mempool_add(mp, tx1, 0));
+
+  btc_outpoint_set(&prevout, tx1->hash, 0);
+
+  tx2 = create_spend(mp, &prevout, &addr, 0xffffffff, 40000);
+
+  ASSERT(btc_mempool_add(mp, tx2, 0));
+
+  /* Independent transaction paying more than
+     the parent but less than the package. */
+  tx3 = create_spend(mp, &cb2, &addr, 0xffffffff, 10000);
+
+  ASSERT(btc_mempool_add(mp, tx3, 0));
+
+  parent = btc_mempool_get(mp, tx1->hash);
+  child = btc_mempool_get(mp, tx2->hash);
+
+  ASSERT(parent != NULL && child != NULL);
+  ASSERT(parent->anc_count == 1);
+  ASSERT(parent->anc_fee == 1000);
+  ASSERT(parent->desc_fee == 41000);
+  ASSERT(parent->desc_size == parent->size + child->size);
+  ASSERT(child->anc_count == 2);
+  ASSERT(child->anc_fee == 41000);
+  ASSERT(child->anc_size == parent->size + child->size);
+
+  /* A grandchild extends both totals. */
+  btc_outpoint_set(&prevout, tx2->hash, 0);
+
+  tx4 = create_spend(mp, &prevout, &addr, 0xffffffff, 1000);
+
+  ASSERT(btc_mempool_add(mp, tx4, 0));
+
+  grandchild = btc_mempool_get(mp, tx4->hash);
+
+  ASSERT(grandchild != NULL);
+  ASSERT(grandchild->anc_count == 3);
+  ASSERT(grandchild->anc_fee == 42000);
+  ASSERT(parent->desc_fee == 42000);
+  ASSERT(child->desc_fee == 41000);
+
+  /* The package is mined before the middling
+     transaction, which is mined before the
+     (now cheaper) grandchild. */
+  bt = btc_miner_template(miner);
+
+  ASSERT(bt->txs.length == 4);
+  ASSERT(bt->fees == 52000);
+
+  item = bt->txs.items[0];
+  ASSERT(btc_hash_equal(item->hash, tx1->hash));
+
+  item = bt->txs.items[1];
+  ASSERT(btc_hash_equal(item->hash, tx2->hash));
+
+  item = bt->txs.items[2];
+  ASSERT(btc_hash_equal(item->hash, tx3->hash));
+
+  item = bt->txs.items[3];
+  ASSERT(btc_hash_equal(item->hash, tx4->hash));
+
+  btc_tmpl_destroy(bt);
+
+  /* Confirming the parent leaves the
+     child with only its own package. */
+  block = btc_block_create();
+
+  btc_txvec_push(&block->txs, btc_tx_clone(tx3));
+  btc_txvec_push(&block->txs, btc_tx_clone(tx1));
+
+  btc_mempool_add_block(mp, btc_chain_tip(chain), block);
+
+  btc_block_destroy(block);
+
+  ASSERT(btc_mempool_size(mp) == 3);
+  ASSERT(!btc_mempool_has(mp, tx1->hash));
+  ASSERT(child->anc_count == 1);
+  ASSERT(child->anc_fee == 40000);
+  ASSERT(child->desc_fee == 41000);
+  ASSERT(grandchild->anc_count == 2);
+  ASSERT(grandchild->anc_fee == 41000);
+
+  btc_tx_destroy(tx1);
+  btc_tx_destroy(tx2);
+  btc_tx_destroy(tx3);
+  btc_tx_destroy(tx4);
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_min_fee(void) {
+  const btc_network_t *network = btc_regtest;
+  btc_chain_t *chain = btc_chain_create(network);
+  btc_mempool_t *mp = btc_mempool_create(network, chain);
+  btc_miner_t *miner = btc_miner_create(network, NULL, chain, mp);
+  int64_t min_relay = network->min_relay;
+  btc_outpoint_t cb1, cb2, cb3, cb4;
+  btc_tx_t *tx1, *tx2, *tx3, *tx4;
+  const btc_mpentry_t *entry;
+  btc_address_t addr;
+  btc_timedata_t td;
+  btc_block_t *block;
+  int64_t rate, fee;
+  uint8_t pub[33];
+  size_t size;
+
+  btc_rimraf(BTC_PREFIX);
+
+  btc_timedata_init(&td);
+
+  ASSERT(btc_ecdsa_pubkey_create(pub, test_priv, 1));
+
+  btc_address_set_p2pk(&addr, pub, 33);
+
+  btc_mempool_set_timedata(mp, &td);
+
+  ASSERT(btc_chain_open(chain, BTC_PREFIX, 0));
+  ASSERT(btc_mempool_open(mp, NULL, 0));
+
+  btc_miner_generate(miner, BTC_COINBASE_MATURITY + 4, &addr);
+
+  get_coinbase(&cb1, chain, 1);
+  get_coinbase(&cb2, chain, 2);
+  get_coinbase(&cb3, chain, 3);
+  get_coinbase(&cb4, chain, 4);
+
+  tx1 = create_spend(mp, &cb1, &addr, 0xffffffff, 1000);
+
+  ASSERT(btc_mempool_add(mp, tx1, 0));
+
+  entry = btc_mempool_get(mp, tx1->hash);
+
+  ASSERT(entry != NULL);
+
+  size = entry->size;
+
+  /* Room for two and a half transactions. */
+  btc_mempool_set_max_size(mp, size * 2 + size / 2);
+
+  tx2 = create_spend(mp, &cb2, &addr, 0xffffffff, 5000);
+
+  ASSERT(btc_mempool_add(mp, tx2, 0));
+  ASSERT(btc_mempool_min_fee(mp) == min_relay);
+
+  /* The third evicts the cheapest and
+     raises the floor above its rate. */
+  tx3 = create_spend(mp, &cb3, &addr, 0xffffffff, 10000);
+
+  ASSERT(btc_mempool_add(mp, tx3, 0));
+  ASSERT(btc_mempool_size(mp) == 2);
+  ASSERT(!btc_mempool_has(mp, tx1->hash));
+  ASSERT(btc_mempool_has(mp, tx2->hash));
+  ASSERT(btc_mempool_has(mp, tx3->hash));
+
+  rate = btc_get_rate(1000, size) + min_relay;
+
+  ASSERT(btc_mempool_min_fee(mp) == rate);
+
+  /* Paying the relay minimum is no longer enough. */
+  tx4 = create_spend(mp, &cb4, &addr, 0xffffffff, 1000);
+
+  ASSERT(!btc_mempool_add(mp, tx4, 0));
+  ASSERT(has_error(mp, "mempool min fee not met"));
+  ASSERT(!btc_mempool_has(mp, tx4->hash));
+
+  /* No decay until a block is connected. */
+  td.offset = 60 * 60;
+
+  ASSERT(btc_mempool_min_fee(mp) == rate);
+
+  block = btc_block_create();
+
+  btc_txvec_push(&block->txs, btc_tx_clone(tx3));
+
+  btc_mempool_add_block(mp, btc_chain_tip(chain), block);
+
+  btc_block_destroy(block);
+
+  fee = btc_mempool_min_fee(mp);
+
+  ASSERT(fee < rate);
+  ASSERT(fee > min_relay);
+
+  btc_tx_destroy(tx1);
+  btc_tx_destroy(tx2);
+  btc_tx_destroy(tx3);
+  btc_tx_destroy(tx4);
+
+  btc_mempool_close(mp);
+  btc_chain_close(chain);
+
+  btc_miner_destroy(miner);
+  btc_mempool_destroy(mp);
+  btc_chain_destroy(chain);
+
+  btc_timedata_clear(&td);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_round_filter(void) {
+  static const int64_t rates[] = {0, 1000, 1234, 5000, 99999, 1234567};
+  int64_t min_relay = btc_regtest->min_relay;
+  size_t i, j;
+
+  /* Below the first bucket. */
+  ASSERT(btc_round_filter(0, min_relay) == min_relay / 2);
+  ASSERT(btc_round_filter(min_relay / 2, min_relay) == min_relay / 2);
+
+  /* Capped at the last bucket. */
+  ASSERT(btc_round_filter(BTC_MAX_MONEY, min_relay) <= 10000000);
+  ASSERT(btc_round_filter(BTC_MAX_MONEY, min_relay) > 10000000 / 1.1);
+
+  for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+    int64_t rate = rates[i];
+    int64_t lo = -1;
+    int64_t hi = -1;
+
+    /* Lands in one of the two buckets around
+       the rate, and always the same two. */
+    for (j = 0; j < 100; j++) {
+      int64_t filter = btc_round_filter(rate, min_relay);
+
+      ASSERT(filter >= min_relay / 2);
+      ASSERT(filter <= rate * 1.1 || filter == min_relay / 2);
+      ASSERT(filter >= rate / 1.1 - 1);
+
+      if (lo == -1 || filter < lo)
+        lo = filter;
+
+      if (hi == -1 || filter > hi)
+        hi = filter;
+    }
+
+    ASSERT(hi == lo || (double)hi <= (double)lo * 1.1 + 1);
+  }
+}
+
+/*
+ * Main
+ */
+
+int
+main(void) {
+  btc_fs_mkdir(BTC_TMPDIR);
+
+  test_replace();
+  test_cpfp();
+  test_min_fee();
+  test_round_filter();
   return 0;
 }
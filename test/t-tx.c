@@ -8,13 +8,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <mako/address.h>
 #include <mako/coins.h>
+#include <mako/consensus.h>
+#include <mako/crypto/ecc.h>
 #include <mako/network.h>
 #include <mako/script.h>
 #include <mako/tx.h>
 #include <mako/util.h>
 #include "data/tx_valid_vectors.h"
 #include "data/tx_invalid_vectors.h"
+#include "data/taproot_vectors.h"
 #include "lib/tests.h"
 
 static void
@@ -116,6 +120,236 @@ test_tx_invalid_vector(const test_invalid_vector_t *vec, size_t index) {
   btc_view_destroy(view);
 }
 
+static void
+test_tx_taproot(void) {
+  unsigned int flags = BTC_SCRIPT_STANDARD_VERIFY_FLAGS;
+  btc_sigbatch_t batch;
+  btc_buffer_t *sig;
+  btc_coin_t *coin;
+  btc_view_t *view;
+  btc_tx_t tx;
+  size_t i;
+
+  printf("tx taproot vector\n");
+
+  btc_tx_init(&tx);
+  btc_sigbatch_init(&batch);
+
+  view = btc_view_create();
+
+  ASSERT(btc_tx_import(&tx, test_taproot_tx, sizeof(test_taproot_tx)));
+
+  for (i = 0; i < lengthof(test_taproot_coins); i++) {
+    coin = btc_coin_create();
+
+    ASSERT(btc_output_import(&coin->output, test_taproot_coins[i].output_raw,
+                                            test_taproot_coins[i].output_len));
+
+    btc_view_put(view, &test_taproot_coins[i].outpoint, coin);
+  }
+
+  ASSERT(btc_tx_verify(&tx, view, flags));
+
+  /* One key path signature per input, plus
+     a second signature for CHECKSIGADD. */
+  ASSERT(btc_tx_verify_batch(&tx, view, flags, &batch));
+  ASSERT(batch.length == 5);
+  ASSERT(btc_sigbatch_verify(&batch));
+  ASSERT(batch.length == 0);
+
+  /* Annexes are non-standard. */
+  ASSERT(!btc_tx_has_standard_witness(&tx, view));
+
+  for (i = 0; i < tx.inputs.length; i++) {
+    sig = tx.inputs.items[i]->witness.items[0];
+    sig->data[0] ^= 1;
+
+    ASSERT(!btc_tx_verify(&tx, view, flags));
+
+    /* Failure is deferred to the batch. */
+    ASSERT(btc_tx_verify_batch(&tx, view, flags, &batch));
+    ASSERT(!btc_sigbatch_verify(&batch));
+
+    /* Pre-activation, v1 programs are anyone-can-spend. */
+    ASSERT(btc_tx_verify(&tx, view, flags & ~BTC_SCRIPT_VERIFY_TAPROOT));
+
+    sig->data[0] ^= 1;
+  }
+
+  ASSERT(btc_tx_verify(&tx, view, flags));
+
+  btc_sigbatch_clear(&batch);
+  btc_tx_clear(&tx);
+  btc_view_destroy(view);
+}
+
+static void
+test_tx_bip341_scripts(void) {
+  size_t i, j;
+
+  printf("tx bip341 script vectors\n");
+
+  for (i = 0; i < lengthof(test_bip341_scripts); i++) {
+    const test_bip341_script_t *vec = &test_bip341_scripts[i];
+    char str[BTC_ADDRESS_MAXLEN + 1];
+    uint8_t key[32], root[32], tweak[32];
+    uint8_t tweaked[32], out[32];
+    btc_address_t addr;
+    int negated;
+
+    hex_parse(key, 32, vec->internal_key);
+    hex_parse(tweaked, 32, vec->tweaked_key);
+
+    if (vec->root != NULL)
+      hex_parse(root, 32, vec->root);
+
+    btc_taproot_tweak_hash(tweak, key, vec->root != NULL ? root : NULL);
+
+    ASSERT(btc_bip340_pubkey_tweak_add(out, &negated, key, tweak));
+    ASSERT(memcmp(out, tweaked, 32) == 0);
+
+    btc_address_set_p2tr(&addr, tweaked);
+    btc_address_get_str(str, &addr, btc_mainnet);
+
+    ASSERT(strcmp(str, vec->address) == 0);
+
+    for (j = 0; j < lengthof(vec->leaves); j++) {
+      const test_bip341_leaf_t *leaf = &vec->leaves[j];
+      uint8_t control[BTC_TAPROOT_CONTROL_BASE_SIZE + 2 * 32];
+      size_t control_len = sizeof(control);
+      uint8_t raw[64], hash[32];
+      size_t raw_len = sizeof(raw);
+      btc_script_t script;
+
+      if (leaf->script == NULL)
+        break;
+
+      hex_decode(raw, &raw_len, leaf->script);
+      hex_parse(hash, 32, leaf->hash);
+      hex_decode(control, &control_len, leaf->control);
+
+      btc_script_init(&script);
+      btc_script_set(&script, raw, raw_len);
+      btc_taproot_leaf_hash(out, leaf->version, &script);
+      btc_script_clear(&script);
+
+      ASSERT(memcmp(out, hash, 32) == 0);
+
+      /* The control block commits to the leaf version, the
+         output key's parity, the internal key and the path. */
+      ASSERT((control[0] & 0xfe) == leaf->version);
+      ASSERT((control[0] & 1) == negated);
+      ASSERT(memcmp(control + 1, key, 32) == 0);
+
+      control_len -= BTC_TAPROOT_CONTROL_BASE_SIZE;
+
+      ASSERT(control_len % BTC_TAPROOT_CONTROL_NODE_SIZE == 0);
+
+      btc_taproot_root(out, hash,
+                       control + BTC_TAPROOT_CONTROL_BASE_SIZE,
+                       control_len / BTC_TAPROOT_CONTROL_NODE_SIZE);
+
+      ASSERT(memcmp(out, root, 32) == 0);
+
+      ASSERT(btc_bip340_pubkey_tweak_add_check(key, tweak,
+                                               tweaked, control[0] & 1));
+    }
+  }
+}
+
+static void
+test_tx_bip341_keypath(void) {
+  unsigned int flags = BTC_SCRIPT_STANDARD_VERIFY_FLAGS;
+  static const uint8_t aux[32] = {0};
+  btc_tx_cache_t cache;
+  btc_view_t *view;
+  uint8_t raw[512];
+  size_t i, len;
+  btc_tx_t tx;
+
+  printf("tx bip341 key path vectors\n");
+
+  btc_tx_init(&tx);
+
+  view = btc_view_create();
+
+  len = sizeof(raw);
+
+  hex_decode(raw, &len, test_bip341_tx);
+
+  ASSERT(btc_tx_import(&tx, raw, len));
+  ASSERT(tx.inputs.length == lengthof(test_bip341_utxos));
+
+  for (i = 0; i < lengthof(test_bip341_utxos); i++) {
+    btc_coin_t *coin = btc_coin_create();
+
+    len = sizeof(raw);
+
+    hex_decode(raw, &len, test_bip341_utxos[i].script);
+
+    btc_script_set(&coin->output.script, raw, len);
+
+    coin->output.value = test_bip341_utxos[i].value;
+
+    btc_view_put(view, &tx.inputs.items[i]->prevout, coin);
+  }
+
+  memset(&cache, 0, sizeof(cache));
+
+  ASSERT(btc_tx_precompute(&cache, &tx, view));
+  ASSERT(cache.has_taproot);
+
+  for (i = 0; i < lengthof(test_bip341_spends); i++) {
+    const test_bip341_spend_t *vec = &test_bip341_spends[i];
+    btc_input_t *input = tx.inputs.items[vec->index];
+    const btc_coin_t *coin = btc_view_get(view, &input->prevout);
+    uint8_t priv[32], pub[32], root[32], tweak[32];
+    uint8_t hash[32], expect[32], sig[65];
+    size_t sig_len = sizeof(sig);
+
+    hex_parse(priv, 32, vec->priv);
+    hex_parse(expect, 32, vec->sighash);
+    hex_decode(sig, &sig_len, vec->sig);
+
+    if (vec->root != NULL)
+      hex_parse(root, 32, vec->root);
+
+    ASSERT(sig_len == 64 + (vec->type != 0));
+
+    ASSERT(btc_tx_sighash_taproot(hash, &tx, vec->index,
+                                  &coin->output.script,
+                                  coin->output.value,
+                                  vec->type, NULL, NULL,
+                                  0xffffffff, &cache));
+
+    ASSERT(memcmp(hash, expect, 32) == 0);
+
+    /* Sign with the tweaked key. */
+    ASSERT(btc_bip340_pubkey_create(pub, priv));
+
+    btc_taproot_tweak_hash(tweak, pub, vec->root != NULL ? root : NULL);
+
+    ASSERT(btc_bip340_privkey_tweak_add(priv, priv, tweak));
+    ASSERT(btc_bip340_sign(raw, hash, 32, priv, aux));
+    ASSERT(memcmp(raw, sig, 64) == 0);
+
+    if (vec->type != 0)
+      ASSERT(sig[64] == vec->type);
+
+    /* The signature spends the output. */
+    ASSERT(!btc_tx_verify_input(&tx, vec->index, &coin->output,
+                                flags, &cache));
+
+    btc_stack_push_data(&input->witness, sig, sig_len);
+
+    ASSERT(btc_tx_verify_input(&tx, vec->index, &coin->output,
+                               flags, &cache));
+  }
+
+  btc_tx_clear(&tx);
+  btc_view_destroy(view);
+}
+
 int
 main(void) {
   size_t i;
@@ -126,5 +360,9 @@ main(void) {
   for (i = 0; i < lengthof(test_invalid_vectors); i++)
     test_tx_invalid_vector(&test_invalid_vectors[i], i);
 
+  test_tx_taproot();
+  test_tx_bip341_scripts();
+  test_tx_bip341_keypath();
+
   return 0;
 }
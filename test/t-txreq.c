@@ -0,0 +1,226 @@
+/*!
+ * t-txreq.c - tx request tracker test for mako
+ * Copyright (c) 2021, Christopher Jeffrey (MIT License).
+ * https://github.com/chjj/mako
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <node/txreq.h>
+#include <mako/net.h>
+#include <mako/vector.h>
+#include "lib/tests.h"
+
+static const uint8_t hash1[32] = {1};
+static const uint8_t hash2[32] = {2};
+
+static size_t
+poll_one(btc_txreqs_t *reqs, btc_txpeer_t *peer, int64_t now, int want) {
+  btc_vector_t out;
+  size_t expired;
+
+  btc_vector_init(&out);
+
+  expired = btc_txreqs_poll(&out, reqs, peer, now);
+
+  if (want) {
+    ASSERT(out.length == 1);
+    ASSERT(memcmp(out.items[0], hash1, 32) == 0);
+  } else {
+    ASSERT(out.length == 0);
+  }
+
+  btc_vector_clear(&out);
+
+  return expired;
+}
+
+static void
+test_timeout(void) {
+  btc_txreqs_t *reqs = btc_txreqs_create();
+  btc_txpeer_t a, b, c;
+  int64_t now = 1000;
+
+  btc_txpeer_init(&a);
+  btc_txpeer_init(&b);
+  btc_txpeer_init(&c);
+
+  a.outbound = 1;
+  b.outbound = 1;
+
+  btc_txreqs_announce(reqs, &a, hash1, now);
+  btc_txreqs_announce(reqs, &b, hash1, now + 1);
+
+  /* Only the first announcer is asked. */
+  ASSERT(poll_one(reqs, &a, now, 1) == 0);
+  ASSERT(poll_one(reqs, &b, now, 0) == 0);
+  ASSERT(a.inflight == 1);
+
+  /* The request times out and falls back to the other announcer. */
+  now += BTC_NET_TX_TIMEOUT;
+
+  ASSERT(poll_one(reqs, &a, now, 0) == 1);
+  ASSERT(a.inflight == 0);
+  ASSERT(a.announced.size == 0);
+
+  ASSERT(poll_one(reqs, &b, now, 1) == 0);
+  ASSERT(b.inflight == 1);
+
+  /* A late reply from the first peer is still a reply... */
+  ASSERT(btc_txreqs_received(reqs, &a, hash1));
+  ASSERT(!btc_txreqs_has(reqs, hash1));
+  ASSERT(b.inflight == 0);
+  ASSERT(b.announced.size == 0);
+
+  /* ...as is the second peer's, racing it. */
+  ASSERT(btc_txreqs_received(reqs, &b, hash1));
+
+  /* But only once, and never from a peer that wasn't asked. */
+  ASSERT(!btc_txreqs_received(reqs, &a, hash1));
+  ASSERT(!btc_txreqs_received(reqs, &c, hash1));
+
+  btc_txpeer_clear(&a);
+  btc_txpeer_clear(&b);
+  btc_txpeer_clear(&c);
+
+  btc_txreqs_destroy(reqs);
+}
+
+static void
+test_late(void) {
+  btc_txreqs_t *reqs = btc_txreqs_create();
+  btc_txpeer_t a;
+  int64_t now = 1000;
+
+  btc_txpeer_init(&a);
+
+  a.outbound = 1;
+
+  btc_txreqs_announce(reqs, &a, hash1, now);
+
+  ASSERT(poll_one(reqs, &a, now, 1) == 0);
+
+  /* Nobody else announced it: the tx is forgotten. */
+  now += BTC_NET_TX_TIMEOUT;
+
+  ASSERT(poll_one(reqs, &a, now, 0) == 1);
+  ASSERT(!btc_txreqs_has(reqs, hash1));
+  ASSERT(a.requested.size == 1);
+
+  /* The record of the request eventually expires. */
+  now += BTC_NET_TX_LATE_TIMEOUT;
+
+  ASSERT(poll_one(reqs, &a, now, 0) == 0);
+  ASSERT(a.requested.size == 0);
+  ASSERT(!btc_txreqs_received(reqs, &a, hash1));
+
+  btc_txpeer_clear(&a);
+  btc_txreqs_destroy(reqs);
+}
+
+static void
+test_notfound(void) {
+  btc_txreqs_t *reqs = btc_txreqs_create();
+  btc_txpeer_t a, b;
+  int64_t now = 1000;
+
+  btc_txpeer_init(&a);
+  btc_txpeer_init(&b);
+
+  a.outbound = 1;
+  a.ping = 10;
+  b.outbound = 1;
+  b.ping = 20;
+
+  btc_txreqs_announce(reqs, &b, hash1, now);
+  btc_txreqs_announce(reqs, &a, hash1, now);
+
+  /* The lower ping wins. */
+  ASSERT(poll_one(reqs, &b, now, 0) == 0);
+  ASSERT(poll_one(reqs, &a, now, 1) == 0);
+
+  /* Unrequested notfound. */
+  ASSERT(!btc_txreqs_notfound(reqs, &b, hash1));
+  ASSERT(!btc_txreqs_notfound(reqs, &a, hash2));
+
+  /* The next announcer is asked. */
+  ASSERT(btc_txreqs_notfound(reqs, &a, hash1));
+  ASSERT(a.inflight == 0);
+  ASSERT(a.announced.size == 0);
+  ASSERT(btc_txreqs_has(reqs, hash1));
+
+  ASSERT(poll_one(reqs, &b, now, 1) == 0);
+
+  /* Nobody left. */
+  ASSERT(!btc_txreqs_notfound(reqs, &a, hash1));
+  ASSERT(btc_txreqs_notfound(reqs, &b, hash1));
+  ASSERT(!btc_txreqs_has(reqs, hash1));
+
+  btc_txpeer_clear(&a);
+  btc_txpeer_clear(&b);
+
+  btc_txreqs_destroy(reqs);
+}
+
+static void
+test_disconnect(void) {
+  btc_txreqs_t *reqs = btc_txreqs_create();
+  btc_txpeer_t a, b;
+  int64_t now = 1000;
+
+  btc_txpeer_init(&a);
+  btc_txpeer_init(&b);
+
+  a.outbound = 1;
+
+  /* Inbound announcements wait a moment. */
+  btc_txreqs_announce(reqs, &b, hash1, now);
+  btc_txreqs_announce(reqs, &a, hash1, now);
+  btc_txreqs_announce(reqs, &a, hash2, now);
+
+  ASSERT(poll_one(reqs, &b, now, 0) == 0);
+
+  /* Two requests in flight to the outbound peer. */
+  {
+    btc_vector_t out;
+
+    btc_vector_init(&out);
+
+    ASSERT(btc_txreqs_poll(&out, reqs, &a, now) == 0);
+    ASSERT(out.length == 2);
+    ASSERT(a.inflight == 2);
+
+    btc_vector_clear(&out);
+  }
+
+  /* The in-flight request moves to the remaining
+     announcer; a tx nobody else announced is gone. */
+  btc_txreqs_remove(reqs, &a);
+
+  ASSERT(a.inflight == 0);
+  ASSERT(a.announced.size == 0);
+  ASSERT(btc_txreqs_size(reqs) == 1);
+  ASSERT(btc_txreqs_has(reqs, hash1));
+
+  ASSERT(poll_one(reqs, &b, now, 0) == 0);
+  ASSERT(poll_one(reqs, &b, now + BTC_NET_TX_INBOUND_DELAY, 1) == 0);
+  ASSERT(b.inflight == 1);
+
+  btc_txpeer_clear(&a);
+
+  btc_txreqs_remove(reqs, &b);
+  btc_txpeer_clear(&b);
+
+  ASSERT(btc_txreqs_size(reqs) == 0);
+
+  btc_txreqs_destroy(reqs);
+}
+
+int main(void) {
+  test_timeout();
+  test_late();
+  test_notfound();
+  test_disconnect();
+  return 0;
+}
@@ -8,17 +8,28 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <io/core.h>
+
 #include <mako/crypto/rand.h>
 
 #include <mako/address.h>
+#include <mako/bip32.h>
+#include <mako/bip39.h>
+#include <mako/block.h>
 #include <mako/consensus.h>
+#include <mako/entry.h>
+#include <mako/header.h>
 #include <mako/network.h>
 #include <mako/tx.h>
 #include <mako/util.h>
 
+#include <wallet/client.h>
 #include <wallet/iterator.h>
 #include <wallet/wallet.h>
 
+
+#define BTC_PREFIX BTC_TMPPATH("wallet")
+
 #include "lib/tests.h"
 
 static btc_tx_t *
@@ -101,7 +112,419 @@ test_simple(void) {
   btc_rimraf(BTC_PREFIX);
 }
 
+static void
+test_taproot(void) {
+  const btc_network_t *network = btc_mainnet;
+  btc_walopt_t opt = *btc_walopt_default;
+  btc_address_t addr;
+  btc_balance_t bal;
+  btc_wallet_t *w;
+  btc_tx_t *tx;
+  size_t i;
+
+  opt.type = BTC_BIP32_P2TR;
+
+  w = btc_wallet_create(network, &opt);
+
+  ASSERT(btc_wallet_open(w, BTC_PREFIX));
+
+  for (i = 0; i < 10; i++) {
+    ASSERT(btc_wallet_receive(&addr, w, 0));
+    ASSERT(btc_address_is_p2tr(&addr));
+
+    tx = create_funding(&addr, 50);
+
+    ASSERT(btc_wallet_add_tx(w, tx));
+
+    btc_tx_destroy(tx);
+  }
+
+  ASSERT(btc_wallet_create_account(w, "foobar", -1));
+
+  {
+    ASSERT(btc_wallet_receive(&addr, w, 1));
+    ASSERT(btc_address_is_p2tr(&addr));
+
+    tx = create_tbs(&addr, 125);
+
+    ASSERT(btc_wallet_send(w, 0, NULL, tx));
+
+    for (i = 0; i < tx->inputs.length; i++) {
+      const btc_input_t *input = tx->inputs.items[i];
+
+      ASSERT(input->script.length == 0);
+      ASSERT(input->witness.length == 1);
+      ASSERT(input->witness.items[0]->length == 64);
+    }
+
+    btc_tx_destroy(tx);
+  }
+
+  ASSERT(btc_wallet_balance(&bal, w, 1));
+  ASSERT(bal.tx == 1);
+  ASSERT(bal.coin == 1);
+  ASSERT(bal.unconfirmed == 125 * BTC_COIN);
+
+  btc_wallet_close(w);
+  btc_wallet_destroy(w);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_watch_taproot(void) {
+  /* https://github.com/bitcoin/bips/blob/master/bip-0086.mediawiki */
+  static const char *phrase = "abandon abandon abandon abandon abandon "
+                              "abandon abandon abandon abandon abandon "
+                              "abandon about";
+  static const char *expect[2] = {
+    "bc1p5cyxnuxmeuwuvkwfem96lqzszd02n6xdcjrs20cac6yqjjwudpxqkedrcr",
+    "bc1p3qkhfews2uk44qtvauqyr2ttdsw7svhkl9nkm9s9c3x4ax5h60wqwruhk7"
+  };
+  const btc_network_t *network = btc_mainnet;
+  btc_wallet_t *w = btc_wallet_create(network, 0);
+  char xpub[BTC_BIP32_STRLEN + 1];
+  char str[BTC_ADDRESS_MAXLEN + 1];
+  btc_hdnode_t root, node;
+  btc_mnemonic_t mn;
+  btc_address_t addr;
+  uint32_t account;
+
+  ASSERT(btc_mnemonic_set_phrase(&mn, phrase));
+  ASSERT(btc_hdpriv_set_mnemonic(&root, BTC_BIP32_P2TR, &mn, NULL));
+  ASSERT(btc_hdpriv_account(&node, &root, 86, 0, 0));
+
+  /* A BIP86 account serializes as a plain xpub... */
+  btc_hdpub_get_str(xpub, &node, network);
+
+  ASSERT(memcmp(xpub, "xpub", 4) == 0);
+
+  /* ...and decodes as a standard key. */
+  ASSERT(btc_hdpub_set_str(&node, xpub, network));
+  ASSERT(node.type == BTC_BIP32_STANDARD);
+
+  node.type = BTC_BIP32_P2TR;
+
+  ASSERT(btc_wallet_open(w, BTC_PREFIX));
+  ASSERT(btc_wallet_create_watcher(w, "bip86", &node, -1));
+  ASSERT(btc_wallet_lookup(&account, w, "bip86"));
+
+  ASSERT(btc_wallet_receive(&addr, w, account));
+  ASSERT(btc_address_is_p2tr(&addr));
+
+  btc_address_get_str(str, &addr, network);
+
+  ASSERT(strcmp(str, expect[0]) == 0);
+
+  ASSERT(btc_wallet_change(&addr, w, account));
+  ASSERT(btc_address_is_p2tr(&addr));
+
+  btc_address_get_str(str, &addr, network);
+
+  ASSERT(strcmp(str, expect[1]) == 0);
+
+  btc_wallet_close(w);
+  btc_wallet_destroy(w);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+on_unlock(int result, void *arg) {
+  int *status = arg;
+  *status = result;
+}
+
+static void
+test_unlock(void) {
+  const btc_network_t *network = btc_mainnet;
+  btc_wallet_t *w = btc_wallet_create(network, 0);
+  int status = -1;
+
+  ASSERT(btc_wallet_open(w, BTC_PREFIX));
+  ASSERT(btc_wallet_encrypt(w, "foo"));
+  ASSERT(btc_wallet_locked(w));
+
+  /* The key is derived off the event loop... */
+  ASSERT(btc_wallet_unlock_async(w, "foo", 60000, on_unlock, &status));
+  ASSERT(status == -1);
+  ASSERT(btc_wallet_locked(w));
+
+  /* ...and applied on a later tick. */
+  while (status == -1) {
+    btc_wallet_tick(w);
+    btc_time_sleep(1);
+  }
+
+  ASSERT(status == 1);
+  ASSERT(!btc_wallet_locked(w));
+  ASSERT(btc_wallet_until(w) > 0);
+
+  /* Re-unlocking runs the KDF again. */
+  status = -1;
+
+  ASSERT(btc_wallet_unlock_async(w, "bar", -1, on_unlock, &status));
+
+  while (status == -1) {
+    btc_wallet_tick(w);
+    btc_time_sleep(1);
+  }
+
+  ASSERT(status == 0);
+  ASSERT(!btc_wallet_locked(w));
+  ASSERT(!btc_wallet_unlock(w, "bar", -1));
+  ASSERT(btc_wallet_until(w) > 0);
+  ASSERT(btc_wallet_unlock(w, "foo", -1));
+  ASSERT(btc_wallet_until(w) == 0);
+
+  /* A bad passphrase fails asynchronously. */
+  btc_wallet_lock(w);
+
+  status = -1;
+
+  ASSERT(btc_wallet_unlock_async(w, "bar", -1, on_unlock, &status));
+
+  while (status == -1) {
+    btc_wallet_tick(w);
+    btc_time_sleep(1);
+  }
+
+  ASSERT(status == 0);
+  ASSERT(btc_wallet_locked(w));
+
+  /* Closing completes anything outstanding. */
+  status = -1;
+
+  ASSERT(btc_wallet_unlock_async(w, "foo", -1, on_unlock, &status));
+
+  btc_wallet_close(w);
+
+  ASSERT(status != -1);
+
+  btc_wallet_destroy(w);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+static void
+test_set(void) {
+  const btc_network_t *network = btc_mainnet;
+  btc_wallet_t *a = btc_wallet_create(network, 0);
+  btc_wallet_t *b = btc_wallet_create(network, 0);
+  btc_walletset_t *set = btc_walletset_create();
+  btc_address_t addr1, addr2, addr3;
+  btc_balance_t bal;
+  btc_tx_t *tx;
+
+  btc_fs_mkdir(BTC_PREFIX);
+
+  ASSERT(btc_wallet_open(a, BTC_PREFIX "/a"));
+  ASSERT(btc_wallet_open(b, BTC_PREFIX "/b"));
+
+  ASSERT(btc_walletset_add(set, "", a));
+  ASSERT(btc_walletset_add(set, "b", b));
+  ASSERT(!btc_walletset_add(set, "b", b));
+  ASSERT(btc_walletset_size(set) == 2);
+  ASSERT(btc_walletset_get(set, "b") == b);
+
+  ASSERT(btc_wallet_receive(&addr1, a, 0));
+  ASSERT(btc_wallet_receive(&addr2, b, 0));
+
+  /* Only the owning wallet sees the transaction. */
+  tx = create_funding(&addr1, 10);
+  btc_walletset_add_tx(set, tx);
+  btc_tx_destroy(tx);
+
+  tx = create_funding(&addr2, 20);
+  btc_walletset_add_tx(set, tx);
+  btc_tx_destroy(tx);
+
+  ASSERT(btc_wallet_balance(&bal, a, -1));
+  ASSERT(bal.tx == 1);
+  ASSERT(bal.unconfirmed == 10 * BTC_COIN);
+
+  ASSERT(btc_wallet_balance(&bal, b, -1));
+  ASSERT(bal.tx == 1);
+  ASSERT(bal.unconfirmed == 20 * BTC_COIN);
+
+  /* Removed wallets stop receiving. */
+  ASSERT(btc_walletset_remove(set, "b") == b);
+  ASSERT(btc_walletset_get(set, "b") == NULL);
+
+  tx = create_funding(&addr2, 20);
+  btc_walletset_add_tx(set, tx);
+  btc_tx_destroy(tx);
+
+  ASSERT(btc_wallet_balance(&bal, b, -1));
+  ASSERT(bal.tx == 1);
+
+  /* Keys derived after the set was built are matched. */
+  ASSERT(btc_wallet_create_account(a, "foobar", -1));
+  ASSERT(btc_wallet_receive(&addr3, a, 1));
+
+  tx = create_funding(&addr3, 30);
+  btc_walletset_add_tx(set, tx);
+  btc_tx_destroy(tx);
+
+  ASSERT(btc_wallet_balance(&bal, a, 1));
+  ASSERT(bal.tx == 1);
+  ASSERT(bal.unconfirmed == 30 * BTC_COIN);
+
+  btc_walletset_destroy(set);
+
+  btc_wallet_close(a);
+  btc_wallet_close(b);
+  btc_wallet_destroy(a);
+  btc_wallet_destroy(b);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
+/*
+ * Fake Chain
+ */
+
+#define FAKE_HEIGHT 20
+#define FAKE_TIME 1600000000
+
+static btc_entry_t fake_chain[FAKE_HEIGHT];
+static int64_t fake_query = -1;
+static int32_t fake_start = -1;
+
+static void
+fake_init(void) {
+  int32_t i;
+
+  for (i = 0; i < FAKE_HEIGHT; i++) {
+    btc_entry_t *entry = &fake_chain[i];
+
+    btc_entry_init(entry);
+
+    if (i > 0)
+      btc_hash_copy(entry->header.prev_block, fake_chain[i - 1].hash);
+
+    entry->header.time = FAKE_TIME + i * 60 * 60;
+    entry->height = i;
+    entry->max_time = entry->header.time;
+
+    btc_header_hash(entry->hash, &entry->header);
+  }
+
+  fake_query = -1;
+  fake_start = -1;
+}
+
+static const btc_entry_t *
+fake_tip(void *state) {
+  (void)state;
+  return &fake_chain[FAKE_HEIGHT - 1];
+}
+
+static const btc_entry_t *
+fake_by_hash(void *state, const uint8_t *hash) {
+  int32_t i;
+
+  (void)state;
+
+  for (i = 0; i < FAKE_HEIGHT; i++) {
+    if (btc_hash_equal(fake_chain[i].hash, hash))
+      return &fake_chain[i];
+  }
+
+  return NULL;
+}
+
+static const btc_entry_t *
+fake_by_height(void *state, int32_t height) {
+  (void)state;
+
+  if (height < 0 || height >= FAKE_HEIGHT)
+    return NULL;
+
+  return &fake_chain[height];
+}
+
+static const btc_entry_t *
+fake_by_time(void *state, int64_t time) {
+  int32_t i;
+
+  (void)state;
+
+  fake_query = time;
+
+  /* Same as btc_chaindb_by_time. */
+  for (i = 0; i < FAKE_HEIGHT; i++) {
+    if (fake_chain[i].max_time >= time)
+      return &fake_chain[i];
+  }
+
+  return NULL;
+}
+
+static btc_block_t *
+fake_get_block(void *state, const btc_entry_t *entry) {
+  btc_block_t *block = btc_block_create();
+
+  (void)state;
+
+  if (fake_start < 0)
+    fake_start = entry->height;
+
+  btc_header_copy(&block->header, &entry->header);
+
+  return block;
+}
+
+static void
+test_birth(void) {
+  const btc_network_t *network = btc_mainnet;
+  int64_t birth = FAKE_TIME + 10 * 60 * 60;
+  btc_walopt_t opt = *btc_walopt_default;
+  btc_mnemonic_t mnemonic;
+  btc_wclient_t client;
+  btc_wallet_t *w;
+
+  fake_init();
+
+  btc_wclient_init(&client);
+
+  client.tip = fake_tip;
+  client.by_hash = fake_by_hash;
+  client.by_height = fake_by_height;
+  client.by_time = fake_by_time;
+  client.get_block = fake_get_block;
+
+  btc_mnemonic_generate(&mnemonic, 128);
+
+  opt.client = &client;
+  opt.mnemonic = &mnemonic;
+  opt.birth = birth;
+
+  w = btc_wallet_create(network, &opt);
+
+  ASSERT(btc_wallet_open(w, BTC_PREFIX));
+
+  /* The rescan starts two hours before the birth. */
+  ASSERT(fake_query == birth - 2 * 60 * 60);
+  ASSERT(fake_start == 8);
+  ASSERT(btc_wallet_height(w) == FAKE_HEIGHT - 1);
+
+  btc_wallet_close(w);
+  btc_wallet_destroy(w);
+
+  btc_mnemonic_clear(&mnemonic);
+
+  btc_rimraf(BTC_PREFIX);
+}
+
 int main(void) {
+  btc_fs_mkdir(BTC_TMPDIR);
+
   test_simple();
+  test_taproot();
+  test_watch_taproot();
+  test_unlock();
+  test_set();
+  test_birth();
   return 0;
 }